@@ -5,6 +5,7 @@
 #include <util/entprops.h>
 #include <util/sdkcalls.h>
 #include <mods/basemod.h>
+#include <navmesh/nav_mesh.h>
 #include <tier1/convar.h>
 #include <sdkports/sdk_takedamageinfo.h>
 #include <sdkports/sdk_traces.h>
@@ -68,6 +69,12 @@ void CBaseBot::PostAdd()
 
 std::vector<IEventListener*>* CBaseBot::GetListenerVector()
 {
+	// the interfaces and behaviors read the nav mesh, events are dropped until it's loaded
+	if (TheNavMesh->IsLoading())
+	{
+		return nullptr;
+	}
+
 	return &m_listeners;
 }
 
@@ -103,6 +110,13 @@ void CBaseBot::PlayerThink()
 		return;
 	}
 
+	// nav not ready, the bot waits until the mesh is loaded
+	if (TheNavMesh->IsLoading())
+	{
+		BuildUserCommand(0);
+		return;
+	}
+
 	// Clear the move weight from the last frame
 	GetMovementInterface()->ClearMoveWeight();
 
@@ -1,3 +1,4 @@
+#include <string_view>
 #include <extension.h>
 #include <navmesh/nav_mesh.h>
 #include <navmesh/nav_area.h>
@@ -113,3 +114,18 @@ float CBaseBotPathCost::operator()(CNavArea* toArea, CNavArea* fromArea, const C
 
 	return cost;
 }
+
+bool CBaseBotPathCost::GetPathCacheKey(std::size_t& key) const
+{
+	key = std::hash<std::string_view>{}("CBaseBotPathCost");
+	NavHashCombineValue(key, m_stepheight);
+	NavHashCombineValue(key, m_maxjumpheight);
+	NavHashCombineValue(key, m_maxdropheight);
+	NavHashCombineValue(key, m_maxdjheight);
+	NavHashCombineValue(key, m_maxgapjumpdistance);
+	NavHashCombineValue(key, m_candoublejump);
+	NavHashCombineValue(key, m_canblastjump);
+	return true;
+}
+
+NAV_INSTANTIATE_PATH_SEARCH(CBaseBotPathCost);
@@ -4,12 +4,13 @@
 #include "basebot.h"
 #include "interfaces/path/basepath.h"
 
-class CBaseBotPathCost : public IPathCost
+class CBaseBotPathCost final : public IPathCost
 {
 public:
 	CBaseBotPathCost(CBaseBot* bot);
 
 	float operator()(CNavArea* toArea, CNavArea* fromArea, const CNavLadder* ladder, const NavOffMeshConnection* link, const CNavElevator* elevator, float length) const override;
+	bool GetPathCacheKey(std::size_t& key) const override;
 
 private:
 	CBaseBot* m_me;
@@ -22,4 +23,6 @@ private:
 	bool m_canblastjump;
 };
 
+NAV_DECLARE_PATH_SEARCH(CBaseBotPathCost);
+
 #endif // !NAVBOT_BASE_BOT_PATH_COST_H_
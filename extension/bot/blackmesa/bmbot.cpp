@@ -1,3 +1,4 @@
+#include <string_view>
 #include <extension.h>
 #include <util/entprops.h>
 #include <mods/blackmesa/blackmesadm_mod.h>
@@ -196,3 +197,19 @@ float CBlackMesaBotPathCost::operator()(CNavArea* toArea, CNavArea* fromArea, co
 
 	return cost;
 }
+
+bool CBlackMesaBotPathCost::GetPathCacheKey(std::size_t& key) const
+{
+	key = std::hash<std::string_view>{}("CBlackMesaBotPathCost");
+	NavHashCombineValue(key, static_cast<int>(m_routetype));
+	NavHashCombineValue(key, m_stepheight);
+	NavHashCombineValue(key, m_maxjumpheight);
+	NavHashCombineValue(key, m_maxdropheight);
+	NavHashCombineValue(key, m_maxdjheight);
+	NavHashCombineValue(key, m_maxgapjumpdistance);
+	NavHashCombineValue(key, m_candoublejump);
+	NavHashCombineValue(key, m_canblastjump);
+	return true;
+}
+
+NAV_INSTANTIATE_PATH_SEARCH(CBlackMesaBotPathCost);
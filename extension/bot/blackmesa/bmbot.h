@@ -40,12 +40,13 @@ private:
 	std::unique_ptr<CBlackMesaBotInventory> m_bminventory;
 };
 
-class CBlackMesaBotPathCost : public IPathCost
+class CBlackMesaBotPathCost final : public IPathCost
 {
 public:
 	CBlackMesaBotPathCost(CBlackMesaBot* bot, RouteType routetype = FASTEST_ROUTE);
 
 	float operator()(CNavArea* toArea, CNavArea* fromArea, const CNavLadder* ladder, const NavOffMeshConnection* link, const CNavElevator* elevator, float length) const override;
+	bool GetPathCacheKey(std::size_t& key) const override;
 
 private:
 	CBlackMesaBot* m_me;
@@ -59,4 +60,6 @@ private:
 	bool m_canblastjump;
 };
 
+NAV_DECLARE_PATH_SEARCH(CBlackMesaBotPathCost);
+
 #endif // !NAVBOT_BLACKMESA_BOT_H_
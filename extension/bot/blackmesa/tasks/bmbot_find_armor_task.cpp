@@ -1,7 +1,9 @@
+#include <vector>
 #include <extension.h>
 #include <util/helpers.h>
 #include <util/entprops.h>
 #include <util/librandom.h>
+#include <navmesh/nav_pathfind.h>
 #include <bot/blackmesa/bmbot.h>
 #include "bmbot_find_armor_task.h"
 
@@ -194,28 +196,25 @@ bool CBlackMesaBotFindArmorTask::FindArmorSource(CBlackMesaBot* bot, CBaseEntity
 	// select the nearest armor source
 	if (filterByDistance)
 	{
-		float best = maxRange;
-		CBaseEntity* out = nullptr;
+		std::vector<NavTravelCandidate> candidates;
+		candidates.reserve(sources.size());
 
 		for (CBaseEntity* entity : sources)
 		{
 			const Vector& end = UtilHelpers::getEntityOrigin(entity);
-			float range = (start - end).Length();
-
-			if (range < best)
-			{
-				best = range;
-				out = entity;
-			}
+			candidates.push_back({ TheNavMesh->GetNearestNavArea(end, 256.0f, false, true), (start - end).Length(), 1.0f });
 		}
 
-		if (out == nullptr)
+		// rank by travel distance, the sources were collected within maxRange in a straight line
+		const int selected = NavSelectNearestCandidate(bot->GetLastKnownNavArea(), bot->GetCurrentTeamIndex(), maxRange, candidates);
+
+		if (selected < 0)
 		{
-			// this shouldn't happen
+			// none of them are reachable
 			return false;
 		}
 
-		*armorSource = out;
+		*armorSource = sources[selected];
 	}
 	else
 	{
@@ -3,6 +3,7 @@
 #include <bot/basebot.h>
 #include <navmesh/nav_mesh.h>
 #include <navmesh/nav_area.h>
+#include <navmesh/nav_areatracker.h>
 #include <util/helpers.h>
 #include <util/sdkcalls.h>
 #include <entities/baseentity.h>
@@ -85,7 +86,18 @@ void CKnownEntity::UpdatePosition()
 		m_timelastinfo = gpGlobals->curtime;
 		m_lastknownposition = be.GetAbsOrigin();
 		m_lastknownvelocity = be.GetAbsVelocity();
-		m_lastknownarea = TheNavMesh->GetNearestNavArea(m_lastknownposition, NAV_AREA_DIST);
+		m_lastknownarea = nullptr;
+
+		// players have their area tracked every tick
+		if (UtilHelpers::IsPlayerIndex(be.GetIndex()) && TheNavMesh->GetAreaTracker()->IsEnabled())
+		{
+			m_lastknownarea = TheNavMesh->GetAreaTracker()->GetArea(be.GetIndex());
+		}
+
+		if (m_lastknownarea == nullptr)
+		{
+			m_lastknownarea = TheNavMesh->GetNearestNavArea(m_lastknownposition, NAV_AREA_DIST);
+		}
 	}
 }
 
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <limits>
 #include <cmath>
 
@@ -17,6 +18,7 @@
 
 static ConVar sm_navbot_path_segment_draw_limit("sm_navbot_path_segment_draw_limit", "25", FCVAR_GAMEDLL | FCVAR_DONTRECORD, "Path segment draw limit.");
 static ConVar sm_navbot_path_max_segments("sm_navbot_path_max_segments", "128", FCVAR_GAMEDLL | FCVAR_DONTRECORD, "Maximum number of path segments. Affects performance.");
+static ConVar sm_navbot_path_funnel("sm_navbot_path_funnel", "1", FCVAR_GAMEDLL | FCVAR_DONTRECORD, "Pulls ground paths tight through the area portals and removes the segments left on straight lines.");
 
 CPath::CPath() :
 	m_ageTimer()
@@ -27,9 +29,168 @@ CPath::CPath() :
 
 CPath::~CPath()
 {
+	CancelPathComputation();
 	m_segments.clear();
 }
 
+CBasePathSegment* CPath::CreateNewSegment()
+{
+	CBasePathSegment* segment = nullptr;
+
+	if (!m_freesegments.empty())
+	{
+		segment = m_freesegments.back();
+		m_freesegments.pop_back();
+		segment->Reset();
+		return segment;
+	}
+
+	segment = AllocNewSegment();
+	m_segmentpool.emplace_back(segment);
+	return segment;
+}
+
+void CPath::CancelPathComputation()
+{
+	if (m_pendingsearch)
+	{
+		m_pendingsearch->Cancel();
+		m_pendingsearch.reset();
+	}
+}
+
+bool CPath::SetupPathSearch(CBaseBot* bot, const Vector& goal, CNavArea** startArea, CNavArea** goalArea, Vector* endPos, bool* result)
+{
+	*startArea = bot->GetLastKnownNavArea();
+
+	if (*startArea == nullptr)
+	{
+		Invalidate();
+		OnPathChanged(bot, AIPath::ResultType::NO_PATH);
+		*result = false;
+		return false;
+	}
+
+	*goalArea = TheNavMesh->GetNearestNavArea(goal, MAX_DISTANCE_TO_GOAL_AREA, true, true);
+
+	if (*goalArea == *startArea)
+	{
+		BuildTrivialPath(bot->GetAbsOrigin(), goal);
+		OnPathChanged(bot, AIPath::ResultType::COMPLETE_PATH);
+		*result = true;
+		return false;
+	}
+
+	*endPos = goal;
+
+	if (*goalArea)
+	{
+		endPos->z = (*goalArea)->GetZ(*endPos);
+	}
+	else
+	{
+		TheNavMesh->GetGroundHeight(*endPos, &endPos->z);
+	}
+
+	return true;
+}
+
+bool CPath::BuildPathFromSearch(CBaseBot* bot, const Vector& start, const Vector& goal, const Vector& endPos, const std::vector<SearchPathArea>& areas, const bool pathBuildResult, const bool includeGoalOnFailure)
+{
+	if (areas.empty())
+	{
+		OnPathChanged(bot, AIPath::ResultType::NO_PATH);
+		return false; // no path
+	}
+
+	if (areas.size() == 1)
+	{
+		BuildTrivialPath(start, goal);
+		OnPathChanged(bot, AIPath::ResultType::COMPLETE_PATH);
+		return true;
+	}
+
+	// the path is built from end to start, include the end position first
+	if (pathBuildResult == true || includeGoalOnFailure == true)
+	{
+		CBasePathSegment* segment = CreateNewSegment();
+
+		segment->area = areas.front().area;
+		segment->goal = endPos;
+		segment->type = AIPath::SegmentType::SEGMENT_GROUND;
+
+		m_segments.push_back(segment);
+	}
+
+	// construct the path segments
+	// Reminder: areas are added to the back of the segment vector, the first area is the goal area.
+	for (auto& pathArea : areas)
+	{
+		CBasePathSegment* segment = CreateNewSegment();
+
+		segment->area = pathArea.area;
+		segment->how = pathArea.how;
+
+		m_segments.push_back(segment);
+	}
+
+	// Place the path start at the vector start
+	std::reverse(m_segments.begin(), m_segments.end());
+
+	if (ProcessCurrentPath(bot, start) == false)
+	{
+		Invalidate(); // destroy the path so IsValid returns false
+		OnPathChanged(bot, AIPath::ResultType::NO_PATH);
+		return false;
+	}
+
+	PostProcessPath(bot);
+
+	if (pathBuildResult == true)
+	{
+		OnPathChanged(bot, AIPath::ResultType::COMPLETE_PATH);
+	}
+	else
+	{
+		OnPathChanged(bot, AIPath::ResultType::PARTIAL_PATH);
+	}
+
+	return pathBuildResult;
+}
+
+void CPath::OnAsyncPathSearchFinished(CPathAsyncSearchBase* search)
+{
+	// keeps the search alive, the slicer still holds a reference to it
+	m_pendingsearch.reset();
+	Invalidate();
+
+	if (search->useCache)
+	{
+		TheNavMesh->GetPathCache()->Store(search->cacheKey, search->cacheGeneration, search->areas, search->result);
+	}
+
+	CBaseBot* bot = search->GetBot();
+	CNavArea* currentArea = bot->GetLastKnownNavArea();
+
+	// the bot kept moving while the search ran, drop the areas it already left behind so the path starts on its current area
+	if (currentArea != nullptr && currentArea != search->startArea)
+	{
+		auto it = std::find_if(search->areas.begin(), search->areas.end(), [currentArea](const SearchPathArea& pathArea) { return pathArea.area == currentArea; });
+
+		if (it != search->areas.end())
+		{
+			search->areas.erase(it + 1, search->areas.end());
+		}
+	}
+
+	BuildPathFromSearch(bot, bot->GetAbsOrigin(), search->goal, search->endPos, search->areas, search->result, search->includeGoalOnFailure);
+}
+
+void CPathAsyncSearchBase::Finish()
+{
+	m_path->OnAsyncPathSearchFinished(this);
+}
+
 bool CPath::BuildTrivialPath(const Vector& start, const Vector& goal)
 {
 	constexpr float NAV_MAX_DIST = 1024.0f;
@@ -42,8 +203,8 @@ bool CPath::BuildTrivialPath(const Vector& start, const Vector& goal)
 
 	Invalidate(); // destroy any path that exists
 
-	std::shared_ptr<CBasePathSegment> startSeg = CreateNewSegment();
-	std::shared_ptr<CBasePathSegment> endSeg = CreateNewSegment();
+	CBasePathSegment* startSeg = CreateNewSegment();
+	CBasePathSegment* endSeg = CreateNewSegment();
 
 	startSeg->area = startArea;
 	startSeg->goal = start;
@@ -56,8 +217,9 @@ bool CPath::BuildTrivialPath(const Vector& start, const Vector& goal)
 	endSeg->forward = startSeg->forward;
 	endSeg->distance = startSeg->length;
 
-	m_segments.push_back(std::move(startSeg));
-	m_segments.push_back(std::move(endSeg));
+	m_segments.push_back(startSeg);
+	m_segments.push_back(endSeg);
+	BuildSegmentIndex();
 	m_ageTimer.Start();
 
 	return true;
@@ -153,62 +315,104 @@ void CPath::MoveCursorToClosestPosition(const Vector& pos, SeekType type, float
 
 	if (type == SEEK_ENTIRE_PATH || type == SEEK_AHEAD)
 	{
-		const CBasePathSegment* segment;
+		size_t startIndex = 0;
 
-		if (type == SEEK_AHEAD)
+		if (type == SEEK_AHEAD && m_cursor.segment != nullptr)
 		{
 			// continue search from existing data
-			if (m_cursor.segment != nullptr)
-			{
-				segment = m_cursor.segment;
-			}
-			else
+			startIndex = GetSegmentIndex(m_cursor.segment);
+
+			if (startIndex == INVALID_SEGMENT_INDEX)
 			{
-				// get start instead
-				segment = GetFirstSegment();
+				startIndex = 0; // get start instead
 			}
 		}
-		else
+
+		// the last segment doesn't have a line to a next segment
+		size_t endIndex = m_segments.size() - 1;
+
+		if (alongLimit != 0.0f)
 		{
-			// search entire path from the start
-			segment = GetFirstSegment();
+			// segments are sorted by distance, skip the ones beyond the limit
+			const float maxDistance = m_segments[startIndex]->distance + alongLimit;
+			auto it = std::upper_bound(std::next(m_segments.begin(), startIndex), std::next(m_segments.begin(), endIndex), maxDistance, [](float distance, const CBasePathSegment* segment) {
+				return distance < segment->distance;
+			});
+
+			endIndex = static_cast<size_t>(std::distance(m_segments.begin(), it));
 		}
 
 		m_cursor.position = pos;
-		m_cursor.segment = segment;
+		m_cursor.segment = m_segments[startIndex];
 		float closeRangeSq = std::numeric_limits<float>::max();
+		size_t closeIndex = startIndex;
 
-		float distanceSoFar = 0.0f;
-		while (alongLimit == 0.0f || distanceSoFar <= alongLimit)
-		{
-			auto next = GetNextSegment(segment);
-
-			if (next != nullptr)
+		auto searchlines = [this, &pos, &closeRangeSq, &closeIndex](size_t first, size_t last) {
+			for (size_t i = first; i < last; i++)
 			{
+				const CBasePathSegment* segment = m_segments[i];
 				Vector close;
-				CalcClosestPointOnLineSegment(pos, segment->goal, next->goal, close);
+				CalcClosestPointOnLineSegment(pos, segment->goal, m_segments[i + 1]->goal, close);
 
-				float rangeSq = (close - pos).LengthSqr();
-				if (rangeSq < closeRangeSq)
+				const float rangeSq = (close - pos).LengthSqr();
+
+				// on ties, the segment closer to the path start wins
+				if (rangeSq < closeRangeSq || (rangeSq == closeRangeSq && i < closeIndex))
 				{
 					m_cursor.position = close;
 					m_cursor.segment = segment;
-
 					closeRangeSq = rangeSq;
+					closeIndex = i;
 				}
 			}
-			else
+		};
+
+		if (m_segmentruns.empty())
+		{
+			searchlines(startIndex, endIndex);
+		}
+		else
+		{
+			// search the runs nearest to the position first, stop once the runs left are farther away than the closest line found
+			m_seekruns.clear();
+
+			for (size_t run = startIndex / SEGMENT_RUN_SIZE; run < m_segmentruns.size() && m_segmentruns[run].first < endIndex; run++)
 			{
-				break;
+				const SegmentRun& bounds = m_segmentruns[run];
+				float distanceSq = 0.0f;
+
+				for (int axis = 0; axis < 3; axis++)
+				{
+					const float below = bounds.mins[axis] - pos[axis];
+					const float above = pos[axis] - bounds.maxs[axis];
+					const float outside = std::max(0.0f, std::max(below, above));
+					distanceSq += outside * outside;
+				}
+
+				m_seekruns.emplace_back(distanceSq, run);
 			}
 
-			distanceSoFar += segment->length;
-			segment = next;
+			std::sort(m_seekruns.begin(), m_seekruns.end());
+
+			for (auto& seekrun : m_seekruns)
+			{
+				if (seekrun.first > closeRangeSq)
+				{
+					break;
+				}
+
+				const SegmentRun& bounds = m_segmentruns[seekrun.second];
+				searchlines(std::max(bounds.first, startIndex), std::min(bounds.last, endIndex));
+			}
 		}
 
-		segment = m_cursor.segment;
+		const CBasePathSegment* segment = m_cursor.segment;
+		float t = 0.0f;
 
-		float t = (m_cursor.position - segment->goal).Length() / segment->length;
+		if (segment->length > 0.0f)
+		{
+			t = (m_cursor.position - segment->goal).Length() / segment->length;
+		}
 
 		m_cursorPos = segment->distance + t * segment->length;
 		m_cursor.outdated = true;
@@ -230,7 +434,7 @@ const CPath::PathCursor& CPath::GetCursorData()
 				m_cursor.position = seg->goal;
 				m_cursor.forward = seg->forward;
 				m_cursor.curvature = seg->curvature;
-				m_cursor.segment = seg.get();
+				m_cursor.segment = seg;
 			}
 			else if (m_cursorPos > GetPathLength() + error)
 			{
@@ -239,65 +443,56 @@ const CPath::PathCursor& CPath::GetCursorData()
 				m_cursor.position = seg->goal;
 				m_cursor.forward = seg->forward;
 				m_cursor.curvature = seg->curvature;
-				m_cursor.segment = seg.get();
+				m_cursor.segment = seg;
 			}
 			else
 			{
-				// find segment along the path
-				float lengthSoFar = 0.0f;
-				auto current = GetFirstSegment();
-				auto next = GetNextSegment(current);
+				// find segment along the path, the segment distances are the running sum of the segment lengths
+				auto it = std::upper_bound(std::next(m_segments.begin()), m_segments.end(), m_cursorPos, [](float distance, const CBasePathSegment* segment) {
+					return distance < segment->distance;
+				});
 
-				while (next != nullptr)
+				if (it != m_segments.end())
 				{
-					float length = current->length;
+					const CBasePathSegment* current = *std::prev(it);
+					const CBasePathSegment* next = *it;
+					const float length = current->length;
+					const float overlap = m_cursorPos - current->distance;
+					float t = 0.0f;
 
-					if (lengthSoFar + length > m_cursorPos)
+					if (length > 0.0f)
 					{
-						float overlap = m_cursorPos - lengthSoFar;
-						float t = 0.0f;
-
-						if (length > 0.0f)
-						{
-							t = overlap / length;
-						}
+						t = overlap / length;
+					}
 
-						// apply interpolation
-						m_cursor.position = current->goal + t * (next->goal - current->goal);
-						m_cursor.forward = current->forward + t * (next->forward - current->forward);
-						m_cursor.segment = current;
+					// apply interpolation
+					m_cursor.position = current->goal + t * (next->goal - current->goal);
+					m_cursor.forward = current->forward + t * (next->forward - current->forward);
+					m_cursor.segment = current;
 
-						constexpr float INFLUENCE_RADIUS = 100.0f;
+					constexpr float INFLUENCE_RADIUS = 100.0f;
 
-						if (overlap < INFLUENCE_RADIUS)
+					if (overlap < INFLUENCE_RADIUS)
+					{
+						if (length - overlap < INFLUENCE_RADIUS)
 						{
-							if (length - overlap < INFLUENCE_RADIUS)
-							{
-								// near both start and end, needs interpolation
-								float startCurvature = current->curvature * (1.0f - (overlap / INFLUENCE_RADIUS));
-								float endCurvature = next->curvature * (1.0f - ((length - overlap) / INFLUENCE_RADIUS));
-
-								m_cursor.curvature = (startCurvature + endCurvature) / 2.0f;
-							}
-							else
-							{
-								// near start
-								m_cursor.curvature = current->curvature * (1.0f - (overlap / INFLUENCE_RADIUS));
-							}
+							// near both start and end, needs interpolation
+							float startCurvature = current->curvature * (1.0f - (overlap / INFLUENCE_RADIUS));
+							float endCurvature = next->curvature * (1.0f - ((length - overlap) / INFLUENCE_RADIUS));
+
+							m_cursor.curvature = (startCurvature + endCurvature) / 2.0f;
 						}
-						else if (length - overlap < INFLUENCE_RADIUS)
+						else
 						{
-							// near end
-							m_cursor.curvature = next->curvature * (1.0f - ((length - overlap) / INFLUENCE_RADIUS));
+							// near start
+							m_cursor.curvature = current->curvature * (1.0f - (overlap / INFLUENCE_RADIUS));
 						}
-
-						break;
 					}
-
-					lengthSoFar += length;
-
-					current = next;
-					next = GetNextSegment(next);
+					else if (length - overlap < INFLUENCE_RADIUS)
+					{
+						// near end
+						m_cursor.curvature = next->curvature * (1.0f - ((length - overlap) / INFLUENCE_RADIUS));
+					}
 				}
 			}
 
@@ -313,6 +508,39 @@ const CPath::PathCursor& CPath::GetCursorData()
 	return m_cursor;
 }
 
+void CPath::BuildSegmentIndex()
+{
+	m_segmentruns.clear();
+
+	for (size_t i = 0; i < m_segments.size(); i++)
+	{
+		m_segments[i]->index = i;
+	}
+
+	// runs cover the lines from each segment to the next one, the last segment doesn't start a line
+	for (size_t first = 0; first + 1 < m_segments.size(); first += SEGMENT_RUN_SIZE)
+	{
+		SegmentRun run;
+		run.first = first;
+		run.last = std::min(first + SEGMENT_RUN_SIZE, m_segments.size() - 1);
+		run.mins = m_segments[first]->goal;
+		run.maxs = m_segments[first]->goal;
+
+		for (size_t i = first + 1; i <= run.last; i++)
+		{
+			const Vector& goal = m_segments[i]->goal;
+
+			for (int axis = 0; axis < 3; axis++)
+			{
+				run.mins[axis] = std::min(run.mins[axis], goal[axis]);
+				run.maxs[axis] = std::max(run.maxs[axis], goal[axis]);
+			}
+		}
+
+		m_segmentruns.push_back(run);
+	}
+}
+
 /**
  * @brief Analyze the current path
  * @param bot Bot that will use this path
@@ -334,7 +562,7 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 		m_segments.erase(std::next(m_segments.begin(), maxSegments - 1), m_segments.end());
 	}
 
-	auto& startSeg = m_segments[0];
+	CBasePathSegment* startSeg = m_segments[0];
 
 	// If the starting area is inside the start area, then use it
 	if (startSeg->area->Contains(start))
@@ -352,15 +580,15 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 	startSeg->how = NUM_TRAVERSE_TYPES;
 	startSeg->type = AIPath::SegmentType::SEGMENT_GROUND;
 
-	std::stack<PathInsertSegmentInfo> insertstack;
+	std::vector<PathInsertSegmentInfo> insertlist;
 
 	bool failed = false;
 
 	// first iteration
 	for (size_t i = 1; i < m_segments.size(); i++)
 	{
-		auto& to = m_segments[i];
-		auto& from = m_segments[i - 1];
+		CBasePathSegment* to = m_segments[i];
+		CBasePathSegment* from = m_segments[i - 1];
 
 		switch (to->how)
 		{
@@ -371,7 +599,7 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 		case GO_SOUTH:
 			[[fallthrough]];
 		case GO_WEST:
-			if (!ProcessGroundPath(bot, i, start, from, to, insertstack))
+			if (!ProcessGroundPath(bot, i, start, from, to, insertlist))
 			{
 				failed = true;
 			}
@@ -379,7 +607,7 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 		case GO_LADDER_UP:
 			[[fallthrough]];
 		case GO_LADDER_DOWN:
-			if (!ProcessLaddersInPath(bot, from, to, insertstack))
+			if (!ProcessLaddersInPath(bot, i, from, to, insertlist))
 			{
 				failed = true;
 			}
@@ -387,7 +615,7 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 
 		case GO_OFF_MESH_CONNECTION:
 		{
-			if (!ProcessOffMeshConnectionsInPath(bot, i, from, to, insertstack))
+			if (!ProcessOffMeshConnectionsInPath(bot, i, from, to, insertlist))
 			{
 				failed = true;
 			}
@@ -397,7 +625,7 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 			[[fallthrough]];
 		case GO_ELEVATOR_DOWN:
 		{
-			if (!ProcessElevatorsInPath(bot, from, to, insertstack))
+			if (!ProcessElevatorsInPath(bot, i, from, to, insertlist))
 			{
 				failed = true;
 			}
@@ -416,8 +644,8 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 		// Second iteration, handle jump and climbing
 		for (size_t i = 1; i < m_segments.size(); i++)
 		{
-			auto& to = m_segments[i];
-			auto& from = m_segments[i - 1];
+			CBasePathSegment* to = m_segments[i];
+			CBasePathSegment* from = m_segments[i - 1];
 
 			if (from->how != NUM_TRAVERSE_TYPES && from->how > GO_WEST)
 				continue;
@@ -428,7 +656,7 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 			if (to->how == GO_OFF_MESH_CONNECTION)
 				continue;
 
-			if (ProcessPathJumps(bot, from, to, insertstack) == false)
+			if (ProcessPathJumps(bot, i, from, to, insertlist) == false)
 			{
 				failed = true;
 				break;
@@ -436,47 +664,42 @@ bool CPath::ProcessCurrentPath(CBaseBot* bot, const Vector& start)
 		}
 	}
 
-	// Path process failed, clean up insert stack and exit
-	if (failed == true)
+	// Path process failed, the new segments go back to the pool when the path is invalidated.
+	// A failed ladder or link lookup with nothing queued for insertion keeps the path as is, like the old insert stack did.
+	if (failed == true && !insertlist.empty())
 	{
-		while (insertstack.empty() == false)
-		{
-			// auto& insert = insertstack.top();
-			// delete insert.newSeg;
-			insertstack.pop();
-			return false;
-		}
+		return false;
 	}
 
-	// process insert stack and add any new needed segments into the path
-	while (insertstack.empty() == false)
+	// add the new segments into the path, the last queued segment is added first
+	for (size_t n = insertlist.size(); n > 0; n--)
 	{
-		auto& insert = insertstack.top(); // get top element
-		auto& seg = insert.Seg;
-		auto it = std::find(m_segments.begin(), m_segments.end(), seg);
+		const PathInsertSegmentInfo& insert = insertlist[n - 1];
+		size_t position = insert.index;
 
-		if (it != m_segments.end() || (it == m_segments.end() && !insert.after)) // got iterator of where we need to insert
+		// shift by the segments already added in front of the anchor segment
+		for (size_t k = n; k < insertlist.size(); k++)
 		{
-			if (insert.after)
+			const PathInsertSegmentInfo& other = insertlist[k];
+
+			if (other.index < insert.index || (other.index == insert.index && !other.after))
 			{
-				it++; // by default, it will be added before the element of the iterator
+				position++;
 			}
-
-			m_segments.insert(it, std::move(insert.newSeg));
 		}
-		else
+
+		if (insert.after)
 		{
-			// delete insert.newSeg;
+			position++; // by default, it will be added before the anchor segment
 		}
 
-		insertstack.pop(); // remove top element
+		m_segments.insert(std::next(m_segments.begin(), position), insert.newSeg);
 	}
 
-
 	return true;
 }
 
-bool CPath::ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& start, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert)
+bool CPath::ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& start, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert)
 {
 	IMovement* mover = bot->GetMovementInterface();
 
@@ -538,8 +761,8 @@ bool CPath::ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& s
 				to->goal = startDrop;
 				to->type = AIPath::SegmentType::SEGMENT_GROUND;
 
-				std::shared_ptr<CBasePathSegment> newSegment = CreateNewSegment();
-				newSegment->CopySegment(to.get());
+				CBasePathSegment* newSegment = CreateNewSegment();
+				newSegment->CopySegment(to);
 
 				newSegment->goal.x = endDrop.x;
 				newSegment->goal.y = endDrop.y;
@@ -560,13 +783,13 @@ bool CPath::ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& s
 				if (result.DidHit()) // probably collided with a railing
 				{
 					to->goal = result.endpos;
-					std::shared_ptr<CBasePathSegment> seg2 = CreateNewSegment();
-					seg2->CopySegment(to.get());
+					CBasePathSegment* seg2 = CreateNewSegment();
+					seg2->CopySegment(to);
 					seg2->goal = startDrop + Vector(0.0f, 0.0f, mover->GetStepHeight());
 					seg2->type = AIPath::SegmentType::SEGMENT_CLIMB_UP;
 
-					std::shared_ptr<CBasePathSegment> jumpRunSegment = CreateNewSegment();
-					jumpRunSegment->CopySegment(from.get());
+					CBasePathSegment* jumpRunSegment = CreateNewSegment();
+					jumpRunSegment->CopySegment(from);
 					jumpRunSegment->type = AIPath::SegmentType::SEGMENT_GROUND;
 
 					Vector runDir = (jumpRunSegment->goal - result.endpos);
@@ -574,13 +797,14 @@ bool CPath::ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& s
 					runDir.NormalizeInPlace();
 					jumpRunSegment->goal = result.endpos + (runDir * (mover->GetHullWidth() * 1.2f));
 
-					pathinsert.emplace(seg2, jumpRunSegment, false);
-					pathinsert.emplace(newSegment, seg2, false);
+					// after 'to': jump run, climb, drop
+					pathinsert.emplace_back(index, jumpRunSegment, true);
+					pathinsert.emplace_back(index, seg2, true);
 				}
 
 #endif
 
-				pathinsert.emplace(to, newSegment, true);
+				pathinsert.emplace_back(index, newSegment, true);
 			}
 		}
 	}
@@ -588,7 +812,7 @@ bool CPath::ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& s
 	return true;
 }
 
-bool CPath::ProcessLaddersInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert)
+bool CPath::ProcessLaddersInPath(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert)
 {
 	switch (to->how)
 	{
@@ -657,7 +881,7 @@ bool CPath::ProcessLaddersInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegment
 	return true;
 }
 
-bool CPath::ProcessElevatorsInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert)
+bool CPath::ProcessElevatorsInPath(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert)
 {
 	const CNavElevator* elevator = from->area->GetElevator();
 
@@ -676,7 +900,7 @@ bool CPath::ProcessElevatorsInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegme
 	segment->CopySegment(from);
 	segment->goal = from->area->GetCenter();
 	segment->type = AIPath::SegmentType::SEGMENT_ELEVATOR;
-	pathinsert.emplace(to, std::move(segment), false); // Insert before to
+	pathinsert.emplace_back(index, segment, false); // Insert before to
 
 	to->goal = to->area->GetCenter();
 	to->type = AIPath::SegmentType::SEGMENT_GROUND;
@@ -684,7 +908,7 @@ bool CPath::ProcessElevatorsInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegme
 	return true;
 }
 
-bool CPath::ProcessPathJumps(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert)
+bool CPath::ProcessPathJumps(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert)
 {
 	auto mover = bot->GetMovementInterface();
 	// get closest point from areas to test for a gap
@@ -717,13 +941,13 @@ bool CPath::ProcessPathJumps(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& f
 		// Adjust goal for optimal jump landing
 		to->goal = landing + jumpforward * halfwidth;
 
-		std::shared_ptr<CBasePathSegment> newSegment = CreateNewSegment();
+		CBasePathSegment* newSegment = CreateNewSegment();
 
 		newSegment->CopySegment(from);
 		newSegment->goal = jumpfrom - jumpforward * halfwidth;
 		newSegment->type = AIPath::SegmentType::SEGMENT_JUMP_OVER_GAP;
 
-		pathinsert.emplace(from, std::move(newSegment), true);
+		pathinsert.emplace_back(index - 1, newSegment, true);
 	}
 	else if (zdiff > fullstepsize) // too high to just walk, must climb/jump
 	{
@@ -742,19 +966,19 @@ bool CPath::ProcessPathJumps(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& f
 		from->area->GetClosestPointOnArea(to->goal, &jumppos);
 		
 		// Create a new ground segment towards the jump position
-		std::shared_ptr<CBasePathSegment> newSegment = CreateNewSegment();
+		CBasePathSegment* newSegment = CreateNewSegment();
 
 		newSegment->CopySegment(from);
 		newSegment->goal = jumppos;
 		newSegment->type = AIPath::SegmentType::SEGMENT_GROUND;
 
-		pathinsert.emplace(from, std::move(newSegment), true);
+		pathinsert.emplace_back(index - 1, newSegment, true);
 	}
 
 	return true;
 }
 
-bool CPath::ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert)
+bool CPath::ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert)
 {
 	auto link = from->area->GetOffMeshConnectionToArea(to->area);
 
@@ -785,7 +1009,7 @@ bool CPath::ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, s
 			segpoint_to_end->how = GO_OFF_MESH_CONNECTION;
 			segpoint_to_end->type = AIPath::SEGMENT_GROUND;
 			segpoint_to_end->goal = link->GetEnd();
-			pathinsert.emplace(to, std::move(segpoint_to_end), false);
+			pathinsert.emplace_back(index, segpoint_to_end, false);
 			break;
 		}
 
@@ -809,8 +1033,8 @@ bool CPath::ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, s
 		post->goal = link->GetEnd();
 		post->type = AIPath::SEGMENT_GROUND;
 
-		pathinsert.emplace(to, std::move(post), false);
-		pathinsert.emplace(to, std::move(between), false); // insert before 'to'
+		pathinsert.emplace_back(index, post, false);
+		pathinsert.emplace_back(index, between, false); // insert before 'to'
 		break;
 	}
 	case OffMeshConnectionType::OFFMESH_BLAST_JUMP:
@@ -836,8 +1060,8 @@ bool CPath::ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, s
 		rjseg->how = GO_OFF_MESH_CONNECTION;
 		rjseg->type = AIPath::SEGMENT_BLAST_JUMP;
 
-		pathinsert.emplace(to, std::move(between), false); // insert before 'to'
-		pathinsert.emplace(to, std::move(rjseg), false);
+		pathinsert.emplace_back(index, between, false); // insert before 'to'
+		pathinsert.emplace_back(index, rjseg, false);
 		break;
 	}
 	case OffMeshConnectionType::OFFMESH_DOUBLE_JUMP:
@@ -862,8 +1086,8 @@ bool CPath::ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, s
 		post->goal = link->GetEnd();
 		post->type = AIPath::SEGMENT_CLIMB_DOUBLE_JUMP;
 
-		pathinsert.emplace(to, std::move(post), false);
-		pathinsert.emplace(to, std::move(between), false); // insert before 'to'
+		pathinsert.emplace_back(index, post, false);
+		pathinsert.emplace_back(index, between, false); // insert before 'to'
 		break;
 	}
 	default:
@@ -881,11 +1105,250 @@ void CPath::ComputeAreaCrossing(CBaseBot* bot, CNavArea* from, const Vector& fro
 	bot->GetMovementInterface()->AdjustPathCrossingPoint(from, to, frompos, crosspoint);
 }
 
-void CPath::PostProcessPath()
+// z component of the cross product, positive if 'b' is counter-clockwise from 'a'
+static inline float PathCross2D(const Vector2D& a, const Vector2D& b)
+{
+	return a.x * b.y - a.y * b.x;
+}
+
+bool CPath::IsFunnelPortal(const size_t index) const
+{
+	// the path start and end positions are fixed
+	if (index == 0 || index + 1 >= m_segments.size())
+	{
+		return false;
+	}
+
+	const CBasePathSegment* seg = m_segments[index];
+	const CBasePathSegment* next = m_segments[index + 1];
+
+	if (seg->type != AIPath::SegmentType::SEGMENT_GROUND || seg->how > GO_WEST || seg->portalhalfwidth <= 0.0f)
+	{
+		return false;
+	}
+
+	// jumps, drops, ladders and links need the bot at the exact position computed for them
+	return next->type == AIPath::SegmentType::SEGMENT_GROUND && (next->how <= GO_WEST || next->how == NUM_TRAVERSE_TYPES);
+}
+
+bool CPath::CanPullAreaFromPath(CBaseBot* bot, const CNavArea* area)
+{
+	// prerequisites, volumes and elevators are looked up from the areas on the path
+	if (area->GetAttributes() != 0 || area->HasPrerequisite() || area->GetNavVolume() != nullptr || area->GetElevator() != nullptr)
+	{
+		return false;
+	}
+
+	// same rule the navigator uses when skipping segments
+	return bot->GetMovementInterface()->NavigatorAllowSkip(area);
+}
+
+void CPath::PullGroundSegments(CBaseBot* bot)
+{
+	std::vector<Vector2D> portalLeft;
+	std::vector<Vector2D> portalRight;
+	std::vector<size_t> cornerPortals;
+	std::vector<Vector2D> corners;
+	std::vector<bool> removed(m_segments.size(), false);
+	const float margin = navgenparams->half_human_width;
+
+	for (size_t first = 0; first + 2 < m_segments.size();)
+	{
+		size_t last = first + 1;
+
+		while (IsFunnelPortal(last))
+		{
+			last++;
+		}
+
+		if (last == first + 1)
+		{
+			first = last;
+			continue;
+		}
+
+		// portals between the fixed first and last segments, left and right as seen walking along the path
+		portalLeft.clear();
+		portalRight.clear();
+		portalLeft.push_back(m_segments[first]->goal.AsVector2D());
+		portalRight.push_back(m_segments[first]->goal.AsVector2D());
+
+		for (size_t i = first + 1; i < last; i++)
+		{
+			const CBasePathSegment* seg = m_segments[i];
+			Vector2D dir;
+			DirectionToVector2D(static_cast<NavDirType>(seg->how), &dir);
+			const Vector2D left(-dir.y, dir.x);
+			const float halfWidth = std::max(seg->portalhalfwidth - margin, 0.0f);
+
+			portalLeft.push_back(seg->portalcenter.AsVector2D() + left * halfWidth);
+			portalRight.push_back(seg->portalcenter.AsVector2D() - left * halfWidth);
+		}
+
+		portalLeft.push_back(m_segments[last]->goal.AsVector2D());
+		portalRight.push_back(m_segments[last]->goal.AsVector2D());
+
+		// simple stupid funnel, the corners of the pulled path are portal end points
+		cornerPortals.clear();
+		corners.clear();
+		cornerPortals.push_back(0);
+		corners.push_back(portalLeft[0]);
+
+		Vector2D apex = portalLeft[0];
+		Vector2D funnelLeft = portalLeft[0];
+		Vector2D funnelRight = portalRight[0];
+		size_t leftIndex = 0;
+		size_t rightIndex = 0;
+
+		for (size_t i = 1; i < portalLeft.size(); i++)
+		{
+			const Vector2D& left = portalLeft[i];
+			const Vector2D& right = portalRight[i];
+
+			// narrow the funnel from the right
+			if (PathCross2D(funnelRight - apex, right - apex) >= 0.0f)
+			{
+				if (apex == funnelRight || PathCross2D(funnelLeft - apex, right - apex) < 0.0f)
+				{
+					funnelRight = right;
+					rightIndex = i;
+				}
+				else
+				{
+					// the right side crossed over the left side, the left side is a corner
+					apex = funnelLeft;
+					i = leftIndex;
+					cornerPortals.push_back(i);
+					corners.push_back(apex);
+					funnelLeft = apex;
+					funnelRight = apex;
+					rightIndex = i;
+					continue;
+				}
+			}
+
+			// narrow the funnel from the left
+			if (PathCross2D(funnelLeft - apex, left - apex) <= 0.0f)
+			{
+				if (apex == funnelLeft || PathCross2D(funnelRight - apex, left - apex) > 0.0f)
+				{
+					funnelLeft = left;
+					leftIndex = i;
+				}
+				else
+				{
+					apex = funnelRight;
+					i = rightIndex;
+					cornerPortals.push_back(i);
+					corners.push_back(apex);
+					funnelLeft = apex;
+					funnelRight = apex;
+					leftIndex = i;
+					continue;
+				}
+			}
+		}
+
+		cornerPortals.push_back(portalLeft.size() - 1);
+		corners.push_back(portalLeft.back());
+
+		// move the goals to where the pulled path crosses the portals
+		for (size_t c = 0; c + 1 < corners.size(); c++)
+		{
+			const Vector2D& start = corners[c];
+			const Vector2D along = corners[c + 1] - start;
+
+			for (size_t i = cornerPortals[c] + 1; i <= cornerPortals[c + 1] && i + 1 < portalLeft.size(); i++)
+			{
+				CBasePathSegment* seg = m_segments[first + i];
+				const Vector2D center = seg->portalcenter.AsVector2D();
+				const Vector2D portal = portalLeft[i] - portalRight[i];
+				const float portalLength = portal.Length();
+				Vector2D goal = corners[c + 1];
+				const bool isCorner = i == cornerPortals[c + 1];
+
+				if (!isCorner && portalLength > 0.0f)
+				{
+					const float denom = PathCross2D(along, portal);
+
+					if (denom != 0.0f)
+					{
+						goal = start + along * (PathCross2D(portalRight[i] - start, portal) / denom);
+					}
+
+					// keep the goal inside the portal
+					const Vector2D unit = portal * (1.0f / portalLength);
+					const float offset = std::clamp((goal - center).Dot(unit), -0.5f * portalLength, 0.5f * portalLength);
+					goal = center + unit * offset;
+				}
+				else if (!isCorner)
+				{
+					goal = center;
+				}
+
+				seg->goal.x = goal.x;
+				seg->goal.y = goal.y;
+				seg->goal.z = m_segments[first + i - 1]->area->GetZ(seg->goal);
+
+				// segments on a straight line only add work for the navigator, keep the ones with special areas
+				if (!isCorner && CanPullAreaFromPath(bot, seg->area))
+				{
+					removed[first + i] = true;
+				}
+			}
+		}
+
+		first = last;
+	}
+
+	// a removed segment must stay close to the line between its neighbors, hills and stairs keep their segments
+	size_t previous = 0;
+
+	for (size_t i = 1; i + 1 < m_segments.size(); i++)
+	{
+		if (!removed[i])
+		{
+			previous = i;
+			continue;
+		}
+
+		size_t next = i + 1;
+
+		while (next + 1 < m_segments.size() && removed[next])
+		{
+			next++;
+		}
+
+		const Vector& from = m_segments[previous]->goal;
+		const Vector& to = m_segments[next]->goal;
+		const Vector& goal = m_segments[i]->goal;
+		const float total = (to - from).Length2D();
+		const float fraction = total > 0.0f ? (goal - from).Length2D() / total : 0.0f;
+
+		if (fabsf(from.z + (to.z - from.z) * fraction - goal.z) > navgenparams->step_height)
+		{
+			removed[i] = false;
+			previous = i;
+		}
+	}
+
+	size_t index = 0;
+
+	m_segments.erase(std::remove_if(m_segments.begin(), m_segments.end(), [&removed, &index](const CBasePathSegment* seg) {
+		return removed[index++];
+	}), m_segments.end());
+}
+
+void CPath::PostProcessPath(CBaseBot* bot)
 {
 	if (m_segments.size() == 0)
 		return;
 
+	if (sm_navbot_path_funnel.GetBool())
+	{
+		PullGroundSegments(bot);
+	}
+
 	if (m_segments.size() == 1)
 	{
 		auto& seg = m_segments[0];
@@ -894,6 +1357,7 @@ void CPath::PostProcessPath()
 		seg->length = 0.0f;
 		seg->distance = 0.0f;
 		seg->curvature = 0.0f;
+		BuildSegmentIndex();
 		return;
 	}
 
@@ -948,6 +1412,7 @@ void CPath::PostProcessPath()
 	seglast->distance = currentDistance;
 	seglast->curvature = 0.0f;
 
+	BuildSegmentIndex();
 	m_ageTimer.Start();
 }
 
@@ -3,16 +3,22 @@
 #pragma once
 
 #include <vector>
-#include <stack>
+#include <limits>
 #include <iterator>
 #include <algorithm>
 #include <memory>
+#include <type_traits>
 
 #include <sdkports/sdk_timers.h>
 #include <bot/basebot.h>
 #include <navmesh/nav.h>
 #include <navmesh/nav_mesh.h>
 #include <navmesh/nav_pathfind.h>
+#include <navmesh/nav_pathslicer.h>
+#include <navmesh/nav_pathcache.h>
+#include <navmesh/nav_incremental.h>
+#include <navmesh/nav_flowfield.h>
+#include <navmesh/nav_reachability.h>
 
 class CNavArea;
 class CNavLadder;
@@ -75,7 +81,8 @@ namespace AIPath
 	}
 }
 
-// Abstract class for custom path finding costs
+// Abstract class for custom path finding costs.
+// Searches are templated on the concrete cost class, declare implementations 'final' so the cost is called without a virtual dispatch.
 class IPathCost
 {
 public:
@@ -92,6 +99,14 @@ public:
 	 * @return path cost
 	*/
 	virtual float operator()(CNavArea* toArea, CNavArea* fromArea, const CNavLadder* ladder, const NavOffMeshConnection* link, const CNavElevator* elevator, float length) const = 0;
+
+	/**
+	 * @brief Computes a key for the path search cache. Two cost functions with the same key must return the same costs while the
+	 * cache isn't invalidated, the key should include the cost function type and every parameter that changes the costs.
+	 * @param key Stores the key.
+	 * @return true if paths found with this cost function can be cached. The default implementation disables caching.
+	 */
+	virtual bool GetPathCacheKey(std::size_t& key) const { return false; }
 };
 
 // A path segment is a single 'node' that the bot uses to move. The path is a list of segments and the bot follows these segments
@@ -99,19 +114,29 @@ class CBasePathSegment
 {
 public:
 	CBasePathSegment()
+	{
+		CBasePathSegment::Reset();
+	}
+
+	virtual ~CBasePathSegment() {}
+
+	// Restores the default values, called when a pooled segment is reused
+	virtual void Reset()
 	{
 		area = nullptr;
+		goal = vec3_origin;
 		ladder = nullptr;
 		how = NUM_TRAVERSE_TYPES;
 		type = AIPath::SegmentType::SEGMENT_GROUND;
 		length = 0.0f;
 		distance = 0.0f;
 		curvature = 0.0f;
+		forward = vec3_origin;
+		portalcenter = vec3_origin;
 		portalhalfwidth = 0.0f;
+		index = 0;
 	}
 
-	virtual ~CBasePathSegment() {}
-
 	CNavArea* area; // The area that is part of this segment
 	Vector goal; // Movement goal position for this segment
 	NavTraverseType how; // How to approach this segment
@@ -123,6 +148,7 @@ public:
 	float curvature; // How much this path segment 'curves' (ranges from 0 (0) to 1 (180)
 	Vector portalcenter; // Segment portal center position
 	float portalhalfwidth; // Portal's half width
+	size_t index; // Position of this segment in the path, updated when the path is built
 
 	virtual void CopySegment(CBasePathSegment* other)
 	{
@@ -137,28 +163,24 @@ public:
 		this->portalcenter = other->portalcenter;
 		this->portalhalfwidth = other->portalhalfwidth;
 	}
-
-	inline void CopySegment(const std::shared_ptr<CBasePathSegment>& other)
-	{
-		CopySegment(other.get());
-	}
 };
 
 class PathInsertSegmentInfo
 {
 public:
-	PathInsertSegmentInfo(std::shared_ptr<CBasePathSegment> Seg, std::shared_ptr<CBasePathSegment> newSeg, const bool afterseg = true) :
-		after(afterseg)
+	PathInsertSegmentInfo(const size_t index, CBasePathSegment* newSeg, const bool afterseg = true) :
+		index(index), newSeg(newSeg), after(afterseg)
 	{
-		this->Seg = Seg;
-		this->newSeg = newSeg;
 	}
 
-	const bool after;
-	std::shared_ptr<CBasePathSegment> Seg; // the segment will be added after this one
-	std::shared_ptr<CBasePathSegment> newSeg; // new segment to be added
+	size_t index; // the segment will be added after (or before) the segment at this index, indexes are taken before any insertion
+	CBasePathSegment* newSeg; // new segment to be added, from the path segment pool
+	bool after;
 };
 
+class CPathAsyncSearchBase;
+template <typename CostFunction> class CPathAsyncSearch;
+
 // good reference for valve nav mesh pathing
 // - https://github.com/ValveSoftware/halflife/blob/master/game_shared/bot/nav_path.cpp
 // - https://github.com/ValveSoftware/halflife/blob/master/game_shared/bot/nav_path.h
@@ -201,10 +223,14 @@ public:
 protected:
 	virtual CBasePathSegment* AllocNewSegment() const { return new CBasePathSegment; }
 
-	std::shared_ptr<CBasePathSegment> CreateNewSegment() { return std::shared_ptr<CBasePathSegment>(AllocNewSegment()); }
+	// Gets a segment from the path segment pool, allocates a new one if the pool is empty. Segments go back to the pool when the path is invalidated.
+	CBasePathSegment* CreateNewSegment();
 
 public:
 
+	// An area on the path found by the A* search
+	using SearchPathArea = NavPathArea;
+
 	/**
 	 * @brief Finds a path via A* search
 	 * @tparam CostFunction Path cost function
@@ -218,115 +244,209 @@ public:
 	template <typename CostFunction>
 	bool ComputePathToPosition(CBaseBot* bot, const Vector& goal, CostFunction& costFunc, const float maxPathLength = 0.0f, const bool includeGoalOnFailure = false)
 	{
+		CancelPathComputation();
 		Invalidate();
 
 		auto start = bot->GetAbsOrigin();
-		auto startArea = bot->GetLastKnownNavArea();
+		CNavArea* startArea = nullptr;
+		CNavArea* goalArea = nullptr;
+		Vector endPos;
+		bool result = false;
 
-		if (startArea == nullptr)
+		if (!SetupPathSearch(bot, goal, &startArea, &goalArea, &endPos, &result))
 		{
-			OnPathChanged(bot, AIPath::ResultType::NO_PATH);
-			return false;
+			return result;
 		}
 
-		constexpr float MaxDistanceToArea = 200.0f;
-		CNavArea* goalArea = TheNavMesh->GetNearestNavArea(goal, MaxDistanceToArea, true, true);
+		CNavPathCache* cache = TheNavMesh->GetPathCache();
+		NavPathCacheKey cacheKey;
+		const bool useCache = SetupPathCacheKey(bot, costFunc, startArea, goalArea, maxPathLength, cacheKey);
+		bool pathBuildResult = false;
 
-		if (goalArea == startArea)
+		if (!useCache || !cache->Lookup(cacheKey, m_searchareas, pathBuildResult))
 		{
-			BuildTrivialPath(start, goal);
-			OnPathChanged(bot, AIPath::ResultType::COMPLETE_PATH);
-			return true;
-		}
+			// Compute the shorest path
+			CNavArea* closestArea = nullptr;
+			pathBuildResult = NavAreaBuildPath(startArea, goalArea, &goal, costFunc, &closestArea, maxPathLength, bot->GetCurrentTeamIndex());
 
-		Vector endPos = goal;
-		if (goalArea)
-		{
-			endPos.z = goalArea->GetZ(endPos);
-		}
-		else
-		{
-			TheNavMesh->GetGroundHeight(endPos, &endPos.z);
-		}
-
-		// Compute the shorest path
-		CNavArea* closestArea = nullptr;
-		bool pathBuildResult = NavAreaBuildPath(startArea, goalArea, &goal, costFunc, &closestArea, maxPathLength, bot->GetCurrentTeamIndex());
+			m_searchareas.clear();
 
-		// count the number of areas in the path
-		int areaCount = 0;
+			for (CNavArea* area = closestArea; area != nullptr; area = area->GetParent())
+			{
+				m_searchareas.push_back({ area, area->GetParentHow() });
 
-		for (CNavArea* area = closestArea; area != nullptr; area = area->GetParent())
-		{
-			areaCount++;
+				if (area == startArea)
+				{
+					break;
+				}
+			}
 
-			if (area == startArea)
+			if (useCache)
 			{
-				break;
+				cache->Store(cacheKey, cache->GetGeneration(), m_searchareas, pathBuildResult);
 			}
 		}
 
-		if (areaCount == 0)
+		return BuildPathFromSearch(bot, start, goal, endPos, m_searchareas, pathBuildResult, includeGoalOnFailure);
+	}
+
+	/**
+	 * @brief Finds a path via A* search on the game thread, a few areas per tick.
+	 * 
+	 * The search shares a per tick budget with the searches of the other bots (see CNavPathSlicer), OnPathChanged is called once the
+	 * path is built. The current path remains valid until then. Trivial cases and cached paths are resolved immediately and the search
+	 * is run at once when time slicing is disabled.
+	 * @tparam CostFunction Path cost function. The functor is copied and evaluated on the next ticks, anything it points to must outlive the path.
+	 * @param bot The bot that will traverse this path
+	 * @param goal Path goal position
+	 * @param costFunc cost function
+	 * @param maxPathLength Maximum path length
+	 * @param includeGoalOnFailure if true, a segment to the goal position will be added even if it failed to find a path
+	 * @return false if it's already known that no path exists.
+	 */
+	template <typename CostFunction>
+	bool ComputePathToPositionTimeSliced(CBaseBot* bot, const Vector& goal, CostFunction& costFunc, const float maxPathLength = 0.0f, const bool includeGoalOnFailure = false)
+	{
+		CNavPathSlicer* slicer = TheNavMesh->GetPathSlicer();
+
+		if (!slicer->IsEnabled())
 		{
-			OnPathChanged(bot, AIPath::ResultType::NO_PATH);
-			return false; // no path
+			return ComputePathToPosition(bot, goal, costFunc, maxPathLength, includeGoalOnFailure);
 		}
 
-		if (areaCount == 1)
+		CancelPathComputation();
+
+		CNavArea* startArea = nullptr;
+		CNavArea* goalArea = nullptr;
+		Vector endPos;
+		bool result = false;
+
+		if (!SetupPathSearch(bot, goal, &startArea, &goalArea, &endPos, &result))
 		{
-			BuildTrivialPath(start, goal);
-			OnPathChanged(bot, AIPath::ResultType::COMPLETE_PATH);
-			return true;
+			return result;
 		}
 
-		// the path is built from end to start, include the end position first
-		if (pathBuildResult == true || includeGoalOnFailure == true)
+		CNavPathCache* cache = TheNavMesh->GetPathCache();
+		NavPathCacheKey cacheKey;
+		const bool useCache = SetupPathCacheKey(bot, costFunc, startArea, goalArea, maxPathLength, cacheKey);
+
+		if (useCache && cache->Lookup(cacheKey, m_searchareas, result))
 		{
-			std::shared_ptr<CBasePathSegment> segment = CreateNewSegment();
+			Invalidate();
+			return BuildPathFromSearch(bot, bot->GetAbsOrigin(), goal, endPos, m_searchareas, result, includeGoalOnFailure);
+		}
 
-			segment->area = closestArea;
-			segment->goal = endPos;
-			segment->type = AIPath::SegmentType::SEGMENT_GROUND;
+		auto search = CreateAsyncSearch(bot, goal, costFunc, startArea, goalArea, endPos, maxPathLength, includeGoalOnFailure, useCache, cacheKey);
+		m_pendingsearch = search;
+		slicer->Submit(std::move(search));
+		return true;
+	}
 
-			m_segments.push_back(std::move(segment));
-		}
+	/**
+	 * @brief Finds a path with an incremental search that repairs the search tree of the previous calls instead of starting over.
+	 * 
+	 * Used when the goal moves a little between searches (chasing, following). Falls back to ComputePathToPosition when the incremental
+	 * search can't be used (no goal area, cost function without a path cache key, nav mesh being edited) or when no path is found.
+	 * @tparam CostFunction Path cost function
+	 * @param bot The bot that will traverse this path
+	 * @param goal Path goal position
+	 * @param costFunc cost function
+	 * @param search Search tree kept between calls, owned by the caller.
+	 * @param includeGoalOnFailure if true, a segment to the goal position will be added even if it failed to find a path
+	 * @param timeSlicedFallback if true, the fallback search is time sliced (see ComputePathToPositionTimeSliced)
+	 * @return true if a path is found, or a time sliced fallback search was started
+	 */
+	template <typename CostFunction>
+	bool ComputePathToPositionIncremental(CBaseBot* bot, const Vector& goal, CostFunction& costFunc, CNavIncrementalSearch& search, const bool includeGoalOnFailure = false,
+		const bool timeSlicedFallback = false)
+	{
+		std::size_t costKey = 0U;
 
-		// construct the path segments
-		// Reminder: areas are added to the back of the segment vector, the first area is the goal area.
-		for (CNavArea* area = closestArea; area != nullptr; area = area->GetParent())
+		if (!CNavIncrementalSearch::IsAvailable() || !GetCostFunctionKey(costFunc, costKey))
 		{
-			std::shared_ptr<CBasePathSegment> segment = CreateNewSegment();
+			return timeSlicedFallback ? ComputePathToPositionTimeSliced(bot, goal, costFunc, 0.0f, includeGoalOnFailure) :
+				ComputePathToPosition(bot, goal, costFunc, 0.0f, includeGoalOnFailure);
+		}
 
-			segment->area = area;
-			segment->how = area->GetParentHow();
+		CancelPathComputation();
+		Invalidate();
 
-			m_segments.push_back(std::move(segment));
+		auto start = bot->GetAbsOrigin();
+		CNavArea* startArea = nullptr;
+		CNavArea* goalArea = nullptr;
+		Vector endPos;
+		bool result = false;
+
+		if (!SetupPathSearch(bot, goal, &startArea, &goalArea, &endPos, &result))
+		{
+			return result;
 		}
 
-		// Place the path start at the vector start
-		std::reverse(m_segments.begin(), m_segments.end());
+		if (goalArea == nullptr || !search.FindPath(startArea, goalArea, costFunc, costKey, bot->GetCurrentTeamIndex(), m_searchareas))
+		{
+			// the regular search also builds the path to the closest area
+			return timeSlicedFallback ? ComputePathToPositionTimeSliced(bot, goal, costFunc, 0.0f, includeGoalOnFailure) :
+				ComputePathToPosition(bot, goal, costFunc, 0.0f, includeGoalOnFailure);
+		}
+
+		return BuildPathFromSearch(bot, start, goal, endPos, m_searchareas, true, includeGoalOnFailure);
+	}
+
+	/**
+	 * @brief Finds a path by following the flow field to the goal area, the field is shared by every bot of the team going to the same area.
+	 * 
+	 * Used for objectives many bots move to (payload carts, control points). Falls back to ComputePathToPosition when flow fields
+	 * can't be used (no goal area, cost function without a path cache key, nav mesh being edited) or when the goal can't be reached.
+	 * @tparam CostFunction Path cost function
+	 * @param bot The bot that will traverse this path
+	 * @param goal Path goal position
+	 * @param costFunc cost function
+	 * @param includeGoalOnFailure if true, a segment to the goal position will be added even if it failed to find a path
+	 * @return true if a path is found
+	 */
+	template <typename CostFunction>
+	bool ComputePathToPositionShared(CBaseBot* bot, const Vector& goal, CostFunction& costFunc, const bool includeGoalOnFailure = false)
+	{
+		CNavFlowFieldManager* flowFields = TheNavMesh->GetFlowFields();
+		std::size_t costKey = 0U;
 
-		if (ProcessCurrentPath(bot, start) == false)
+		if (!flowFields->IsEnabled() || !GetCostFunctionKey(costFunc, costKey))
 		{
-			Invalidate(); // destroy the path so IsValid returns false
-			OnPathChanged(bot, AIPath::ResultType::NO_PATH);
-			return false;
+			return ComputePathToPosition(bot, goal, costFunc, 0.0f, includeGoalOnFailure);
 		}
 
-		PostProcessPath();
+		CancelPathComputation();
+		Invalidate();
+
+		auto start = bot->GetAbsOrigin();
+		CNavArea* startArea = nullptr;
+		CNavArea* goalArea = nullptr;
+		Vector endPos;
+		bool result = false;
 
-		if (pathBuildResult == true)
+		if (!SetupPathSearch(bot, goal, &startArea, &goalArea, &endPos, &result))
 		{
-			OnPathChanged(bot, AIPath::ResultType::COMPLETE_PATH);
+			return result;
 		}
-		else
+
+		const CNavFlowField* field = goalArea != nullptr ? flowFields->GetFlowField({ goalArea }, bot->GetCurrentTeamIndex(), costFunc, costKey) : nullptr;
+
+		if (field == nullptr || !field->BuildPath(startArea, m_searchareas))
 		{
-			OnPathChanged(bot, AIPath::ResultType::PARTIAL_PATH);
+			// the regular search also builds the path to the closest area
+			return ComputePathToPosition(bot, goal, costFunc, 0.0f, includeGoalOnFailure);
 		}
 
-		return pathBuildResult;
+		return BuildPathFromSearch(bot, start, goal, endPos, m_searchareas, true, includeGoalOnFailure);
 	}
 
+	// Returns true if an asynchronous path search is waiting for results
+	bool IsComputingPath() const;
+	// Gets the goal position and area of the pending asynchronous path search. Returns false if there is none.
+	bool GetComputingGoal(Vector& goal, CNavArea*& goalArea) const;
+	// Cancels the pending asynchronous path search, if any
+	void CancelPathComputation();
+
 	/**
 	 * @brief Checks if the bot can reach a specific goal.
 	 * @tparam CostFunction Nav path cost functor
@@ -355,6 +475,12 @@ public:
 			return true;
 		}
 
+		// goals outside of the bot's connected components can't be reached by any path
+		if (goalArea && !TheNavMesh->GetReachability()->MayReach(startArea, goalArea, bot->GetCurrentTeamIndex()))
+		{
+			return false;
+		}
+
 		Vector endPos = goal;
 		if (goalArea)
 		{
@@ -388,6 +514,10 @@ public:
 	const CBasePathSegment* GetLastSegment() const;
 	const CBasePathSegment* GetNextSegment(const CBasePathSegment* current) const;
 	const CBasePathSegment* GetPriorSegment(const CBasePathSegment* current) const;
+	static constexpr size_t INVALID_SEGMENT_INDEX = std::numeric_limits<size_t>::max();
+
+	// Gets the position of the segment in the path or INVALID_SEGMENT_INDEX if the segment isn't part of the path
+	size_t GetSegmentIndex(const CBasePathSegment* segment) const;
 	virtual const CBasePathSegment* GetGoalSegment() const;
 
 	enum SeekType
@@ -423,7 +553,7 @@ public:
 	{
 		for (auto& segptr : m_segments)
 		{
-			const T* segment = static_cast<T*>(segptr.get());
+			const T* segment = static_cast<T*>(segptr);
 
 			if (functor(segment) == false)
 			{
@@ -433,31 +563,266 @@ public:
 	}
 
 protected:
+	static constexpr float MAX_DISTANCE_TO_GOAL_AREA = 200.0f; // maximum distance between the goal position and its nav area
+
 	virtual bool ProcessCurrentPath(CBaseBot* bot, const Vector& start);
-	virtual bool ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& start, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert);
-	virtual bool ProcessLaddersInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert);
-	virtual bool ProcessElevatorsInPath(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert);
-	virtual bool ProcessPathJumps(CBaseBot* bot, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert);
-	virtual bool ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, std::shared_ptr<CBasePathSegment>& from, std::shared_ptr<CBasePathSegment>& to, std::stack<PathInsertSegmentInfo>& pathinsert);
+	virtual bool ProcessGroundPath(CBaseBot* bot, const size_t index, const Vector& start, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert);
+	virtual bool ProcessLaddersInPath(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert);
+	virtual bool ProcessElevatorsInPath(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert);
+	virtual bool ProcessPathJumps(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert);
+	virtual bool ProcessOffMeshConnectionsInPath(CBaseBot* bot, const size_t index, CBasePathSegment* from, CBasePathSegment* to, std::vector<PathInsertSegmentInfo>& pathinsert);
 	virtual void ComputeAreaCrossing(CBaseBot* bot, CNavArea* from, const Vector& frompos, CNavArea* to, NavDirType dir, Vector* crosspoint);
-	virtual void PostProcessPath();
+	virtual void PostProcessPath(CBaseBot* bot);
+	// true if the segment is a ground portal crossing that can be moved along its portal
+	bool IsFunnelPortal(const size_t index) const;
+	// Pulls the ground segments tight through their portals (simple stupid funnel) and removes the segments left on straight lines
+	void PullGroundSegments(CBaseBot* bot);
+	// true if the segment of the given area can be removed from the path when it lies on a straight line
+	static bool CanPullAreaFromPath(CBaseBot* bot, const CNavArea* area);
 	
-	inline std::vector<std::shared_ptr<CBasePathSegment>>& GetAllSegments() { return m_segments; }
+	inline std::vector<CBasePathSegment*>& GetAllSegments() { return m_segments; }
 	bool BuildTrivialPath(const Vector& start, const Vector& goal);
+	// Stores the segment indexes and computes the segment run bounds, call after changing the segments of a built path
+	void BuildSegmentIndex();
 
 private:
-	std::vector<std::shared_ptr<CBasePathSegment>> m_segments;
+	friend class CPathAsyncSearchBase;
+
+	// Bounds of a few consecutive path lines (segment goal to the next segment goal)
+	struct SegmentRun
+	{
+		Vector mins;
+		Vector maxs;
+		size_t first; // first segment of the run
+		size_t last; // one past the last segment of the run
+	};
+
+	static constexpr size_t SEGMENT_RUN_SIZE = 8;
+
+	std::vector<CBasePathSegment*> m_segments; // path segments, start first. Owned by the segment pool
+	std::vector<std::unique_ptr<CBasePathSegment>> m_segmentpool; // every segment allocated by this path, reused between paths
+	std::vector<CBasePathSegment*> m_freesegments; // pool segments not used by the current path
+	std::vector<SegmentRun> m_segmentruns;
+	std::vector<std::pair<float, size_t>> m_seekruns; // runs to search by MoveCursorToClosestPosition, distance squared to the run and run index
 	IntervalTimer m_ageTimer;
 	PathCursor m_cursor;
 	float m_cursorPos;
+	std::vector<SearchPathArea> m_searchareas; // areas found by synchronous path searches, goal area first
+	std::shared_ptr<CPathAsyncSearchBase> m_pendingsearch;
+
+	// Finds the start and goal areas. Returns false if no search is needed, 'result' is the path result in this case.
+	bool SetupPathSearch(CBaseBot* bot, const Vector& goal, CNavArea** startArea, CNavArea** goalArea, Vector* endPos, bool* result);
+	// Builds the path segments from the areas found by the search and processes the path.
+	bool BuildPathFromSearch(CBaseBot* bot, const Vector& start, const Vector& goal, const Vector& endPos, const std::vector<SearchPathArea>& areas, const bool pathBuildResult, const bool includeGoalOnFailure);
+	void OnAsyncPathSearchFinished(CPathAsyncSearchBase* search);
+
+	// Creates a search for ComputePathToPositionTimeSliced
+	template <typename CostFunction>
+	std::shared_ptr<CPathAsyncSearch<CostFunction>> CreateAsyncSearch(CBaseBot* bot, const Vector& goal, const CostFunction& costFunc, CNavArea* startArea, CNavArea* goalArea,
+		const Vector& endPos, const float maxPathLength, const bool includeGoalOnFailure, const bool useCache, const NavPathCacheKey& cacheKey)
+	{
+		auto search = std::make_shared<CPathAsyncSearch<CostFunction>>(this, bot, costFunc);
+		search->startArea = startArea;
+		search->goalArea = goalArea;
+		search->goal = goal;
+		search->endPos = endPos;
+		search->maxPathLength = maxPathLength;
+		search->teamID = bot->GetCurrentTeamIndex();
+		search->includeGoalOnFailure = includeGoalOnFailure;
+		search->useCache = useCache;
+		search->cacheKey = cacheKey;
+		search->cacheGeneration = TheNavMesh->GetPathCache()->GetGeneration();
+		return search;
+	}
+
+	// Gets the key identifying the cost function type and parameters. Returns false if the cost function doesn't provide one.
+	template <typename CostFunction>
+	static bool GetCostFunctionKey(const CostFunction& costFunc, std::size_t& key)
+	{
+		if constexpr (std::is_base_of_v<IPathCost, CostFunction>)
+		{
+			return costFunc.GetPathCacheKey(key);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// Fills the path cache key for a search. Returns false if the search results can't be cached.
+	template <typename CostFunction>
+	static bool SetupPathCacheKey(CBaseBot* bot, const CostFunction& costFunc, CNavArea* startArea, CNavArea* goalArea, const float maxPathLength, NavPathCacheKey& key)
+	{
+		if constexpr (std::is_base_of_v<IPathCost, CostFunction>)
+		{
+			// without a goal area, the result depends on the exact goal position
+			if (goalArea == nullptr || !TheNavMesh->GetPathCache()->IsEnabled() || !costFunc.GetPathCacheKey(key.costKey))
+			{
+				return false;
+			}
+
+			key.startArea = startArea;
+			key.goalArea = goalArea;
+			key.teamID = bot->GetCurrentTeamIndex();
+			key.maxPathLength = maxPathLength;
+			return true;
+		}
+		else
+		{
+			return false;
+		}
+	}
 
 	void DrawSingleSegment(const Vector& v1, const Vector& v2, AIPath::SegmentType type, const float duration);
 	void Drawladder(const CNavLadder* ladder, AIPath::SegmentType type, const float duration);
 };
 
+// Asynchronous path search, the search is time sliced on the game thread and the path is built once it's done
+class CPathAsyncSearchBase : public INavSlicedPathJob
+{
+public:
+	CPathAsyncSearchBase(CPath* path, CBaseBot* bot) :
+		m_path(path), m_bot(bot)
+	{
+		m_sliceStarted = false;
+		startArea = nullptr;
+		goalArea = nullptr;
+		maxPathLength = 0.0f;
+		teamID = NAV_TEAM_ANY;
+		includeGoalOnFailure = false;
+		useCache = false;
+		cacheGeneration = 0U;
+		result = false;
+	}
+
+	void Finish() override;
+
+	CBaseBot* GetBot() const { return m_bot; }
+
+	CNavArea* startArea;
+	CNavArea* goalArea;
+	Vector goal;
+	Vector endPos;
+	float maxPathLength;
+	int teamID;
+	bool includeGoalOnFailure;
+	bool useCache;
+	NavPathCacheKey cacheKey;
+	unsigned int cacheGeneration; // path cache generation when the search was submitted
+
+	// written by the search
+	bool result;
+	std::vector<CPath::SearchPathArea> areas; // goal area first
+
+protected:
+	// Runs part of the search, returns true once the path areas are collected
+	template <typename CostFunction>
+	bool DoSearchStep(NavSearchContext& context, CNavAreaPathSearch<CostFunction>& search, int maxExpansions, int& expansions)
+	{
+		expansions = 0;
+
+		if (!m_sliceStarted)
+		{
+			// same as NavAreaBuildPath, the search is restricted to the cluster corridor first and searches the whole mesh if that fails
+			const NavClusterCorridor* corridor = TheNavMesh->GetClusterGraph()->FindCorridor(context.GetClusterCorridor(), startArea, goalArea, teamID, false);
+			search.Start(context, corridor, startArea, goalArea, &goal, maxPathLength, teamID);
+			m_sliceStarted = true;
+		}
+
+		for (;;)
+		{
+			const int expanded = search.GetExpansionCount();
+			const NavPathSearchStatus status = search.Run(maxExpansions - expansions);
+			expansions += search.GetExpansionCount() - expanded;
+
+			if (status == NAV_PATH_SEARCH_RUNNING)
+			{
+				return false;
+			}
+
+			if (status == NAV_PATH_SEARCH_FAILED && search.IsInCorridor())
+			{
+				search.Start(context, nullptr, startArea, goalArea, &goal, maxPathLength, teamID);
+
+				if (expansions >= maxExpansions)
+				{
+					return false;
+				}
+
+				continue;
+			}
+
+			result = status == NAV_PATH_SEARCH_FOUND;
+			CollectAreas(context, search.GetClosestArea());
+			return true;
+		}
+	}
+
+private:
+	CPath* m_path;
+	CBaseBot* m_bot;
+	bool m_sliceStarted;
+
+	// Follows the parents from the closest area back to the start area
+	void CollectAreas(const NavSearchContext& context, CNavArea* closestArea)
+	{
+		for (CNavArea* area = closestArea; area != nullptr; area = context.GetParent(area))
+		{
+			areas.push_back({ area, context.GetParentHow(area) });
+
+			if (area == startArea)
+			{
+				break;
+			}
+		}
+	}
+};
+
+template <typename CostFunction>
+class CPathAsyncSearch : public CPathAsyncSearchBase
+{
+public:
+	CPathAsyncSearch(CPath* path, CBaseBot* bot, const CostFunction& costFunc) :
+		CPathAsyncSearchBase(path, bot), m_costFunc(costFunc), m_search(m_costFunc)
+	{
+	}
+
+	bool Step(NavSearchContext& context, int maxExpansions, int& expansions) override { return DoSearchStep(context, m_search, maxExpansions, expansions); }
+
+private:
+	CostFunction m_costFunc;
+	CNavAreaPathSearch<CostFunction> m_search; // state of the time sliced search
+};
+
+inline bool CPath::GetComputingGoal(Vector& goal, CNavArea*& goalArea) const
+{
+	if (!IsComputingPath())
+	{
+		return false;
+	}
+
+	goal = m_pendingsearch->goal;
+	goalArea = m_pendingsearch->goalArea;
+	return true;
+}
+
+inline bool CPath::IsComputingPath() const
+{
+	return m_pendingsearch && !m_pendingsearch->IsDone();
+}
+
 inline void CPath::Invalidate()
 {
+	// every pool segment is free again, including the ones removed from the path during processing
 	m_segments.clear();
+	m_segmentruns.clear();
+	m_freesegments.clear();
+
+	for (auto& segment : m_segmentpool)
+	{
+		m_freesegments.push_back(segment.get());
+	}
+
 	m_ageTimer.Invalidate();
 	m_cursorPos = 0.0f;
 	m_cursor.Invalidate();
@@ -510,7 +875,7 @@ inline const CBasePathSegment* CPath::GetFirstSegment() const
 		return nullptr;
 	}
 
-	return m_segments.begin()->get();
+	return m_segments.front();
 }
 
 inline const CBasePathSegment* CPath::GetLastSegment() const
@@ -520,69 +885,54 @@ inline const CBasePathSegment* CPath::GetLastSegment() const
 		return nullptr;
 	}
 
-	return std::prev(m_segments.end())->get();
+	return m_segments.back();
 }
 
-inline const CBasePathSegment* CPath::GetNextSegment(const CBasePathSegment* current) const
+inline size_t CPath::GetSegmentIndex(const CBasePathSegment* segment) const
 {
-	if (m_segments.size() == 0)
+	if (segment == nullptr)
 	{
-		return nullptr;
+		return INVALID_SEGMENT_INDEX;
 	}
 
-	auto it = std::find_if(m_segments.begin(), m_segments.end(), [&current](const std::shared_ptr<CBasePathSegment> object) {
-		if (object.get() == current)
-		{
-			return true;
-		}
-
-		return false;
-	});
-
-	if (it == m_segments.end())
+	// the stored index is only refreshed when the path is built, search the path if the segments moved since then
+	if (segment->index < m_segments.size() && m_segments[segment->index] == segment)
 	{
-		return nullptr; // not found
+		return segment->index;
 	}
 
-	it = std::next(it);
+	auto it = std::find(m_segments.begin(), m_segments.end(), segment);
 
 	if (it == m_segments.end())
 	{
-		return nullptr;
+		return INVALID_SEGMENT_INDEX; // not found
 	}
 
-	return it->get();
+	return static_cast<size_t>(std::distance(m_segments.begin(), it));
 }
 
-inline const CBasePathSegment* CPath::GetPriorSegment(const CBasePathSegment* current) const
+inline const CBasePathSegment* CPath::GetNextSegment(const CBasePathSegment* current) const
 {
-	if (m_segments.size() == 0)
+	const size_t index = GetSegmentIndex(current);
+
+	if (index == INVALID_SEGMENT_INDEX || index + 1 >= m_segments.size())
 	{
 		return nullptr;
 	}
 
-	auto it = std::find_if(m_segments.begin(), m_segments.end(), [&current](const std::shared_ptr<CBasePathSegment> object) {
-		if (object.get() == current)
-		{
-			return true;
-		}
-
-		return false;
-	});
+	return m_segments[index + 1];
+}
 
-	if (it == m_segments.end())
-	{
-		return nullptr; // not found
-	}
+inline const CBasePathSegment* CPath::GetPriorSegment(const CBasePathSegment* current) const
+{
+	const size_t index = GetSegmentIndex(current);
 
-	if (it == m_segments.begin())
+	if (index == INVALID_SEGMENT_INDEX || index == 0)
 	{
-		return nullptr; // current segment is the first segment, no previous segment
+		return nullptr; // not found or current segment is the first segment, no previous segment
 	}
 
-	it = std::prev(it);
-
-	return it->get();
+	return m_segments[index - 1];
 }
 
 #endif // !SMNAV_BOT_BASE_PATH_H_
@@ -17,6 +17,8 @@
 ConVar sm_navbot_path_debug_climbing("sm_navbot_path_debug_climbing", "0", FCVAR_CHEAT | FCVAR_DONTRECORD, "Debugs automatic object climbing");
 ConVar sm_navbot_path_goal_tolerance("sm_navbot_path_goal_tolerance", "32", FCVAR_DONTRECORD, "Default navigator goal tolerance");
 ConVar sm_navbot_path_skip_ahead_distance("sm_navbot_path_skip_ahead_distance", "350", FCVAR_DONTRECORD, "Default navigator skip ahead distance");
+ConVar sm_navbot_path_incremental("sm_navbot_path_incremental", "1", FCVAR_DONTRECORD, "If enabled, auto repath navigators repair their previous search instead of searching from scratch.");
+ConVar sm_navbot_path_time_sliced("sm_navbot_path_time_sliced", "1", FCVAR_DONTRECORD, "If enabled, auto repath navigators run their searches a few areas per tick and keep their current path until the search is done. With sm_navbot_path_incremental, only the searches the incremental search falls back to are time sliced.");
 ConVar sm_navbot_path_useable_scan("sm_navbot_path_useable_scan", "0.5", FCVAR_DONTRECORD, "How frequently the navigation will scan for useable entities on the bot's path.");
 
 CMeshNavigator::CMeshNavigator() : CPath()
@@ -1500,3 +1502,64 @@ bool CMeshNavigatorAutoRepath::IsRepathNeeded(const Vector& goal)
 
 	return (goal - m_lastGoal).LengthSqr() > tolerance;
 }
+
+bool CMeshNavigatorAutoRepath::HasComputingGoalChanged(const Vector& goal) const
+{
+	Vector searchGoal;
+	CNavArea* searchGoalArea = nullptr;
+
+	if (!GetComputingGoal(searchGoal, searchGoalArea))
+	{
+		return false;
+	}
+
+	float tolerance = GetGoalTolerance() * GetGoalTolerance();
+
+	// small moves don't need the nav area lookup
+	if ((goal - searchGoal).LengthSqr() <= tolerance)
+	{
+		return false;
+	}
+
+	return TheNavMesh->GetNearestNavArea(goal, MAX_DISTANCE_TO_GOAL_AREA, true, true) != searchGoalArea;
+}
+
+bool CMeshNavigatorAutoRepath::UseIncrementalSearch()
+{
+	return sm_navbot_path_incremental.GetBool();
+}
+
+bool CMeshNavigatorAutoRepath::UseTimeSlicedSearch()
+{
+	return sm_navbot_path_time_sliced.GetBool();
+}
+
+void CMeshNavigatorAutoRepath::OnPathChanged(CBaseBot* bot, AIPath::ResultType result)
+{
+	CMeshNavigator::OnPathChanged(bot, result);
+
+	if (!m_waitingForSearch)
+	{
+		return;
+	}
+
+	m_waitingForSearch = false;
+
+	// same as a synchronous repath, partial paths count as failures
+	if (result == AIPath::ResultType::COMPLETE_PATH)
+	{
+		m_repathTimer.Start(m_repathinterval);
+	}
+	else
+	{
+		OnRepathFailed(bot);
+	}
+}
+
+void CMeshNavigatorAutoRepath::OnRepathFailed(CBaseBot* bot)
+{
+	Invalidate();
+	m_failTimer.Start(1.0f); // Wait one second before repath
+	m_failCount++;
+	bot->OnMoveToFailure(this, IEventListener::MovementFailureType::FAIL_NO_PATH);
+}
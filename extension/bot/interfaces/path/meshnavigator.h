@@ -71,6 +71,7 @@ public:
 		m_repathinterval = repathInterval;
 		m_repathTimer.Invalidate();
 		m_failCount = 0;
+		m_waitingForSearch = false;
 	}
 
 	void Invalidate() override
@@ -79,6 +80,8 @@ public:
 		CMeshNavigator::Invalidate();
 	}
 
+	void OnPathChanged(CBaseBot* bot, AIPath::ResultType result) override;
+
 	template <typename CF>
 	void Update(CBaseBot* bot, const Vector& goal, CF& costFunctor);
 
@@ -94,11 +97,18 @@ private:
 	CountdownTimer m_failTimer; // Time to wait if the path failed
 	Vector m_lastGoal; // goal from the last valid path
 	int m_failCount; // number of times it failed to build a path
+	bool m_waitingForSearch; // a time sliced search was started by the last repath
+	CNavIncrementalSearch m_incrementalSearch; // search tree reused by the next repath
 
 	template <typename CF>
 	void RefreshPath(CBaseBot* bot, const Vector& goal, CF& costFunctor);
 
 	bool IsRepathNeeded(const Vector& goal);
+	// true if the goal moved to another area since the pending search was started
+	bool HasComputingGoalChanged(const Vector& goal) const;
+	void OnRepathFailed(CBaseBot* bot);
+	static bool UseIncrementalSearch();
+	static bool UseTimeSlicedSearch();
 
 	void Update(CBaseBot* bot) override
 	{
@@ -112,6 +122,13 @@ inline void CMeshNavigatorAutoRepath::Update(CBaseBot* bot, const Vector& goal,
 	// Refresh path if needed
 	RefreshPath(bot, goal, costFunctor);
 
+	if (!IsValid() && IsComputingPath())
+	{
+		// no path until the search is done, head straight to the goal meanwhile
+		bot->GetMovementInterface()->MoveTowards(goal);
+		return;
+	}
+
 	// Move bot along path
 	CMeshNavigator::Update(bot);
 }
@@ -119,7 +136,23 @@ inline void CMeshNavigatorAutoRepath::Update(CBaseBot* bot, const Vector& goal,
 template<typename CF>
 inline void CMeshNavigatorAutoRepath::RefreshPath(CBaseBot* bot, const Vector& goal, CF& costFunctor)
 {
-	if (IsValid() && !m_repathTimer.IsElapsed())
+	bool goalChanged = false;
+
+	if (IsComputingPath())
+	{
+		// keep following the current path, OnPathChanged is called once the search is done
+		if (!HasComputingGoalChanged(goal))
+		{
+			return;
+		}
+
+		// the goal moved to another area, the search is restarted
+		CancelPathComputation();
+		m_waitingForSearch = false;
+		goalChanged = true;
+	}
+
+	if (IsValid() && !goalChanged && !m_repathTimer.IsElapsed())
 	{
 		return;
 	}
@@ -138,16 +171,34 @@ inline void CMeshNavigatorAutoRepath::RefreshPath(CBaseBot* bot, const Vector& g
 		return;
 	}
 
-	if (!IsValid() || IsRepathNeeded(goal))
+	if (!IsValid() || goalChanged || IsRepathNeeded(goal))
 	{
-		bool foundpath = this->ComputePathToPosition<CF>(bot, goal, costFunctor);
+		bool foundpath = false;
+		m_waitingForSearch = false;
+
+		// the incremental search repairs the previous search, only the searches it falls back to are time sliced
+		if (UseIncrementalSearch())
+		{
+			foundpath = this->ComputePathToPositionIncremental<CF>(bot, goal, costFunctor, m_incrementalSearch, false, UseTimeSlicedSearch());
+		}
+		else if (UseTimeSlicedSearch())
+		{
+			foundpath = this->ComputePathToPositionTimeSliced<CF>(bot, goal, costFunctor);
+		}
+		else
+		{
+			foundpath = this->ComputePathToPosition<CF>(bot, goal, costFunctor);
+		}
+
+		if (foundpath && IsComputingPath())
+		{
+			m_waitingForSearch = true;
+			return;
+		}
 
 		if (!foundpath)
 		{
-			Invalidate();
-			m_failTimer.Start(1.0f); // Wait one second before repath
-			m_failCount++;
-			bot->OnMoveToFailure(this, IEventListener::MovementFailureType::FAIL_NO_PATH);
+			OnRepathFailed(bot);
 		}
 		else
 		{
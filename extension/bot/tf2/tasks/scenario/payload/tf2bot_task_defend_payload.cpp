@@ -28,7 +28,7 @@ TaskResult<CTF2Bot> CTF2BotDefendPayloadTask::OnTaskUpdate(CTF2Bot* bot)
 
 			CTF2BotPathCost cost(bot);
 			Vector pos = UtilHelpers::getWorldSpaceCenter(payload);
-			m_nav.ComputePathToPosition(bot, pos, cost);
+			m_nav.ComputePathToPositionShared(bot, pos, cost);
 		}
 
 		m_nav.Update(bot);
@@ -52,7 +52,7 @@ TaskResult<CTF2Bot> CTF2BotPushPayloadTask::OnTaskUpdate(CTF2Bot* bot)
 		m_goal = UtilHelpers::getWorldSpaceCenter(m_payload.ToEdict());
 
 		CTF2BotPathCost cost(bot);
-		m_nav.ComputePathToPosition(bot, m_goal, cost);
+		m_nav.ComputePathToPositionShared(bot, m_goal, cost);
 
 		m_repathtimer.Start(0.4f);
 	}
@@ -1,4 +1,5 @@
 #include <limits>
+#include <vector>
 
 #include <extension.h>
 #include <util/helpers.h>
@@ -7,6 +8,7 @@
 #include <entities/tf2/tf_entities.h>
 #include <sdkports/debugoverlay_shared.h>
 #include <mods/tf2/tf2lib.h>
+#include <navmesh/nav_pathfind.h>
 #include "bot/tf2/tf2bot.h"
 #include "tf2bot_find_health_task.h"
 
@@ -61,11 +63,18 @@ TaskResult<CTF2Bot> CTF2BotFindHealthTask::OnTaskUpdate(CTF2Bot* bot)
 
 CTF2BotFindHealthTask::HealthSource CTF2BotFindHealthTask::FindSource(CTF2Bot* me)
 {
+	struct SourceCandidate
+	{
+		edict_t* edict;
+		HealthSource source;
+	};
+
 	Vector origin = me->GetAbsOrigin();
-	float smallest = std::numeric_limits<float>::max();
 	edict_t* best = nullptr;
 	auto myteam = me->GetMyTFTeam();
 	HealthSource source = HealthSource::NONE;
+	std::vector<SourceCandidate> candidates;
+	std::vector<NavTravelCandidate> travelCandidates;
 
 	auto evaluateammopack = [&myteam](edict_t* ammopack) -> bool {
 		tfentities::HTFBaseEntity entity(ammopack);
@@ -158,15 +167,17 @@ CTF2BotFindHealthTask::HealthSource CTF2BotFindHealthTask::FindSource(CTF2Bot* m
 		if (distance > max_distance())
 			continue;
 
-		// apply preference
-		distance = distance * distance_mul;
+		candidates.push_back({ edict, currentsource });
+		travelCandidates.push_back({ TheNavMesh->GetNearestNavArea(center, 512.0f, false, false), distance, distance_mul });
+	}
+
+	// rank the sources by travel distance, preferred sources have a lower distance multiplier
+	const int selected = NavSelectNearestCandidate(me->GetLastKnownNavArea(), me->GetCurrentTeamIndex(), max_distance(), travelCandidates);
 
-		if (distance < smallest)
-		{
-			smallest = distance;
-			best = edict;
-			source = currentsource;
-		}
+	if (selected >= 0)
+	{
+		best = candidates[selected].edict;
+		source = candidates[selected].source;
 	}
 
 	if (best)
@@ -1,3 +1,4 @@
+#include <string_view>
 #include <extension.h>
 #include <manager.h>
 #include <util/helpers.h>
@@ -674,3 +675,20 @@ float CTF2BotPathCost::operator()(CNavArea* toArea, CNavArea* fromArea, const CN
 
 	return cost;
 }
+
+bool CTF2BotPathCost::GetPathCacheKey(std::size_t& key) const
+{
+	key = std::hash<std::string_view>{}("CTF2BotPathCost");
+	NavHashCombineValue(key, static_cast<int>(m_routetype));
+	NavHashCombineValue(key, m_me->IsCarryingAFlag()); // flag carriers avoid some areas
+	NavHashCombineValue(key, m_stepheight);
+	NavHashCombineValue(key, m_maxjumpheight);
+	NavHashCombineValue(key, m_maxdropheight);
+	NavHashCombineValue(key, m_maxdjheight);
+	NavHashCombineValue(key, m_maxgapjumpdistance);
+	NavHashCombineValue(key, m_candoublejump);
+	NavHashCombineValue(key, m_canblastjump);
+	return true;
+}
+
+NAV_INSTANTIATE_PATH_SEARCH(CTF2BotPathCost);
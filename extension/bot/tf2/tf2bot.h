@@ -165,12 +165,13 @@ private:
 	static constexpr float medic_patient_health_low_level() { return 0.6f; }
 };
 
-class CTF2BotPathCost : public IPathCost
+class CTF2BotPathCost final : public IPathCost
 {
 public:
 	CTF2BotPathCost(CTF2Bot* bot, RouteType routetype = FASTEST_ROUTE);
 
 	float operator()(CNavArea* toArea, CNavArea* fromArea, const CNavLadder* ladder, const NavOffMeshConnection* link, const CNavElevator* elevator, float length) const override;
+	bool GetPathCacheKey(std::size_t& key) const override;
 
 private:
 	CTF2Bot* m_me;
@@ -184,4 +185,6 @@ private:
 	bool m_canblastjump;
 };
 
+NAV_DECLARE_PATH_SEARCH(CTF2BotPathCost);
+
 #endif // !NAVBOT_TEAM_FORTRESS_2_BOT_H_
@@ -35,7 +35,7 @@ CON_COMMAND(sm_navbot_info, "Prints information about the extension.")
 	Msg("Game Folder: %s\n", smutils->GetGameFolderName() != nullptr ? smutils->GetGameFolderName() : "");
 	Msg("Current Mod (Extension): %s\n", mod->GetModName());
 	Msg("Current Map: %s\n", STRING(gpGlobals->mapname));
-	Msg("Nav Mesh:\n    Status: %s\n    Version: %i\n    Subversion: %i\n", TheNavMesh->IsLoaded() ? "Loaded" : "NOT Loaded", CNavMesh::NavMeshVersion, TheNavMesh->GetSubVersionNumber());
+	Msg("Nav Mesh:\n    Status: %s\n    Version: %i\n    Subversion: %i\n", TheNavMesh->IsLoading() ? "Loading" : TheNavMesh->IsLoaded() ? "Loaded" : "NOT Loaded", CNavMesh::NavMeshVersion, TheNavMesh->GetSubVersionNumber());
 	Msg("Update Rate: %3.5f\n", mod->GetModSettings()->GetUpdateRate());
 	Msg("Tick Rate: %3.2f\n", (1.0f / gpGlobals->interval_per_tick));
 	Msg("--- END NavBot Info ---\n");
@@ -229,6 +229,12 @@ CON_COMMAND(sm_navbot_debug_pathfind, "Path finding debug.")
 	reset = false;
 	end = player.GetAbsOrigin();
 
+	if (TheNavMesh->IsLoading())
+	{
+		META_CONPRINT("The nav mesh is still loading! \n");
+		return;
+	}
+
 	CNavArea* startArea = TheNavMesh->GetNearestNavArea(start, 256.0f, true, true);
 
 	if (startArea == nullptr)
@@ -309,6 +315,12 @@ CON_COMMAND(sm_navbot_debug_pathfind2, "Path finding debug (new function).")
 	reset = false;
 	end = player.GetAbsOrigin();
 
+	if (TheNavMesh->IsLoading())
+	{
+		META_CONPRINT("The nav mesh is still loading! \n");
+		return;
+	}
+
 	CNavArea* startArea = TheNavMesh->GetNearestNavArea(start, 512.0f, true, true);
 
 	if (startArea == nullptr)
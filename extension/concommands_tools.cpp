@@ -1,10 +1,14 @@
+#include <algorithm>
 #include <chrono>
+#include <random>
 
 #include <extension.h>
+#include <manager.h>
 #include <util/helpers.h>
 #include <navmesh/nav_area.h>
 #include <navmesh/nav_mesh.h>
 #include <navmesh/nav_pathfind.h>
+#include <bot/basebot_pathcost.h>
 #include <sdkports/debugoverlay_shared.h>
 
 CON_COMMAND_F(sm_navbot_tool_build_path, "Builds a path from your current position to the marked nav area. (Original Search Method)", FCVAR_CHEAT)
@@ -15,6 +19,12 @@ CON_COMMAND_F(sm_navbot_tool_build_path, "Builds a path from your current positi
 		return;
 	}
 
+	if (TheNavMesh->IsLoading())
+	{
+		META_CONPRINT("The nav mesh is still loading! \n");
+		return;
+	}
+
 	edict_t* host = UtilHelpers::GetListenServerHost();
 	const Vector& origin = host->GetCollideable()->GetCollisionOrigin();
 
@@ -80,6 +90,12 @@ CON_COMMAND_F(sm_navbot_tool_build_path_new, "Builds a path from your current po
 		return;
 	}
 
+	if (TheNavMesh->IsLoading())
+	{
+		META_CONPRINT("The nav mesh is still loading! \n");
+		return;
+	}
+
 	edict_t* host = UtilHelpers::GetListenServerHost();
 	const Vector& origin = host->GetCollideable()->GetCollisionOrigin();
 
@@ -127,6 +143,55 @@ CON_COMMAND_F(sm_navbot_tool_build_path_new, "Builds a path from your current po
 	}
 }
 
+CON_COMMAND_F(sm_navbot_tool_benchmark_pathfind, "Runs path searches between random nav areas with a bot's path cost and reports the time taken. Usage: sm_navbot_tool_benchmark_pathfind <number of searches>", FCVAR_CHEAT)
+{
+	extern NavAreaVector TheNavAreas;
+
+	if (TheNavMesh->IsLoading() || TheNavAreas.Count() < 2)
+	{
+		META_CONPRINT("The nav mesh is not loaded! \n");
+		return;
+	}
+
+	if (extmanager->GetAllBots().empty())
+	{
+		META_CONPRINT("Add a bot first! The search uses the path cost of the first bot. \n");
+		return;
+	}
+
+	int searches = 500;
+
+	if (args.ArgC() >= 2)
+	{
+		searches = std::clamp(atoi(args[1]), 1, 100000);
+	}
+
+	CBaseBot* bot = extmanager->GetAllBots()[0].get();
+	CBaseBotPathCost cost(bot);
+	std::mt19937 random(12345U); // fixed seed, every run searches the same area pairs
+	std::uniform_int_distribution<int> distribution(0, TheNavAreas.Count() - 1);
+	int found = 0;
+
+	auto tstart = std::chrono::high_resolution_clock::now();
+
+	for (int i = 0; i < searches; i++)
+	{
+		CNavArea* start = TheNavAreas[distribution(random)];
+		CNavArea* end = TheNavAreas[distribution(random)];
+
+		if (NavAreaBuildPath(start, end, nullptr, cost, nullptr, 0.0f, bot->GetCurrentTeamIndex()))
+		{
+			found++;
+		}
+	}
+
+	auto tend = std::chrono::high_resolution_clock::now();
+
+	const std::chrono::duration<double, std::milli> millis = (tend - tstart);
+
+	META_CONPRINTF("%i searches took %f ms (%f ms per search). %i paths found.\n", searches, millis.count(), millis.count() / static_cast<double>(searches), found);
+}
+
 CON_COMMAND_F(sm_navbot_tool_report_hull_sizes, "Prints the player's hull size to the console.", FCVAR_CHEAT)
 {
 	edict_t* host = UtilHelpers::GetListenServerHost();
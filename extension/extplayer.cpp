@@ -2,6 +2,7 @@
 #include <PlayerState.h>
 #include "navmesh/nav_mesh.h"
 #include "navmesh/nav_area.h"
+#include "navmesh/nav_areatracker.h"
 #include <entities/baseentity.h>
 #include <util/entprops.h>
 #include <util/helpers.h>
@@ -53,6 +54,28 @@ void CBaseExtPlayer::UpdateLastKnownNavArea(const bool forceupdate)
 {
 	// https://cs.alliedmods.net/hl2sdk-csgo/source/game/server/basecombatcharacter.cpp#3351
 
+	// the areas are still being loaded
+	if (TheNavMesh->IsLoading())
+	{
+		return;
+	}
+
+	CNavAreaTracker* tracker = TheNavMesh->GetAreaTracker();
+
+	if (tracker->IsEnabled())
+	{
+		// the nav mesh updates the area of every client each tick
+		CNavArea* trackedarea = forceupdate ? tracker->UpdateClient(GetIndex()) : tracker->GetArea(GetIndex());
+
+		if (trackedarea != nullptr && trackedarea != m_lastnavarea)
+		{
+			NavAreaChanged(m_lastnavarea, trackedarea);
+			m_lastnavarea = trackedarea;
+		}
+
+		return;
+	}
+
 	if (forceupdate)
 	{
 		m_navupdatetimer = -1;
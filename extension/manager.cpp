@@ -16,13 +16,14 @@
 #include <extplayer.h>
 #include <util/helpers.h>
 #include <util/librandom.h>
+#include <navmesh/nav_mesh.h>
+#include <navmesh/nav_pathslicer.h>
 #include "manager.h"
 
 #ifdef EXT_DEBUG
 #include <sdkports/debugoverlay_shared.h>
 #include <navmesh/nav.h>
 #include <navmesh/nav_area.h>
-#include <navmesh/nav_mesh.h>
 #include <navmesh/nav_pathfind.h>
 #include <bot/interfaces/path/basepath.h>
 #include <entities/baseentity.h>
@@ -114,6 +115,12 @@ void CExtManager::Frame()
 		m_callModUpdateTimer.Start(get_mod_update_interval());
 		m_mod->Update();
 	}
+
+	// the searches started by all bots share a single per tick budget
+	if (TheNavMesh != nullptr && !TheNavMesh->IsLoading())
+	{
+		TheNavMesh->GetPathSlicer()->Update();
+	}
 }
 
 void CExtManager::OnClientPutInServer(int client)
@@ -253,6 +253,12 @@ CON_COMMAND_F(sm_tf_nav_toggle_mvm_attrib, "Toggles NavBot TF MvM Attributes on
 
 CON_COMMAND_F(sm_tf_nav_auto_set_spawnrooms, "Detects and set spawn room areas automatically.", FCVAR_CHEAT)
 {
+	if (TheNavMesh->IsLoading())
+	{
+		Msg("The nav mesh is still loading.\n");
+		return;
+	}
+
 	int areas = 0;
 
 	auto functor = [&areas](CNavArea* baseArea) {
@@ -50,7 +50,7 @@ CTFWaypoint::TFHint CTFWaypoint::StringToTFHint(const char* szName)
 	return MAX_TFHINT_TYPES;
 }
 
-void CTFWaypoint::Save(std::fstream& filestream, uint32_t version)
+void CTFWaypoint::Save(std::ostream& filestream, uint32_t version)
 {
 	CWaypoint::Save(filestream, version);
 
@@ -58,24 +58,24 @@ void CTFWaypoint::Save(std::fstream& filestream, uint32_t version)
 	filestream.write(reinterpret_cast<char*>(&m_tfhint), sizeof(TFHint));
 }
 
-NavErrorType CTFWaypoint::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+NavErrorType CTFWaypoint::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	NavErrorType base = CWaypoint::Load(filestream, version, subVersion);
+	NavErrorType base = CWaypoint::Load(reader, version, subVersion);
 
 	if (base != NAV_OK)
 	{
 		return base;
 	}
 
-	if (!filestream.good())
+	if (!reader.IsGood())
 	{
 		return NAV_CORRUPT_DATA;
 	}
 
-	filestream.read(reinterpret_cast<char*>(&m_cpindex), sizeof(int));
-	filestream.read(reinterpret_cast<char*>(&m_tfhint), sizeof(TFHint));
+	reader.Read(m_cpindex);
+	reader.Read(m_tfhint);
 
-	return filestream.good() ? NAV_OK : NAV_CORRUPT_DATA;
+	return reader.IsGood() ? NAV_OK : NAV_CORRUPT_DATA;
 }
 
 bool CTFWaypoint::IsAvailableToTeam(const int teamNum)
@@ -32,8 +32,8 @@ public:
 	
 	static CTFWaypoint::TFHint StringToTFHint(const char* szName);
 
-	void Save(std::fstream& filestream, uint32_t version) override;
-	NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion) override;
+	void Save(std::ostream& filestream, uint32_t version) override;
+	NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion) override;
 
 	bool IsAvailableToTeam(const int teamNum) override;
 
@@ -13,7 +13,7 @@
 #undef min
 #undef clamp
 
-void CTFNavArea::Save(std::fstream& filestream, uint32_t version)
+void CTFNavArea::Save(std::ostream& filestream, uint32_t version)
 {
 	CNavArea::Save(filestream, version); // Save base first
 
@@ -22,9 +22,9 @@ void CTFNavArea::Save(std::fstream& filestream, uint32_t version)
 	filestream.write(reinterpret_cast<char*>(&m_mvmattributes), sizeof(int));
 }
 
-NavErrorType CTFNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+NavErrorType CTFNavArea::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	auto base = CNavArea::Load(filestream, version, subVersion); // Load base first
+	auto base = CNavArea::Load(reader, version, subVersion); // Load base first
 
 	if (base != NAV_OK)
 	{
@@ -33,11 +33,11 @@ NavErrorType CTFNavArea::Load(std::fstream& filestream, uint32_t version, uint32
 
 	if (subVersion > 0)
 	{
-		filestream.read(reinterpret_cast<char*>(&m_tfattributes), sizeof(int));
-		filestream.read(reinterpret_cast<char*>(&m_tfpathattributes), sizeof(int));
-		filestream.read(reinterpret_cast<char*>(&m_mvmattributes), sizeof(int));
+		reader.Read(m_tfattributes);
+		reader.Read(m_tfpathattributes);
+		reader.Read(m_mvmattributes);
 
-		if (!filestream.good())
+		if (!reader.IsGood())
 		{
 			return NAV_CORRUPT_DATA;
 		}
@@ -16,8 +16,8 @@ public:
 		m_spawnroomteam = 0;
 	}
 
-	void Save(std::fstream& filestream, uint32_t version) override;
-	NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion) override;
+	void Save(std::ostream& filestream, uint32_t version) override;
+	NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion) override;
 	void UpdateBlocked(bool force = false, int teamID = NAV_TEAM_ANY) override;
 	bool IsBlocked(int teamID, bool ignoreNavBlockers = false) const override;
 
@@ -51,24 +51,21 @@ CTFNavMesh::~CTFNavMesh()
 {
 }
 
-void CTFNavMesh::FireGameEvent(IGameEvent* event)
+void CTFNavMesh::OnGameEvent(IGameEvent* event)
 {
-	if (event != nullptr)
-	{
-		const char* name = event->GetName();
+	const char* name = event->GetName();
 
-		if (name)
+	if (name)
+	{
+		if (std::strcmp(name, "mvm_wave_failed") == 0 || std::strcmp(name, "mvm_wave_complete") == 0)
 		{
-			if (std::strcmp(name, "mvm_wave_failed") == 0 || std::strcmp(name, "mvm_wave_complete") == 0)
-			{
-				OnRoundRestart();
-				PropagateOnRoundRestart();
-				return;
-			}
+			OnRoundRestart();
+			PropagateOnRoundRestart();
+			return;
 		}
 	}
 
-	CNavMesh::FireGameEvent(event);
+	CNavMesh::OnGameEvent(event);
 }
 
 void CTFNavMesh::OnRoundRestart(void)
@@ -87,9 +84,9 @@ unsigned int CTFNavMesh::GetGenerationTraceMask(void) const
 	return MASK_PLAYERSOLID_BRUSHONLY;
 }
 
-void CTFNavMesh::Update()
+void CTFNavMesh::OnFrame()
 {
-	CNavMesh::Update();
+	CNavMesh::OnFrame();
 	UpdateDebugDraw();
 
 	if (m_spawnroomupdatetimer.IsElapsed())
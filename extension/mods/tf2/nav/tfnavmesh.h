@@ -14,7 +14,6 @@ public:
 	CTFNavMesh();
 	virtual ~CTFNavMesh();
 
-	void FireGameEvent(IGameEvent* event) override;
 	virtual void OnRoundRestart(void) override;
 	virtual CNavArea* CreateArea(void) const override;
 	virtual uint32_t GetSubVersionNumber(void) const override;
@@ -22,13 +21,13 @@ public:
 	virtual bool IsAuthoritative(void) const override { return true; }
 	virtual unsigned int GetGenerationTraceMask(void) const override;
 
-	virtual void Update() override;
-
 	virtual bool Save(void) override;
 
 	virtual std::string GetMapFileName() const override;
 
 protected:
+	void OnFrame() override;
+	void OnGameEvent(IGameEvent* event) override;
 	void PostCustomAnalysis(void) override;
 
 	// Creates a new waypoint instance
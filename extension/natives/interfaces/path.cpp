@@ -39,7 +39,7 @@
 	}																										\
 																											\
 
-class CPluginBotPathCost : public IPathCost
+class CPluginBotPathCost final : public IPathCost
 {
 public:
 	CPluginBotPathCost(CBaseBot* bot)
@@ -65,6 +65,7 @@ enum NavErrorType
 	NAV_FILE_OUT_OF_DATE,
 	NAV_CORRUPT_DATA,
 	NAV_OUT_OF_MEMORY,
+	NAV_LOAD_CANCELLED,
 };
 
 enum NavAttributeType
@@ -29,6 +29,7 @@
 #include "nav_prereq.h"
 #include "nav_entities.h"
 #include "nav_colors.h"
+#include "nav_search_context.h"
 #include <Color.h>
 #include <collisionutils.h>
 #include <tier1/checksum_crc.h>
@@ -44,9 +45,8 @@ extern ConVar sm_nav_quicksave;
 unsigned int CNavArea::m_nextID = 1;
 NavAreaVector TheNavAreas;
 
-unsigned int CNavArea::m_masterMarker = 1;
-CNavArea *CNavArea::m_openList = NULL;
-CNavArea *CNavArea::m_openListTail = NULL;
+unsigned int CNavArea::s_nextSearchIndex = 0;
+std::vector<unsigned int> CNavArea::s_freeSearchIndexes;
 
 bool CNavArea::m_isReset = false;
 uint32 CNavArea::s_nCurrVisTestCounter = 0;
@@ -91,6 +91,17 @@ bool UTIL_IsCommandIssuedByServerAdmin()
 	return true;
 }
 
+bool UTIL_WarnIfNavMeshIsLoading()
+{
+	if (TheNavMesh->IsLoading())
+	{
+		Msg("The nav mesh is still loading.\n");
+		return true;
+	}
+
+	return false;
+}
+
 static void SelectedSetColorChaged(IConVar *var, const char *pOldValue, float flOldValue) 
 {
 	ConVarRef colorVar(var->GetName());
@@ -282,22 +293,24 @@ void CNavArea::CompressIDs( CNavMesh *TheNavMesh  )
  */
 CNavArea::CNavArea(unsigned int place)
 {
-	m_marker = 0;
-	m_nearNavSearchMarker = 0;
 	m_damagingTickCount = 0;
-	m_openMarker = 0;
 
-	m_parent = NULL;
-	m_parentHow = GO_NORTH;
+	// reuse the search index of a destroyed area to keep the search state arrays dense
+	if ( !s_freeSearchIndexes.empty() )
+	{
+		m_searchIndex = s_freeSearchIndexes.back();
+		s_freeSearchIndexes.pop_back();
+	}
+	else
+	{
+		m_searchIndex = s_nextSearchIndex++;
+	}
+
 	m_attributeFlags = 0;
 	m_place = place;
 	m_isUnderwater = false;
 	m_avoidanceObstacleHeight = 0.0f;
 
-	m_totalCost = 0.0f;
-	m_costSoFar = 0.0f;
-	m_pathLengthSoFar = 0.0f;
-
 	ResetNodes();
 
 	for (auto& b : m_isBlocked)
@@ -606,6 +619,8 @@ CNavArea::~CNavArea()
 {
 	m_offmeshconnections.clear();
 
+	s_freeSearchIndexes.push_back( m_searchIndex );
+
 	// if we are resetting the system, don't bother cleaning up - all areas are being destroyed
 	if (m_isReset)
 		return;
@@ -3385,185 +3400,140 @@ void CNavArea::DrawConnectedAreas( CNavMesh* TheNavMesh ) const
 
 
 //--------------------------------------------------------------------------------------------------------------
-/**
- * Add to open list in decreasing value order
- */
-void CNavArea::AddToOpenList( void )
+void CNavArea::MakeNewMarker( void )
 {
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-
-	if ( IsOpen() )
-	{
-		// already on list
-		return;
-	}
-
-	// mark as being on open list for quick check
-	m_openMarker = m_masterMarker;
-
-	// if list is empty, add and return
-	if ( m_openList == NULL )
-	{
-		m_openList = this;
-		m_openListTail = this;
-		this->m_prevOpen = NULL;
-		this->m_nextOpen = NULL;
-		return;
-	}
-
-	// insert self in ascending cost order
-	CNavArea *area, *last = NULL;
-	for( area = m_openList; area; area = area->m_nextOpen )
-	{
-		if ( GetTotalCost() < area->GetTotalCost() )
-		{
-			break;
-		}
-		last = area;
-	}
+	NavSearchContext::GetCurrent()->MakeNewMarker();
+}
 
-	if ( area )
-	{
-		// insert before this area
-		this->m_prevOpen = area->m_prevOpen;
+//--------------------------------------------------------------------------------------------------------------
+void CNavArea::Mark( void )
+{
+	NavSearchContext::GetCurrent()->Mark( this );
+}
 
-		if ( this->m_prevOpen )
-		{
-			this->m_prevOpen->m_nextOpen = this;
-		}
-		else
-		{
-			m_openList = this;
-		}
+//--------------------------------------------------------------------------------------------------------------
+bool CNavArea::IsMarked( void ) const
+{
+	return NavSearchContext::GetCurrent()->IsMarked( this );
+}
 
-		this->m_nextOpen = area;
-		area->m_prevOpen = this;
-	}
-	else
-	{
-		// append to end of list
-		last->m_nextOpen = this;
-		this->m_prevOpen = last;
-	
-		this->m_nextOpen = NULL;
+//--------------------------------------------------------------------------------------------------------------
+void CNavArea::SetParent( CNavArea *parent, NavTraverseType how )
+{
+	NavSearchContext::GetCurrent()->SetParent( this, parent, how );
+}
 
-		m_openListTail = this;
-	}
+//--------------------------------------------------------------------------------------------------------------
+CNavArea *CNavArea::GetParent( void ) const
+{
+	return NavSearchContext::GetCurrent()->GetParent( this );
+}
 
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
+//--------------------------------------------------------------------------------------------------------------
+NavTraverseType CNavArea::GetParentHow( void ) const
+{
+	return NavSearchContext::GetCurrent()->GetParentHow( this );
 }
 
+//--------------------------------------------------------------------------------------------------------------
+bool CNavArea::IsOpen( void ) const
+{
+	return NavSearchContext::GetCurrent()->IsOpen( this );
+}
 
 //--------------------------------------------------------------------------------------------------------------
 /**
- * Add to tail of the open list
+ * Add to open list, the open list is a min heap ordered by total cost
  */
-void CNavArea::AddToOpenListTail( void )
+void CNavArea::AddToOpenList( void )
 {
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-
-	if ( IsOpen() )
-	{
-		// already on list
-		return;
-	}
-
-	// mark as being on open list for quick check
-	m_openMarker = m_masterMarker;
+	NavSearchContext::GetCurrent()->AddToOpenList( this );
+}
 
-	// if list is empty, add and return
-	if ( m_openList == NULL )
-	{
-		m_openList = this;
-		m_openListTail = this;
-		this->m_prevOpen = NULL;
-		this->m_nextOpen = NULL;
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * A smaller value has been found, update this area on the open list
+ */
+void CNavArea::UpdateOnOpenList( void )
+{
+	NavSearchContext::GetCurrent()->UpdateOnOpenList( this );
+}
 
-		Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-		return;
-	}
+//--------------------------------------------------------------------------------------------------------------
+void CNavArea::RemoveFromOpenList( void )
+{
+	NavSearchContext::GetCurrent()->RemoveFromOpenList( this );
+}
 
-	// append to end of list
-	m_openListTail->m_nextOpen = this;
+//--------------------------------------------------------------------------------------------------------------
+bool CNavArea::IsOpenListEmpty( void )
+{
+	return NavSearchContext::GetCurrent()->IsOpenListEmpty();
+}
 
-	this->m_prevOpen = m_openListTail;
-	this->m_nextOpen = NULL;
+//--------------------------------------------------------------------------------------------------------------
+CNavArea *CNavArea::PopOpenList( void )
+{
+	return NavSearchContext::GetCurrent()->PopOpenList();
+}
 
-	m_openListTail = this;
+//--------------------------------------------------------------------------------------------------------------
+bool CNavArea::IsClosed( void ) const
+{
+	return NavSearchContext::GetCurrent()->IsClosed( this );
+}
 
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
+//--------------------------------------------------------------------------------------------------------------
+void CNavArea::AddToClosedList( void )
+{
+	NavSearchContext::GetCurrent()->AddToClosedList( this );
 }
 
 //--------------------------------------------------------------------------------------------------------------
-/**
- * A smaller value has been found, update this area on the open list
- * @todo "bubbling" does unnecessary work, since the order of all other nodes will be unchanged - only this node is altered
- */
-void CNavArea::UpdateOnOpenList( void )
+void CNavArea::RemoveFromClosedList( void )
 {
-	// since value can only decrease, bubble this area up from current spot
-	while( m_prevOpen && this->GetTotalCost() < m_prevOpen->GetTotalCost() )
-	{
-		// swap position with predecessor
-		CNavArea *other = m_prevOpen;
-		CNavArea *before = other->m_prevOpen;
-		CNavArea *after  = this->m_nextOpen;
+	// since "closed" is defined as visited (marked) and not on open list, do nothing
+}
 
-		this->m_nextOpen = other;
-		this->m_prevOpen = before;
+//--------------------------------------------------------------------------------------------------------------
+void CNavArea::SetTotalCost( float value )
+{
+	DebuggerBreakOnNaN_StagingOnly( value );
+	Assert( !IS_NAN( value ) );
+	NavSearchContext::GetCurrent()->SetTotalCost( this, value );
+}
 
-		other->m_prevOpen = this;
-		other->m_nextOpen = after;
+//--------------------------------------------------------------------------------------------------------------
+float CNavArea::GetTotalCost( void ) const
+{
+	return NavSearchContext::GetCurrent()->GetTotalCost( this );
+}
 
-		if ( before )
-		{
-			before->m_nextOpen = this;
-		}
-		else
-		{
-			m_openList = this;
-		}
+//--------------------------------------------------------------------------------------------------------------
+void CNavArea::SetCostSoFar( float value )
+{
+	DebuggerBreakOnNaN_StagingOnly( value );
+	NavSearchContext::GetCurrent()->SetCostSoFar( this, value );
+}
 
-		if ( after )
-		{
-			after->m_prevOpen = other;
-		}
-		else
-		{
-			m_openListTail = this;
-		}
-	}
+//--------------------------------------------------------------------------------------------------------------
+float CNavArea::GetCostSoFar( void ) const
+{
+	return NavSearchContext::GetCurrent()->GetCostSoFar( this );
 }
 
 //--------------------------------------------------------------------------------------------------------------
-void CNavArea::RemoveFromOpenList( void )
+void CNavArea::SetPathLengthSoFar( float value )
 {
-	if ( m_openMarker == 0 )
-	{
-		// not on the list
-		return;
-	}
+	DebuggerBreakOnNaN_StagingOnly( value );
+	Assert( !IS_NAN( value ) );
+	NavSearchContext::GetCurrent()->SetPathLengthSoFar( this, value );
+}
 
-	if ( m_prevOpen )
-	{
-		m_prevOpen->m_nextOpen = m_nextOpen;
-	}
-	else
-	{
-		m_openList = m_nextOpen;
-	}
-	
-	if ( m_nextOpen )
-	{
-		m_nextOpen->m_prevOpen = m_prevOpen;
-	}
-	else
-	{
-		m_openListTail = m_prevOpen;
-	}
-	
-	// zero is an invalid marker
-	m_openMarker = 0;
+//--------------------------------------------------------------------------------------------------------------
+float CNavArea::GetPathLengthSoFar( void ) const
+{
+	return NavSearchContext::GetCurrent()->GetPathLengthSoFar( this );
 }
 
 //--------------------------------------------------------------------------------------------------------------
@@ -3633,11 +3603,7 @@ inline bool CNavArea::IsVisible( const Vector &eye, Vector *visSpot ) const
  */
 void CNavArea::ClearSearchLists( void )
 {
-	// effectively clears all open list pointers and closed flags
-	CNavArea::MakeNewMarker();
-
-	m_openList = NULL;
-	m_openListTail = NULL;
+	NavSearchContext::GetCurrent()->ClearSearchLists();
 }
 
 //--------------------------------------------------------------------------------------------------------------
@@ -4192,7 +4158,7 @@ bool CNavArea::ComputeLighting( void )
 CON_COMMAND_F( sm_nav_update_lighting, "Recomputes lighting values", FCVAR_CHEAT )
 {
 
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 	int numComputed = 0;
 	if ( args.ArgC() == 2 )
@@ -4458,7 +4424,7 @@ void CNavArea::Shift( const Vector &shift )
 //--------------------------------------------------------------------------------------------------------------
 static void CommandNavUpdateBlocked( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 	if ( TheNavMesh->GetMarkedArea() )
 	{
@@ -5014,7 +4980,7 @@ void CNavArea::CheckWaterLevel( void )
 //--------------------------------------------------------------------------------------------------------------
 static void CommandNavCheckFloor( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 	if ( TheNavMesh->GetMarkedArea() )
 	{
@@ -5137,7 +5103,7 @@ bool CollectOverlappingAreas::operator()(CNavArea* area)
 //--------------------------------------------------------------------------------------------------------------
 static void CommandNavSelectOverlapping( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 	TheNavMesh->ClearSelectedSet();
 
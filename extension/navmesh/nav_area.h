@@ -22,6 +22,7 @@
 #include <cmath>
 
 #include "nav_ladder.h"
+#include "nav_filereader.h"
 #include "nav_elevator.h"
 #include <sdkports/sdk_timers.h>
 #include <shareddefs.h>
@@ -43,6 +44,7 @@ inline void DebuggerBreakOnNaN_StagingOnly( float val )
 
 class CFuncElevator;
 class CFuncNavCost;
+class CNavAreaIDTable;
 // class KeyValues;
 
 inline bool FStrEq(const char *sz1, const char *sz2)
@@ -54,6 +56,7 @@ template < typename Functor >
 bool ForEachActor( Functor &func );
 
 bool UTIL_IsCommandIssuedByServerAdmin();
+bool UTIL_WarnIfNavMeshIsLoading();		// prints a message and returns true while the loader thread owns the mesh, edit commands bail out then
 
 const char *UTIL_VarArgs( const char *format, ... );
 
@@ -134,8 +137,8 @@ public:
 
 	int GetFlags( void ) const		{ return m_flags; }
 
-	void Save(std::fstream& filestream, uint32_t version);
-	void Load(std::fstream& filestream, uint32_t version);
+	void Save(std::ostream& filestream, uint32_t version);
+	void Load(CNavFileReader& reader, uint32_t version);
 	NavErrorType PostLoad( void );
 
 	const Vector &GetPosition( void ) const		{ return m_pos; }	// get the position of the hiding spot
@@ -277,24 +280,15 @@ protected:
 	float m_neZ;												// height of the implicit corner defined by (m_seCorner.x, m_nwCorner.y, m_neZ)
 	float m_swZ;												// height of the implicit corner defined by (m_nwCorner.x, m_seCorner.y, m_neZ)
 	Vector m_center;											// centroid of area
-	unsigned int m_marker;										// used to flag the area as visited
-	float m_totalCost;											// the distance so far plus an estimate of the distance left
-	float m_costSoFar;											// distance travelled so far
+	unsigned int m_searchIndex;									// dense index into the per query search state, see NavSearchContext
 	std::array<bool, NAV_TEAMS_ARRAY_SIZE> m_isBlocked;					// Blocked status for each team
 
-	CNavArea *m_nextOpen, *m_prevOpen;							// only valid if m_openMarker == m_masterMarker
-	unsigned int m_openMarker;									// if this equals the current marker value, we are on the open list
 	int	m_attributeFlags;										// set of attribute bit flags (see NavAttributeType)
 
 	//- connections to adjacent areas -------------------------------------------------------------------
 	NavConnectVector m_connect[ NUM_DIRECTIONS ];				// a list of adjacent areas for each direction
 	NavLadderConnectVector m_ladder[ CNavLadder::NUM_LADDER_DIRECTIONS ];	// list of ladders leading up and down from this area
 
-	unsigned int m_nearNavSearchMarker;							// used in GetNearestNavArea()
-
-	CNavArea *m_parent;											// the area just prior to this on in the search path
-	NavTraverseType m_parentHow;								// how we get from parent to us
-	float m_pathLengthSoFar;									// length of path so far, needed for limiting pathfind max path length
 	const CNavElevator* m_elevator;								// elevator assigned to this area
 	const CNavElevator::ElevatorFloor* m_elevfloor;				// elevator floor of this area
 
@@ -325,9 +319,9 @@ public:
 	virtual void OnEditDestroyNotify( CNavArea *deadArea ) { }		// invoked when given area has just been deleted from the mesh in edit mode
 	virtual void OnEditDestroyNotify( CNavLadder *deadLadder ) { }	// invoked when given ladder has just been deleted from the mesh in edit mode
 
-	virtual void Save(std::fstream& filestream, uint32_t version);	// (EXTEND)
-	virtual NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);		// (EXTEND)
-	virtual NavErrorType PostLoad( void );								// (EXTEND) invoked after all areas have been loaded - for pointer binding, etc
+	virtual void Save(std::ostream& filestream, uint32_t version);	// (EXTEND)
+	virtual NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);		// (EXTEND)
+	virtual NavErrorType PostLoad( const CNavAreaIDTable &areas );	// (EXTEND) invoked after all areas have been loaded - for pointer binding, etc. May run on a loader thread.
 
 	// virtual void SaveToSelectedSet( KeyValues *areaKey ) const;		// (EXTEND) saves attributes for the area to a KeyValues
 	// virtual void RestoreFromSelectedSet( KeyValues *areaKey );		// (EXTEND) restores attributes from a KeyValues
@@ -533,17 +527,20 @@ public:
 	float GetLightIntensity( void ) const;						// returns a 0..1 light intensity averaged over the whole area
 
 	//- A* pathfinding algorithm ------------------------------------------------------------------------
-	static void MakeNewMarker( void )	{ ++m_masterMarker; if (m_masterMarker == 0) m_masterMarker = 1; }
-	void Mark( void )					{ m_marker = m_masterMarker; }
-	bool IsMarked( void ) const			{ return (m_marker == m_masterMarker) ? true : false; }
+	// The search state lives in the calling thread's current NavSearchContext, these forward to it.
+	unsigned int GetSearchIndex( void ) const	{ return m_searchIndex; }
+	static unsigned int GetSearchIndexCount( void )	{ return s_nextSearchIndex; }	// upper bound of all search indexes in use
+
+	static void MakeNewMarker( void );
+	void Mark( void );
+	bool IsMarked( void ) const;
 	
-	void SetParent( CNavArea *parent, NavTraverseType how = NUM_TRAVERSE_TYPES )	{ m_parent = parent; m_parentHow = how; }
-	CNavArea *GetParent( void ) const	{ return m_parent; }
-	NavTraverseType GetParentHow( void ) const	{ return m_parentHow; }
+	void SetParent( CNavArea *parent, NavTraverseType how = NUM_TRAVERSE_TYPES );
+	CNavArea *GetParent( void ) const;
+	NavTraverseType GetParentHow( void ) const;
 
 	bool IsOpen( void ) const;									// true if on "open list"
-	void AddToOpenList( void );									// add to open list in decreasing value order
-	void AddToOpenListTail( void );								// add to tail of the open list
+	void AddToOpenList( void );									// add to open list, ordered by total cost
 	void UpdateOnOpenList( void );								// a smaller value has been found, update this area on the open list
 	void RemoveFromOpenList( void );
 	static bool IsOpenListEmpty( void );
@@ -555,14 +552,14 @@ public:
 
 	static void ClearSearchLists( void );						// clears the open and closed lists for a new search
 
-	void SetTotalCost( float value )	{ DebuggerBreakOnNaN_StagingOnly( value ); Assert( !IS_NAN(value) ); m_totalCost = value; }
-	float GetTotalCost( void ) const	{ DebuggerBreakOnNaN_StagingOnly( m_totalCost ); return m_totalCost; }
+	void SetTotalCost( float value );
+	float GetTotalCost( void ) const;
 
-	void SetCostSoFar( float value )	{ DebuggerBreakOnNaN_StagingOnly( value ); Assert( IS_NAN(value) ); m_costSoFar = value; }
-	float GetCostSoFar( void ) const	{ DebuggerBreakOnNaN_StagingOnly( m_costSoFar ); return m_costSoFar; }
+	void SetCostSoFar( float value );
+	float GetCostSoFar( void ) const;
 
-	void SetPathLengthSoFar( float value )	{ DebuggerBreakOnNaN_StagingOnly( value ); Assert( !IS_NAN(value) ); m_pathLengthSoFar = value; }
-	float GetPathLengthSoFar( void ) const	{ DebuggerBreakOnNaN_StagingOnly( m_pathLengthSoFar ); return m_pathLengthSoFar; }
+	void SetPathLengthSoFar( float value );
+	float GetPathLengthSoFar( void ) const;
 
 	//- editing -----------------------------------------------------------------------------------------
 	virtual void Draw( void ) const;							// draw area for debugging & editing
@@ -761,7 +758,7 @@ private:
 					m_seCorner
 	*/
 
-	static unsigned int m_nextID;								// used to allocate unique IDs
+	static unsigned int m_nextID;								// used to allocate unique IDs, owned by the loader thread while the mesh is loading
 	unsigned int m_id;											// unique area ID
 	unsigned int m_debugid;
 
@@ -803,10 +800,8 @@ private:
 	float m_lightIntensity[ NUM_CORNERS ];						// 0..1 light intensity at corners
 
 	//- A* pathfinding algorithm ------------------------------------------------------------------------
-	static unsigned int m_masterMarker;
-
-	static CNavArea *m_openList;
-	static CNavArea *m_openListTail;
+	static unsigned int s_nextSearchIndex;						// used to allocate search indexes, owned by the loader thread while the mesh is loading
+	static std::vector<unsigned int> s_freeSearchIndexes;		// search indexes released by destroyed areas, same as above
 
 	//- connections to adjacent areas -------------------------------------------------------------------
 	NavConnectVector m_incomingConnect[ NUM_DIRECTIONS ];		// a list of adjacent areas for each direction that connect TO us, but we have no connection back to them
@@ -959,61 +954,6 @@ inline CNavArea *CNavArea::GetAdjacentArea( NavDirType dir, int i ) const
 	return m_connect[dir][i].area;
 }
 
-//--------------------------------------------------------------------------------------------------------------
-inline bool CNavArea::IsOpen( void ) const
-{
-	return (m_openMarker == m_masterMarker) ? true : false;
-}
-
-//--------------------------------------------------------------------------------------------------------------
-inline bool CNavArea::IsOpenListEmpty( void )
-{
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-	return (m_openList) ? false : true;
-}
-
-//--------------------------------------------------------------------------------------------------------------
-inline CNavArea *CNavArea::PopOpenList( void )
-{
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-
-	if ( m_openList )
-	{
-		CNavArea *area = m_openList;
-	
-		// disconnect from list
-		area->RemoveFromOpenList();
-		area->m_prevOpen = NULL;
-		area->m_nextOpen = NULL;
-
-		Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-
-		return area;
-	}
-
-	Assert( (m_openList && m_openList->m_prevOpen == NULL) || m_openList == NULL );
-
-	return NULL;
-}
-
-//--------------------------------------------------------------------------------------------------------------
-inline bool CNavArea::IsClosed( void ) const
-{
-	return IsMarked() && !IsOpen();
-}
-
-//--------------------------------------------------------------------------------------------------------------
-inline void CNavArea::AddToClosedList( void )
-{
-	Mark();
-}
-
-//--------------------------------------------------------------------------------------------------------------
-inline void CNavArea::RemoveFromClosedList( void )
-{
-	// since "closed" is defined as visited (marked) and not on open list, do nothing
-}
-
 //--------------------------------------------------------------------------------------------------------------
 inline float CNavArea::GetClearedTimestamp( int teamID ) const
 { 
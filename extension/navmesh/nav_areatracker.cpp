@@ -0,0 +1,224 @@
+#include <extension.h>
+#include <util/helpers.h>
+#include <util/entprops.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_areatracker.h"
+#include "nav_stats.h"
+
+extern ConVar sm_nav_edit;
+
+ConVar sm_nav_area_tracker("sm_nav_area_tracker", "1", FCVAR_GAMEDLL, "Tracks the nav area of every client once per tick, checking the last area and its neighbors before the full nearest area query.");
+ConVar sm_nav_area_tracker_query_interval("sm_nav_area_tracker_query_interval", "0.1", FCVAR_GAMEDLL, "Minimum time in seconds between two full nearest area queries of the same client.", true, 0.0f, true, 2.0f);
+
+// same search radius as the per player updates
+static constexpr float NEAREST_AREA_MAX_DISTANCE = 50.0f;
+
+CNavAreaTracker::CNavAreaTracker()
+{
+	ResetStats();
+}
+
+bool CNavAreaTracker::IsEnabled() const
+{
+	// areas may be deleted at any time while editing
+	return sm_nav_area_tracker.GetBool() && !sm_nav_edit.GetBool() && TheNavMesh->IsLoaded();
+}
+
+void CNavAreaTracker::Update()
+{
+	if (!IsEnabled())
+	{
+		Clear();
+		return;
+	}
+
+	for (int client = 1; client <= gpGlobals->maxClients; client++)
+	{
+		TrackClient(client, false);
+	}
+}
+
+CNavArea* CNavAreaTracker::UpdateClient(int client)
+{
+	if (!IsEnabled())
+	{
+		return nullptr;
+	}
+
+	return TrackClient(client, true);
+}
+
+CNavArea* CNavAreaTracker::GetArea(int client) const
+{
+	if (client < 1 || client >= static_cast<int>(m_clients.size()))
+	{
+		return nullptr;
+	}
+
+	return m_clients[client].area;
+}
+
+void CNavAreaTracker::Clear()
+{
+	m_clients.clear();
+}
+
+void CNavAreaTracker::ResetStats()
+{
+	m_stats.lastAreaHits = 0U;
+	m_stats.adjacentHits = 0U;
+	m_stats.fullQueries = 0U;
+	m_stats.deferredQueries = 0U;
+}
+
+CNavAreaTracker::ClientState* CNavAreaTracker::GetClientState(int client)
+{
+	if (client < 1 || client > gpGlobals->maxClients)
+	{
+		return nullptr;
+	}
+
+	if (client >= static_cast<int>(m_clients.size()))
+	{
+		m_clients.resize(static_cast<std::size_t>(gpGlobals->maxClients) + 1U, { nullptr, 0 });
+	}
+
+	return &m_clients[client];
+}
+
+CNavArea* CNavAreaTracker::TrackClient(int client, bool force)
+{
+	ClientState* state = GetClientState(client);
+
+	if (state == nullptr)
+	{
+		return nullptr;
+	}
+
+	SourceMod::IGamePlayer* player = playerhelpers->GetGamePlayer(client);
+	edict_t* edict = gamehelpers->EdictOfIndex(client);
+
+	if (player == nullptr || edict == nullptr || !player->IsInGame() || player->IsSourceTV() || player->IsReplay())
+	{
+		state->area = nullptr;
+		return nullptr;
+	}
+
+	IPlayerInfo* info = player->GetPlayerInfo();
+
+	if (info == nullptr || info->IsDead())
+	{
+		return state->area;
+	}
+
+	int groundent = -1;
+	edict_t* ground = nullptr;
+	entprops->GetEntPropEnt(client, Prop_Send, "m_hGroundEntity", groundent);
+	UtilHelpers::IndexToAThings(groundent, nullptr, &ground);
+
+	if (ground == nullptr)
+	{
+		return state->area; // don't update while in the air
+	}
+
+	const Vector pos = edict->GetCollideable()->GetCollisionOrigin();
+
+	if (state->area != nullptr)
+	{
+		CNavArea* area = FindNearbyArea(state->area, pos, info->GetTeamIndex());
+
+		if (area != nullptr)
+		{
+			state->area = area;
+			return area;
+		}
+	}
+
+	if (!force && gpGlobals->tickcount < state->nextQueryTick)
+	{
+		m_stats.deferredQueries++;
+		return state->area;
+	}
+
+	m_stats.fullQueries++;
+	state->nextQueryTick = gpGlobals->tickcount + TIME_TO_TICKS(sm_nav_area_tracker_query_interval.GetFloat());
+
+	CNavArea* area = TheNavMesh->GetNearestNavArea(edict, GETNAVAREA_CHECK_GROUND | GETNAVAREA_CHECK_LOS, NEAREST_AREA_MAX_DISTANCE);
+
+	if (area != nullptr)
+	{
+		state->area = area;
+	}
+
+	return state->area;
+}
+
+CNavArea* CNavAreaTracker::FindNearbyArea(const CNavArea* last, const Vector& pos, int team)
+{
+	const float stepHeight = navgenparams->step_height;
+
+	// same checks as CNavMesh::GetNavArea, limited to the areas within step height so no LOS trace is needed
+	auto contains = [&pos, team, stepHeight](const CNavArea* area, float& z) {
+		if (!area->IsOverlapping(pos) || area->IsBlocked(team))
+		{
+			return false;
+		}
+
+		z = area->GetZ(pos);
+		return z <= pos.z + stepHeight && z >= pos.z - stepHeight;
+	};
+
+	float z = 0.0f;
+
+	// on the shared edge of two areas, stay on the last one
+	if (contains(last, z))
+	{
+		m_stats.lastAreaHits++;
+		return const_cast<CNavArea*>(last);
+	}
+
+	CNavArea* use = nullptr;
+	float useZ = -99999999.9f;
+
+	for (int dir = 0; dir < static_cast<int>(NUM_DIRECTIONS); dir++)
+	{
+		const NavConnectVector* adjacent = last->GetAdjacentAreas(static_cast<NavDirType>(dir));
+
+		FOR_EACH_VEC((*adjacent), it)
+		{
+			CNavArea* area = (*adjacent)[it].area;
+
+			// like the full query, the highest area wins
+			if (contains(area, z) && z > useZ)
+			{
+				use = area;
+				useZ = z;
+			}
+		}
+	}
+
+	if (use != nullptr)
+	{
+		m_stats.adjacentHits++;
+	}
+
+	return use;
+}
+
+NAV_STATS_COMMAND(sm_nav_area_tracker_stats, "client nav area tracker")
+{
+	CNavAreaTracker* tracker = TheNavMesh->GetAreaTracker();
+
+	if (!navutils::BeginStatsCommand(args, "Nav area tracker", tracker))
+	{
+		return;
+	}
+
+	const CNavAreaTracker::Stats& stats = tracker->GetStats();
+	const unsigned int total = stats.lastAreaHits + stats.adjacentHits + stats.fullQueries + stats.deferredQueries;
+	const float hitRate = total > 0U ? static_cast<float>(stats.lastAreaHits + stats.adjacentHits) / static_cast<float>(total) : 0.0f;
+
+	Msg("  Last area: %u  Connected area: %u  Hit rate: %3.1f%%\n", stats.lastAreaHits, stats.adjacentHits, hitRate * 100.0f);
+	Msg("  Full queries: %u  Deferred: %u\n", stats.fullQueries, stats.deferredQueries);
+}
@@ -0,0 +1,68 @@
+#ifndef NAV_AREA_TRACKER_H_
+#define NAV_AREA_TRACKER_H_
+
+#include <vector>
+#include "nav.h"
+
+class CNavArea;
+
+/**
+ * @brief Keeps the nav area of every client up to date, once per tick.
+ *
+ * Players almost always stay on the area they were on or step into one of its neighbors, so the last area and the areas connected
+ * to it are tested first (2D overlap and height within step height, no traces). The full nearest area query only runs when none of
+ * them contain the player, at most once per sm_nav_area_tracker_query_interval seconds for each client.
+ * Clients in the air keep their last area. Not enabled while editing, areas may be deleted at any time.
+ */
+class CNavAreaTracker
+{
+public:
+	struct Stats
+	{
+		unsigned int lastAreaHits;		// still on the last area
+		unsigned int adjacentHits;		// moved to a connected area
+		unsigned int fullQueries;		// fell back to the nearest area query
+		unsigned int deferredQueries;	// misses waiting for the query interval
+	};
+
+	CNavAreaTracker();
+
+	CNavAreaTracker(const CNavAreaTracker&) = delete;
+	CNavAreaTracker& operator=(const CNavAreaTracker&) = delete;
+
+	// true if the tracked areas may be used, see sm_nav_area_tracker
+	bool IsEnabled() const;
+
+	// Updates the area of every client in game. Game thread only.
+	void Update();
+	/**
+	 * @brief Updates the area of a single client now, the full query isn't deferred.
+	 * @param client Client index.
+	 * @return Area of the client or NULL if unknown.
+	 */
+	CNavArea* UpdateClient(int client);
+	// Last known area of the client or NULL if unknown
+	CNavArea* GetArea(int client) const;
+	// Forgets every area. Called before areas are removed or the mesh is destroyed.
+	void Clear();
+
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats();
+
+private:
+	struct ClientState
+	{
+		CNavArea* area;
+		int nextQueryTick;			// misses before this tick keep the last area
+	};
+
+	std::vector<ClientState> m_clients;	// indexed by client index
+	Stats m_stats;
+
+	ClientState* GetClientState(int client);
+	CNavArea* TrackClient(int client, bool force);
+	// Checks the last area and the areas connected to it, returns NULL if none contain the position
+	CNavArea* FindNearbyArea(const CNavArea* last, const Vector& pos, int team);
+};
+
+#endif // !NAV_AREA_TRACKER_H_
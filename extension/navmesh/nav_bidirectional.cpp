@@ -0,0 +1,169 @@
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_landmarks.h"
+#include "nav_bidirectional.h"
+
+ConVar sm_nav_bidirectional_search_distance("sm_nav_bidirectional_search_distance", "3000", FCVAR_GAMEDLL, "Path searches between areas further apart than this distance expand from both ends. Zero disables bidirectional searches.", true, 0.0f, false, 0.0f);
+
+CNavBidirectionalSearch::CNavBidirectionalSearch()
+{
+	m_graph = nullptr;
+	m_landmarks = nullptr;
+	m_startArea = nullptr;
+	m_goalArea = nullptr;
+	m_meetingArea = nullptr;
+	m_bestCost = INFINITE_COST;
+	m_marker = 1U;
+	m_expansions = 0U;
+}
+
+bool CNavBidirectionalSearch::IsAvailable()
+{
+	return TheNavMesh->GetConnectionGraph()->IsBuilt();
+}
+
+bool CNavBidirectionalSearch::ShouldUse(const CNavArea* startArea, const CNavArea* goalArea)
+{
+	const float distance = sm_nav_bidirectional_search_distance.GetFloat();
+
+	if (distance <= 0.0f || startArea == nullptr || goalArea == nullptr || !IsAvailable())
+	{
+		return false;
+	}
+
+	return (goalArea->GetCenter() - startArea->GetCenter()).IsLengthGreaterThan(distance);
+}
+
+CNavBidirectionalSearch& CNavBidirectionalSearch::GetThreadSearch()
+{
+	static thread_local CNavBidirectionalSearch s_search;
+	return s_search;
+}
+
+bool CNavBidirectionalSearch::IsSearchable(const CNavArea* area) const
+{
+	return static_cast<std::size_t>(area->GetSearchIndex()) < TheNavMesh->GetConnectionGraph()->GetAreaCount();
+}
+
+void CNavBidirectionalSearch::Reset(CNavArea* startArea, CNavArea* goalArea)
+{
+	m_graph = TheNavMesh->GetConnectionGraph();
+	m_landmarks = TheNavMesh->GetLandmarks()->IsBuilt() ? TheNavMesh->GetLandmarks() : nullptr;
+	m_startArea = startArea;
+	m_goalArea = goalArea;
+	m_meetingArea = nullptr;
+	m_bestCost = INFINITE_COST;
+
+	if (m_nodes.size() != m_graph->GetAreaCount())
+	{
+		Node empty{};
+		empty.marker = 0U;
+		m_nodes.assign(m_graph->GetAreaCount(), empty);
+		m_marker = 1U;
+	}
+	else if (++m_marker == 0U)
+	{
+		// markers wrapped around, clear the old markers
+		for (Node& node : m_nodes)
+		{
+			node.marker = 0U;
+		}
+
+		m_marker = 1U;
+	}
+
+	m_openList[FORWARD].clear();
+	m_openList[REVERSE].clear();
+
+	GetNode(startArea).g[FORWARD] = 0.0f;
+	PushOpen(FORWARD, startArea, 0.0f);
+	GetNode(goalArea).g[REVERSE] = 0.0f;
+	PushOpen(REVERSE, goalArea, 0.0f);
+}
+
+float CNavBidirectionalSearch::GetPotential(int direction, const CNavArea* area) const
+{
+	float toGoal = (m_goalArea->GetCenter() - area->GetCenter()).Length();
+	float fromStart = (area->GetCenter() - m_startArea->GetCenter()).Length();
+
+	if (m_landmarks != nullptr)
+	{
+		toGoal = std::max(toGoal, m_landmarks->GetLowerBound(area, m_goalArea));
+		fromStart = std::max(fromStart, m_landmarks->GetLowerBound(m_startArea, area));
+	}
+
+	const float potential = 0.5f * (toGoal - fromStart);
+	return direction == FORWARD ? potential : -potential;
+}
+
+void CNavBidirectionalSearch::PushOpen(int direction, CNavArea* area, float g)
+{
+	std::vector<OpenEntry>& openList = m_openList[direction];
+	openList.push_back({ g + GetPotential(direction, area), g, area });
+	std::push_heap(openList.begin(), openList.end(), OpenEntryGreater);
+}
+
+bool CNavBidirectionalSearch::PruneOpenList(int direction)
+{
+	std::vector<OpenEntry>& openList = m_openList[direction];
+
+	while (!openList.empty())
+	{
+		const OpenEntry& top = openList.front();
+
+		if (GetNode(top.area).g[direction] == top.g)
+		{
+			return true;
+		}
+
+		std::pop_heap(openList.begin(), openList.end(), OpenEntryGreater);
+		openList.pop_back();
+	}
+
+	return false;
+}
+
+bool CNavBidirectionalSearch::BuildPath()
+{
+	const std::size_t maxLength = m_nodes.size();
+
+	// from the meeting area back to the start area
+	for (CNavArea* area = m_meetingArea; area != m_startArea;)
+	{
+		const Node& node = GetNode(area);
+
+		if (node.parent[FORWARD] == nullptr || m_path.size() > maxLength)
+		{
+			m_path.clear();
+			return false;
+		}
+
+		m_path.push_back({ area, node.parent[FORWARD]->how });
+		m_pathCosts.push_back(node.g[FORWARD]);
+		area = node.parent[FORWARD]->from;
+	}
+
+	m_path.push_back({ m_startArea, NUM_TRAVERSE_TYPES });
+	m_pathCosts.push_back(0.0f);
+	std::reverse(m_path.begin(), m_path.end());
+	std::reverse(m_pathCosts.begin(), m_pathCosts.end());
+
+	// from the meeting area to the goal area
+	for (CNavArea* area = m_meetingArea; area != m_goalArea;)
+	{
+		const Node& node = GetNode(area);
+
+		if (node.parent[REVERSE] == nullptr || m_path.size() > maxLength)
+		{
+			m_path.clear();
+			m_pathCosts.clear();
+			return false;
+		}
+
+		area = node.parent[REVERSE]->to;
+		m_path.push_back({ area, node.parent[REVERSE]->how });
+		m_pathCosts.push_back(m_bestCost - GetNode(area).g[REVERSE]);
+	}
+
+	return true;
+}
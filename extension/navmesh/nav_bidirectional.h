@@ -0,0 +1,233 @@
+#ifndef NAV_BIDIRECTIONAL_H_
+#define NAV_BIDIRECTIONAL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "nav.h"
+#include "nav_area.h"
+#include "nav_cluster.h"
+#include "nav_connections.h"
+#include "nav_pathcache.h"
+
+// undef valve mathlib stuff so we can use std version
+#undef max
+#undef min
+#undef clamp
+
+class CNavLandmarks;
+
+/**
+ * @brief Bidirectional A* search between two areas on the connection graph.
+ *
+ * One search expands from the start area along the outgoing connections, the other from the goal area along the incoming connections,
+ * so one-way drops, ladders, elevators and off-mesh links are followed in the right direction by both. Both searches use the average
+ * of the two heuristics as their potential and the search stops once the best path found can't be improved. On long routes the
+ * two searches meet in the middle and expand fewer areas than a single search from the start area.
+ *
+ * Connection costs must not depend on the path taken to reach an area. The search memory is kept between calls, one search per thread.
+ */
+class CNavBidirectionalSearch
+{
+public:
+	CNavBidirectionalSearch();
+
+	CNavBidirectionalSearch(const CNavBidirectionalSearch&) = delete;
+	CNavBidirectionalSearch& operator=(const CNavBidirectionalSearch&) = delete;
+
+	// true if the nav mesh has the data needed by bidirectional searches (not available while editing)
+	static bool IsAvailable();
+	// true if the areas are far enough apart for a bidirectional search to pay off, see sm_nav_bidirectional_search_distance
+	static bool ShouldUse(const CNavArea* startArea, const CNavArea* goalArea);
+	// Search of the calling thread
+	static CNavBidirectionalSearch& GetThreadSearch();
+
+	/**
+	 * @brief Finds the shortest path between two areas.
+	 * @tparam EdgeCost float (const NavAreaConnection& connection), returns CNavConnectionGraph::INFINITE_COST if the connection can't be used.
+	 * @param startArea Area the path starts at.
+	 * @param goalArea Goal area.
+	 * @param edgeCost Connection cost functor.
+	 * @param corridor If not NULL, only the areas inside the corridor clusters are searched.
+	 * @return true if a path was found.
+	 */
+	template <typename EdgeCost>
+	bool FindPath(CNavArea* startArea, CNavArea* goalArea, const EdgeCost& edgeCost, const NavClusterCorridor* corridor = nullptr);
+
+	// Path found by the last search, start area first
+	const std::vector<NavPathArea>& GetPath() const { return m_path; }
+	// Travel cost from the start area to each area of the path, same order as GetPath
+	const std::vector<float>& GetPathCosts() const { return m_pathCosts; }
+	// Number of areas expanded by the last search, both directions
+	unsigned int GetLastExpansionCount() const { return m_expansions; }
+
+private:
+	static constexpr float INFINITE_COST = CNavConnectionGraph::INFINITE_COST;
+
+	enum SearchDirection
+	{
+		FORWARD = 0,	// from the start area
+		REVERSE,		// from the goal area
+		NUM_DIRECTIONS
+	};
+
+	struct Node
+	{
+		float g[NUM_DIRECTIONS];							// cost from the start area, cost to the goal area
+		const NavAreaConnection* parent[NUM_DIRECTIONS];	// connection into the area (forward), connection out of the area (reverse)
+		unsigned int marker;								// node belongs to the current search if equal to m_marker
+	};
+
+	struct OpenEntry
+	{
+		float key;
+		float g;											// entries with a g different from the node's are stale
+		CNavArea* area;
+	};
+
+	// min heap ordering of the open lists
+	static bool OpenEntryGreater(const OpenEntry& lhs, const OpenEntry& rhs) { return lhs.key > rhs.key; }
+
+	std::vector<Node> m_nodes;								// indexed by area search index
+	std::vector<OpenEntry> m_openList[NUM_DIRECTIONS];		// min heaps
+	std::vector<NavPathArea> m_path;
+	std::vector<float> m_pathCosts;
+	const CNavConnectionGraph* m_graph;
+	const CNavLandmarks* m_landmarks;
+	CNavArea* m_startArea;
+	CNavArea* m_goalArea;
+	CNavArea* m_meetingArea;								// area where the best path found so far crosses both searches
+	float m_bestCost;										// cost of the best path found so far
+	unsigned int m_marker;
+	unsigned int m_expansions;
+
+	// true if the area existed when the connection graph was built
+	bool IsSearchable(const CNavArea* area) const;
+	void Reset(CNavArea* startArea, CNavArea* goalArea);
+
+	Node& GetNode(const CNavArea* area)
+	{
+		Node& node = m_nodes[area->GetSearchIndex()];
+
+		if (node.marker != m_marker)
+		{
+			node.g[FORWARD] = INFINITE_COST;
+			node.g[REVERSE] = INFINITE_COST;
+			node.parent[FORWARD] = nullptr;
+			node.parent[REVERSE] = nullptr;
+			node.marker = m_marker;
+		}
+
+		return node;
+	}
+
+	// Potential of the area for the given direction, the forward and reverse potentials add up to zero
+	float GetPotential(int direction, const CNavArea* area) const;
+	void PushOpen(int direction, CNavArea* area, float g);
+	// Removes stale entries from the top of the open list, returns false if empty
+	bool PruneOpenList(int direction);
+	// Builds the path through the meeting area, returns false if the parents don't form a path
+	bool BuildPath();
+
+	template <typename EdgeCost>
+	void Relax(int direction, const NavAreaConnection& connection, CNavArea* other, float g, const EdgeCost& edgeCost, const NavClusterCorridor* corridor);
+};
+
+template <typename EdgeCost>
+inline void CNavBidirectionalSearch::Relax(int direction, const NavAreaConnection& connection, CNavArea* other, float g, const EdgeCost& edgeCost, const NavClusterCorridor* corridor)
+{
+	if (corridor != nullptr && !corridor->Contains(other))
+	{
+		return;
+	}
+
+	const float cost = edgeCost(connection);
+
+	if (cost == INFINITE_COST)
+	{
+		return;
+	}
+
+	Node& next = GetNode(other);
+	const float newCost = g + cost;
+
+	if (newCost >= next.g[direction])
+	{
+		return;
+	}
+
+	next.g[direction] = newCost;
+	next.parent[direction] = &connection;
+	PushOpen(direction, other, newCost);
+
+	const float otherCost = next.g[direction == FORWARD ? REVERSE : FORWARD];
+
+	if (otherCost != INFINITE_COST && newCost + otherCost < m_bestCost)
+	{
+		m_bestCost = newCost + otherCost;
+		m_meetingArea = other;
+	}
+}
+
+template <typename EdgeCost>
+inline bool CNavBidirectionalSearch::FindPath(CNavArea* startArea, CNavArea* goalArea, const EdgeCost& edgeCost, const NavClusterCorridor* corridor)
+{
+	m_path.clear();
+	m_pathCosts.clear();
+	m_expansions = 0U;
+
+	if (!IsAvailable() || !IsSearchable(startArea) || !IsSearchable(goalArea))
+	{
+		return false;
+	}
+
+	if (startArea == goalArea)
+	{
+		m_path.push_back({ startArea, NUM_TRAVERSE_TYPES });
+		m_pathCosts.push_back(0.0f);
+		return true;
+	}
+
+	Reset(startArea, goalArea);
+
+	// enough to expand every area a few times from both sides, more than that means the cost functor isn't stable
+	const unsigned int maxExpansions = static_cast<unsigned int>(m_nodes.size()) * 4U + 64U;
+
+	while (PruneOpenList(FORWARD) && PruneOpenList(REVERSE))
+	{
+		// with the average potentials, no path through the unexpanded areas can be cheaper than this
+		if (m_openList[FORWARD].front().key + m_openList[REVERSE].front().key >= m_bestCost)
+		{
+			break;
+		}
+
+		if (++m_expansions > maxExpansions)
+		{
+			return false;
+		}
+
+		// expand the side with less open areas, this keeps both searches about the same size
+		const int direction = m_openList[FORWARD].size() <= m_openList[REVERSE].size() ? FORWARD : REVERSE;
+		std::vector<OpenEntry>& openList = m_openList[direction];
+		const OpenEntry top = openList.front();
+		std::pop_heap(openList.begin(), openList.end(), OpenEntryGreater);
+		openList.pop_back();
+
+		if (direction == FORWARD)
+		{
+			m_graph->ForEachOutgoingConnection(top.area, [this, &top, &edgeCost, corridor](const NavAreaConnection& connection) {
+				Relax(FORWARD, connection, connection.to, top.g, edgeCost, corridor);
+			});
+		}
+		else
+		{
+			m_graph->ForEachIncomingConnection(top.area, [this, &top, &edgeCost, corridor](const NavAreaConnection& connection) {
+				Relax(REVERSE, connection, connection.from, top.g, edgeCost, corridor);
+			});
+		}
+	}
+
+	return m_meetingArea != nullptr && BuildPath();
+}
+
+#endif // !NAV_BIDIRECTIONAL_H_
@@ -0,0 +1,406 @@
+#include <algorithm>
+#include <functional>
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_ladder.h"
+#include "nav_elevator.h"
+#include "nav_cluster.h"
+#include "nav_utils.h"
+
+#undef min
+#undef max
+#undef clamp
+
+extern NavAreaVector TheNavAreas;
+
+static constexpr unsigned int INVALID_PORTAL = std::numeric_limits<unsigned int>::max();
+
+static float GetConnectionCost(const CNavArea* from, const CNavArea* to, float length)
+{
+	if (length > 0.0f)
+	{
+		return length;
+	}
+
+	return (to->GetCenter() - from->GetCenter()).Length();
+}
+
+// Runs a function on each outgoing connection of an area, the function receives the connection cost
+template <typename F>
+static void ForEachOutgoingConnection(const CNavArea* area, F functor)
+{
+	navutils::ForEachOutgoingConnection(area, [area, &functor](CNavArea* connectedArea, float length) {
+		functor(connectedArea, GetConnectionCost(area, connectedArea, length));
+	});
+}
+
+void NavClusterCorridor::Begin(const CNavClusterGraph* graph, std::size_t numClusters, std::size_t numPortals, std::size_t numAreas)
+{
+	m_graph = graph;
+
+	if (m_clusterMarks.size() < numClusters)
+	{
+		m_clusterMarks.resize(numClusters, 0U);
+	}
+
+	if (m_visitMarks.size() < numPortals)
+	{
+		m_visitMarks.resize(numPortals, 0U);
+		m_costSoFar.resize(numPortals, 0.0f);
+		m_parent.resize(numPortals, INVALID_PORTAL);
+	}
+
+	if (m_areaMarks.size() < numAreas)
+	{
+		m_areaMarks.resize(numAreas, 0U);
+		m_areaCosts.resize(numAreas, 0.0f);
+	}
+
+	++m_marker;
+
+	if (m_marker == 0)
+	{
+		// wrapped around, stale marks could match again
+		std::fill(m_clusterMarks.begin(), m_clusterMarks.end(), 0U);
+		std::fill(m_visitMarks.begin(), m_visitMarks.end(), 0U);
+		m_marker = 1;
+	}
+
+	m_clusters.clear();
+	m_openList.clear();
+}
+
+void NavClusterCorridor::AddCluster(unsigned int cluster)
+{
+	if (m_clusterMarks[cluster] != m_marker)
+	{
+		m_clusterMarks[cluster] = m_marker;
+		m_clusters.push_back(cluster);
+	}
+}
+
+bool NavClusterCorridor::Contains(const CNavArea* area) const
+{
+	const unsigned int cluster = m_graph->GetAreaCluster(area);
+	return cluster != CNavClusterGraph::INVALID_CLUSTER && m_clusterMarks[cluster] == m_marker;
+}
+
+CNavClusterGraph::CNavClusterGraph()
+{
+	m_built = false;
+}
+
+void CNavClusterGraph::Clear()
+{
+	m_areaCluster.clear();
+	m_areaPortal.clear();
+	m_clusterAreas.clear();
+	m_clusterAreaStart.clear();
+	m_clusterPortals.clear();
+	m_clusterPortalStart.clear();
+	m_portals.clear();
+	m_edges.clear();
+	m_built = false;
+}
+
+void CNavClusterGraph::Build()
+{
+	Clear();
+
+	if (TheNavAreas.Count() == 0)
+	{
+		return;
+	}
+
+	BuildClusters();
+	BuildPortals();
+	m_built = true;
+}
+
+unsigned int CNavClusterGraph::GetAreaCluster(const CNavArea* area) const
+{
+	const unsigned int index = area->GetSearchIndex();
+	return index < m_areaCluster.size() ? m_areaCluster[index] : INVALID_CLUSTER;
+}
+
+void CNavClusterGraph::BuildClusters()
+{
+	m_areaCluster.assign(CNavArea::GetSearchIndexCount(), INVALID_CLUSTER);
+	m_clusterAreas.reserve(TheNavAreas.Count());
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		CNavArea* seed = TheNavAreas[it];
+
+		if (m_areaCluster[seed->GetSearchIndex()] != INVALID_CLUSTER)
+		{
+			continue;
+		}
+
+		// grow a new cluster from this area over ground connections, in both directions so one way drops don't split rooms
+		const unsigned int cluster = static_cast<unsigned int>(m_clusterAreaStart.size());
+		const std::size_t first = m_clusterAreas.size();
+		m_clusterAreaStart.push_back(static_cast<unsigned int>(first));
+		m_clusterAreas.push_back(seed);
+		m_areaCluster[seed->GetSearchIndex()] = cluster;
+
+		auto tryAdd = [this, seed, cluster, first](CNavArea* area) {
+			if (m_clusterAreas.size() - first >= MAX_CLUSTER_AREAS || area->GetPlace() != seed->GetPlace() ||
+				m_areaCluster[area->GetSearchIndex()] != INVALID_CLUSTER)
+			{
+				return;
+			}
+
+			m_areaCluster[area->GetSearchIndex()] = cluster;
+			m_clusterAreas.push_back(area);
+		};
+
+		for (std::size_t next = first; next < m_clusterAreas.size() && m_clusterAreas.size() - first < MAX_CLUSTER_AREAS; next++)
+		{
+			CNavArea* area = m_clusterAreas[next];
+
+			for (int dir = 0; dir < static_cast<int>(NUM_DIRECTIONS); dir++)
+			{
+				const NavConnectVector* outgoing = area->GetAdjacentAreas(static_cast<NavDirType>(dir));
+
+				for (int i = 0; i < outgoing->Count(); i++)
+				{
+					tryAdd(outgoing->Element(i).area);
+				}
+
+				const NavConnectVector* incoming = area->GetIncomingConnections(static_cast<NavDirType>(dir));
+
+				for (int i = 0; i < incoming->Count(); i++)
+				{
+					tryAdd(incoming->Element(i).area);
+				}
+			}
+		}
+	}
+
+	m_clusterAreaStart.push_back(static_cast<unsigned int>(m_clusterAreas.size()));
+}
+
+void CNavClusterGraph::BuildPortals()
+{
+	// an area is a portal if it has a connection to or from another cluster
+	std::vector<bool> isPortal(m_areaCluster.size(), false);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		CNavArea* area = TheNavAreas[it];
+		const unsigned int cluster = m_areaCluster[area->GetSearchIndex()];
+
+		ForEachOutgoingConnection(area, [this, &isPortal, area, cluster](CNavArea* connectedArea, float cost) {
+			if (GetAreaCluster(connectedArea) != cluster)
+			{
+				isPortal[area->GetSearchIndex()] = true;
+				isPortal[connectedArea->GetSearchIndex()] = true;
+			}
+		});
+	}
+
+	// portals are stored grouped by cluster
+	m_areaPortal.assign(m_areaCluster.size(), INVALID_PORTAL);
+	const std::size_t numClusters = GetClusterCount();
+
+	for (std::size_t cluster = 0; cluster < numClusters; cluster++)
+	{
+		m_clusterPortalStart.push_back(static_cast<unsigned int>(m_clusterPortals.size()));
+
+		for (unsigned int i = m_clusterAreaStart[cluster]; i < m_clusterAreaStart[cluster + 1]; i++)
+		{
+			CNavArea* area = m_clusterAreas[i];
+
+			if (isPortal[area->GetSearchIndex()])
+			{
+				const unsigned int portal = static_cast<unsigned int>(m_portals.size());
+				m_areaPortal[area->GetSearchIndex()] = portal;
+				m_portals.push_back({ area, static_cast<unsigned int>(cluster), 0U });
+				m_clusterPortals.push_back(portal);
+			}
+		}
+	}
+
+	m_clusterPortalStart.push_back(static_cast<unsigned int>(m_clusterPortals.size()));
+
+	// edges: cached travel distance to the other portals of the same cluster, then the connections leaving the cluster
+	NavClusterCorridor scratch;
+	scratch.Begin(this, numClusters, m_portals.size(), m_areaCluster.size());
+
+	for (unsigned int portal = 0; portal < m_portals.size(); portal++)
+	{
+		Portal& from = m_portals[portal];
+		from.firstEdge = static_cast<unsigned int>(m_edges.size());
+
+		SearchCluster(scratch, from.area);
+
+		for (unsigned int i = m_clusterPortalStart[from.cluster]; i < m_clusterPortalStart[from.cluster + 1]; i++)
+		{
+			const unsigned int other = m_clusterPortals[i];
+			const unsigned int index = m_portals[other].area->GetSearchIndex();
+
+			if (other != portal && scratch.m_areaMarks[index] == scratch.m_areaMarker)
+			{
+				m_edges.push_back({ other, scratch.m_areaCosts[index] });
+			}
+		}
+
+		ForEachOutgoingConnection(from.area, [this, &from](CNavArea* connectedArea, float cost) {
+			if (GetAreaCluster(connectedArea) != from.cluster)
+			{
+				m_edges.push_back({ m_areaPortal[connectedArea->GetSearchIndex()], cost });
+			}
+		});
+	}
+}
+
+void CNavClusterGraph::SearchCluster(NavClusterCorridor& scratch, CNavArea* area) const
+{
+	const unsigned int cluster = GetAreaCluster(area);
+
+	++scratch.m_areaMarker;
+
+	if (scratch.m_areaMarker == 0)
+	{
+		std::fill(scratch.m_areaMarks.begin(), scratch.m_areaMarks.end(), 0U);
+		scratch.m_areaMarker = 1;
+	}
+
+	auto& openList = scratch.m_areaOpenList;
+	using OpenEntry = std::pair<float, CNavArea*>;
+	openList.clear();
+	openList.emplace_back(0.0f, area);
+	scratch.m_areaMarks[area->GetSearchIndex()] = scratch.m_areaMarker;
+	scratch.m_areaCosts[area->GetSearchIndex()] = 0.0f;
+
+	while (!openList.empty())
+	{
+		std::pop_heap(openList.begin(), openList.end(), std::greater<OpenEntry>());
+		const OpenEntry entry = openList.back();
+		openList.pop_back();
+
+		if (entry.first > scratch.m_areaCosts[entry.second->GetSearchIndex()])
+		{
+			continue; // stale entry
+		}
+
+		ForEachOutgoingConnection(entry.second, [this, &scratch, &openList, &entry, cluster](CNavArea* connectedArea, float cost) {
+			if (GetAreaCluster(connectedArea) != cluster)
+			{
+				return;
+			}
+
+			const unsigned int index = connectedArea->GetSearchIndex();
+			const float newCost = entry.first + cost;
+
+			if (scratch.m_areaMarks[index] == scratch.m_areaMarker && scratch.m_areaCosts[index] <= newCost)
+			{
+				return;
+			}
+
+			scratch.m_areaMarks[index] = scratch.m_areaMarker;
+			scratch.m_areaCosts[index] = newCost;
+			openList.emplace_back(newCost, connectedArea);
+			std::push_heap(openList.begin(), openList.end(), std::greater<OpenEntry>());
+		});
+	}
+}
+
+const NavClusterCorridor* CNavClusterGraph::FindCorridor(NavClusterCorridor& corridor, CNavArea* startArea, CNavArea* goalArea, int teamID, bool ignoreNavBlockers) const
+{
+	if (!m_built || startArea == nullptr || goalArea == nullptr)
+	{
+		return nullptr;
+	}
+
+	const unsigned int startCluster = GetAreaCluster(startArea);
+	const unsigned int goalCluster = GetAreaCluster(goalArea);
+
+	if (startCluster == INVALID_CLUSTER || goalCluster == INVALID_CLUSTER || startCluster == goalCluster)
+	{
+		return nullptr;
+	}
+
+	const Vector& goalPos = goalArea->GetCenter();
+
+	if ((startArea->GetCenter() - goalPos).IsLengthLessThan(MIN_CORRIDOR_DISTANCE))
+	{
+		return nullptr;
+	}
+
+	corridor.Begin(this, GetClusterCount(), m_portals.size(), m_areaCluster.size());
+
+	auto& openList = corridor.m_openList;
+	auto addToOpenList = [this, &corridor, &openList, &goalPos](unsigned int portal, unsigned int parent, float costSoFar) {
+		corridor.m_visitMarks[portal] = corridor.m_marker;
+		corridor.m_costSoFar[portal] = costSoFar;
+		corridor.m_parent[portal] = parent;
+		openList.push_back({ costSoFar + (m_portals[portal].area->GetCenter() - goalPos).Length(), portal });
+		std::push_heap(openList.begin(), openList.end());
+	};
+
+	// the search starts from the portals of the start cluster the start area can reach
+	SearchCluster(corridor, startArea);
+
+	for (unsigned int i = m_clusterPortalStart[startCluster]; i < m_clusterPortalStart[startCluster + 1]; i++)
+	{
+		const unsigned int portal = m_clusterPortals[i];
+		const unsigned int index = m_portals[portal].area->GetSearchIndex();
+
+		if (corridor.m_areaMarks[index] == corridor.m_areaMarker && !m_portals[portal].area->IsBlocked(teamID, ignoreNavBlockers))
+		{
+			addToOpenList(portal, INVALID_PORTAL, corridor.m_areaCosts[index]);
+		}
+	}
+
+	while (!openList.empty())
+	{
+		std::pop_heap(openList.begin(), openList.end());
+		const NavClusterCorridor::OpenNode node = openList.back();
+		openList.pop_back();
+
+		const Portal& portal = m_portals[node.portal];
+		const float costSoFar = corridor.m_costSoFar[node.portal];
+
+		if (node.totalCost > costSoFar + (portal.area->GetCenter() - goalPos).Length())
+		{
+			continue; // stale entry, a cheaper route to this portal was found after it was added
+		}
+
+		if (portal.cluster == goalCluster)
+		{
+			corridor.AddCluster(startCluster);
+			corridor.AddCluster(goalCluster);
+
+			for (unsigned int current = node.portal; current != INVALID_PORTAL; current = corridor.m_parent[current])
+			{
+				corridor.AddCluster(m_portals[current].cluster);
+			}
+
+			return &corridor;
+		}
+
+		for (unsigned int i = portal.firstEdge; i < GetPortalEdgeEnd(node.portal); i++)
+		{
+			const Edge& edge = m_edges[i];
+			const float newCostSoFar = costSoFar + edge.cost;
+
+			if (corridor.m_visitMarks[edge.portal] == corridor.m_marker && corridor.m_costSoFar[edge.portal] <= newCostSoFar)
+			{
+				continue;
+			}
+
+			if (m_portals[edge.portal].area->IsBlocked(teamID, ignoreNavBlockers))
+			{
+				continue;
+			}
+
+			addToOpenList(edge.portal, node.portal, newCostSoFar);
+		}
+	}
+
+	// the goal cluster can't be reached on the cluster graph, let the area search handle it
+	return nullptr;
+}
@@ -0,0 +1,139 @@
+#ifndef NAV_CLUSTER_H_
+#define NAV_CLUSTER_H_
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "nav.h"
+
+class CNavArea;
+class CNavClusterGraph;
+
+/**
+ * @brief Set of clusters a path search is allowed to expand into.
+ *
+ * Also holds the scratch memory used by the cluster graph search, each search context owns one.
+ */
+class NavClusterCorridor
+{
+public:
+	NavClusterCorridor()
+	{
+		m_graph = nullptr;
+		m_marker = 0;
+		m_areaMarker = 0;
+	}
+
+	NavClusterCorridor(const NavClusterCorridor&) = delete;
+	NavClusterCorridor& operator=(const NavClusterCorridor&) = delete;
+
+	// true if the given area is inside one of the corridor clusters
+	bool Contains(const CNavArea* area) const;
+	std::size_t GetClusterCount() const { return m_clusters.size(); }
+
+private:
+	friend class CNavClusterGraph;
+
+	struct OpenNode
+	{
+		float totalCost;
+		unsigned int portal;
+
+		bool operator<(const OpenNode& other) const { return totalCost > other.totalCost; } // min heap
+	};
+
+	const CNavClusterGraph* m_graph;
+	std::vector<unsigned int> m_clusterMarks;					// equals m_marker if the cluster is part of the corridor
+	std::vector<unsigned int> m_clusters;						// clusters of the corridor
+	unsigned int m_marker;
+
+	// cluster graph search
+	std::vector<float> m_costSoFar;
+	std::vector<unsigned int> m_parent;
+	std::vector<unsigned int> m_visitMarks;
+	std::vector<OpenNode> m_openList;
+	std::vector<float> m_areaCosts;								// intra cluster searches, indexed by area search index
+	std::vector<unsigned int> m_areaMarks;
+	std::vector<std::pair<float, CNavArea*>> m_areaOpenList;
+	unsigned int m_areaMarker;
+
+	void Begin(const CNavClusterGraph* graph, std::size_t numClusters, std::size_t numPortals, std::size_t numAreas);
+	void AddCluster(unsigned int cluster);
+};
+
+/**
+ * @brief Cluster level graph over the nav areas, used to speed up long path searches.
+ *
+ * Areas are grouped into small clusters of ground connected areas sharing the same place. Areas with a connection to another cluster
+ * are portals. The graph nodes are the portals, edges are the connections between clusters (ground, ladders, elevators and off-mesh links)
+ * and the cached travel distances between the portals of each cluster.
+ *
+ * Long searches first find the sequence of clusters on this graph, the area search is then limited to those clusters.
+ * The graph is built after the mesh is loaded and is read only while searches are running.
+ */
+class CNavClusterGraph
+{
+public:
+	static constexpr unsigned int INVALID_CLUSTER = std::numeric_limits<unsigned int>::max();
+	static constexpr std::size_t MAX_CLUSTER_AREAS = 64U;			// maximum number of areas per cluster
+	static constexpr float MIN_CORRIDOR_DISTANCE = 1500.0f;			// searches shorter than this don't use the cluster graph
+
+	CNavClusterGraph();
+
+	void Build();
+	void Clear();
+	bool IsBuilt() const { return m_built; }
+
+	std::size_t GetClusterCount() const { return m_clusterAreaStart.empty() ? 0U : m_clusterAreaStart.size() - 1U; }
+	std::size_t GetPortalCount() const { return m_portals.size(); }
+
+	unsigned int GetAreaCluster(const CNavArea* area) const;
+
+	/**
+	 * @brief Searches the cluster graph for the clusters between the start and goal areas.
+	 * @param corridor Corridor to store the result in.
+	 * @param startArea Search start area.
+	 * @param goalArea Search goal area.
+	 * @param teamID Portals blocked for this team are skipped.
+	 * @param ignoreNavBlockers Ignore func_nav_blocker when testing blocked portals.
+	 * @return The corridor if the search should be restricted to it or NULL to search the whole mesh.
+	 */
+	const NavClusterCorridor* FindCorridor(NavClusterCorridor& corridor, CNavArea* startArea, CNavArea* goalArea, int teamID, bool ignoreNavBlockers) const;
+
+private:
+	struct Portal
+	{
+		CNavArea* area;
+		unsigned int cluster;
+		unsigned int firstEdge;				// index into m_edges
+	};
+
+	struct Edge
+	{
+		unsigned int portal;
+		float cost;
+	};
+
+	std::vector<unsigned int> m_areaCluster;			// cluster of each area, indexed by search index
+	std::vector<unsigned int> m_areaPortal;				// portal of each area, indexed by search index
+	std::vector<CNavArea*> m_clusterAreas;				// areas of each cluster
+	std::vector<unsigned int> m_clusterAreaStart;		// index of the first area of each cluster in m_clusterAreas, with one extra entry at the end
+	std::vector<unsigned int> m_clusterPortals;			// portals of each cluster
+	std::vector<unsigned int> m_clusterPortalStart;		// index of the first portal of each cluster in m_clusterPortals, with one extra entry at the end
+	std::vector<Portal> m_portals;
+	std::vector<Edge> m_edges;							// outgoing edges of each portal, the last portal's edges end at m_edges.size()
+	bool m_built;
+
+	unsigned int GetPortalEdgeEnd(unsigned int portal) const
+	{
+		return portal + 1U < m_portals.size() ? m_portals[portal + 1U].firstEdge : static_cast<unsigned int>(m_edges.size());
+	}
+
+	void BuildClusters();
+	void BuildPortals();
+	// Computes the travel distance from 'area' to every area of the same cluster, results are stored in the corridor scratch memory
+	void SearchCluster(NavClusterCorridor& scratch, CNavArea* area) const;
+};
+
+#endif // !NAV_CLUSTER_H_
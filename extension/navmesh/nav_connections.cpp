@@ -0,0 +1,81 @@
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_utils.h"
+#include "nav_connections.h"
+
+CNavConnectionGraph::CNavConnectionGraph()
+{
+	m_buildCount = 0U;
+}
+
+void CNavConnectionGraph::Build()
+{
+	Clear();
+
+	const std::size_t numAreas = static_cast<std::size_t>(CNavArea::GetSearchIndexCount());
+
+	if (numAreas == 0U)
+	{
+		return;
+	}
+
+	std::vector<CNavArea*> areas(numAreas, nullptr);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		CNavArea* area = TheNavAreas[it];
+		areas[area->GetSearchIndex()] = area;
+	}
+
+	m_outgoing.assign(numAreas + 1U, 0U);
+	m_incoming.assign(numAreas + 1U, 0U);
+	m_connections.reserve(static_cast<std::size_t>(TheNavAreas.Count()) * 4U);
+
+	for (std::size_t index = 0U; index < numAreas; index++)
+	{
+		m_outgoing[index] = static_cast<unsigned int>(m_connections.size());
+
+		if (areas[index] == nullptr)
+		{
+			continue; // search index not in use
+		}
+
+		navutils::ForEachOutgoingAreaConnection(areas[index], [this](const NavAreaConnection& connection) {
+			if (connection.to != connection.from)
+			{
+				m_connections.push_back(connection);
+			}
+		});
+	}
+
+	m_outgoing[numAreas] = static_cast<unsigned int>(m_connections.size());
+
+	// counting sort of the connections by their destination
+	for (auto& connection : m_connections)
+	{
+		m_incoming[connection.to->GetSearchIndex() + 1U]++;
+	}
+
+	for (std::size_t index = 0U; index < numAreas; index++)
+	{
+		m_incoming[index + 1U] += m_incoming[index];
+	}
+
+	std::vector<unsigned int> next(m_incoming.begin(), m_incoming.end() - 1);
+	m_incomingConnections.resize(m_connections.size());
+
+	for (std::size_t i = 0U; i < m_connections.size(); i++)
+	{
+		m_incomingConnections[next[m_connections[i].to->GetSearchIndex()]++] = static_cast<unsigned int>(i);
+	}
+}
+
+void CNavConnectionGraph::Clear()
+{
+	m_connections.clear();
+	m_outgoing.clear();
+	m_incoming.clear();
+	m_incomingConnections.clear();
+	m_buildCount++;
+}
@@ -0,0 +1,132 @@
+#ifndef NAV_CONNECTIONS_H_
+#define NAV_CONNECTIONS_H_
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "nav.h"
+#include "nav_area.h"
+#include "nav_search_context.h"
+
+class CNavLadder;
+class CNavElevator;
+
+/**
+ * @brief A connection between two areas, with the parameters given to path cost functors.
+ */
+struct NavAreaConnection
+{
+	CNavArea* from;
+	CNavArea* to;
+	const CNavLadder* ladder;
+	const NavOffMeshConnection* link;
+	const CNavElevator* elevator;
+	float length;					// connection length as given to the cost functors, negative for ladders and elevators
+	NavTraverseType how;
+};
+
+/**
+ * @brief Flat copy of every area connection (ground, ladders, elevators and off-mesh links), indexed by both ends.
+ *
+ * Areas only store their outgoing connections, this graph also allows iterating the connections that lead into an area.
+ * It's built after the mesh is loaded and cleared while editing, it's read only while searches are running.
+ */
+class CNavConnectionGraph
+{
+public:
+	static constexpr float INFINITE_COST = std::numeric_limits<float>::infinity();
+	static constexpr float MIN_CONNECTION_COST = 0.00001f;	// every step costs something, see NavAreaBuildPath
+
+	CNavConnectionGraph();
+
+	CNavConnectionGraph(const CNavConnectionGraph&) = delete;
+	CNavConnectionGraph& operator=(const CNavConnectionGraph&) = delete;
+
+	void Build();
+	void Clear();
+	bool IsBuilt() const { return !m_outgoing.empty(); }
+	// Incremented each time the graph is built or cleared, connection pointers from an older build are no longer valid
+	unsigned int GetBuildCount() const { return m_buildCount; }
+	// Upper bound of the area search indexes known by the graph
+	std::size_t GetAreaCount() const { return m_outgoing.empty() ? 0U : m_outgoing.size() - 1U; }
+
+	/**
+	 * @brief Runs a function on each connection leaving an area.
+	 * @tparam F void (const NavAreaConnection& connection)
+	 */
+	template <typename F>
+	void ForEachOutgoingConnection(const CNavArea* area, F functor) const
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+		if (index >= GetAreaCount())
+		{
+			return;
+		}
+
+		for (unsigned int i = m_outgoing[index]; i < m_outgoing[index + 1U]; i++)
+		{
+			functor(m_connections[i]);
+		}
+	}
+
+	/**
+	 * @brief Runs a function on each connection leading into an area.
+	 * @tparam F void (const NavAreaConnection& connection)
+	 */
+	template <typename F>
+	void ForEachIncomingConnection(const CNavArea* area, F functor) const
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+		if (index >= GetAreaCount())
+		{
+			return;
+		}
+
+		for (unsigned int i = m_incoming[index]; i < m_incoming[index + 1U]; i++)
+		{
+			functor(m_connections[m_incomingConnections[i]]);
+		}
+	}
+
+	/**
+	 * @brief Evaluates a path cost functor on a single connection.
+	 * @param connection Connection to evaluate.
+	 * @param costFunc Path cost functor.
+	 * @param teamID Team used to check for blocked areas.
+	 * @return Cost of the connection alone, infinite if it can't be used.
+	 */
+	template <typename CostFunctor>
+	static float GetConnectionCost(const NavAreaConnection& connection, const CostFunctor& costFunc, int teamID)
+	{
+		if (connection.from->IsBlocked(teamID) || connection.to->IsBlocked(teamID))
+		{
+			return INFINITE_COST;
+		}
+
+		// cost functors return the cost so far of 'from' plus the connection cost, only the connection cost is wanted.
+		// the cost so far is set on a scratch context, a search may be using the caller's context.
+		static thread_local NavSearchContext scratch;
+		NavSearchContext::Scope scope(scratch);
+		scratch.SetCostSoFar(connection.from, 0.0f);
+		const float cost = costFunc(connection.to, connection.from, connection.ladder, connection.link, connection.elevator, connection.length);
+
+		if (std::isnan(cost) || cost < 0.0f)
+		{
+			return INFINITE_COST;
+		}
+
+		return cost < MIN_CONNECTION_COST ? MIN_CONNECTION_COST : cost;
+	}
+
+private:
+	std::vector<NavAreaConnection> m_connections;		// grouped by the 'from' area
+	std::vector<unsigned int> m_outgoing;				// first connection of each area, indexed by search index with one extra entry at the end
+	std::vector<unsigned int> m_incoming;				// first entry of each area on m_incomingConnections, same layout
+	std::vector<unsigned int> m_incomingConnections;	// indexes into m_connections grouped by the 'to' area
+	unsigned int m_buildCount;
+};
+
+#endif // !NAV_CONNECTIONS_H_
@@ -23,6 +23,11 @@
 #include "nav_pathfind.h"
 #include "nav_node.h"
 #include "nav_colors.h"
+#include "nav_search_context.h"
+#include "nav_pathcache.h"
+#include "nav_flowfield.h"
+#include "nav_pathslicer.h"
+#include "nav_layeredgrid.h"
 #include <util/helpers.h>
 #include <sdkports/debugoverlay_shared.h>
 #include <sdkports/sdk_traces.h>
@@ -560,9 +565,21 @@ private:
  */
 void CNavMesh::OnEditModeStart( void )
 {
+	// author info and skipped waypoints
+	LoadDeferredSections();
+
 	ClearSelectedSet();
 	m_isContinuouslySelecting = false;
 	m_isContinuouslyDeselecting = false;
+
+	// areas and connections may change while editing, the edit commands don't wait for the time sliced searches
+	m_pathSlicer->DiscardAll();
+	RebuildClusterGraph();
+	RebuildLandmarks();
+	RebuildConnectionGraph();
+	RebuildLayeredGrid();
+	m_pathCache->Invalidate();
+	m_flowFields->Invalidate();
 }
 
 
@@ -572,6 +589,12 @@ void CNavMesh::OnEditModeStart( void )
  */
 void CNavMesh::OnEditModeEnd( void )
 {
+	RebuildClusterGraph();
+	RebuildLandmarks();
+	RebuildConnectionGraph();
+	RebuildLayeredGrid();
+	m_pathCache->Invalidate();
+	m_flowFields->Invalidate();
 }
 
 
@@ -2098,7 +2121,7 @@ void CNavMesh::CommandNavEndShiftXY( void )
 //--------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_shift, "Shifts the selected areas by the specified amount", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	edict_t* player = UTIL_GetListenServerEnt();
@@ -2136,7 +2159,7 @@ CON_COMMAND_F(sm_nav_shift, "Shifts the selected areas by the specified amount",
 //--------------------------------------------------------------------------------------------------------
 void CommandNavCenterInWorld( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	edict_t* player = UTIL_GetListenServerEnt();
@@ -3830,7 +3853,7 @@ public:
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_radius, "Adds all areas in a radius to the selection set", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() || engine->IsDedicatedServer() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() || engine->IsDedicatedServer() )
 		return;
 
 	if ( args.ArgC() < 2 )
@@ -3964,12 +3987,11 @@ bool CNavMesh::ForAllAreasOverlappingExtent( Functor &func, const Extent &extent
 #endif
 		return true;
 	}
-	static unsigned int searchMarker = librandom::generate_random_int(0, 1024 * 1024);
-	if ( ++searchMarker == 0 )
-	{
-		++searchMarker;
-	}
+	NavSearchContext* searchContext = NavSearchContext::GetCurrent();
+	searchContext->MakeNewNearSearchMarker();
 
+	// areas that don't overlap can be skipped from their stored extent
+	const CNavLayeredGrid *layeredGrid = m_layeredGrid->IsAvailable() ? m_layeredGrid.get() : nullptr;
 	Extent areaExtent;
 
 	// get list in cell that contains position
@@ -3991,17 +4013,29 @@ bool CNavMesh::ForAllAreasOverlappingExtent( Functor &func, const Extent &extent
 
 			NavAreaVector *areaVector = &m_grid[ iGrid ];
 
+			unsigned int candidates = 0U;
+
 			// find closest area in this cell
 			FOR_EACH_VEC( (*areaVector), it )
 			{
+				if ( layeredGrid )
+				{
+					// the stored extents of a batch of areas are tested at once
+					if ( it % CNavLayeredGrid::BATCH_SIZE == 0 )
+						candidates = layeredGrid->GetOverlapMask( iGrid, it, extent );
+
+					if ( ( candidates & ( 1U << ( it % CNavLayeredGrid::BATCH_SIZE ) ) ) == 0 )
+						continue;
+				}
+
 				CNavArea *area = (*areaVector)[ it ];
 
 				// skip if we've already visited this area
-				if ( area->m_nearNavSearchMarker == searchMarker )
+				if ( searchContext->IsNearSearchMarked( area ) )
 					continue;
 
 				// mark as visited
-				area->m_nearNavSearchMarker = searchMarker;
+				searchContext->NearSearchMark( area );
 				area->GetExtent( &areaExtent );
 
 				if ( extent.IsOverlapping( areaExtent )
@@ -4027,12 +4061,11 @@ void CNavMesh::CollectAreasOverlappingExtent( const Extent &extent, CUtlVector<
 		return;
 	}
 
-	static unsigned int searchMarker = librandom::generate_random_int(0, 1024 * 1024);
-	if ( ++searchMarker == 0 )
-	{
-		++searchMarker;
-	}
+	NavSearchContext* searchContext = NavSearchContext::GetCurrent();
+	searchContext->MakeNewNearSearchMarker();
 
+	// areas that don't overlap can be skipped from their stored extent
+	const CNavLayeredGrid *layeredGrid = m_layeredGrid->IsAvailable() ? m_layeredGrid.get() : nullptr;
 	Extent areaExtent;
 
 	// get list in cell that contains position
@@ -4054,17 +4087,29 @@ void CNavMesh::CollectAreasOverlappingExtent( const Extent &extent, CUtlVector<
 
 			NavAreaVector *areaVector = &m_grid[ iGrid ];
 
+			unsigned int candidates = 0U;
+
 			// find closest area in this cell
 			for( int v=0; v<areaVector->Count(); ++v )
 			{
+				if ( layeredGrid )
+				{
+					// the stored extents of a batch of areas are tested at once
+					if ( v % CNavLayeredGrid::BATCH_SIZE == 0 )
+						candidates = layeredGrid->GetOverlapMask( iGrid, v, extent );
+
+					if ( ( candidates & ( 1U << ( v % CNavLayeredGrid::BATCH_SIZE ) ) ) == 0 )
+						continue;
+				}
+
 				CNavArea *area = areaVector->Element( v );
 
 				// skip if we've already visited this area
-				if ( area->m_nearNavSearchMarker == searchMarker )
+				if ( searchContext->IsNearSearchMarked( area ) )
 					continue;
 
 				// mark as visited
-				area->m_nearNavSearchMarker = searchMarker;
+				searchContext->NearSearchMark( area );
 				area->GetExtent( &areaExtent );
 
 				if ( extent.IsOverlapping( areaExtent ) )
@@ -4083,14 +4128,8 @@ template < typename Functor >
 bool CNavMesh::ForAllAreasInRadius( Functor &func, const Vector &pos, float radius )
 {
 	// use a unique marker for this method, so it can be used within a SearchSurroundingArea() call
-	static unsigned int searchMarker = librandom::generate_random_int(0, 1024 * 1024);
-
-	++searchMarker;
-
-	if ( searchMarker == 0 )
-	{
-		++searchMarker;
-	}
+	NavSearchContext* searchContext = NavSearchContext::GetCurrent();
+	searchContext->MakeNewNearSearchMarker();
 
 
 	// get list in cell that contains position
@@ -4103,6 +4142,9 @@ bool CNavMesh::ForAllAreasInRadius( Functor &func, const Vector &pos, float radi
 		shiftLimit = MAX( m_gridSizeX, m_gridSizeY );	// range 0 means all areas
 	}
 
+	// areas out of range can be skipped from their stored center
+	const CNavLayeredGrid *layeredGrid = m_layeredGrid->IsAvailable() ? m_layeredGrid.get() : nullptr;
+
 	for( int x = originX - shiftLimit; x <= originX + shiftLimit; ++x )
 	{
 		if ( x < 0 || x >= m_gridSizeX )
@@ -4118,14 +4160,17 @@ bool CNavMesh::ForAllAreasInRadius( Functor &func, const Vector &pos, float radi
 			// find closest area in this cell
 			FOR_EACH_VEC( (*areaVector), it )
 			{
+				if ( layeredGrid && radiusSq != 0 && ( layeredGrid->GetEntry( x + y*m_gridSizeX, it ).center - pos ).LengthSqr() > radiusSq )
+					continue;
+
 				CNavArea *area = (*areaVector)[ it ];
 
 				// skip if we've already visited this area
-				if ( area->m_nearNavSearchMarker == searchMarker )
+				if ( searchContext->IsNearSearchMarked( area ) )
 					continue;
 
 				// mark as visited
-				area->m_nearNavSearchMarker = searchMarker;
+				searchContext->NearSearchMark( area );
 
 				if ( (( area->GetCenter() - pos ).LengthSqr() <= radiusSq || radiusSq == 0 )
 						&& !func( area ) ) {
@@ -5,6 +5,8 @@
 #include "nav_mesh.h"
 #include "nav_area.h"
 #include "nav_elevator.h"
+#include "nav_pathcache.h"
+#include "nav_flowfield.h"
 
 CNavElevator::CNavElevator()
 {
@@ -141,7 +143,7 @@ void CNavElevator::ScreenText() const
 		m_elevator.classname.c_str(), m_elevator.handle.GetEntryIndex());
 }
 
-void CNavElevator::Save(std::fstream& filestream, uint32_t version)
+void CNavElevator::Save(std::ostream& filestream, uint32_t version)
 {
 	filestream.write(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
 	filestream.write(reinterpret_cast<char*>(&m_team), sizeof(int));
@@ -179,24 +181,24 @@ void CNavElevator::Save(std::fstream& filestream, uint32_t version)
 	}
 }
 
-NavErrorType CNavElevator::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+NavErrorType CNavElevator::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	filestream.read(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
-	filestream.read(reinterpret_cast<char*>(&m_team), sizeof(int));
-	filestream.read(reinterpret_cast<char*>(&m_type), sizeof(ElevatorType));
-	filestream.read(reinterpret_cast<char*>(&m_minFloorDistance), sizeof(float));
-	m_elevator.Load(filestream, version, subVersion);
+	reader.Read(m_id);
+	reader.Read(m_team);
+	reader.Read(m_type);
+	reader.Read(m_minFloorDistance);
+	m_elevator.Load(reader, version, subVersion);
 
 	std::uint64_t floorcount = 0;
-	filestream.read(reinterpret_cast<char*>(&floorcount), sizeof(std::uint64_t));
+	reader.Read(floorcount);
 
 	for (std::uint64_t i = 0; i < floorcount; i++)
 	{
 		auto& floor = m_floors.emplace_back();
-		floor.Load(filestream, version, subVersion);
+		floor.Load(reader, version, subVersion);
 	}
 
-	if (filestream.good())
+	if (reader.IsGood())
 	{
 		return NAV_OK;
 	}
@@ -483,6 +485,8 @@ void CNavElevator::SetFloorShootableButton(CNavArea* area)
 
 void CNavElevator::DetectCurrentFloor()
 {
+	bool changed = false;
+
 	// for doors and move linear entities, use toggle state
 	if (m_type == ElevatorType::DOOR || m_type == ElevatorType::MOVELINEAR)
 	{
@@ -490,14 +494,9 @@ void CNavElevator::DetectCurrentFloor()
 
 		for (auto& floor : m_floors)
 		{
-			if (floor.toggle_state == ts)
-			{
-				floor.is_here = true;
-			}
-			else
-			{
-				floor.is_here = false;
-			}
+			bool here = floor.toggle_state == ts;
+			changed = changed || floor.is_here != here;
+			floor.is_here = here;
 		}
 	}
 	else
@@ -506,18 +505,26 @@ void CNavElevator::DetectCurrentFloor()
 
 		for (auto& floor : m_floors)
 		{
-			floor.is_here = false;
 			float dist = (floor.floor_position - pos).Length();
+			bool here = dist < m_minFloorDistance; // don't break the loop, set the other floors to false
+			changed = changed || floor.is_here != here;
+			floor.is_here = here;
+		}
+	}
 
-			if (dist < m_minFloorDistance)
-			{
-				floor.is_here = true; // don't break the loop, set the other floors to false
-			}
+	// path costs depend on the elevator being at the floor
+	if (changed)
+	{
+		TheNavMesh->GetPathCache()->Invalidate();
+
+		for (auto& floor : m_floors)
+		{
+			TheNavMesh->GetFlowFields()->MarkAreaDirty(floor.GetArea());
 		}
 	}
 }
 
-void CNavElevator::ElevatorEntity::Save(std::fstream& filestream, uint32_t version)
+void CNavElevator::ElevatorEntity::Save(std::ostream& filestream, uint32_t version)
 {
 	bool hasclassname = !this->classname.empty();
 	filestream.write(reinterpret_cast<char*>(&hasclassname), sizeof(bool));
@@ -542,34 +549,28 @@ void CNavElevator::ElevatorEntity::Save(std::fstream& filestream, uint32_t versi
 	}
 }
 
-void CNavElevator::ElevatorEntity::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+void CNavElevator::ElevatorEntity::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
 	bool hasclassname = false;
-	filestream.read(reinterpret_cast<char*>(&hasclassname), sizeof(bool));
+	reader.Read(hasclassname);
 
 	if (hasclassname)
 	{
 		std::uint64_t size = 0;
-		filestream.read(reinterpret_cast<char*>(&size), sizeof(std::uint64_t));
-		std::unique_ptr<char[]> clname = std::make_unique<char[]>(size + 1);
-		filestream.read(clname.get(), size);
-		this->classname.assign(clname.get());
+		reader.Read(size);
+		reader.ReadString(size, this->classname);
 
 		bool hastargetname = false;
-		filestream.read(reinterpret_cast<char*>(&hastargetname), sizeof(bool));
+		reader.Read(hastargetname);
 
 		if (hastargetname)
 		{
 			size = 0;
-			filestream.read(reinterpret_cast<char*>(&size), sizeof(std::uint64_t));
-
-			std::unique_ptr<char[]> tgtname = std::make_unique<char[]>(size + 1);
-
-			filestream.read(tgtname.get(), size);
-			this->targetname.assign(tgtname.get());
+			reader.Read(size);
+			reader.ReadString(size, this->targetname);
 		}
 
-		filestream.read(reinterpret_cast<char*>(&this->position), sizeof(Vector));
+		reader.Read(this->position);
 	}
 }
 
@@ -662,7 +663,7 @@ void CNavElevator::ElevatorFloor::ConvertAreaIDToPointer()
 	this->floor_area = area;
 }
 
-void CNavElevator::ElevatorFloor::Save(std::fstream& filestream, uint32_t version)
+void CNavElevator::ElevatorFloor::Save(std::ostream& filestream, uint32_t version)
 {
 	this->use_button.Save(filestream, version);
 	this->call_button.Save(filestream, version);
@@ -675,18 +676,18 @@ void CNavElevator::ElevatorFloor::Save(std::fstream& filestream, uint32_t versio
 	filestream.write(reinterpret_cast<char*>(&this->toggle_state), sizeof(int));
 }
 
-void CNavElevator::ElevatorFloor::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+void CNavElevator::ElevatorFloor::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	this->use_button.Load(filestream, version, subVersion);
-	this->call_button.Load(filestream, version, subVersion);
+	this->use_button.Load(reader, version, subVersion);
+	this->call_button.Load(reader, version, subVersion);
 
 	unsigned int id = 0;
-	filestream.read(reinterpret_cast<char*>(&id), sizeof(unsigned int));
+	reader.Read(id);
 	this->floor_area = id;
-	filestream.read(reinterpret_cast<char*>(&this->floor_position), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&this->wait_position), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&this->shootable_button), sizeof(bool));
-	filestream.read(reinterpret_cast<char*>(&this->toggle_state), sizeof(int));
+	reader.Read(this->floor_position);
+	reader.Read(this->wait_position);
+	reader.Read(this->shootable_button);
+	reader.Read(this->toggle_state);
 }
 
 void CNavElevator::ElevatorFloor::PostLoad()
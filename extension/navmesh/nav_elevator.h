@@ -11,6 +11,7 @@
 #include <sdkports/sdk_ehandle.h>
 #include <sdkports/sdk_timers.h>
 #include "nav.h"
+#include "nav_filereader.h"
 
 /**
  * @brief Class for representing a nav mesh elevator
@@ -46,8 +47,8 @@ public:
 			targetname.reserve(64);
 		}
 
-		void Save(std::fstream& filestream, uint32_t version);
-		void Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);
+		void Save(std::ostream& filestream, uint32_t version);
+		void Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);
 		void PostLoad();
 		void SearchForEntity(const bool noerror = true);
 		void AssignEntity(CBaseEntity* entity);
@@ -80,8 +81,8 @@ public:
 		void ConvertAreaIDToPointer();
 		CNavArea* GetArea() const { return std::get<CNavArea*>(floor_area); }
 
-		void Save(std::fstream& filestream, uint32_t version);
-		void Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);
+		void Save(std::ostream& filestream, uint32_t version);
+		void Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);
 		void PostLoad();
 
 		bool HasCallButton() const { return !this->call_button.classname.empty(); }
@@ -112,8 +113,8 @@ public:
 	virtual void Draw() const; // draws this elevator 
 	virtual void ScreenText() const; // screen text for this elevator
 
-	virtual void Save(std::fstream& filestream, uint32_t version);
-	virtual NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);
+	virtual void Save(std::ostream& filestream, uint32_t version);
+	virtual NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);
 	virtual NavErrorType PostLoad();
 
 	const ElevatorFloor* GetFloorForArea(const CNavArea* area) const;
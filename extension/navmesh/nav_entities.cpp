@@ -14,6 +14,8 @@
 #include "nav_entities.h"
 
 #include "nav_area.h"
+#include "nav_pathcache.h"
+#include "nav_flowfield.h"
 #include <eiface.h>
 #include <iplayerinfo.h>
 #include <collisionutils.h>
@@ -278,6 +280,10 @@ void CFuncNavCost::UpdateAllNavCostDecoration( CNavMesh* TheNavMesh )
 			}
 		}
 	}
+
+	// area costs changed, cached paths may no longer be the cheapest
+	TheNavMesh->GetPathCache()->Invalidate();
+	TheNavMesh->GetFlowFields()->Invalidate();
 }
 
 
@@ -10,7 +10,10 @@
 // Author: Michael S. Booth (mike@turtlerockstudios.com), January-September 2003
 
 #include <cinttypes>
+#include <cstring>
 #include <memory>
+#include <chrono>
+#include <mutex>
 
 #include "extension.h"
 #include <manager.h>
@@ -21,10 +24,16 @@
 #include "nav_waypoint.h"
 #include "nav_volume.h"
 #include "nav_prereq.h"
+#include "nav_landmarks.h"
+#include "nav_filereader.h"
+#include "nav_filesections.h"
+#include "nav_loader.h"
+#include "nav_loadcache.h"
 
 #include "tier1/lzmaDecoder.h"
 
 #include <utlbuffer.h>
+#include <tier1/checksum_crc.h>
 #include <filesystem.h>
 #include <eiface.h>
 
@@ -115,7 +124,86 @@ constexpr int NavCurrentVersion = 17;
 // Current version of the Sourcemod Nav Mesh
 constexpr int SMNavVersion = 1;
 
+// First version stored in sections with a table of contents
+constexpr uint32_t NavSectionedFileVersion = 3;
+
+// Order the sections are loaded in, older versions store them in this order
+static constexpr NavFileSectionID s_sectionLoadOrder[] = {
+	NavFileSectionID::SECTION_MESH,
+	NavFileSectionID::SECTION_AUTHOR,
+	NavFileSectionID::SECTION_WAYPOINTS,
+	NavFileSectionID::SECTION_VOLUMES,
+	NavFileSectionID::SECTION_ELEVATORS,
+	NavFileSectionID::SECTION_PREREQUISITES,
+	NavFileSectionID::SECTION_PLACES,
+	NavFileSectionID::SECTION_CUSTOM_PRE_AREA,
+	NavFileSectionID::SECTION_AREAS,
+	NavFileSectionID::SECTION_LADDERS,
+	NavFileSectionID::SECTION_CUSTOM,
+	NavFileSectionID::SECTION_LANDMARKS,
+	NavFileSectionID::SECTION_AREA_INDEX, // read before the areas, saved after them
+};
+
+// smaller ranges aren't worth a thread
+static constexpr std::size_t MIN_AREAS_PER_THREAD = 256U;
+
+// hiding spots are added to a global list by their constructor
+static std::mutex s_hidingSpotMutex;
+
+// the areas log their warnings from several threads
+static std::mutex s_loadMessageMutex;
+
+// Logs a loader message, game thread only
+static void PrintLoadMessage(NavLoadMessageType type, const char* text)
+{
+	switch (type)
+	{
+	case NAV_LOAD_ERROR:
+		smutils->LogError(myself, "%s", text);
+		break;
+	case NAV_LOAD_WARNING:
+		Warning("%s", text);
+		break;
+	case NAV_LOAD_DEV_WARNING:
+		DevWarning("%s", text);
+		break;
+	}
+}
+
+// Milliseconds elapsed since start
+static double MillisecondsSince(const std::chrono::high_resolution_clock::time_point& start)
+{
+	const std::chrono::duration<double, std::milli> millis = std::chrono::high_resolution_clock::now() - start;
+	return millis.count();
+}
+
+// CRC32 of a nav mesh file. The table of contents has the checksum of every section, only the headers and the table are hashed for them.
+static std::uint32_t ComputeNavFileCRC(const CNavFileReader& file, uint32_t version)
+{
+	constexpr std::size_t tableStart = sizeof(NavMeshFileHeader) + sizeof(NavMeshInfoHeader);
+	std::size_t size = file.GetSize();
+
+	if (version >= NavSectionedFileVersion && size >= tableStart + sizeof(std::uint32_t))
+	{
+		std::uint32_t count = 0U;
+		std::memcpy(&count, file.GetData() + tableStart, sizeof(std::uint32_t));
+
+		const std::uint64_t tableEnd = static_cast<std::uint64_t>(tableStart + sizeof(std::uint32_t)) + static_cast<std::uint64_t>(count) * sizeof(NavFileSectionEntry);
+
+		if (tableEnd < static_cast<std::uint64_t>(size))
+		{
+			size = static_cast<std::size_t>(tableEnd);
+		}
+	}
+
+	return CRC32_ProcessSingleBuffer(file.GetData(), static_cast<int>(size));
+}
+
 extern IFileSystem *filesystem;
+extern ConVar sm_nav_landmarks;
+extern ConVar sm_nav_load_waypoints;
+extern ConVar sm_nav_load_threads;
+extern ConVar sm_nav_load_cache;
 extern IVEngineServer* engine;
 extern CGlobalVars *gpGlobals;
 extern NavAreaVector TheNavAreas;
@@ -134,7 +222,7 @@ extern NavAreaVector TheNavAreas;
 //
 
 /// store the directory
-void PlaceDirectory::Save(std::fstream& filestream)
+void PlaceDirectory::Save(std::ostream& filestream)
 {
 	// store number of entries in directory
 	uint64_t size = static_cast<uint64_t>(m_directory.size());
@@ -154,35 +242,34 @@ void PlaceDirectory::Save(std::fstream& filestream)
 }
 
 /// load the directory
-void PlaceDirectory::Load(std::fstream& filestream, uint32_t version)
+void PlaceDirectory::Load(CNavFileReader& reader, uint32_t version)
 {
 	// read number of entries
 	uint64_t size = 0U;
-	filestream.read(reinterpret_cast<char*>(&size), sizeof(uint64_t));
+	reader.Read(size);
 
 	m_directory.clear();
 
-	for (uint64_t i = 0; i < size; i++)
+	for (uint64_t i = 0; i < size && reader.IsGood(); i++)
 	{
-		char placeName[256];
+		std::string name;
 		uint64_t length = 0U;
 		IndexType entry = 0;
-		filestream.read(reinterpret_cast<char*>(&length), sizeof(uint64_t));
-		filestream.read(placeName, length);
-		filestream.read(reinterpret_cast<char*>(&entry), sizeof(IndexType));
+		reader.Read(length);
+		reader.ReadString(length, name);
+		reader.Read(entry);
 
-		std::string name(placeName);
 		auto place = TheNavMesh->GetPlaceFromName(name);
 
 		if (place == UNDEFINED_PLACE)
 		{
-			Warning("Warning: NavMesh place \"%s\" is undefined? \n", placeName);
+			TheNavMesh->LogLoadMessage(NAV_LOAD_WARNING, "Warning: NavMesh place \"%s\" is undefined? \n", name.c_str());
 		}
 
 		LoadPlace(entry, place);
 	}
 
-	filestream.read(reinterpret_cast<char*>(&m_hasUnnamedAreas), sizeof(m_hasUnnamedAreas));
+	reader.Read(m_hasUnnamedAreas);
 }
 
 PlaceDirectory placeDirectory;
@@ -221,7 +308,7 @@ char *GetBspFilename( const char *navFilename )
 /**
  * Save a navigation area to the opened binary stream
  */
-void CNavArea::Save(std::fstream& filestream, uint32_t version)
+void CNavArea::Save(std::ostream& filestream, uint32_t version)
 {
 	// save ID
 	filestream.write(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
@@ -345,34 +432,30 @@ void CNavArea::Save(std::fstream& filestream, uint32_t version)
 /**
  * Load a navigation area from the file
  */
-NavErrorType CNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t subversion)
+NavErrorType CNavArea::Load(CNavFileReader& reader, uint32_t version, uint32_t subversion)
 {
-	if (!filestream.good())
+	if (!reader.IsGood())
 	{
 		return NAV_CORRUPT_DATA;
 	}
 
-	// load ID
-	filestream.read(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
-
-	// update nextID to avoid collisions
-	if (m_id >= m_nextID)
-		m_nextID = m_id+1;
+	// load ID, nextID is updated by the mesh once all areas are loaded
+	reader.Read(m_id);
 
 	// save attribute flags
-	filestream.read(reinterpret_cast<char*>(&m_attributeFlags), sizeof(int));
+	reader.Read(m_attributeFlags);
 
-	if (!filestream.good())
+	if (!reader.IsGood())
 	{
 		return NAV_CORRUPT_DATA;
 	}
 
 	// load extent of area
-	filestream.read(reinterpret_cast<char*>(&m_nwCorner), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_seCorner), sizeof(Vector));
+	reader.Read(m_nwCorner);
+	reader.Read(m_seCorner);
 	// load heights of implicit corners
-	filestream.read(reinterpret_cast<char*>(&m_neZ), sizeof(float));
-	filestream.read(reinterpret_cast<char*>(&m_swZ), sizeof(float));
+	reader.Read(m_neZ);
+	reader.Read(m_swZ);
 
 	m_center.x = (m_nwCorner.x + m_seCorner.x)/2.0f;
 	m_center.y = (m_nwCorner.y + m_seCorner.y)/2.0f;
@@ -387,26 +470,24 @@ NavErrorType CNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t
 	{
 		m_invDxCorners = m_invDyCorners = 0;
 
-		DevWarning( "Degenerate Navigation Area #%d at setpos %g %g %g\n", 
+		TheNavMesh->LogLoadMessage( NAV_LOAD_DEV_WARNING, "Degenerate Navigation Area #%d at setpos %g %g %g\n", 
 			m_id, m_center.x, m_center.y, m_center.z );
 	}
 
-	CheckWaterLevel();
-
 	// load connections (IDs) to adjacent areas
 	// in the enum order NORTH, EAST, SOUTH, WEST
 	for( int d=0; d<NUM_DIRECTIONS; d++ )
 	{
 		// load number of connections for this direction
 		int count = 0;
-		filestream.read(reinterpret_cast<char*>(&count), sizeof(int));
+		reader.Read(count);
 
 		m_connect[d].EnsureCapacity( count );
 		for(int i=0; i<count; ++i)
 		{
 			NavConnect connect;
 			unsigned int cid = 0;
-			filestream.read(reinterpret_cast<char*>(&cid), sizeof(unsigned int));
+			reader.Read(cid);
 			connect.id = cid;
 
 			// don't allow self-referential connections
@@ -423,22 +504,28 @@ NavErrorType CNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t
 
 	// load number of hiding spots
 	int hidingSpotCount = 0;
-	filestream.read(reinterpret_cast<char*>(&hidingSpotCount), sizeof(int));
+	reader.Read(hidingSpotCount);
 
 	// load HidingSpot objects for this area
-	for( int h=0; h<hidingSpotCount; ++h )
+	if (hidingSpotCount > 0)
 	{
-		// create new hiding spot and put on master list
-		HidingSpot *spot = TheNavMesh->CreateHidingSpot();
-		spot->Load(filestream, version);
-		m_hidingSpots.AddToTail(spot);
+		// areas may be loaded on several threads
+		std::lock_guard<std::mutex> lock(s_hidingSpotMutex);
+
+		for( int h=0; h<hidingSpotCount; ++h )
+		{
+			// create new hiding spot and put on master list
+			HidingSpot *spot = TheNavMesh->CreateHidingSpot();
+			spot->Load(reader, version);
+			m_hidingSpots.AddToTail(spot);
+		}
 	}
 
 	//
 	// Load Place data
 	//
 	PlaceDirectory::IndexType entry = 0;
-	filestream.read(reinterpret_cast<char*>(&entry), sizeof(PlaceDirectory::IndexType));
+	reader.Read(entry);
 
 	// convert entry to actual Place
 	SetPlace(placeDirectory.IndexToPlace(entry));
@@ -447,13 +534,13 @@ NavErrorType CNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t
 	for ( int dir=0; dir<CNavLadder::NUM_LADDER_DIRECTIONS; ++dir )
 	{
 		int count = 0;
-		filestream.read(reinterpret_cast<char*>(&count), sizeof(int));
+		reader.Read(count);
 
 		for(int i = 0; i < count; ++i )
 		{
 			NavLadderConnect connect;
 			unsigned int id = 0;
-			filestream.read(reinterpret_cast<char*>(&id), sizeof(unsigned int));
+			reader.Read(id);
 			connect.id = id;
 
 			bool alreadyConnected = false;
@@ -477,33 +564,33 @@ NavErrorType CNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t
 	for( int i=0; i<MAX_NAV_TEAMS; ++i )
 	{
 		// no spot in the map should take longer than this to reach
-		filestream.read(reinterpret_cast<char*>(&m_earliestOccupyTime[i]), sizeof(float));
+		reader.Read(m_earliestOccupyTime[i]);
 	}
 
 	// load light intensity
 	for ( int i=0; i<NUM_CORNERS; ++i )
 	{
-		filestream.read(reinterpret_cast<char*>(&m_lightIntensity[i]), sizeof(float));
+		reader.Read(m_lightIntensity[i]);
 	}
 
 	// Load special links
 
 	uint64_t linksize = 0U;
-	filestream.read(reinterpret_cast<char*>(&linksize), sizeof(uint64_t));
+	reader.Read(linksize);
 
 	for (uint64_t i = 0U; i < linksize; i++)
 	{
 		unsigned int id = 0;
-		filestream.read(reinterpret_cast<char*>(&id), sizeof(unsigned int));
+		reader.Read(id);
 
 		OffMeshConnectionType type = OffMeshConnectionType::OFFMESH_INVALID;
-		filestream.read(reinterpret_cast<char*>(&type), sizeof(OffMeshConnectionType));
+		reader.Read(type);
 
 		Vector start;
-		filestream.read(reinterpret_cast<char*>(&start), sizeof(Vector));
+		reader.Read(start);
 
 		Vector end;
-		filestream.read(reinterpret_cast<char*>(&end), sizeof(Vector));
+		reader.Read(end);
 
 		m_offmeshconnections.emplace_back(type, id, start, end);
 	}
@@ -516,8 +603,9 @@ NavErrorType CNavArea::Load(std::fstream& filestream, uint32_t version, uint32_t
 /**
  * Convert loaded IDs to pointers
  * Make sure all IDs are converted, even if corrupt data is encountered.
+ * May run on a loader thread, errors are logged by the mesh.
  */
-NavErrorType CNavArea::PostLoad( void )
+NavErrorType CNavArea::PostLoad( const CNavAreaIDTable &areas )
 {
 	NavErrorType error = NAV_OK;
 
@@ -536,7 +624,6 @@ NavErrorType CNavArea::PostLoad( void )
 
 			if (id && connect.ladder == NULL)
 			{
-				smutils->LogError(myself, "CNavArea::PostLoad: Corrupt navigation ladder data. Cannot connect Navigation Areas.");
 				error = NAV_CORRUPT_DATA;
 				return error;
 			}
@@ -552,10 +639,9 @@ NavErrorType CNavArea::PostLoad( void )
 
 			// convert connect ID into an actual area
 			unsigned int id = connect->id;
-			connect->area = TheNavMesh->GetNavAreaByID( id );
+			connect->area = areas.Find( id );
 			if (id && connect->area == NULL)
 			{
-				smutils->LogError(myself, "CNavArea::PostLoad: Corrupt navigation data. Cannot connect Navigation Areas.");
 				error = NAV_CORRUPT_DATA;
 				return error;
 			}
@@ -573,11 +659,10 @@ NavErrorType CNavArea::PostLoad( void )
 	{
 		NavOffMeshConnection* link = &i;
 		auto id = link->m_link.id;
-		CNavArea* area = TheNavMesh->GetNavAreaByID(id);
+		CNavArea* area = areas.Find(id);
 
 		if (!area)
 		{
-			smutils->LogError(myself, "CNavArea::PostLoad: Corrupt navigation data. Nav Area #%i Special Link <%s> is missing connecting area!", GetID(), NavOffMeshConnection::OffMeshConnectionTypeToString(link->m_type));
 			error = NAV_CORRUPT_DATA;
 			return error;
 		}
@@ -856,6 +941,8 @@ static void WarnIfMeshNeedsAnalysis( int version )
  */
 bool CNavMesh::Save(void)
 {
+	// sections skipped when the file was loaded are stored again
+	LoadDeferredSections();
 	BuildAuthorInfo();
 
 	WarnIfMeshNeedsAnalysis(CNavMesh::NavMeshVersion);
@@ -871,36 +958,74 @@ bool CNavMesh::Save(void)
 	info.Init();
 	filestream.write(reinterpret_cast<char*>(&info), sizeof(NavMeshInfoHeader));
 
-	filestream.write(reinterpret_cast<char*>(&m_isAnalyzed), sizeof(bool));
+	// sections are written to memory first, the table of contents needs their size and checksum
+	CNavFileSectionWriter sections;
 
-	// store author information
-	auto& authorinfo = GetAuthorInfo();
-	bool authorset = authorinfo.HasCreatorBeenSet();
-	filestream.write(reinterpret_cast<char*>(&authorset), sizeof(bool));
+	for (NavFileSectionID id : s_sectionLoadOrder)
+	{
+		SaveSection(id, sections.BeginSection(id));
+	}
 
-	if (authorset)
+	sections.Write(filestream, static_cast<std::uint64_t>(sizeof(NavMeshFileHeader) + sizeof(NavMeshInfoHeader)));
+
+	if (m_isEditing)
 	{
-		auto& creator = authorinfo.GetCreator();
+		m_landmarks->Clear(); // areas may still change, rebuilt when leaving edit mode
+	}
 
-		std::uint64_t length = static_cast<std::uint64_t>(creator.first.length() + 1U);
-		filestream.write(reinterpret_cast<char*>(&length), sizeof(std::uint64_t));
-		filestream.write(creator.first.c_str(), length);
-		std::uint64_t steamid = creator.second;
-		filestream.write(reinterpret_cast<char*>(&steamid), sizeof(std::uint64_t));
+	filestream.close();
+	auto filesize = std::filesystem::file_size(path);
+	auto pathname = path.string();
+	Msg("[NavBot] Navigation Mesh file \"%s\" saved. Size on disk '%" PRIiMAX "' bytes. \n", pathname.c_str(), filesize);
 
-		std::uint64_t count = static_cast<std::uint64_t>(authorinfo.GetEditorCount());
-		filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
+	return true;
+}
+
+/**
+ * Store a single section of the Navigation Mesh
+ */
+void CNavMesh::SaveSection(NavFileSectionID id, std::ostream& filestream)
+{
+	switch (id)
+	{
+	case NavFileSectionID::SECTION_MESH:
+	{
+		filestream.write(reinterpret_cast<char*>(&m_isAnalyzed), sizeof(bool));
+		break;
+	}
+	case NavFileSectionID::SECTION_AUTHOR:
+	{
+		// store author information
+		auto& authorinfo = GetAuthorInfo();
+		bool authorset = authorinfo.HasCreatorBeenSet();
+		filestream.write(reinterpret_cast<char*>(&authorset), sizeof(bool));
 
-		for (auto& naveditor : authorinfo.GetEditors())
+		if (authorset)
 		{
-			length = static_cast<std::uint64_t>(naveditor.first.length() + 1U);
+			auto& creator = authorinfo.GetCreator();
+
+			std::uint64_t length = static_cast<std::uint64_t>(creator.first.length() + 1U);
 			filestream.write(reinterpret_cast<char*>(&length), sizeof(std::uint64_t));
-			filestream.write(naveditor.first.c_str(), length);
-			steamid = naveditor.second;
+			filestream.write(creator.first.c_str(), length);
+			std::uint64_t steamid = creator.second;
 			filestream.write(reinterpret_cast<char*>(&steamid), sizeof(std::uint64_t));
+
+			std::uint64_t count = static_cast<std::uint64_t>(authorinfo.GetEditorCount());
+			filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
+
+			for (auto& naveditor : authorinfo.GetEditors())
+			{
+				length = static_cast<std::uint64_t>(naveditor.first.length() + 1U);
+				filestream.write(reinterpret_cast<char*>(&length), sizeof(std::uint64_t));
+				filestream.write(naveditor.first.c_str(), length);
+				steamid = naveditor.second;
+				filestream.write(reinterpret_cast<char*>(&steamid), sizeof(std::uint64_t));
+			}
 		}
-	}
 
+		break;
+	}
+	case NavFileSectionID::SECTION_WAYPOINTS:
 	{
 		// first write the number of waypoints
 		std::uint64_t count = static_cast<std::uint64_t>(m_waypoints.size());
@@ -911,8 +1036,10 @@ bool CNavMesh::Save(void)
 			auto& wpt = pair.second;
 			wpt->Save(filestream, CNavMesh::NavMeshVersion);
 		}
-	}
 
+		break;
+	}
+	case NavFileSectionID::SECTION_VOLUMES:
 	{
 		std::uint64_t count = static_cast<std::uint64_t>(m_volumes.size());
 		filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
@@ -922,8 +1049,10 @@ bool CNavMesh::Save(void)
 			auto& volume = pair.second;
 			volume->Save(filestream, CNavMesh::NavMeshVersion);
 		}
-	}
 
+		break;
+	}
+	case NavFileSectionID::SECTION_ELEVATORS:
 	{
 		std::uint64_t count = static_cast<std::uint64_t>(m_elevators.size());
 		filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
@@ -933,8 +1062,10 @@ bool CNavMesh::Save(void)
 			auto& elevator = pair.second;
 			elevator->Save(filestream, CNavMesh::NavMeshVersion);
 		}
-	}
 
+		break;
+	}
+	case NavFileSectionID::SECTION_PREREQUISITES:
 	{
 		std::uint64_t count = static_cast<std::uint64_t>(m_prerequisites.size());
 		filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
@@ -944,43 +1075,52 @@ bool CNavMesh::Save(void)
 			auto& prerequisite = pair.second;
 			prerequisite->Save(filestream, CNavMesh::NavMeshVersion);
 		}
-	}
-
-	//
-	// Build a directory of the Places in this map
-	//
-	placeDirectory.Reset();
 
-	FOR_EACH_VEC(TheNavAreas, nit)
+		break;
+	}
+	case NavFileSectionID::SECTION_PLACES:
 	{
-		CNavArea *area = TheNavAreas[nit];
+		//
+		// Build a directory of the Places in this map
+		//
+		placeDirectory.Reset();
 
-		Place place = area->GetPlace();
-		placeDirectory.AddPlace(place);
-	}
+		FOR_EACH_VEC(TheNavAreas, nit)
+		{
+			CNavArea *area = TheNavAreas[nit];
 
-	placeDirectory.Save(filestream);
-	SaveCustomDataPreArea(filestream);
+			Place place = area->GetPlace();
+			placeDirectory.AddPlace(place);
+		}
 
-	//
-	// Store navigation areas
-	//
+		placeDirectory.Save(filestream);
+		break;
+	}
+	case NavFileSectionID::SECTION_CUSTOM_PRE_AREA:
+	{
+		SaveCustomDataPreArea(filestream);
+		break;
+	}
+	case NavFileSectionID::SECTION_AREAS:
 	{
 		// store number of areas
 		int count = TheNavAreas.Count();
 		filestream.write(reinterpret_cast<char*>(&count), sizeof(int));
 
+		m_areaRecordOffsets.clear();
+		m_areaRecordOffsets.reserve(static_cast<std::size_t>(count));
+
 		// store each area
 		FOR_EACH_VEC(TheNavAreas, it)
 		{
 			CNavArea *area = TheNavAreas[it];
+			m_areaRecordOffsets.push_back(static_cast<std::uint64_t>(filestream.tellp()));
 			area->Save(filestream, CNavMesh::NavMeshVersion);
 		}
-	}
 
-	//
-	// Store ladders
-	//
+		break;
+	}
+	case NavFileSectionID::SECTION_LADDERS:
 	{
 		// store number of ladders
 		int count = m_ladders.Count();
@@ -992,18 +1132,38 @@ bool CNavMesh::Save(void)
 			CNavLadder *ladder = m_ladders[i];
 			ladder->Save(filestream, CNavMesh::NavMeshVersion);
 		}
-	}
-	
-	//
-	// Store derived class mesh info
-	//
-	SaveCustomData(filestream);
-	filestream.close();
-	auto filesize = std::filesystem::file_size(path);
-	auto pathname = path.string();
-	Msg("[NavBot] Navigation Mesh file \"%s\" saved. Size on disk '%" PRIiMAX "' bytes. \n", pathname.c_str(), filesize);
 
-	return true;
+		break;
+	}
+	case NavFileSectionID::SECTION_CUSTOM:
+	{
+		//
+		// Store derived class mesh info
+		//
+		SaveCustomData(filestream);
+		break;
+	}
+	case NavFileSectionID::SECTION_LANDMARKS:
+	{
+		//
+		// Store landmark distance tables, computed from the mesh being saved
+		//
+		m_landmarks->Build(static_cast<unsigned int>(sm_nav_landmarks.GetInt()));
+		m_landmarks->Save(filestream, CNavMesh::NavMeshVersion);
+		break;
+	}
+	case NavFileSectionID::SECTION_AREA_INDEX:
+	{
+		// recorded when the areas were stored
+		std::uint64_t count = static_cast<std::uint64_t>(m_areaRecordOffsets.size());
+		filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
+		filestream.write(reinterpret_cast<char*>(m_areaRecordOffsets.data()), sizeof(std::uint64_t) * m_areaRecordOffsets.size());
+		m_areaRecordOffsets.clear();
+		break;
+	}
+	default:
+		break;
+	}
 }
 
 
@@ -1108,226 +1268,717 @@ static ConCommand sm_nav_check_file_consistency( "sm_nav_check_file_consistency"
  * Load AI navigation data from a file
  */
 NavErrorType CNavMesh::Load( void )
+{
+	// a load still running on the loader thread is dropped
+	CancelLoad();
+	BeginLoad();
+
+	return FinishLoad( LoadFile() );
+}
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Load AI navigation data from a file on the loader thread. The server keeps running while the file is read and decoded,
+ * Update publishes the mesh on the game thread once it's done.
+ */
+void CNavMesh::LoadAsync( void )
+{
+	CancelLoad();
+	BeginLoad();
+
+	m_loadTask = std::async( std::launch::async, [this]() { return LoadFile(); } );
+}
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Stop the loader thread and discard what it loaded
+ */
+void CNavMesh::CancelLoad( void )
+{
+	if ( !m_loadTask.valid() )
+	{
+		return;
+	}
+
+	// the loader checks the flag between sections and area ranges, only the current one is finished
+	m_loadCancelled = true;
+
+	try
+	{
+		m_loadTask.get();
+	}
+	catch (const std::exception&)
+	{
+	}
+
+	m_loadCache->Clear();
+	Reset();
+	m_loadCancelled = false;
+	m_loadRequest.active = false;
+	m_loadRequest.messages.clear();
+}
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Free the current mesh and collect what the loader needs from the engine, called on the game thread
+ */
+void CNavMesh::BeginLoad( void )
 {
 	// free previous navigation mesh data
 	Reset();
 	placeDirectory.Reset();
 	CNavArea::m_nextID = 1;
-	auto path = GetFullPathToNavMeshFile();
+	m_loadTimes = {};
+	m_loadCancelled = false;
+
+	m_loadRequest = {};
+	m_loadRequest.start = std::chrono::high_resolution_clock::now();
+	m_loadRequest.path = GetFullPathToNavMeshFile();
+	m_loadRequest.mapName.assign(STRING(gpGlobals->mapname));
+	m_loadRequest.modFolder.assign(smutils->GetGameFolderName());
+	m_loadRequest.mapVersion = static_cast<std::uint32_t>(gpGlobals->mapversion);
+	m_loadRequest.active = true;
+}
 
-	if (!std::filesystem::exists(path))
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Log an error or warning of the loader. While a load is running the message is kept in the load request, FinishLoad logs it
+ * on the game thread since the loader thread can't call SourceMod or the engine.
+ */
+void CNavMesh::LogLoadMessage( NavLoadMessageType type, const char *fmt, ... )
+{
+	char text[1024];
+	va_list vaargs;
+	va_start(vaargs, fmt);
+	ke::SafeVsprintf(text, sizeof(text), fmt, vaargs);
+	va_end(vaargs);
+
+	if (m_loadRequest.active)
 	{
-		return NAV_CANT_ACCESS_FILE;
+		std::lock_guard<std::mutex> lock(s_loadMessageMutex);
+		m_loadRequest.messages.push_back({ type, text });
+		return;
 	}
 
-	std::fstream filestream;
-	filestream.open(path, std::fstream::in | std::fstream::binary);
+	PrintLoadMessage(type, text);
+}
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Read and decode the file and bind the loaded data. Doesn't call the engine, may run on the loader thread.
+ */
+NavErrorType CNavMesh::LoadFile( void )
+{
+	const auto& path = m_loadRequest.path;
 
-	if (!filestream.is_open() || filestream.eof())
+	if (!std::filesystem::exists(path))
 	{
-		filestream.close();
 		return NAV_CANT_ACCESS_FILE;
 	}
 
-	if (!filestream.good())
+	const auto tstart = std::chrono::high_resolution_clock::now();
+
+	// the whole file is read at once, the loaders read from memory
+	CNavFileReader reader;
+
+	if (!reader.Open(path))
 	{
-		filestream.close();
 		return NAV_CANT_ACCESS_FILE;
 	}
 
+	m_loadTimes.read = MillisecondsSince(tstart);
+
 	NavMeshFileHeader header;
-	filestream.read(reinterpret_cast<char*>(&header), sizeof(NavMeshFileHeader));
+	reader.Read(header);
 
 	if (!header.IsHeaderValid())
 	{
-		filestream.close();
 		std::string str = path.string();
-		smutils->LogError(myself, "Navigation Mesh file \"%s\" has bad header!", str.c_str());
+		LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file \"%s\" has bad header!", str.c_str());
 		return NAV_INVALID_FILE;
 	}
 
 	if (!header.IsMagicValid())
 	{
-		filestream.close();
 		std::string str = path.string();
-		smutils->LogError(myself, "Navigation Mesh file \"%s\" has bad magic number!", str.c_str());
+		LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file \"%s\" has bad magic number!", str.c_str());
 		return NAV_INVALID_FILE;
 	}
 
 	if (!header.IsVersionValid())
 	{
-		filestream.close();
 		std::string str = path.string();
-		smutils->LogError(myself, "Navigation Mesh file \"%s\" has bad version number! Got '%i', should be '%i' or lower!", str.c_str(), header.version, CNavMesh::NavMeshVersion);
+		LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file \"%s\" has bad version number! Got '%i', should be '%i' or lower!", str.c_str(), header.version, CNavMesh::NavMeshVersion);
 		return NAV_INVALID_FILE;
 	}
 
 	if (!header.IsSubVersionValid(GetSubVersionNumber()))
 	{
-		filestream.close();
 		std::string str = path.string();
-		smutils->LogError(myself, "Navigation Mesh file \"%s\" has bad sub version number! Got '%i', should be '%i' or lower!", str.c_str(), header.subversion, GetSubVersionNumber());
+		LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file \"%s\" has bad sub version number! Got '%i', should be '%i' or lower!", str.c_str(), header.subversion, GetSubVersionNumber());
 		return NAV_INVALID_FILE;
 	}
 
 	NavMeshInfoHeader info;
-	filestream.read(reinterpret_cast<char*>(&info), sizeof(NavMeshInfoHeader));
+	reader.Read(info);
 
-	if (info.mapversion != gpGlobals->mapversion)
+	if (info.mapversion != static_cast<int>(m_loadRequest.mapVersion))
 	{
-		Warning("Navigation Mesh map version mismatch! \n");
+		LogLoadMessage(NAV_LOAD_WARNING, "Navigation Mesh map version mismatch! \n");
 	}
 
-	const char* gpMap = STRING(gpGlobals->mapname);
-
-	if (Q_strcmp(info.mapname, gpMap) != 0)
+	if (Q_strcmp(info.mapname, m_loadRequest.mapName.c_str()) != 0)
 	{
-		Warning("Navigation Mesh was generated for another map! %s != %s \n", info.mapname, gpMap);
+		LogLoadMessage(NAV_LOAD_WARNING, "Navigation Mesh was generated for another map! %s != %s \n", info.mapname, m_loadRequest.mapName.c_str());
 	}
 
-	const char* mod = smutils->GetGameFolderName();
-
-	if (Q_strcmp(info.modfolder, mod) != 0)
+	if (Q_strcmp(info.modfolder, m_loadRequest.modFolder.c_str()) != 0)
 	{
-		Warning("Navigation Mesh was generated from another game! %s != %s \n", info.modfolder, mod);
+		LogLoadMessage(NAV_LOAD_WARNING, "Navigation Mesh was generated from another game! %s != %s \n", info.modfolder, m_loadRequest.modFolder.c_str());
 	}
 
-	filestream.read(reinterpret_cast<char*>(&m_isAnalyzed), sizeof(bool));
+	m_loadRequest.version = header.version;
 
-	bool authorisset = false;
-	filestream.read(reinterpret_cast<char*>(&authorisset), sizeof(bool));
+	// data computed from the same file on an earlier load
+	NavLoadCacheKey& cacheKey = m_loadRequest.cacheKey;
+	cacheKey.fileCRC = ComputeNavFileCRC(reader, header.version);
+	cacheKey.mapVersion = m_loadRequest.mapVersion;
+	cacheKey.fileSize = static_cast<std::uint64_t>(reader.GetSize());
+	cacheKey.gridCellSize = m_gridCellSize;
+	cacheKey.stepHeight = navgenparams->step_height;
+	m_loadCache->Clear();
 
-	if (authorisset)
+	if (sm_nav_load_cache.GetBool())
 	{
-		std::uint64_t length = 0U;
-		filestream.read(reinterpret_cast<char*>(&length), sizeof(std::uint64_t));
-		std::unique_ptr<char[]> creatornamebuffer = std::make_unique<char[]>(length);
-		filestream.read(creatornamebuffer.get(), length);
-		std::uint64_t steamid = 0;
-		filestream.read(reinterpret_cast<char*>(&steamid), sizeof(std::uint64_t));
-
-		std::string cname(creatornamebuffer.get());
-		m_authorinfo.SetCreator(cname, steamid);
-
-		std::uint64_t count = 0U;
-		filestream.read(reinterpret_cast<char*>(&count), sizeof(std::uint64_t));
-
-		for (std::uint64_t i = 0U; i < count; i++)
-		{
-			length = 0U;
-			filestream.read(reinterpret_cast<char*>(&length), sizeof(std::uint64_t));
-			std::unique_ptr<char[]> editornamebuffer = std::make_unique<char[]>(length);
-			filestream.read(editornamebuffer.get(), length);
+		m_loadCache->Load(GetFullPathToLoadCacheFile(), cacheKey);
+	}
 
-			std::uint64_t steamid = 0;
-			filestream.read(reinterpret_cast<char*>(&steamid), sizeof(std::uint64_t));
+	NavErrorType error = NAV_OK;
+	const auto tdecode = std::chrono::high_resolution_clock::now();
 
-			std::string ename(editornamebuffer.get());
-			m_authorinfo.AddEditor(ename, steamid);
-		}
+	if (header.version >= NavSectionedFileVersion)
+	{
+		error = LoadSections(reader, header.version, header.subversion);
 	}
-
+	else
 	{
-		std::uint64_t numWaypoints = 0;
-		CWaypoint::g_NextWaypointID = 0;
-		filestream.read(reinterpret_cast<char*>(&numWaypoints), sizeof(std::uint64_t));
-		Vector tmp{ 0.0f, 0.0f, 0.0f };
-
-		m_waypoints.reserve(static_cast<size_t>(numWaypoints));
-
-		for (std::uint64_t i = 0; i < numWaypoints; i++)
+		// older versions store the sections in sequence, without a table of contents
+		for (NavFileSectionID id : s_sectionLoadOrder)
 		{
-			auto wpt = AddWaypoint(tmp);
+			// landmark distance tables were added on version 2, the sections after them with the table of contents
+			if ((id == NavFileSectionID::SECTION_LANDMARKS && header.version < 2) || id > NavFileSectionID::SECTION_LANDMARKS)
+			{
+				continue;
+			}
 
-			if (wpt.has_value())
+			if (IsLoadCancelled())
 			{
-				NavErrorType error = wpt->get()->Load(filestream, header.version, header.subversion);
+				error = NAV_LOAD_CANCELLED;
+				break;
+			}
 
-				if (error != NAV_OK)
-				{
-					return error;
-				}
+			error = LoadSection(id, reader, header.version, header.subversion);
+
+			if (error != NAV_OK)
+			{
+				break;
 			}
 		}
 	}
 
-	{
-		std::uint64_t numVolumes = 0;
-		CNavVolume::s_nextID = 0;
-		filestream.read(reinterpret_cast<char*>(&numVolumes), sizeof(std::uint64_t));
-		Vector tmp{ 0.0f, 0.0f, 0.0f };
+	m_areaRecordOffsets.clear();
 
-		for (std::uint64_t i = 0; i < numVolumes; i++)
-		{
-			auto volume = AddNavVolume(tmp);
+	if (error != NAV_OK)
+	{
+		return error;
+	}
 
-			if (volume.has_value())
-			{
-				NavErrorType error = volume->get()->Load(filestream, header.version, header.subversion);
+	m_loadTimes.sections = MillisecondsSince(tdecode) - m_loadTimes.areas;
 
-				if (error != NAV_OK)
-				{
-					return error;
-				}
-			}
-		}
+	if (IsLoadCancelled())
+	{
+		return NAV_LOAD_CANCELLED;
 	}
 
-	{
-		std::uint64_t numElevators = 0;
-		CNavElevator::s_nextID = 0;
-		filestream.read(reinterpret_cast<char*>(&numElevators), sizeof(std::uint64_t));
+	//
+	// Bind pointers, etc
+	//
+	const auto tpostload = std::chrono::high_resolution_clock::now();
+	error = PostLoadData(header.version);
+	m_loadTimes.postLoad = MillisecondsSince(tpostload) - m_loadTimes.connections;
 
-		for (std::uint64_t i = 0; i < numElevators; i++)
-		{
-			auto elevator = AddNavElevator(nullptr);
+	return error;
+}
 
-			if (elevator.has_value())
-			{
-				NavErrorType error = elevator->get()->Load(filestream, header.version, header.subversion);
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Finish loading on the game thread, everything that needs the engine or the map entities is done here
+ */
+NavErrorType CNavMesh::FinishLoad( NavErrorType error )
+{
+	// the loader thread is done, log what it raised
+	m_loadRequest.active = false;
 
-				if (error != NAV_OK)
-				{
-					return error;
-				}
-			}
-		}
+	for (const NavLoadMessage& message : m_loadRequest.messages)
+	{
+		PrintLoadMessage(message.type, message.text.c_str());
 	}
 
+	m_loadRequest.messages.clear();
+
+	if (error != NAV_OK)
 	{
-		std::uint64_t numPrerequisites = 0;
-		CNavPrerequisite::s_nextID = 0;
+		// the partially loaded data is freed here, Reset needs the game thread
+		m_loadCache->Clear();
+		Reset();
+		return error;
+	}
 
-		filestream.read(reinterpret_cast<char*>(&numPrerequisites), sizeof(std::uint64_t));
+	const auto tpostload = std::chrono::high_resolution_clock::now();
 
-		for (std::uint64_t i = 0; i < numPrerequisites; i++)
-		{
-			auto prereq = AddNavPrerequisite(nullptr);
+	// traces aren't allowed on the loader thread
+	FOR_EACH_VEC( TheNavAreas, it )
+	{
+		TheNavAreas[ it ]->CheckWaterLevel();
+	}
 
-			if (prereq.has_value())
-			{
-				NavErrorType error = prereq->get()->Load(filestream, header.version, header.subversion);
+	// mark stairways (TODO: this can be removed once all maps are re-saved with this attribute in them)
+	MarkStairAreas();
 
-				if (error != NAV_OK)
-				{
-					return error;
-				}
-			}
+	NavErrorType loadResult = PostLoad(m_loadRequest.version);
+	m_loadTimes.postLoad += MillisecondsSince(tpostload);
+
+	WarnIfMeshNeedsAnalysis(m_loadRequest.version);
+
+	if (loadResult == NAV_OK)
+	{
+		smutils->LogMessage(myself, "Loaded Navigation Mesh file \"%s\" in %3.2f ms. Read: %3.2f ms, sections: %3.2f ms, areas: %3.2f ms, connections: %3.2f ms, post load: %3.2f ms.%s",
+			m_loadRequest.path.string().c_str(), MillisecondsSince(m_loadRequest.start), m_loadTimes.read, m_loadTimes.sections, m_loadTimes.areas, m_loadTimes.connections, m_loadTimes.postLoad,
+			m_loadCache->IsLoaded() ? " Grid and volumes restored from the cache." : "");
+
+		if (sm_nav_load_cache.GetBool() && !m_loadCache->IsLoaded())
+		{
+			SaveLoadCache(m_loadRequest.cacheKey);
 		}
 	}
 
-	placeDirectory.Load(filestream, header.version);
-	LoadCustomDataPreArea(filestream, header.subversion);
+	// only needed while loading
+	m_loadCache->Clear();
 
-	// get number of areas
-	int count = 0;
-	int i;
-	filestream.read(reinterpret_cast<char*>(&count), sizeof(int));
+	return loadResult;
+}
+
+/**
+ * Load a file with a table of contents (version 3 and later)
+ */
+NavErrorType CNavMesh::LoadSections(CNavFileReader& reader, uint32_t version, uint32_t subversion)
+{
+	CNavFileSectionTable table;
 
-	if (count == 0)
+	if (!table.Read(reader))
 	{
-		return NAV_INVALID_FILE;
+		LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file has a corrupt table of contents!");
+		return NAV_CORRUPT_DATA;
+	}
+
+	for (const NavFileSectionEntry& entry : table.GetEntries())
+	{
+		if (CNavFileSectionTable::IsKnown(entry.id))
+		{
+			continue;
+		}
+
+		if ((entry.flags & NAV_SECTION_REQUIRED) != 0U)
+		{
+			LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file has unknown section #%u, it was saved by a newer version of NavBot!", static_cast<std::uint32_t>(entry.id));
+			return NAV_BAD_FILE_VERSION;
+		}
+
+		// added by a newer version, not stored when the mesh is saved again
+		LogLoadMessage(NAV_LOAD_WARNING, "Navigation Mesh file section #%u is unknown and will be skipped. \n", static_cast<std::uint32_t>(entry.id));
+	}
+
+	m_areaRecordOffsets.clear();
+
+	// without the area index, the areas are decoded one at a time
+	if (const NavFileSectionEntry* index = table.Find(NavFileSectionID::SECTION_AREA_INDEX))
+	{
+		CNavFileReader section;
+
+		if (CNavFileSectionTable::Open(reader, *index, section) != NAV_OK || LoadSection(NavFileSectionID::SECTION_AREA_INDEX, section, version, subversion) != NAV_OK)
+		{
+			m_areaRecordOffsets.clear();
+		}
+	}
+
+	for (NavFileSectionID id : s_sectionLoadOrder)
+	{
+		if (id == NavFileSectionID::SECTION_AREA_INDEX)
+		{
+			continue; // already loaded
+		}
+
+		if (IsLoadCancelled())
+		{
+			return NAV_LOAD_CANCELLED;
+		}
+
+		const NavFileSectionEntry* entry = table.Find(id);
+
+		if (entry == nullptr)
+		{
+			if (id == NavFileSectionID::SECTION_AREAS)
+			{
+				return NAV_INVALID_FILE;
+			}
+
+			continue; // loaded as empty
+		}
+
+		CNavFileReader section;
+		NavErrorType error = CNavFileSectionTable::Open(reader, *entry, section);
+
+		if (error == NAV_OK && ShouldDeferSection(id))
+		{
+			NavDeferredSection& deferred = m_deferredSections.emplace_back();
+			deferred.id = id;
+			deferred.version = version;
+			deferred.subversion = subversion;
+			deferred.data.assign(section.GetData(), section.GetData() + section.GetSize());
+			continue;
+		}
+
+		if (error == NAV_OK)
+		{
+			error = LoadSection(id, section, version, subversion);
+		}
+
+		if (error != NAV_OK)
+		{
+			if (id == NavFileSectionID::SECTION_LANDMARKS)
+			{
+				LogLoadMessage(NAV_LOAD_WARNING, "Navigation Mesh landmark tables are corrupt and will be rebuilt. \n");
+				continue;
+			}
+
+			LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh file section \"%s\" is corrupt!", CNavFileSectionTable::GetName(id));
+			return error;
+		}
+	}
+
+	return NAV_OK;
+}
+
+/**
+ * Load a single section of the Navigation Mesh
+ */
+NavErrorType CNavMesh::LoadSection(NavFileSectionID id, CNavFileReader& reader, uint32_t version, uint32_t subversion)
+{
+	switch (id)
+	{
+	case NavFileSectionID::SECTION_MESH:
+	{
+		reader.Read(m_isAnalyzed);
+		break;
+	}
+	case NavFileSectionID::SECTION_AUTHOR:
+	{
+		m_authorinfo = AuthorInfo();
+
+		bool authorisset = false;
+		reader.Read(authorisset);
+
+		if (authorisset)
+		{
+			std::uint64_t length = 0U;
+			reader.Read(length);
+			std::string cname;
+			reader.ReadString(length, cname);
+			std::uint64_t steamid = 0;
+			reader.Read(steamid);
+
+			m_authorinfo.SetCreator(cname, steamid);
+
+			std::uint64_t count = 0U;
+			reader.Read(count);
+
+			for (std::uint64_t i = 0U; i < count && reader.IsGood(); i++)
+			{
+				length = 0U;
+				reader.Read(length);
+				std::string ename;
+				reader.ReadString(length, ename);
+
+				std::uint64_t steamid = 0;
+				reader.Read(steamid);
+
+				m_authorinfo.AddEditor(ename, steamid);
+			}
+		}
+
+		break;
+	}
+	case NavFileSectionID::SECTION_WAYPOINTS:
+	{
+		std::uint64_t numWaypoints = 0;
+		CWaypoint::g_NextWaypointID = 0;
+		reader.Read(numWaypoints);
+		Vector tmp{ 0.0f, 0.0f, 0.0f };
+
+		m_waypoints.reserve(static_cast<size_t>(numWaypoints));
+
+		for (std::uint64_t i = 0; i < numWaypoints; i++)
+		{
+			auto wpt = AddWaypoint(tmp);
+
+			if (wpt.has_value())
+			{
+				NavErrorType error = wpt->get()->Load(reader, version, subversion);
+
+				if (error != NAV_OK)
+				{
+					return error;
+				}
+			}
+		}
+
+		break;
+	}
+	case NavFileSectionID::SECTION_VOLUMES:
+	{
+		std::uint64_t numVolumes = 0;
+		CNavVolume::s_nextID = 0;
+		reader.Read(numVolumes);
+		Vector tmp{ 0.0f, 0.0f, 0.0f };
+
+		for (std::uint64_t i = 0; i < numVolumes; i++)
+		{
+			auto volume = AddNavVolume(tmp);
+
+			if (volume.has_value())
+			{
+				NavErrorType error = volume->get()->Load(reader, version, subversion);
+
+				if (error != NAV_OK)
+				{
+					return error;
+				}
+			}
+		}
+
+		break;
 	}
+	case NavFileSectionID::SECTION_ELEVATORS:
+	{
+		std::uint64_t numElevators = 0;
+		CNavElevator::s_nextID = 0;
+		reader.Read(numElevators);
+
+		for (std::uint64_t i = 0; i < numElevators; i++)
+		{
+			auto elevator = AddNavElevator(nullptr);
+
+			if (elevator.has_value())
+			{
+				NavErrorType error = elevator->get()->Load(reader, version, subversion);
+
+				if (error != NAV_OK)
+				{
+					return error;
+				}
+			}
+		}
+
+		break;
+	}
+	case NavFileSectionID::SECTION_PREREQUISITES:
+	{
+		std::uint64_t numPrerequisites = 0;
+		CNavPrerequisite::s_nextID = 0;
+
+		reader.Read(numPrerequisites);
+
+		for (std::uint64_t i = 0; i < numPrerequisites; i++)
+		{
+			auto prereq = AddNavPrerequisite(nullptr);
+
+			if (prereq.has_value())
+			{
+				NavErrorType error = prereq->get()->Load(reader, version, subversion);
+
+				if (error != NAV_OK)
+				{
+					return error;
+				}
+			}
+		}
+
+		break;
+	}
+	case NavFileSectionID::SECTION_PLACES:
+	{
+		placeDirectory.Load(reader, version);
+		break;
+	}
+	case NavFileSectionID::SECTION_CUSTOM_PRE_AREA:
+	{
+		LoadCustomDataPreArea(reader, subversion);
+		break;
+	}
+	case NavFileSectionID::SECTION_AREAS:
+	{
+		// get number of areas
+		int count = 0;
+		reader.Read(count);
+
+		if (count <= 0)
+		{
+			return NAV_INVALID_FILE;
+		}
+
+		const auto tstart = std::chrono::high_resolution_clock::now();
+		NavErrorType error = LoadAreas(reader, count, version, subversion);
+		m_loadTimes.areas = MillisecondsSince(tstart);
+
+		if (error != NAV_OK)
+		{
+			return error;
+		}
+
+		break;
+	}
+	case NavFileSectionID::SECTION_AREA_INDEX:
+	{
+		std::uint64_t count = 0U;
+		reader.Read(count);
+
+		if (count > static_cast<std::uint64_t>(reader.GetBytesLeft() / sizeof(std::uint64_t)))
+		{
+			return NAV_CORRUPT_DATA;
+		}
+
+		m_areaRecordOffsets.resize(static_cast<std::size_t>(count));
+		reader.ReadBytes(m_areaRecordOffsets.data(), sizeof(std::uint64_t) * m_areaRecordOffsets.size());
+		break;
+	}
+	case NavFileSectionID::SECTION_LADDERS:
+	{
+		int count = 0;
+		reader.Read(count);
+		m_ladders.EnsureCapacity(count);
+
+		for (int i = 0; i < count; i++)
+		{
+			CNavLadder* ladder = new CNavLadder;
+			ladder->Load(this, reader, version);
+			m_ladders.AddToTail(ladder);
+		}
+
+		break;
+	}
+	case NavFileSectionID::SECTION_CUSTOM:
+	{
+		//
+		// Load derived class mesh info
+		//
+		LoadCustomData(reader, subversion);
+		break;
+	}
+	case NavFileSectionID::SECTION_LANDMARKS:
+	{
+		//
+		// Load landmark distance tables
+		//
+		if (m_landmarks->Load(reader, version) != NAV_OK)
+		{
+			LogLoadMessage(NAV_LOAD_WARNING, "Navigation Mesh landmark tables are corrupt and will be rebuilt. \n");
+		}
+
+		return NAV_OK;
+	}
+	default:
+		break;
+	}
+
+	return reader.IsGood() ? NAV_OK : NAV_CORRUPT_DATA;
+}
+
+/**
+ * Load the navigation areas and add them to the grid. With an area index (version 3 and later) the areas are split between the loader
+ * threads, each one decoding its own range of areas.
+ */
+NavErrorType CNavMesh::LoadAreas(CNavFileReader& reader, int count, uint32_t version, uint32_t subversion)
+{
+	// CNavArea's constructor writes m_nextID and the search index statics without a lock. On an asynchronous load this runs on
+	// the loader thread, which owns them until UpdateLoad publishes the mesh: BeginLoad destroys the old areas and discards the time
+	// sliced searches before the thread starts, and the game thread doesn't create, destroy or search areas while IsLoading() is true
+	// (Update, FireGameEvent, bot think and events, the path slicer and the edit commands all check it). The decode threads below
+	// only load the areas, so every area is created here, one at a time.
+	TheNavMesh->PreLoadAreas( count );
+	TheNavAreas.EnsureCapacity( count );
+
+	for( int i=0; i<count; ++i )
+	{
+		TheNavAreas.AddToTail( TheNavMesh->CreateArea() );
+	}
+
+	const std::size_t numAreas = static_cast<std::size_t>(count);
+	const bool hasIndex = m_areaRecordOffsets.size() == numAreas;
+	const unsigned int numThreads = hasIndex ? static_cast<unsigned int>(sm_nav_load_threads.GetInt()) : 1U;
+	std::vector<NavErrorType> errors(numAreas, NAV_OK);
+	std::size_t end = reader.GetPosition();
+
+	NavParallelFor(numAreas, numThreads, MIN_AREAS_PER_THREAD, [this, &reader, hasIndex, numAreas, version, subversion, &errors, &end](std::size_t first, std::size_t last) {
+		// each range has its own view of the areas
+		CNavFileReader range;
+		range.OpenView(reader.GetData(), reader.GetSize());
+		range.Skip(hasIndex ? m_areaRecordOffsets[first] : static_cast<std::uint64_t>(reader.GetPosition()));
+
+		for (std::size_t i = first; i < last; i++)
+		{
+			// CancelLoad is checked once per block of areas
+			if ((i - first) % MIN_AREAS_PER_THREAD == 0U && IsLoadCancelled())
+			{
+				errors[i] = NAV_LOAD_CANCELLED;
+				return;
+			}
+
+			// the index must match the areas
+			if (hasIndex && range.GetPosition() != m_areaRecordOffsets[i])
+			{
+				errors[i] = NAV_CORRUPT_DATA;
+				return;
+			}
+
+			errors[i] = TheNavAreas[static_cast<int>(i)]->Load(range, version, subversion);
+
+			if (errors[i] != NAV_OK)
+			{
+				return;
+			}
+		}
+
+		if (last == numAreas)
+		{
+			end = range.GetPosition();
+		}
+	});
+
+	// FinishLoad frees the areas on failure
+	for (NavErrorType error : errors)
+	{
+		if (error != NAV_OK)
+		{
+			return error;
+		}
+	}
+
+	reader.Skip(static_cast<std::uint64_t>(end - reader.GetPosition()));
+
+	extern HidingSpotVector TheHidingSpots;
+
+	// same order as loading the areas one at a time
+	TheHidingSpots.RemoveAll();
 
 	Extent extent;
 	extent.lo.x = 9999999999.9f;
@@ -1335,23 +1986,17 @@ NavErrorType CNavMesh::Load( void )
 	extent.hi.x = -9999999999.9f;
 	extent.hi.y = -9999999999.9f;
 
-	// load the areas and compute total extent
-	TheNavMesh->PreLoadAreas( count );
+	// compute total extent, the rest needs the game thread
 	Extent areaExtent;
-	for( i=0; i<count; ++i )
+	FOR_EACH_VEC( TheNavAreas, it )
 	{
-		CNavArea *area = TheNavMesh->CreateArea();
-		
-		auto error = area->Load(filestream, header.version, header.subversion);
+		CNavArea *area = TheNavAreas[ it ];
 
-		if (error != NAV_OK)
-		{
-			delete area;
-			Reset();
-			return error;
-		}
+		// update nextID to avoid collisions
+		if (area->GetID() >= CNavArea::m_nextID)
+			CNavArea::m_nextID = area->GetID() + 1;
 
-		TheNavAreas.AddToTail( area );
+		TheHidingSpots.AddVectorToTail( *area->GetHidingSpots() );
 
 		area->GetExtent( &areaExtent );
 
@@ -1365,6 +2010,17 @@ NavErrorType CNavMesh::Load( void )
 			extent.hi.y = areaExtent.hi.y;
 	}
 
+	if ( IsLoadCancelled() )
+	{
+		return NAV_LOAD_CANCELLED;
+	}
+
+	// the grid cells were computed from the same file on an earlier load
+	if ( RestoreGridFromCache() )
+	{
+		return NAV_OK;
+	}
+
 	// add the areas to the grid
 	AllocateGrid( extent.lo.x, extent.hi.x, extent.lo.y, extent.hi.y );
 
@@ -1373,39 +2029,133 @@ NavErrorType CNavMesh::Load( void )
 		AddNavArea( TheNavAreas[ it ] );
 	}
 
+	return NAV_OK;
+}
+
+/**
+ * Restore the grid cells from the load cache once the areas are loaded. Returns false if there's no cache or it doesn't match the areas.
+ */
+bool CNavMesh::RestoreGridFromCache( void )
+{
+	if ( !m_loadCache->IsLoaded() || !m_loadCache->HasGrid() )
+	{
+		return false;
+	}
+
+	CNavAreaIDTable areaTable;
+	areaTable.Build( TheNavAreas );
 
-	count = 0;
-	filestream.read(reinterpret_cast<char*>(&count), sizeof(count));
-	m_ladders.EnsureCapacity(count);
+	m_grid.RemoveAll();
+	m_minX = m_loadCache->GetGridMinX();
+	m_minY = m_loadCache->GetGridMinY();
+	m_gridSizeX = m_loadCache->GetGridSizeX();
+	m_gridSizeY = m_loadCache->GetGridSizeY();
+	m_grid.SetCount( m_gridSizeX * m_gridSizeY );
 
-	for (i = 0; i < count; i++)
+	for ( int cell = 0; cell < m_grid.Count(); ++cell )
 	{
-		CNavLadder* ladder = new CNavLadder;
-		ladder->Load(this, filestream, header.version);
-		m_ladders.AddToTail(ladder);
+		if ( !m_loadCache->RestoreGridCell( cell, areaTable, m_grid[ cell ] ) )
+		{
+			// stale cache, everything is computed again and the cache rebuilt
+			m_grid.RemoveAll();
+			m_loadCache->Clear();
+			return false;
+		}
 	}
 
-	// mark stairways (TODO: this can be removed once all maps are re-saved with this attribute in them)
-	MarkStairAreas();
+	FOR_EACH_VEC( TheNavAreas, it )
+	{
+		AddNavArea( TheNavAreas[ it ], false );
+	}
 
-	//
-	// Load derived class mesh info
-	//
-	LoadCustomData(filestream, header.subversion);
+	return true;
+}
 
-	//
-	// Bind pointers, etc
-	//
-	NavErrorType loadResult = PostLoad(header.version);
+/**
+ * Store the data computed while loading the mesh to the load cache file
+ */
+void CNavMesh::SaveLoadCache( const NavLoadCacheKey& key )
+{
+	m_loadCache->Clear();
+	m_loadCache->StoreGrid( m_minX, m_minY, m_gridSizeX, m_gridSizeY, m_grid );
+
+	for (auto& pair : m_volumes)
+	{
+		m_loadCache->StoreVolumeAreas(pair.second->GetID(), pair.second->m_areas);
+	}
+
+	for (auto& pair : m_prerequisites)
+	{
+		m_loadCache->StorePrerequisiteAreas(pair.second->GetID(), pair.second->m_areas);
+	}
 
-	WarnIfMeshNeedsAnalysis(header.version);
+	auto path = GetFullPathToLoadCacheFile();
 
-	if (loadResult == NAV_OK)
+	if (!m_loadCache->Save(path, key))
 	{
-		smutils->LogMessage(myself, "Loaded Navigation Mesh file \"%s\".", path.string().c_str());
+		smutils->LogError(myself, "Failed to save Navigation Mesh cache file \"%s\"!", path.string().c_str());
 	}
+}
 
-	return loadResult;
+/**
+ * Skip sections that are only needed when editing, or that the server asked not to load. They are kept in memory as they are stored
+ * in the file and decoded when first needed, the mesh is always saved with them.
+ */
+bool CNavMesh::ShouldDeferSection(NavFileSectionID id) const
+{
+	switch (id)
+	{
+	case NavFileSectionID::SECTION_AUTHOR:
+		return true;
+	case NavFileSectionID::SECTION_WAYPOINTS:
+		return !sm_nav_load_waypoints.GetBool();
+	default:
+		return false;
+	}
+}
+
+bool CNavMesh::IsSectionDeferred(NavFileSectionID id) const
+{
+	return std::any_of(m_deferredSections.begin(), m_deferredSections.end(), [id](const NavDeferredSection& section) {
+		return section.id == id;
+	});
+}
+
+void CNavMesh::LoadDeferredSection(NavFileSectionID id)
+{
+	auto it = std::find_if(m_deferredSections.begin(), m_deferredSections.end(), [id](const NavDeferredSection& section) {
+		return section.id == id;
+	});
+
+	if (it == m_deferredSections.end())
+	{
+		return;
+	}
+
+	// removed first, the waypoints are added with AddWaypoint that loads this section too
+	NavDeferredSection deferred = std::move(*it);
+	m_deferredSections.erase(it);
+
+	CNavFileReader reader;
+	reader.OpenView(deferred.data.data(), deferred.data.size());
+
+	if (LoadSection(id, reader, deferred.version, deferred.subversion) != NAV_OK)
+	{
+		smutils->LogError(myself, "Navigation Mesh file section \"%s\" is corrupt!", CNavFileSectionTable::GetName(id));
+	}
+
+	if (id == NavFileSectionID::SECTION_WAYPOINTS)
+	{
+		PostLoadWaypoints();
+	}
+}
+
+void CNavMesh::LoadDeferredSections( void )
+{
+	while (!m_deferredSections.empty())
+	{
+		LoadDeferredSection(m_deferredSections.front().id);
+	}
 }
 
 
@@ -1424,50 +2174,55 @@ struct OneWayLink_t
 
 //--------------------------------------------------------------------------------------------------------------
 /**
- * Invoked after all areas have been loaded - for pointer binding, etc
+ * Invoked after all areas have been loaded - for pointer binding, etc. Doesn't call the engine, may run on the loader thread.
  */
-NavErrorType CNavMesh::PostLoad( uint32_t version )
+NavErrorType CNavMesh::PostLoadData( uint32_t version )
 {
 	// allow areas to connect to each other, etc
-	FOR_EACH_VEC( TheNavAreas, pit )
-	{
-		CNavArea *area = TheNavAreas[ pit ];
-		area->PostLoad();
-	}
+	// IDs are converted with a table indexed by ID, the areas are split between the loader threads
+	const auto tstart = std::chrono::high_resolution_clock::now();
+	const std::size_t numAreas = static_cast<std::size_t>(TheNavAreas.Count());
+	std::vector<NavErrorType> errors(numAreas, NAV_OK);
+	CNavAreaIDTable areaTable;
+	areaTable.Build(TheNavAreas);
+
+	NavParallelFor(numAreas, static_cast<unsigned int>(sm_nav_load_threads.GetInt()), MIN_AREAS_PER_THREAD, [this, &areaTable, &errors](std::size_t first, std::size_t last) {
+		for (std::size_t i = first; i < last; i++)
+		{
+			if ((i - first) % MIN_AREAS_PER_THREAD == 0U && IsLoadCancelled())
+			{
+				return;
+			}
 
-	extern HidingSpotVector TheHidingSpots;
-	// allow hiding spots to compute information
-	FOR_EACH_VEC( TheHidingSpots, hit )
+			errors[i] = TheNavAreas[static_cast<int>(i)]->PostLoad(areaTable);
+		}
+	});
+
+	if (IsLoadCancelled())
 	{
-		HidingSpot *spot = TheHidingSpots[ hit ];
-		spot->PostLoad();
+		return NAV_LOAD_CANCELLED;
 	}
 
-	WaypointID topID = 0;
-
-	RebuildWaypointMap();
-
-	// allow waypoints to connect to each other
-	for (auto& pair : m_waypoints)
+	for (std::size_t i = 0; i < numAreas; i++)
 	{
-		auto& wpt = pair.second;
-		wpt->PostLoad();
-
-		if (wpt->GetID() >= topID)
+		if (errors[i] != NAV_OK)
 		{
-			topID = wpt->GetID();
+			LogLoadMessage(NAV_LOAD_ERROR, "CNavArea::PostLoad: Corrupt navigation data. Nav Area #%i is connected to a missing area or ladder!", TheNavAreas[static_cast<int>(i)]->GetID());
 		}
 	}
 
-	if (m_waypoints.empty())
-	{
-		CWaypoint::g_NextWaypointID = 0;
-	}
-	else
+	m_loadTimes.connections = MillisecondsSince(tstart);
+
+	extern HidingSpotVector TheHidingSpots;
+	// allow hiding spots to compute information
+	FOR_EACH_VEC( TheHidingSpots, hit )
 	{
-		CWaypoint::g_NextWaypointID = topID + 1;
+		HidingSpot *spot = TheHidingSpots[ hit ];
+		spot->PostLoad();
 	}
 
+	PostLoadWaypoints();
+
 	unsigned int nextVolumeID = 0;
 
 	RebuildVolumeMap();
@@ -1475,6 +2230,13 @@ NavErrorType CNavMesh::PostLoad( uint32_t version )
 	for (auto& pair : m_volumes)
 	{
 		auto& volume = pair.second;
+
+		// the areas inside the volume are searched for if they aren't cached
+		if (m_loadCache->IsLoaded())
+		{
+			m_loadCache->RestoreVolumeAreas(volume->GetID(), areaTable, volume->m_areas);
+		}
+
 		volume->PostLoad();
 
 		if (volume->GetID() >= nextVolumeID)
@@ -1492,56 +2254,9 @@ NavErrorType CNavMesh::PostLoad( uint32_t version )
 		CNavVolume::s_nextID = nextVolumeID + 1;
 	}
 
-	RebuildElevatorMap();
-
-	unsigned int nextElevatorID = 0;
-
-	for (auto& pair : m_elevators)
-	{
-		auto& elevator = pair.second;
-		elevator->PostLoad();
-
-		if (elevator->GetID() >= nextElevatorID)
-		{
-			nextElevatorID = elevator->GetID();
-		}
-	}
-
-	if (m_elevators.empty())
-	{
-		CNavElevator::s_nextID = 0;
-	}
-	else
+	if (IsLoadCancelled())
 	{
-		CNavElevator::s_nextID = nextElevatorID + 1;
-	}
-
-	RebuildPrerequisiteMap();
-
-	unsigned int nextPrerequisiteID = 0;
-
-	for (auto& pair : m_prerequisites)
-	{
-		pair.second->PostLoad();
-
-		if (pair.second->GetID() >= nextPrerequisiteID)
-		{
-			nextPrerequisiteID = pair.second->GetID();
-		}
-	}
-
-	if (m_prerequisites.empty())
-	{
-		CNavPrerequisite::s_nextID = 0;
-	}
-	else
-	{
-		CNavPrerequisite::s_nextID = nextPrerequisiteID + 1;
-	}
-
-	for (int i = 0; i < m_ladders.Count(); i++)
-	{
-		m_ladders[i]->PostLoad(this, version);
+		return NAV_LOAD_CANCELLED;
 	}
 
 	ComputeBattlefrontAreas();
@@ -1600,6 +2315,79 @@ NavErrorType CNavMesh::PostLoad( uint32_t version )
 
 	ValidateNavAreaConnections();
 
+	return NAV_OK;
+}
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Invoked on the game thread after the loaded data is bound, for anything that needs the map entities or traces
+ */
+NavErrorType CNavMesh::PostLoad( uint32_t version )
+{
+	CNavAreaIDTable areaTable;
+
+	if (m_loadCache->IsLoaded())
+	{
+		areaTable.Build(TheNavAreas);
+	}
+
+	RebuildElevatorMap();
+
+	unsigned int nextElevatorID = 0;
+
+	for (auto& pair : m_elevators)
+	{
+		auto& elevator = pair.second;
+		elevator->PostLoad();
+
+		if (elevator->GetID() >= nextElevatorID)
+		{
+			nextElevatorID = elevator->GetID();
+		}
+	}
+
+	if (m_elevators.empty())
+	{
+		CNavElevator::s_nextID = 0;
+	}
+	else
+	{
+		CNavElevator::s_nextID = nextElevatorID + 1;
+	}
+
+	RebuildPrerequisiteMap();
+
+	unsigned int nextPrerequisiteID = 0;
+
+	for (auto& pair : m_prerequisites)
+	{
+		if (m_loadCache->IsLoaded())
+		{
+			m_loadCache->RestorePrerequisiteAreas(pair.second->GetID(), areaTable, pair.second->m_areas);
+		}
+
+		pair.second->PostLoad();
+
+		if (pair.second->GetID() >= nextPrerequisiteID)
+		{
+			nextPrerequisiteID = pair.second->GetID();
+		}
+	}
+
+	if (m_prerequisites.empty())
+	{
+		CNavPrerequisite::s_nextID = 0;
+	}
+	else
+	{
+		CNavPrerequisite::s_nextID = nextPrerequisiteID + 1;
+	}
+
+	for (int i = 0; i < m_ladders.Count(); i++)
+	{
+		m_ladders[i]->PostLoad(this, version);
+	}
+
 	// TERROR: loading into a map directly creates entities before the mesh is loaded.  Tell the preexisting
 	// entities now that the mesh is loaded so they can update areas.
 	for ( int i=0; i<m_avoidanceObstacles.Count(); ++i )
@@ -1609,11 +2397,52 @@ NavErrorType CNavMesh::PostLoad( uint32_t version )
 
 	// the Navigation Mesh has been successfully loaded
 	m_isLoaded = true;
+
+	RebuildClusterGraph();
+
+	// older files and files with tables that don't match the areas
+	if ( !m_landmarks->IsBuilt() )
+	{
+		RebuildLandmarks();
+	}
+
+	RebuildConnectionGraph();
+	RebuildLayeredGrid();
+
 	extmanager->GetMod()->OnNavMeshLoaded();
 
 	return NAV_OK;
 }
 
+// Bind the waypoint connections, also used when the waypoints are loaded after the mesh
+void CNavMesh::PostLoadWaypoints( void )
+{
+	WaypointID topID = 0;
+
+	RebuildWaypointMap();
+
+	// allow waypoints to connect to each other
+	for (auto& pair : m_waypoints)
+	{
+		auto& wpt = pair.second;
+		wpt->PostLoad();
+
+		if (wpt->GetID() >= topID)
+		{
+			topID = wpt->GetID();
+		}
+	}
+
+	if (m_waypoints.empty())
+	{
+		CWaypoint::g_NextWaypointID = 0;
+	}
+	else
+	{
+		CWaypoint::g_NextWaypointID = topID + 1;
+	}
+}
+
 std::string CNavMesh::GetMapFileName() const
 {
 	auto mapname = gamehelpers->GetCurrentMap();
@@ -1629,6 +2458,13 @@ std::filesystem::path CNavMesh::GetFullPathToNavMeshFile() const
 	return std::filesystem::path(fullpath);
 }
 
+std::filesystem::path CNavMesh::GetFullPathToLoadCacheFile() const
+{
+	auto path = GetFullPathToNavMeshFile();
+	path.replace_extension(".smnavcache");
+	return path;
+}
+
 void CNavMesh::BuildAuthorInfo()
 {
 	auto host = playerhelpers->GetGamePlayer(1); // gets the listen server host
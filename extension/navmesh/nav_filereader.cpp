@@ -0,0 +1,78 @@
+#include <fstream>
+#include <system_error>
+
+#include "nav_filereader.h"
+
+CNavFileReader::CNavFileReader()
+{
+	m_data = nullptr;
+	m_size = 0U;
+	m_position = 0U;
+	m_good = false;
+}
+
+bool CNavFileReader::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	std::error_code ec;
+	const std::uintmax_t size = std::filesystem::file_size(path, ec);
+
+	if (ec)
+	{
+		return false;
+	}
+
+	std::ifstream file(path, std::ios_base::in | std::ios_base::binary);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	m_buffer.resize(static_cast<std::size_t>(size));
+
+	// a single read instead of one per value
+	if (size > 0U && !file.read(m_buffer.data(), static_cast<std::streamsize>(size)))
+	{
+		Close();
+		return false;
+	}
+
+	m_data = m_buffer.data();
+	m_size = m_buffer.size();
+	m_good = true;
+	return true;
+}
+
+void CNavFileReader::OpenView(const char* data, std::size_t size)
+{
+	Close();
+
+	m_data = data;
+	m_size = size;
+	m_good = true;
+}
+
+void CNavFileReader::Close()
+{
+	m_buffer.clear();
+	m_buffer.shrink_to_fit();
+	m_data = nullptr;
+	m_size = 0U;
+	m_position = 0U;
+	m_good = false;
+}
+
+bool CNavFileReader::ReadString(std::uint64_t length, std::string& out)
+{
+	if (!Advance(length))
+	{
+		return false;
+	}
+
+	const char* str = m_data + (m_position - static_cast<std::size_t>(length));
+	const void* end = std::memchr(str, '\0', static_cast<std::size_t>(length));
+	out.assign(str, end != nullptr ? static_cast<const char*>(end) : str + length);
+	return true;
+}
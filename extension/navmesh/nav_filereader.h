@@ -0,0 +1,104 @@
+#ifndef NAV_FILE_READER_H_
+#define NAV_FILE_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads a nav file from memory.
+ *
+ * The whole file is read at once when opened, the loaders then copy the values out of the buffer. Reads are bounds checked, a read
+ * past the end of the file fails without touching the destination and every read after it fails too (see IsGood).
+ * A reader may also be opened over memory it doesn't own, such as a single section of a file read by another reader.
+ */
+class CNavFileReader
+{
+public:
+	CNavFileReader();
+
+	CNavFileReader(const CNavFileReader&) = delete;
+	CNavFileReader& operator=(const CNavFileReader&) = delete;
+
+	/**
+	 * @brief Reads the file into memory.
+	 * @param path Path to the file.
+	 * @return false if the file can't be read.
+	 */
+	bool Open(const std::filesystem::path& path);
+	/**
+	 * @brief Reads from memory owned by someone else, the memory must stay valid until the reader is closed.
+	 * @param data Start of the memory.
+	 * @param size Number of bytes.
+	 */
+	void OpenView(const char* data, std::size_t size);
+	void Close();
+
+	// false once a read failed
+	bool IsGood() const { return m_good; }
+	bool IsAtEnd() const { return m_position >= m_size; }
+	std::size_t GetPosition() const { return m_position; }
+	std::size_t GetSize() const { return m_size; }
+	std::size_t GetBytesLeft() const { return m_size - m_position; }
+	// Start of the memory being read
+	const char* GetData() const { return m_data; }
+
+	/**
+	 * @brief Copies the next bytes of the file.
+	 * @param dest Destination.
+	 * @param size Number of bytes to copy.
+	 * @return true on success, false if the file doesn't have enough bytes left.
+	 */
+	bool ReadBytes(void* dest, std::size_t size)
+	{
+		if (!Advance(size))
+		{
+			return false;
+		}
+
+		std::memcpy(dest, m_data + (m_position - size), size);
+		return true;
+	}
+
+	// Reads a value stored as raw bytes, see ReadBytes
+	template <typename T>
+	bool Read(T& value)
+	{
+		return ReadBytes(&value, sizeof(T));
+	}
+
+	/**
+	 * @brief Reads a string stored with a fixed number of bytes, the string ends at the first null character of the bytes.
+	 * @param length Number of bytes used by the string on the file.
+	 * @param out String read.
+	 * @return true on success.
+	 */
+	bool ReadString(std::uint64_t length, std::string& out);
+
+	// Skips the next bytes of the file
+	bool Skip(std::uint64_t size) { return Advance(size); }
+
+private:
+	std::vector<char> m_buffer;	// empty when reading a view
+	const char* m_data;
+	std::size_t m_size;
+	std::size_t m_position;
+	bool m_good;
+
+	bool Advance(std::uint64_t size)
+	{
+		if (!m_good || size > static_cast<std::uint64_t>(m_size - m_position))
+		{
+			m_good = false;
+			return false;
+		}
+
+		m_position += static_cast<std::size_t>(size);
+		return true;
+	}
+};
+
+#endif // !NAV_FILE_READER_H_
@@ -0,0 +1,147 @@
+#include <string>
+
+#include <extension.h>
+#include <tier1/checksum_crc.h>
+#include "nav_filesections.h"
+
+bool CNavFileSectionTable::Read(CNavFileReader& file)
+{
+	m_entries.clear();
+
+	std::uint32_t count = 0U;
+
+	if (!file.Read(count) || count > file.GetBytesLeft() / sizeof(NavFileSectionEntry))
+	{
+		return false;
+	}
+
+	m_entries.resize(count);
+
+	if (count > 0U && !file.ReadBytes(m_entries.data(), sizeof(NavFileSectionEntry) * m_entries.size()))
+	{
+		return false;
+	}
+
+	const std::uint64_t filesize = static_cast<std::uint64_t>(file.GetSize());
+
+	for (const NavFileSectionEntry& entry : m_entries)
+	{
+		if (entry.offset > filesize || entry.size > filesize - entry.offset)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const NavFileSectionEntry* CNavFileSectionTable::Find(NavFileSectionID id) const
+{
+	for (const NavFileSectionEntry& entry : m_entries)
+	{
+		if (entry.id == id)
+		{
+			return &entry;
+		}
+	}
+
+	return nullptr;
+}
+
+NavErrorType CNavFileSectionTable::Open(const CNavFileReader& file, const NavFileSectionEntry& entry, CNavFileReader& section)
+{
+	section.Close();
+
+	if (entry.compression != NavFileSectionCompression::COMPRESSION_NONE)
+	{
+		return NAV_BAD_FILE_VERSION;
+	}
+
+	// bounds were checked when the table was read
+	const char* data = file.GetData() + static_cast<std::size_t>(entry.offset);
+	const std::size_t size = static_cast<std::size_t>(entry.size);
+
+	if (entry.rawSize != entry.size || CRC32_ProcessSingleBuffer(data, static_cast<int>(size)) != entry.crc)
+	{
+		return NAV_CORRUPT_DATA;
+	}
+
+	section.OpenView(data, size);
+	return NAV_OK;
+}
+
+const char* CNavFileSectionTable::GetName(NavFileSectionID id)
+{
+	switch (id)
+	{
+	case NavFileSectionID::SECTION_MESH:
+		return "mesh";
+	case NavFileSectionID::SECTION_AUTHOR:
+		return "author";
+	case NavFileSectionID::SECTION_WAYPOINTS:
+		return "waypoints";
+	case NavFileSectionID::SECTION_VOLUMES:
+		return "volumes";
+	case NavFileSectionID::SECTION_ELEVATORS:
+		return "elevators";
+	case NavFileSectionID::SECTION_PREREQUISITES:
+		return "prerequisites";
+	case NavFileSectionID::SECTION_PLACES:
+		return "places";
+	case NavFileSectionID::SECTION_CUSTOM_PRE_AREA:
+		return "custom pre area";
+	case NavFileSectionID::SECTION_AREAS:
+		return "areas";
+	case NavFileSectionID::SECTION_LADDERS:
+		return "ladders";
+	case NavFileSectionID::SECTION_CUSTOM:
+		return "custom";
+	case NavFileSectionID::SECTION_LANDMARKS:
+		return "landmarks";
+	case NavFileSectionID::SECTION_AREA_INDEX:
+		return "area index";
+	default:
+		return "unknown";
+	}
+}
+
+std::ostream& CNavFileSectionWriter::BeginSection(NavFileSectionID id, std::uint32_t flags)
+{
+	return m_sections.emplace_back(std::make_unique<Section>(id, flags))->data;
+}
+
+void CNavFileSectionWriter::Write(std::ostream& file, std::uint64_t base) const
+{
+	std::vector<std::string> sections;
+	std::vector<NavFileSectionEntry> entries;
+	sections.reserve(m_sections.size());
+	entries.reserve(m_sections.size());
+
+	// the sections are stored right after the table
+	std::uint64_t offset = base + sizeof(std::uint32_t) + sizeof(NavFileSectionEntry) * m_sections.size();
+
+	for (auto& section : m_sections)
+	{
+		const std::string& data = sections.emplace_back(section->data.str());
+
+		NavFileSectionEntry& entry = entries.emplace_back();
+		entry.id = section->id;
+		entry.flags = section->flags;
+		entry.compression = NavFileSectionCompression::COMPRESSION_NONE;
+		entry.crc = CRC32_ProcessSingleBuffer(data.data(), static_cast<int>(data.size()));
+		entry.offset = offset;
+		entry.size = static_cast<std::uint64_t>(data.size());
+		entry.rawSize = entry.size;
+
+		offset += entry.size;
+	}
+
+	std::uint32_t count = static_cast<std::uint32_t>(entries.size());
+	file.write(reinterpret_cast<char*>(&count), sizeof(std::uint32_t));
+	file.write(reinterpret_cast<const char*>(entries.data()), sizeof(NavFileSectionEntry) * entries.size());
+
+	for (const std::string& data : sections)
+	{
+		file.write(data.data(), data.size());
+	}
+}
@@ -0,0 +1,146 @@
+#ifndef NAV_FILE_SECTIONS_H_
+#define NAV_FILE_SECTIONS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <vector>
+#include "nav.h"
+#include "nav_filereader.h"
+
+/**
+ * @brief Sections of a nav mesh file, used by version 3 and later.
+ *
+ * The file header and the info header are followed by a table of contents with one entry per section: its position, size and
+ * checksum. A section holds the same data older versions stored in sequence. Sections can be stored in any order, a section that
+ * isn't in the file is loaded as empty and sections unknown to the loader are skipped unless flagged as required, so new sections
+ * can be added without breaking older files or older builds.
+ */
+enum class NavFileSectionID : std::uint32_t
+{
+	SECTION_INVALID = 0,
+	SECTION_MESH,				// mesh flags
+	SECTION_AUTHOR,				// creator and editors, only used when editing and saving
+	SECTION_WAYPOINTS,
+	SECTION_VOLUMES,
+	SECTION_ELEVATORS,
+	SECTION_PREREQUISITES,
+	SECTION_PLACES,				// place directory
+	SECTION_CUSTOM_PRE_AREA,	// mod data loaded before the areas
+	SECTION_AREAS,
+	SECTION_LADDERS,
+	SECTION_CUSTOM,				// mod data
+	SECTION_LANDMARKS,
+	SECTION_AREA_INDEX,			// offset of each area in the areas section, allows decoding them in parallel
+
+	MAX_SECTIONS
+};
+
+enum NavFileSectionFlags : std::uint32_t
+{
+	NAV_SECTION_REQUIRED = 0x00000001,		// the file can't be loaded without this section, loaders that don't know it must fail
+};
+
+enum class NavFileSectionCompression : std::uint32_t
+{
+	COMPRESSION_NONE = 0,
+};
+
+/**
+ * @brief Table of contents entry.
+ */
+struct NavFileSectionEntry
+{
+	NavFileSectionID id;
+	std::uint32_t flags;					// NavFileSectionFlags
+	NavFileSectionCompression compression;
+	std::uint32_t crc;						// CRC32 of the stored bytes
+	std::uint64_t offset;					// from the start of the file
+	std::uint64_t size;						// number of bytes stored
+	std::uint64_t rawSize;					// number of bytes after decompression
+};
+
+static_assert(sizeof(NavFileSectionEntry) == 40U, "Changing this will invalidate all existing nav mesh files!");
+
+/**
+ * @brief Section kept as raw bytes when the file was loaded, decoded when first needed.
+ */
+struct NavDeferredSection
+{
+	NavFileSectionID id;
+	std::uint32_t version;
+	std::uint32_t subversion;
+	std::vector<char> data;
+};
+
+/**
+ * @brief Table of contents of a nav mesh file being loaded.
+ */
+class CNavFileSectionTable
+{
+public:
+	/**
+	 * @brief Reads the table of contents.
+	 * @param file Reader of the whole file, at the start of the table.
+	 * @return false if the table is truncated or a section is outside of the file.
+	 */
+	bool Read(CNavFileReader& file);
+	// First entry of the given section or NULL if the file doesn't have it
+	const NavFileSectionEntry* Find(NavFileSectionID id) const;
+	const std::vector<NavFileSectionEntry>& GetEntries() const { return m_entries; }
+
+	/**
+	 * @brief Opens a section for reading, the checksum is tested first.
+	 * @param file Reader of the whole file, must stay open while the section is read.
+	 * @param entry Section to open.
+	 * @param section Reader opened over the section.
+	 * @return NAV_OK on success, NAV_CORRUPT_DATA if the checksum doesn't match and NAV_BAD_FILE_VERSION if the compression
+	 * isn't supported.
+	 */
+	static NavErrorType Open(const CNavFileReader& file, const NavFileSectionEntry& entry, CNavFileReader& section);
+	static bool IsKnown(NavFileSectionID id) { return id > NavFileSectionID::SECTION_INVALID && id < NavFileSectionID::MAX_SECTIONS; }
+	static const char* GetName(NavFileSectionID id);
+
+private:
+	std::vector<NavFileSectionEntry> m_entries;
+};
+
+/**
+ * @brief Collects the sections of a nav mesh file being saved and writes them after their table of contents.
+ */
+class CNavFileSectionWriter
+{
+public:
+	/**
+	 * @brief Starts a new section.
+	 * @param id Section ID.
+	 * @param flags Section flags (NavFileSectionFlags).
+	 * @return Stream the section data is written to, valid until the writer is destroyed.
+	 */
+	std::ostream& BeginSection(NavFileSectionID id, std::uint32_t flags = 0U);
+	/**
+	 * @brief Writes the table of contents followed by every section.
+	 * @param file Stream of the file.
+	 * @param base Position of the table of contents from the start of the file.
+	 */
+	void Write(std::ostream& file, std::uint64_t base) const;
+
+private:
+	struct Section
+	{
+		Section(NavFileSectionID id, std::uint32_t flags) :
+			id(id), flags(flags), data(std::ios_base::out | std::ios_base::binary)
+		{
+		}
+
+		NavFileSectionID id;
+		std::uint32_t flags;
+		std::ostringstream data;
+	};
+
+	std::vector<std::unique_ptr<Section>> m_sections;
+};
+
+#endif // !NAV_FILE_SECTIONS_H_
@@ -0,0 +1,227 @@
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_pathcache.h"
+#include "nav_flowfield.h"
+#include "nav_stats.h"
+
+extern ConVar sm_nav_edit;
+
+ConVar sm_nav_flow_fields("sm_nav_flow_fields", "32", FCVAR_GAMEDLL, "Maximum number of objective flow fields shared by the bots. Zero disables flow fields.", true, 0.0f, false, 0.0f);
+ConVar sm_nav_flow_field_max_age("sm_nav_flow_field_max_age", "30", FCVAR_GAMEDLL, "Number of seconds before a flow field is built again from scratch.", true, 1.0f, false, 0.0f);
+ConVar sm_nav_flow_field_max_idle("sm_nav_flow_field_max_idle", "10", FCVAR_GAMEDLL, "Number of seconds an unused flow field is kept.", true, 0.0f, false, 0.0f);
+
+CNavFlowField::CNavFlowField(const std::vector<CNavArea*>& goals, int teamID, std::size_t costKey) :
+	m_goals(goals)
+{
+	m_graph = nullptr;
+	m_costKey = costKey;
+	m_teamID = teamID;
+	m_graphBuild = 0U;
+	m_generation = 0U;
+	m_lastExpansions = 0U;
+	m_buildTime = 0.0f;
+}
+
+bool CNavFlowField::IsValid() const
+{
+	return m_graph != nullptr && m_graph == TheNavMesh->GetConnectionGraph() && m_graphBuild == m_graph->GetBuildCount();
+}
+
+bool CNavFlowField::BuildPath(CNavArea* startArea, std::vector<NavPathArea>& areas) const
+{
+	areas.clear();
+
+	if (!IsValid() || !CanReachGoal(startArea))
+	{
+		return false;
+	}
+
+	areas.push_back({ startArea, NUM_TRAVERSE_TYPES });
+
+	// costs always decrease along the next hops, the size check only guards against a broken cost functor
+	for (const NavAreaConnection* next = GetNextHop(startArea); next != nullptr; next = GetNextHop(next->to))
+	{
+		if (areas.size() > m_cost.size())
+		{
+			areas.clear();
+			return false;
+		}
+
+		areas.push_back({ next->to, next->how });
+	}
+
+	// the caller wants the goal first
+	std::reverse(areas.begin(), areas.end());
+	return true;
+}
+
+void CNavFlowField::Reset(unsigned int generation)
+{
+	m_graph = TheNavMesh->GetConnectionGraph();
+	m_graphBuild = m_graph->GetBuildCount();
+	m_generation = generation;
+	m_buildTime = gpGlobals->curtime;
+
+	const std::size_t numAreas = m_graph->GetAreaCount();
+	m_cost.assign(numAreas, INFINITE_COST);
+	m_nextHop.assign(numAreas, nullptr);
+	m_blocked.assign(numAreas, 0U);
+	m_dirtyAreas.clear();
+	m_openList.clear();
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		CNavArea* area = TheNavAreas[it];
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+		if (index < numAreas)
+		{
+			m_blocked[index] = area->IsBlocked(m_teamID) ? 1U : 0U;
+		}
+	}
+}
+
+void CNavFlowField::PushOpen(CNavArea* area, float cost)
+{
+	m_openList.push_back({ cost, area });
+	std::push_heap(m_openList.begin(), m_openList.end(), OpenEntryGreater);
+}
+
+void CNavFlowField::CollectChangedAreas()
+{
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		CNavArea* area = TheNavAreas[it];
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+		if (index >= m_blocked.size())
+		{
+			continue;
+		}
+
+		const std::uint8_t blocked = area->IsBlocked(m_teamID) ? 1U : 0U;
+
+		if (blocked != m_blocked[index])
+		{
+			m_blocked[index] = blocked;
+			m_dirtyAreas.push_back(area);
+		}
+	}
+}
+
+CNavFlowFieldManager::CNavFlowFieldManager()
+{
+	ResetStats();
+}
+
+bool CNavFlowFieldManager::IsEnabled() const
+{
+	// areas and connections may change at any time while editing
+	return sm_nav_flow_fields.GetInt() > 0 && !sm_nav_edit.GetBool() && TheNavMesh->GetConnectionGraph()->IsBuilt();
+}
+
+void CNavFlowFieldManager::Invalidate()
+{
+	m_fields.clear();
+}
+
+void CNavFlowFieldManager::MarkAreaDirty(CNavArea* area)
+{
+	for (auto& pair : m_fields)
+	{
+		pair.second.field->MarkAreaDirty(area);
+	}
+}
+
+void CNavFlowFieldManager::ResetStats()
+{
+	m_stats.requests = 0U;
+	m_stats.builds = 0U;
+	m_stats.updates = 0U;
+}
+
+CNavFlowFieldManager::Entry& CNavFlowFieldManager::FindEntry(const std::vector<CNavArea*>& goals, int teamID, std::size_t costKey, bool& created)
+{
+	FieldKey key;
+	key.goals = goals;
+	key.teamID = teamID;
+	key.costKey = costKey;
+
+	// the same goals given in a different order share the field
+	std::sort(key.goals.begin(), key.goals.end());
+	key.goals.erase(std::unique(key.goals.begin(), key.goals.end()), key.goals.end());
+
+	auto it = m_fields.find(key);
+
+	if (it != m_fields.end())
+	{
+		created = false;
+		return it->second;
+	}
+
+	RemoveUnusedFields();
+
+	Entry entry;
+	entry.field = std::make_unique<CNavFlowField>(key.goals, teamID, costKey);
+	entry.lastUsed = gpGlobals->curtime;
+	created = true;
+
+	return m_fields.emplace(std::move(key), std::move(entry)).first->second;
+}
+
+bool CNavFlowFieldManager::NeedsRebuild(const CNavFlowField* field)
+{
+	return !field->IsValid() || gpGlobals->curtime - field->GetBuildTime() > sm_nav_flow_field_max_age.GetFloat();
+}
+
+unsigned int CNavFlowFieldManager::GetCurrentGeneration()
+{
+	// the path cache is invalidated every time the blocked state of an area changes
+	return TheNavMesh->GetPathCache()->GetGeneration();
+}
+
+void CNavFlowFieldManager::RemoveUnusedFields()
+{
+	const float maxIdle = sm_nav_flow_field_max_idle.GetFloat();
+
+	for (auto it = m_fields.begin(); it != m_fields.end();)
+	{
+		if (gpGlobals->curtime - it->second.lastUsed > maxIdle)
+		{
+			it = m_fields.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	// still full, drop the least recently used field
+	if (m_fields.size() >= static_cast<std::size_t>(sm_nav_flow_fields.GetInt()))
+	{
+		auto oldest = std::min_element(m_fields.begin(), m_fields.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.second.lastUsed < rhs.second.lastUsed;
+		});
+
+		if (oldest != m_fields.end())
+		{
+			m_fields.erase(oldest);
+		}
+	}
+}
+
+NAV_STATS_COMMAND(sm_nav_flow_field_stats, "objective flow field")
+{
+	CNavFlowFieldManager* manager = TheNavMesh->GetFlowFields();
+	char details[64];
+	ke::SafeSprintf(details, sizeof(details), ", %i/%i fields", static_cast<int>(manager->GetSize()), sm_nav_flow_fields.GetInt());
+
+	if (!navutils::BeginStatsCommand(args, "Flow field", manager, details))
+	{
+		return;
+	}
+
+	const CNavFlowFieldManager::Stats& stats = manager->GetStats();
+
+	Msg("  Requests: %u  Builds: %u  Incremental updates: %u\n", stats.requests, stats.builds, stats.updates);
+}
@@ -0,0 +1,413 @@
+#ifndef NAV_FLOW_FIELD_H_
+#define NAV_FLOW_FIELD_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "nav.h"
+#include "nav_area.h"
+#include "nav_connections.h"
+#include "nav_pathcache.h"
+
+// undef valve mathlib stuff so we can use std version
+#undef max
+#undef min
+#undef clamp
+
+/**
+ * @brief Travel cost from every area to the nearest of a set of goal areas, with the connection to take next.
+ *
+ * Built with a reverse Dijkstra search from the goal areas over the incoming connections of the connection graph. Any bot of the
+ * team can build a path to the goal by following the next hops from its area, no search needed.
+ * When the blocked state of areas changes, only the areas whose route passed through the changed areas are searched again.
+ */
+class CNavFlowField
+{
+public:
+	static constexpr float INFINITE_COST = CNavConnectionGraph::INFINITE_COST;
+
+	CNavFlowField(const std::vector<CNavArea*>& goals, int teamID, std::size_t costKey);
+
+	CNavFlowField(const CNavFlowField&) = delete;
+	CNavFlowField& operator=(const CNavFlowField&) = delete;
+
+	const std::vector<CNavArea*>& GetGoals() const { return m_goals; }
+	int GetTeam() const { return m_teamID; }
+	std::size_t GetCostKey() const { return m_costKey; }
+	// Time the field was built from scratch
+	float GetBuildTime() const { return m_buildTime; }
+	// Number of areas searched by the last build or update
+	unsigned int GetLastExpansionCount() const { return m_lastExpansions; }
+	// true if the field was built with the current connection graph
+	bool IsValid() const;
+
+	// Travel cost from the area to the nearest goal, infinite if the goals can't be reached
+	float GetTravelCost(const CNavArea* area) const
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+		return index < m_cost.size() ? m_cost[index] : INFINITE_COST;
+	}
+
+	// Connection to take from the area towards the nearest goal, NULL on the goal areas and on areas that can't reach them
+	const NavAreaConnection* GetNextHop(const CNavArea* area) const
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+		return index < m_nextHop.size() ? m_nextHop[index] : nullptr;
+	}
+
+	bool CanReachGoal(const CNavArea* area) const { return GetTravelCost(area) != INFINITE_COST; }
+
+	/**
+	 * @brief Builds the path from an area to the nearest goal by following the next hops.
+	 * @param startArea Area the path starts at.
+	 * @param areas Stores the path areas, goal area first.
+	 * @return true if a goal can be reached from the area.
+	 */
+	bool BuildPath(CNavArea* startArea, std::vector<NavPathArea>& areas) const;
+
+	/**
+	 * @brief Computes the field from scratch.
+	 * @tparam CostFunctor Path cost functor.
+	 * @param costFunc Path cost functor, must match the cost key of the field.
+	 * @param generation Path cache generation, see CNavPathCache::GetGeneration.
+	 */
+	template <typename CostFunctor>
+	void Build(const CostFunctor& costFunc, unsigned int generation);
+
+	/**
+	 * @brief Searches again the areas whose route may have changed since the last build or update.
+	 * The blocked state of every area is checked when the generation changed, plus the areas marked with MarkAreaDirty.
+	 * @tparam CostFunctor Path cost functor.
+	 * @param costFunc Path cost functor, must match the cost key of the field.
+	 * @param generation Path cache generation, see CNavPathCache::GetGeneration.
+	 */
+	template <typename CostFunctor>
+	void Update(const CostFunctor& costFunc, unsigned int generation);
+
+	// The costs of the connections of this area changed
+	void MarkAreaDirty(CNavArea* area) { m_dirtyAreas.push_back(area); }
+
+private:
+	struct OpenEntry
+	{
+		float cost;
+		CNavArea* area;
+	};
+
+	// min heap ordering of the open list
+	static bool OpenEntryGreater(const OpenEntry& lhs, const OpenEntry& rhs) { return lhs.cost > rhs.cost; }
+
+	std::vector<CNavArea*> m_goals;
+	std::vector<float> m_cost;								// indexed by area search index
+	std::vector<const NavAreaConnection*> m_nextHop;		// indexed by area search index
+	std::vector<std::uint8_t> m_blocked;					// blocked state of each area when the field was last updated
+	std::vector<CNavArea*> m_dirtyAreas;
+	std::vector<OpenEntry> m_openList;						// min heap
+	const CNavConnectionGraph* m_graph;
+	std::size_t m_costKey;
+	int m_teamID;
+	unsigned int m_graphBuild;
+	unsigned int m_generation;								// path cache generation when the blocked states were last checked
+	unsigned int m_lastExpansions;
+	float m_buildTime;
+
+	void Reset(unsigned int generation);
+	void PushOpen(CNavArea* area, float cost);
+	// Adds the areas whose blocked state changed to the dirty areas
+	void CollectChangedAreas();
+
+	// Runs the search until the open list is empty
+	template <typename CostFunctor>
+	void Propagate(const CostFunctor& costFunc);
+	// Computes the cost of an area from its outgoing connections
+	template <typename CostFunctor>
+	void Relax(CNavArea* area, const CostFunctor& costFunc);
+};
+
+/**
+ * @brief Flow fields shared by the bots going to the same objective.
+ *
+ * Fields are identified by the goal areas, the team and the cost function key (see IPathCost::GetPathCacheKey). They are updated
+ * when they're requested, rebuilt from scratch after some time to cover cost changes they aren't told about and removed when
+ * they haven't been used for a while. Game thread only.
+ */
+class CNavFlowFieldManager
+{
+public:
+	CNavFlowFieldManager();
+
+	CNavFlowFieldManager(const CNavFlowFieldManager&) = delete;
+	CNavFlowFieldManager& operator=(const CNavFlowFieldManager&) = delete;
+
+	struct Stats
+	{
+		unsigned int requests;
+		unsigned int builds;
+		unsigned int updates;
+	};
+
+	bool IsEnabled() const;
+
+	/**
+	 * @brief Gets the flow field to a set of goal areas, building or updating it if needed.
+	 * @tparam CostFunctor Path cost functor.
+	 * @param goals Goal areas.
+	 * @param teamID Team used to check for blocked areas.
+	 * @param costFunc Path cost functor.
+	 * @param costKey Cost functor type and parameters, see IPathCost::GetPathCacheKey.
+	 * @return Flow field or NULL if flow fields are not available. The field remains valid until the next call.
+	 */
+	template <typename CostFunctor>
+	const CNavFlowField* GetFlowField(const std::vector<CNavArea*>& goals, int teamID, const CostFunctor& costFunc, std::size_t costKey);
+
+	// Removes all fields, called when the costs of many areas changed
+	void Invalidate();
+	// The costs of the connections of this area changed
+	void MarkAreaDirty(CNavArea* area);
+
+	std::size_t GetSize() const { return m_fields.size(); }
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats();
+
+private:
+	struct FieldKey
+	{
+		std::vector<CNavArea*> goals;
+		int teamID;
+		std::size_t costKey;
+
+		bool operator==(const FieldKey& other) const
+		{
+			return teamID == other.teamID && costKey == other.costKey && goals == other.goals;
+		}
+	};
+
+	struct KeyHasher
+	{
+		std::size_t operator()(const FieldKey& key) const
+		{
+			std::size_t seed = 0U;
+			NavHashCombineValue(seed, key.teamID);
+			NavHashCombine(seed, key.costKey);
+
+			for (CNavArea* area : key.goals)
+			{
+				NavHashCombineValue(seed, area);
+			}
+
+			return seed;
+		}
+	};
+
+	struct Entry
+	{
+		std::unique_ptr<CNavFlowField> field;
+		float lastUsed;
+	};
+
+	std::unordered_map<FieldKey, Entry, KeyHasher> m_fields;
+	Stats m_stats;
+
+	// Finds or creates the entry
+	Entry& FindEntry(const std::vector<CNavArea*>& goals, int teamID, std::size_t costKey, bool& created);
+	// true if the field must be built from scratch
+	static bool NeedsRebuild(const CNavFlowField* field);
+	static unsigned int GetCurrentGeneration();
+	// Removes fields not used for a while
+	void RemoveUnusedFields();
+};
+
+template <typename CostFunctor>
+inline void CNavFlowField::Build(const CostFunctor& costFunc, unsigned int generation)
+{
+	Reset(generation);
+
+	for (CNavArea* goal : m_goals)
+	{
+		const std::size_t index = static_cast<std::size_t>(goal->GetSearchIndex());
+
+		if (index < m_cost.size() && !goal->IsBlocked(m_teamID))
+		{
+			m_cost[index] = 0.0f;
+			PushOpen(goal, 0.0f);
+		}
+	}
+
+	m_lastExpansions = 0U;
+	Propagate(costFunc);
+}
+
+template <typename CostFunctor>
+inline void CNavFlowField::Update(const CostFunctor& costFunc, unsigned int generation)
+{
+	m_lastExpansions = 0U;
+
+	if (generation != m_generation)
+	{
+		m_generation = generation;
+		CollectChangedAreas();
+	}
+
+	if (m_dirtyAreas.empty())
+	{
+		return;
+	}
+
+	std::vector<std::uint8_t> invalid(m_cost.size(), 0U);
+	std::vector<CNavArea*> stack;
+
+	// the areas routed through a changed area may now have a higher cost, forget them
+	for (CNavArea* area : m_dirtyAreas)
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+		if (index < invalid.size() && invalid[index] == 0U)
+		{
+			invalid[index] = 1U;
+			stack.push_back(area);
+		}
+	}
+
+	std::vector<CNavArea*> invalidAreas;
+
+	while (!stack.empty())
+	{
+		CNavArea* area = stack.back();
+		stack.pop_back();
+		invalidAreas.push_back(area);
+
+		m_cost[area->GetSearchIndex()] = INFINITE_COST;
+		m_nextHop[area->GetSearchIndex()] = nullptr;
+
+		m_graph->ForEachIncomingConnection(area, [this, area, &invalid, &stack](const NavAreaConnection& connection) {
+			const std::size_t index = static_cast<std::size_t>(connection.from->GetSearchIndex());
+
+			if (invalid[index] == 0U && m_nextHop[index] != nullptr && m_nextHop[index]->to == area)
+			{
+				invalid[index] = 1U;
+				stack.push_back(connection.from);
+			}
+		});
+	}
+
+	// compute the forgotten areas from the areas around them, then let the changes spread
+	for (CNavArea* area : invalidAreas)
+	{
+		Relax(area, costFunc);
+	}
+
+	m_dirtyAreas.clear();
+	Propagate(costFunc);
+}
+
+template <typename CostFunctor>
+inline void CNavFlowField::Relax(CNavArea* area, const CostFunctor& costFunc)
+{
+	const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+	for (CNavArea* goal : m_goals)
+	{
+		if (goal == area)
+		{
+			if (!area->IsBlocked(m_teamID))
+			{
+				m_cost[index] = 0.0f;
+				m_nextHop[index] = nullptr;
+				PushOpen(area, 0.0f);
+			}
+
+			return;
+		}
+	}
+
+	m_graph->ForEachOutgoingConnection(area, [this, index, &costFunc](const NavAreaConnection& connection) {
+		const float nextCost = m_cost[connection.to->GetSearchIndex()];
+
+		if (nextCost == INFINITE_COST)
+		{
+			return;
+		}
+
+		const float cost = nextCost + CNavConnectionGraph::GetConnectionCost(connection, costFunc, m_teamID);
+
+		if (cost < m_cost[index])
+		{
+			m_cost[index] = cost;
+			m_nextHop[index] = &connection;
+		}
+	});
+
+	if (m_cost[index] != INFINITE_COST)
+	{
+		PushOpen(area, m_cost[index]);
+	}
+}
+
+template <typename CostFunctor>
+inline void CNavFlowField::Propagate(const CostFunctor& costFunc)
+{
+	while (!m_openList.empty())
+	{
+		std::pop_heap(m_openList.begin(), m_openList.end(), OpenEntryGreater);
+		const OpenEntry current = m_openList.back();
+		m_openList.pop_back();
+
+		if (current.cost > m_cost[current.area->GetSearchIndex()])
+		{
+			continue; // stale entry
+		}
+
+		m_lastExpansions++;
+
+		// walking the connections backwards, the cost of 'from' is the cost of this area plus the connection
+		m_graph->ForEachIncomingConnection(current.area, [this, &current, &costFunc](const NavAreaConnection& connection) {
+			const std::size_t index = static_cast<std::size_t>(connection.from->GetSearchIndex());
+			const float cost = current.cost + CNavConnectionGraph::GetConnectionCost(connection, costFunc, m_teamID);
+
+			if (cost < m_cost[index])
+			{
+				m_cost[index] = cost;
+				m_nextHop[index] = &connection;
+				PushOpen(connection.from, cost);
+			}
+		});
+	}
+}
+
+template <typename CostFunctor>
+inline const CNavFlowField* CNavFlowFieldManager::GetFlowField(const std::vector<CNavArea*>& goals, int teamID, const CostFunctor& costFunc, std::size_t costKey)
+{
+	if (!IsEnabled() || goals.empty())
+	{
+		return nullptr;
+	}
+
+	m_stats.requests++;
+
+	const unsigned int generation = GetCurrentGeneration();
+	bool created = false;
+	Entry& entry = FindEntry(goals, teamID, costKey, created);
+	entry.lastUsed = gpGlobals->curtime;
+
+	if (created || NeedsRebuild(entry.field.get()))
+	{
+		entry.field->Build(costFunc, generation);
+		m_stats.builds++;
+	}
+	else
+	{
+		entry.field->Update(costFunc, generation);
+
+		if (entry.field->GetLastExpansionCount() > 0U)
+		{
+			m_stats.updates++;
+		}
+	}
+
+	return entry.field.get();
+}
+
+#endif // !NAV_FLOW_FIELD_H_
@@ -1191,7 +1191,7 @@ void CNavMesh::RemoveOverlappingObstacleTopAreas()
 
 static void CommandNavCheckStairs( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->MarkStairAreas();
@@ -1402,7 +1402,7 @@ bool CNavArea::TestStairs( void )
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_test_stairs, "Test the selected set for being on stairs", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	int count = 0;
@@ -4543,7 +4543,7 @@ void CNavMesh::CommandNavSubdivide( const CCommand &args )
 
 CON_COMMAND_F(sm_nav_subdivide, "Subdivides all selected areas.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSubdivide( args );
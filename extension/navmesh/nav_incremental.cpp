@@ -0,0 +1,209 @@
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_landmarks.h"
+#include "nav_incremental.h"
+
+CNavIncrementalSearch::CNavIncrementalSearch()
+{
+	m_graph = nullptr;
+	m_landmarks = nullptr;
+	m_rootArea = nullptr;
+	m_goalArea = nullptr;
+	m_goalCenter = vec3_origin;
+	m_costKey = 0U;
+	m_teamID = NAV_TEAM_ANY;
+	m_marker = 1U;
+	m_graphBuild = 0U;
+	m_cacheGeneration = 0U;
+	m_expansions = 0U;
+	m_maxExpansions = 0U;
+	m_lastExpansions = 0U;
+}
+
+void CNavIncrementalSearch::Reset()
+{
+	m_rootArea = nullptr;
+	m_goalArea = nullptr;
+	m_openList.clear();
+	m_path.clear();
+
+	if (++m_marker == 0U)
+	{
+		// markers wrapped around, clear the old markers
+		for (Node& node : m_nodes)
+		{
+			node.marker = 0U;
+		}
+
+		m_marker = 1U;
+	}
+}
+
+bool CNavIncrementalSearch::IsAvailable()
+{
+	return TheNavMesh->GetConnectionGraph()->IsBuilt();
+}
+
+bool CNavIncrementalSearch::IsSearchable(const CNavArea* area) const
+{
+	return static_cast<std::size_t>(area->GetSearchIndex()) < TheNavMesh->GetConnectionGraph()->GetAreaCount();
+}
+
+bool CNavIncrementalSearch::IsTreeValid(std::size_t costKey, int teamID) const
+{
+	return m_graph == TheNavMesh->GetConnectionGraph() && m_graphBuild == m_graph->GetBuildCount() && m_cacheGeneration == TheNavMesh->GetPathCache()->GetGeneration() &&
+		m_costKey == costKey && m_teamID == teamID;
+}
+
+void CNavIncrementalSearch::Restart(CNavArea* rootArea, std::size_t costKey, int teamID)
+{
+	Reset();
+
+	m_graph = TheNavMesh->GetConnectionGraph();
+	m_graphBuild = m_graph->GetBuildCount();
+	m_cacheGeneration = TheNavMesh->GetPathCache()->GetGeneration();
+	m_costKey = costKey;
+	m_teamID = teamID;
+	m_rootArea = rootArea;
+
+	if (m_nodes.size() != m_graph->GetAreaCount())
+	{
+		Node empty{};
+		empty.marker = 0U;
+		m_nodes.assign(m_graph->GetAreaCount(), empty);
+	}
+
+	// enough to expand every area a few times, more than that means the cost functor isn't stable
+	m_maxExpansions = static_cast<unsigned int>(m_nodes.size()) * 4U + 64U;
+
+	Node& root = GetNode(rootArea);
+	root.rhs = 0.0f;
+	PushOpen(rootArea, root);
+}
+
+void CNavIncrementalSearch::SetGoal(CNavArea* goalArea)
+{
+	if (goalArea == m_goalArea)
+	{
+		return;
+	}
+
+	m_goalArea = goalArea;
+	m_goalCenter = goalArea->GetCenter();
+	m_landmarks = TheNavMesh->GetLandmarks()->IsBuilt() ? TheNavMesh->GetLandmarks() : nullptr;
+
+	// the heuristic changed
+	RebuildOpenList();
+}
+
+float CNavIncrementalSearch::GetHeuristic(const CNavArea* area) const
+{
+	if (m_goalArea == nullptr)
+	{
+		return 0.0f;
+	}
+
+	const float distance = (area->GetCenter() - m_goalCenter).Length();
+
+	if (m_landmarks != nullptr)
+	{
+		return std::max(distance, m_landmarks->GetLowerBound(area, m_goalArea));
+	}
+
+	return distance;
+}
+
+void CNavIncrementalSearch::PushOpen(CNavArea* area, Node& node)
+{
+	node.openVersion++;
+	node.open = true;
+
+	const Key key = CalculateKey(area, node);
+	m_openList.push_back({ key.k1, key.k2, area, node.openVersion });
+	std::push_heap(m_openList.begin(), m_openList.end(), OpenEntryGreater);
+}
+
+void CNavIncrementalSearch::RemoveOpen(Node& node)
+{
+	if (node.open)
+	{
+		node.open = false;
+		node.openVersion++;
+	}
+}
+
+bool CNavIncrementalSearch::PruneOpenList()
+{
+	while (!m_openList.empty())
+	{
+		const OpenEntry& top = m_openList.front();
+		const Node* node = FindNode(top.area);
+
+		if (node != nullptr && node->open && node->openVersion == top.version)
+		{
+			return true;
+		}
+
+		std::pop_heap(m_openList.begin(), m_openList.end(), OpenEntryGreater);
+		m_openList.pop_back();
+	}
+
+	return false;
+}
+
+void CNavIncrementalSearch::RebuildOpenList()
+{
+	std::size_t count = 0U;
+
+	for (const OpenEntry& entry : m_openList)
+	{
+		const Node* node = FindNode(entry.area);
+
+		if (node != nullptr && node->open && node->openVersion == entry.version)
+		{
+			const Key key = CalculateKey(entry.area, *node);
+			m_openList[count++] = { key.k1, key.k2, entry.area, entry.version };
+		}
+	}
+
+	m_openList.resize(count);
+	std::make_heap(m_openList.begin(), m_openList.end(), OpenEntryGreater);
+}
+
+bool CNavIncrementalSearch::BuildPath()
+{
+	m_path.clear();
+
+	const Node* goal = FindNode(m_goalArea);
+
+	if (goal == nullptr || goal->g == INFINITE_COST)
+	{
+		return false;
+	}
+
+	CNavArea* area = m_goalArea;
+
+	// the parents form a tree, the size check only guards against a broken cost functor
+	while (m_path.size() <= m_nodes.size())
+	{
+		const Node* node = FindNode(area);
+
+		if (area == m_rootArea)
+		{
+			m_path.push_back({ area, NUM_TRAVERSE_TYPES });
+			std::reverse(m_path.begin(), m_path.end());
+			return true;
+		}
+
+		if (node == nullptr || node->parent == nullptr)
+		{
+			break;
+		}
+
+		m_path.push_back({ area, node->parent->how });
+		area = node->parent->from;
+	}
+
+	m_path.clear();
+	return false;
+}
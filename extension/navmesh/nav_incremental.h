@@ -0,0 +1,400 @@
+#ifndef NAV_INCREMENTAL_H_
+#define NAV_INCREMENTAL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "nav.h"
+#include "nav_area.h"
+#include "nav_connections.h"
+#include "nav_pathcache.h"
+#include "nav_search_context.h"
+
+// undef valve mathlib stuff so we can use std version
+#undef max
+#undef min
+#undef clamp
+
+class CNavLandmarks;
+
+/**
+ * @brief Lifelong Planning A* (LPA*) path search that keeps its search tree between calls.
+ *
+ * The tree is rooted at the area where the first search started. When the goal area changes, only the areas between the old and
+ * the new goal are searched. The connections of the returned path are checked with the cost functor on every call; the ones with
+ * a different cost (blocked areas, elevators, ...) are repaired, which only searches the areas whose costs depend on them.
+ * The bot moving along the path doesn't invalidate the tree: the path to the goal is cut at the bot's area as long as it passes
+ * through it, otherwise the tree is rebuilt from the bot's area.
+ *
+ * Connections that became cheaper away from the path are only noticed when the tree is rebuilt, so the tree is also rebuilt when
+ * the path cache generation changes (areas blocked or unblocked, nav volumes, elevator floors, func_nav_cost). Game thread only.
+ */
+class CNavIncrementalSearch
+{
+public:
+	CNavIncrementalSearch();
+
+	// Discards the search tree, the next search starts from scratch
+	void Reset();
+
+	// true if the nav mesh has the data needed by incremental searches (not available while editing)
+	static bool IsAvailable();
+
+	/**
+	 * @brief Finds the shortest path between two areas, reusing the previous searches.
+	 * @tparam CostFunctor Path cost functor.
+	 * @param startArea Area the path starts at.
+	 * @param goalArea Goal area.
+	 * @param costFunc Path cost functor.
+	 * @param costKey Cost functor type and parameters, see IPathCost::GetPathCacheKey. The tree is rebuilt when it changes.
+	 * @param teamID Team used to check for blocked areas.
+	 * @param areas Stores the path areas, goal area first.
+	 * @return true if a path was found.
+	 */
+	template <typename CostFunctor>
+	bool FindPath(CNavArea* startArea, CNavArea* goalArea, const CostFunctor& costFunc, std::size_t costKey, int teamID, std::vector<NavPathArea>& areas);
+
+	// Number of areas expanded by the last call to FindPath
+	unsigned int GetLastExpansionCount() const { return m_lastExpansions; }
+
+private:
+	static constexpr float INFINITE_COST = CNavConnectionGraph::INFINITE_COST;
+	static constexpr int MAX_PATH_REPAIRS = 8;				// rebuild the tree if the path still changes after this many repairs
+
+	struct Node
+	{
+		float g;											// cost from the root, valid once the node was expanded
+		float rhs;											// cost from the root through the best parent
+		float parentCost;									// cost of the connection from the parent when rhs was computed
+		const NavAreaConnection* parent;					// best connection into this area
+		unsigned int marker;								// node is part of the tree if equal to m_marker
+		unsigned int openVersion;							// open list entries with a different version are stale
+		bool open;
+	};
+
+	struct OpenEntry
+	{
+		float k1;
+		float k2;
+		CNavArea* area;
+		unsigned int version;
+	};
+
+	struct Key
+	{
+		float k1;
+		float k2;
+
+		bool operator<(const Key& other) const { return k1 < other.k1 || (k1 == other.k1 && k2 < other.k2); }
+	};
+
+	// min heap ordering of the open list
+	static bool OpenEntryGreater(const OpenEntry& lhs, const OpenEntry& rhs) { return Key{ rhs.k1, rhs.k2 } < Key{ lhs.k1, lhs.k2 }; }
+
+	std::vector<Node> m_nodes;								// indexed by area search index
+	std::vector<OpenEntry> m_openList;						// min heap
+	std::vector<NavPathArea> m_path;						// last path found, root first
+	const CNavConnectionGraph* m_graph;
+	const CNavLandmarks* m_landmarks;
+	CNavArea* m_rootArea;
+	CNavArea* m_goalArea;
+	Vector m_goalCenter;
+	std::size_t m_costKey;
+	int m_teamID;
+	unsigned int m_marker;
+	unsigned int m_graphBuild;
+	unsigned int m_cacheGeneration;							// path cache generation when the tree was built
+	unsigned int m_expansions;
+	unsigned int m_maxExpansions;
+	unsigned int m_lastExpansions;
+
+	// true if the area existed when the connection graph was built
+	bool IsSearchable(const CNavArea* area) const;
+	// true if the tree was built with the current connection graph and path cache generation, and the given cost functor and team
+	bool IsTreeValid(std::size_t costKey, int teamID) const;
+	// Discards the tree and starts a new one from the given area
+	void Restart(CNavArea* rootArea, std::size_t costKey, int teamID);
+	void SetGoal(CNavArea* goalArea);
+
+	Node& GetNode(const CNavArea* area)
+	{
+		Node& node = m_nodes[area->GetSearchIndex()];
+
+		if (node.marker != m_marker)
+		{
+			node.g = INFINITE_COST;
+			node.rhs = INFINITE_COST;
+			node.parentCost = 0.0f;
+			node.parent = nullptr;
+			node.marker = m_marker;
+			node.open = false;
+		}
+
+		return node;
+	}
+
+	const Node* FindNode(const CNavArea* area) const
+	{
+		const Node& node = m_nodes[area->GetSearchIndex()];
+		return node.marker == m_marker ? &node : nullptr;
+	}
+
+	float GetHeuristic(const CNavArea* area) const;
+	Key CalculateKey(const CNavArea* area, const Node& node) const
+	{
+		const float cost = std::min(node.g, node.rhs);
+		return { cost + GetHeuristic(area), cost };
+	}
+
+	// Adds the node to the open list or updates its key
+	void PushOpen(CNavArea* area, Node& node);
+	void RemoveOpen(Node& node);
+	// Removes stale entries from the top of the open list, returns false if empty
+	bool PruneOpenList();
+	// Recomputes the keys of the open list after the heuristic changed
+	void RebuildOpenList();
+	// Follows the parents from the goal to the root, returns false if the goal wasn't reached
+	bool BuildPath();
+
+	template <typename CostFunctor>
+	float GetConnectionCost(const NavAreaConnection& connection, const CostFunctor& costFunc) const;
+	template <typename CostFunctor>
+	void UpdateArea(CNavArea* area, const CostFunctor& costFunc);
+	template <typename CostFunctor>
+	bool ComputeShortestPath(const CostFunctor& costFunc);
+	template <typename CostFunctor>
+	bool RepairPath(const CostFunctor& costFunc);
+	template <typename CostFunctor>
+	bool Search(const CostFunctor& costFunc);
+};
+
+template <typename CostFunctor>
+inline float CNavIncrementalSearch::GetConnectionCost(const NavAreaConnection& connection, const CostFunctor& costFunc) const
+{
+	return CNavConnectionGraph::GetConnectionCost(connection, costFunc, m_teamID);
+}
+
+template <typename CostFunctor>
+inline void CNavIncrementalSearch::UpdateArea(CNavArea* area, const CostFunctor& costFunc)
+{
+	Node& node = GetNode(area);
+
+	if (area != m_rootArea)
+	{
+		node.rhs = INFINITE_COST;
+		node.parent = nullptr;
+
+		m_graph->ForEachIncomingConnection(area, [this, &node, &costFunc](const NavAreaConnection& connection) {
+			const Node* from = FindNode(connection.from);
+
+			if (from == nullptr || from->g == INFINITE_COST)
+			{
+				return;
+			}
+
+			const float cost = GetConnectionCost(connection, costFunc);
+
+			if (from->g + cost < node.rhs)
+			{
+				node.rhs = from->g + cost;
+				node.parentCost = cost;
+				node.parent = &connection;
+			}
+		});
+	}
+
+	if (node.g != node.rhs)
+	{
+		PushOpen(area, node);
+	}
+	else
+	{
+		RemoveOpen(node);
+	}
+}
+
+template <typename CostFunctor>
+inline bool CNavIncrementalSearch::ComputeShortestPath(const CostFunctor& costFunc)
+{
+	while (PruneOpenList())
+	{
+		const Node& goal = GetNode(m_goalArea);
+		const OpenEntry& top = m_openList.front();
+
+		if (!(Key{ top.k1, top.k2 } < CalculateKey(m_goalArea, goal)) && goal.rhs == goal.g)
+		{
+			break;
+		}
+
+		if (++m_expansions > m_maxExpansions)
+		{
+			return false; // broken cost functor, let the caller rebuild the tree
+		}
+
+		CNavArea* area = top.area;
+		std::pop_heap(m_openList.begin(), m_openList.end(), OpenEntryGreater);
+		m_openList.pop_back();
+
+		Node& node = GetNode(area);
+		RemoveOpen(node);
+
+		if (node.g > node.rhs)
+		{
+			// cost decreased, the areas after this one may now be reached with a lower cost
+			node.g = node.rhs;
+			const float g = node.g;
+
+			m_graph->ForEachOutgoingConnection(area, [this, g, &costFunc](const NavAreaConnection& connection) {
+				if (connection.to == m_rootArea)
+				{
+					return;
+				}
+
+				Node& next = GetNode(connection.to);
+				const float cost = GetConnectionCost(connection, costFunc);
+
+				if (g + cost < next.rhs)
+				{
+					next.rhs = g + cost;
+					next.parentCost = cost;
+					next.parent = &connection;
+					PushOpen(connection.to, next);
+				}
+			});
+		}
+		else
+		{
+			// cost increased, the areas reached through this one must find another parent
+			node.g = INFINITE_COST;
+			UpdateArea(area, costFunc);
+
+			m_graph->ForEachOutgoingConnection(area, [this, area, &costFunc](const NavAreaConnection& connection) {
+				const Node* next = FindNode(connection.to);
+
+				if (next != nullptr && next->parent != nullptr && next->parent->from == area)
+				{
+					UpdateArea(connection.to, costFunc);
+				}
+			});
+		}
+	}
+
+	return true;
+}
+
+template <typename CostFunctor>
+inline bool CNavIncrementalSearch::RepairPath(const CostFunctor& costFunc)
+{
+	bool repaired = false;
+
+	// the first entry is the root
+	for (std::size_t i = 1U; i < m_path.size(); i++)
+	{
+		CNavArea* area = m_path[i].area;
+		const Node& node = GetNode(area);
+		const float cost = GetConnectionCost(*node.parent, costFunc);
+
+		if (std::fabs(cost - node.parentCost) > 0.001f * std::max(1.0f, node.parentCost))
+		{
+			UpdateArea(area, costFunc);
+			repaired = true;
+		}
+	}
+
+	return repaired;
+}
+
+template <typename CostFunctor>
+inline bool CNavIncrementalSearch::Search(const CostFunctor& costFunc)
+{
+	for (int repairs = 0; repairs < MAX_PATH_REPAIRS; repairs++)
+	{
+		if (!ComputeShortestPath(costFunc))
+		{
+			Reset();
+			return false;
+		}
+
+		if (!BuildPath())
+		{
+			return false;
+		}
+
+		if (!RepairPath(costFunc))
+		{
+			return true;
+		}
+	}
+
+	// costs keep changing, don't trust the tree
+	Reset();
+	return false;
+}
+
+template <typename CostFunctor>
+inline bool CNavIncrementalSearch::FindPath(CNavArea* startArea, CNavArea* goalArea, const CostFunctor& costFunc, std::size_t costKey, int teamID, std::vector<NavPathArea>& areas)
+{
+	areas.clear();
+	m_expansions = 0U;
+	m_lastExpansions = 0U;
+
+	if (!IsAvailable())
+	{
+		Reset();
+		return false;
+	}
+
+	if (startArea == goalArea)
+	{
+		areas.push_back({ startArea, NUM_TRAVERSE_TYPES });
+		return true;
+	}
+
+	if (!IsSearchable(startArea) || !IsSearchable(goalArea))
+	{
+		return false;
+	}
+
+	bool restarted = false;
+
+	if (m_rootArea == nullptr || !IsTreeValid(costKey, teamID))
+	{
+		Restart(startArea, costKey, teamID);
+		restarted = true;
+	}
+
+	SetGoal(goalArea);
+	bool found = Search(costFunc);
+	auto start = std::find_if(m_path.begin(), m_path.end(), [startArea](const NavPathArea& entry) { return entry.area == startArea; });
+
+	if (!restarted && (m_rootArea == nullptr || (found && start == m_path.end())))
+	{
+		// the tree was discarded or the bot left its path, search from the bot's area
+		Restart(startArea, costKey, teamID);
+		SetGoal(goalArea);
+		found = Search(costFunc);
+		start = m_path.begin();
+	}
+
+	m_lastExpansions = m_expansions;
+
+	if (!found)
+	{
+		return false;
+	}
+
+	// the path is stored root first, the caller wants the goal first
+	areas.push_back({ start->area, NUM_TRAVERSE_TYPES });
+
+	for (auto it = start + 1; it != m_path.end(); ++it)
+	{
+		areas.push_back(*it);
+	}
+
+	std::reverse(areas.begin(), areas.end());
+	return true;
+}
+
+#endif // !NAV_INCREMENTAL_H_
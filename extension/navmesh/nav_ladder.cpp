@@ -526,7 +526,7 @@ void CNavLadder::FindLadderEntity( void )
 /**
  * Save a navigation ladder to the opened binary stream
  */
-void CNavLadder::Save(std::fstream& filestream, uint32_t version)
+void CNavLadder::Save(std::ostream& filestream, uint32_t version)
 {
 	// save ID
 	filestream.write(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
@@ -585,38 +585,38 @@ void CNavLadder::Save(std::fstream& filestream, uint32_t version)
 /**
  * Load a navigation ladder from the opened binary stream
  */
-void CNavLadder::Load(CNavMesh* TheNavMesh, std::fstream& filestream, uint32_t version)
+void CNavLadder::Load(CNavMesh* TheNavMesh, CNavFileReader& reader, uint32_t version)
 {
 	// load ID
-	filestream.read(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
+	reader.Read(m_id);
 
 	// load extent of ladder
-	filestream.read(reinterpret_cast<char*>(&m_width), sizeof(float));
+	reader.Read(m_width);
 
 	// load top endpoint of ladder
-	filestream.read(reinterpret_cast<char*>(&m_top), sizeof(Vector));
+	reader.Read(m_top);
 
 	// load bottom endpoint of ladder
-	filestream.read(reinterpret_cast<char*>(&m_bottom), sizeof(Vector));
+	reader.Read(m_bottom);
 
 	// save useable ladder entity origin
-	filestream.read(reinterpret_cast<char*>(&m_useableOrigin), sizeof(Vector));
+	reader.Read(m_useableOrigin);
 
 	// load ladder length
-	filestream.read(reinterpret_cast<char*>(&m_length), sizeof(float));
+	reader.Read(m_length);
 
 	// load direction
-	filestream.read(reinterpret_cast<char*>(&m_dir), sizeof(NavDirType));
+	reader.Read(m_dir);
 
 	// load ladder type
-	filestream.read(reinterpret_cast<char*>(&m_ladderType), sizeof(LadderType));
+	reader.Read(m_ladderType);
 
 	// load IDs of connecting areas
 	
 	std::uint8_t count = 0;
 	
 	// load vector size
-	filestream.read(reinterpret_cast<char*>(&count), sizeof(std::uint8_t));
+	reader.Read(count);
 
 	for (std::uint8_t i = 0; i < count; i++)
 	{
@@ -624,12 +624,12 @@ void CNavLadder::Load(CNavMesh* TheNavMesh, std::fstream& filestream, uint32_t v
 
 		// area ID
 		unsigned int id = 0;
-		filestream.read(reinterpret_cast<char*>(&id), sizeof(unsigned int));
+		reader.Read(id);
 		connect.connect = id;
 
 		// data
-		filestream.read(reinterpret_cast<char*>(&connect.bottom), sizeof(bool));
-		filestream.read(reinterpret_cast<char*>(&connect.point), sizeof(Vector));
+		reader.Read(connect.bottom);
+		reader.Read(connect.point);
 	}
 }
 
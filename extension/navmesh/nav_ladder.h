@@ -19,6 +19,7 @@
 #include <variant>
 
 #include "nav.h"
+#include "nav_filereader.h"
 #include <sdkports/sdk_ehandle.h>
 
 class CUtlBuffer;
@@ -93,8 +94,8 @@ public:
 
 	void OnRoundRestart( void );			///< invoked when a game round restarts
 
-	void Save(std::fstream& filestream, uint32_t version);
-	void Load(CNavMesh* TheNavMesh, std::fstream& filestream, uint32_t version);
+	void Save(std::ostream& filestream, uint32_t version);
+	void Load(CNavMesh* TheNavMesh, CNavFileReader& reader, uint32_t version);
 	void PostLoad(CNavMesh* TheNavMesh, uint32_t version);
 
 	unsigned int GetID( void ) const	{ return m_id; }		///< return this ladder's unique ID
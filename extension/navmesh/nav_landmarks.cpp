@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <cmath>
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_utils.h"
+#include "nav_landmarks.h"
+
+static constexpr float LANDMARK_UNREACHABLE_DISTANCE = std::numeric_limits<float>::max();
+
+// Connection graph in compressed row form, indexed by area search index
+struct NavLandmarkGraph
+{
+	std::vector<unsigned int> edgeStart;	// index of the first edge of each area, with one extra entry at the end
+	std::vector<unsigned int> edgeTarget;
+	std::vector<float> edgeCost;
+};
+
+// Shortest cost a cost function can assign to a connection
+static float GetMinimumConnectionCost(const CNavArea* from, const CNavArea* to, float length)
+{
+	// cost functions use either the connection length or the distance between the area centers
+	const float distance = (to->GetCenter() - from->GetCenter()).Length();
+	return length > 0.0f ? std::min(length, distance) : distance;
+}
+
+static void BuildLandmarkGraphs(NavLandmarkGraph& forward, NavLandmarkGraph& backward)
+{
+	struct Connection
+	{
+		unsigned int from;
+		unsigned int to;
+		float cost;
+	};
+
+	const std::size_t numAreas = static_cast<std::size_t>(CNavArea::GetSearchIndexCount());
+	std::vector<Connection> connections;
+	connections.reserve(static_cast<std::size_t>(TheNavAreas.Count()) * 4U);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		CNavArea* area = TheNavAreas[it];
+
+		navutils::ForEachOutgoingConnection(area, [area, &connections](CNavArea* connectedArea, float length) {
+			connections.push_back({ area->GetSearchIndex(), connectedArea->GetSearchIndex(), GetMinimumConnectionCost(area, connectedArea, length) });
+		});
+	}
+
+	auto fill = [numAreas, &connections](NavLandmarkGraph& graph, bool reversed) {
+		graph.edgeStart.assign(numAreas + 1U, 0U);
+		graph.edgeTarget.resize(connections.size());
+		graph.edgeCost.resize(connections.size());
+
+		for (auto& connection : connections)
+		{
+			graph.edgeStart[(reversed ? connection.to : connection.from) + 1U]++;
+		}
+
+		for (std::size_t i = 0; i < numAreas; i++)
+		{
+			graph.edgeStart[i + 1U] += graph.edgeStart[i];
+		}
+
+		std::vector<unsigned int> next(graph.edgeStart.begin(), graph.edgeStart.end() - 1);
+
+		for (auto& connection : connections)
+		{
+			const unsigned int edge = next[reversed ? connection.to : connection.from]++;
+			graph.edgeTarget[edge] = reversed ? connection.from : connection.to;
+			graph.edgeCost[edge] = connection.cost;
+		}
+	};
+
+	fill(forward, false);
+	fill(backward, true);
+}
+
+// Dijkstra search from 'source', unreachable areas are set to LANDMARK_UNREACHABLE_DISTANCE
+static void ComputeLandmarkDistances(const NavLandmarkGraph& graph, unsigned int source, std::vector<float>& distances)
+{
+	using OpenEntry = std::pair<float, unsigned int>;
+
+	distances.assign(graph.edgeStart.size() - 1U, LANDMARK_UNREACHABLE_DISTANCE);
+	std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry>> openList;
+
+	distances[source] = 0.0f;
+	openList.emplace(0.0f, source);
+
+	while (!openList.empty())
+	{
+		const OpenEntry entry = openList.top();
+		openList.pop();
+
+		if (entry.first > distances[entry.second])
+		{
+			continue; // stale entry
+		}
+
+		for (unsigned int edge = graph.edgeStart[entry.second]; edge < graph.edgeStart[entry.second + 1U]; edge++)
+		{
+			const unsigned int target = graph.edgeTarget[edge];
+			const float distance = entry.first + graph.edgeCost[edge];
+
+			if (distance < distances[target])
+			{
+				distances[target] = distance;
+				openList.emplace(distance, target);
+			}
+		}
+	}
+}
+
+CNavLandmarks::CNavLandmarks()
+{
+	m_numLandmarks = 0U;
+	m_scale = 1.0f;
+}
+
+void CNavLandmarks::Clear()
+{
+	m_numLandmarks = 0U;
+	m_scale = 1.0f;
+	m_landmarks.clear();
+	m_fromLandmark.clear();
+	m_toLandmark.clear();
+}
+
+void CNavLandmarks::Build(unsigned int numLandmarks)
+{
+	Clear();
+
+	numLandmarks = std::min(numLandmarks, MAX_LANDMARKS);
+
+	if (numLandmarks == 0U || TheNavAreas.Count() == 0)
+	{
+		return;
+	}
+
+	NavLandmarkGraph forward;
+	NavLandmarkGraph backward;
+	BuildLandmarkGraphs(forward, backward);
+
+	std::vector<std::vector<float>> fromLandmark;
+	std::vector<std::vector<float>> toLandmark;
+	std::vector<float> distances;
+
+	// farthest point selection: each landmark is the area farthest away from the previous landmarks, the first one is the area farthest
+	// away from an arbitrary area. Areas not reachable from the first landmark don't get any landmark.
+	ComputeLandmarkDistances(forward, TheNavAreas[0]->GetSearchIndex(), distances);
+	std::vector<float> closestLandmark = distances;
+
+	while (m_landmarks.size() < numLandmarks)
+	{
+		CNavArea* farthest = nullptr;
+		float farthestDistance = 0.0f;
+
+		FOR_EACH_VEC(TheNavAreas, it)
+		{
+			CNavArea* area = TheNavAreas[it];
+			const float distance = closestLandmark[area->GetSearchIndex()];
+
+			if (distance != LANDMARK_UNREACHABLE_DISTANCE && distance > farthestDistance)
+			{
+				farthest = area;
+				farthestDistance = distance;
+			}
+		}
+
+		if (farthest == nullptr)
+		{
+			break; // every reachable area is a landmark
+		}
+
+		m_landmarks.push_back(farthest);
+		fromLandmark.emplace_back();
+		toLandmark.emplace_back();
+		ComputeLandmarkDistances(forward, farthest->GetSearchIndex(), fromLandmark.back());
+		ComputeLandmarkDistances(backward, farthest->GetSearchIndex(), toLandmark.back());
+
+		if (m_landmarks.size() == 1U)
+		{
+			closestLandmark = fromLandmark.back();
+		}
+		else
+		{
+			for (std::size_t i = 0; i < closestLandmark.size(); i++)
+			{
+				closestLandmark[i] = std::min(closestLandmark[i], fromLandmark.back()[i]);
+			}
+		}
+	}
+
+	if (m_landmarks.empty())
+	{
+		return;
+	}
+
+	m_numLandmarks = static_cast<unsigned int>(m_landmarks.size());
+
+	// pick the scale so the longest distance fits in the table
+	float longest = 0.0f;
+
+	for (unsigned int landmark = 0; landmark < m_numLandmarks; landmark++)
+	{
+		FOR_EACH_VEC(TheNavAreas, it)
+		{
+			const unsigned int index = TheNavAreas[it]->GetSearchIndex();
+
+			if (fromLandmark[landmark][index] != LANDMARK_UNREACHABLE_DISTANCE)
+			{
+				longest = std::max(longest, fromLandmark[landmark][index]);
+			}
+
+			if (toLandmark[landmark][index] != LANDMARK_UNREACHABLE_DISTANCE)
+			{
+				longest = std::max(longest, toLandmark[landmark][index]);
+			}
+		}
+	}
+
+	m_scale = std::max(longest / static_cast<float>(UNREACHABLE - 1U), 1.0f);
+
+	auto quantize = [this](float distance) -> std::uint16_t {
+		if (distance == LANDMARK_UNREACHABLE_DISTANCE)
+		{
+			return UNREACHABLE;
+		}
+
+		// round down, the bound is computed assuming the stored distance is at most one unit shorter than the real one
+		const float units = std::floor(distance / m_scale);
+		return static_cast<std::uint16_t>(std::min(units, static_cast<float>(UNREACHABLE - 1U)));
+	};
+
+	const std::size_t tableSize = static_cast<std::size_t>(CNavArea::GetSearchIndexCount()) * m_numLandmarks;
+	m_fromLandmark.assign(tableSize, UNREACHABLE);
+	m_toLandmark.assign(tableSize, UNREACHABLE);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		const unsigned int index = TheNavAreas[it]->GetSearchIndex();
+		const std::size_t first = static_cast<std::size_t>(index) * m_numLandmarks;
+
+		for (unsigned int landmark = 0; landmark < m_numLandmarks; landmark++)
+		{
+			m_fromLandmark[first + landmark] = quantize(fromLandmark[landmark][index]);
+			m_toLandmark[first + landmark] = quantize(toLandmark[landmark][index]);
+		}
+	}
+}
+
+void CNavLandmarks::Save(std::ostream& filestream, uint32_t version) const
+{
+	std::uint32_t count = static_cast<std::uint32_t>(m_numLandmarks);
+	filestream.write(reinterpret_cast<char*>(&count), sizeof(std::uint32_t));
+
+	if (count == 0U)
+	{
+		return;
+	}
+
+	float scale = m_scale;
+	filestream.write(reinterpret_cast<char*>(&scale), sizeof(float));
+
+	for (CNavArea* landmark : m_landmarks)
+	{
+		unsigned int id = landmark->GetID();
+		filestream.write(reinterpret_cast<char*>(&id), sizeof(unsigned int));
+	}
+
+	// tables are written in the same order as the areas
+	std::uint64_t numAreas = static_cast<std::uint64_t>(TheNavAreas.Count());
+	filestream.write(reinterpret_cast<char*>(&numAreas), sizeof(std::uint64_t));
+	const std::vector<std::uint16_t> unknown(m_numLandmarks, UNREACHABLE);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		const unsigned int index = GetTableIndex(TheNavAreas[it]);
+		const std::uint16_t* from = index != INVALID_INDEX ? &m_fromLandmark[index] : unknown.data();
+		const std::uint16_t* to = index != INVALID_INDEX ? &m_toLandmark[index] : unknown.data();
+
+		filestream.write(reinterpret_cast<const char*>(from), sizeof(std::uint16_t) * m_numLandmarks);
+		filestream.write(reinterpret_cast<const char*>(to), sizeof(std::uint16_t) * m_numLandmarks);
+	}
+}
+
+NavErrorType CNavLandmarks::Load(CNavFileReader& reader, uint32_t version)
+{
+	Clear();
+
+	std::uint32_t count = 0U;
+	reader.Read(count);
+
+	if (count == 0U)
+	{
+		return NAV_OK;
+	}
+
+	if (count > MAX_LANDMARKS)
+	{
+		return NAV_CORRUPT_DATA;
+	}
+
+	float scale = 1.0f;
+	reader.Read(scale);
+
+	std::vector<unsigned int> ids(count);
+	reader.ReadBytes(ids.data(), sizeof(unsigned int) * count);
+
+	std::uint64_t numAreas = 0U;
+	reader.Read(numAreas);
+
+	const std::uint64_t tableBytes = numAreas * count * 2U * sizeof(std::uint16_t);
+
+	if (numAreas != static_cast<std::uint64_t>(TheNavAreas.Count()))
+	{
+		reader.Skip(tableBytes);
+		return NAV_OK;
+	}
+
+	for (unsigned int id : ids)
+	{
+		CNavArea* landmark = TheNavMesh->GetNavAreaByID(id);
+
+		if (landmark == nullptr)
+		{
+			m_landmarks.clear();
+			reader.Skip(tableBytes);
+			return NAV_OK;
+		}
+
+		m_landmarks.push_back(landmark);
+	}
+
+	m_numLandmarks = count;
+	m_scale = scale;
+
+	const std::size_t tableSize = static_cast<std::size_t>(CNavArea::GetSearchIndexCount()) * m_numLandmarks;
+	m_fromLandmark.assign(tableSize, UNREACHABLE);
+	m_toLandmark.assign(tableSize, UNREACHABLE);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		const std::size_t first = static_cast<std::size_t>(TheNavAreas[it]->GetSearchIndex()) * m_numLandmarks;
+
+		reader.ReadBytes(&m_fromLandmark[first], sizeof(std::uint16_t) * m_numLandmarks);
+		reader.ReadBytes(&m_toLandmark[first], sizeof(std::uint16_t) * m_numLandmarks);
+	}
+
+	if (!reader.IsGood())
+	{
+		Clear();
+		return NAV_CORRUPT_DATA;
+	}
+
+	return NAV_OK;
+}
@@ -0,0 +1,112 @@
+#ifndef NAV_LANDMARKS_H_
+#define NAV_LANDMARKS_H_
+
+#include <cstdint>
+#include <fstream>
+#include <vector>
+#include "nav.h"
+#include "nav_filereader.h"
+#include "nav_area.h"
+
+/**
+ * @brief Landmark (ALT) distance tables used by the path finding heuristic.
+ *
+ * A few landmark areas spread over the mesh store the travel distance from the landmark to every area and from every area to the
+ * landmark. By the triangle inequality, the distance between two areas is at least d(L, goal) - d(L, area) and d(area, L) - d(goal, L)
+ * for every landmark L, which is a much better estimate than the straight line distance on maps with multiple floors, ladders and drops.
+ *
+ * Distances are measured with the shortest possible cost of each connection, the bound is valid for any cost function that never
+ * returns less than the connection length. Distances are quantized to 16 bits and rounded so the bound is never overestimated.
+ * The tables are saved on the nav mesh file and are read only while searches are running.
+ */
+class CNavLandmarks
+{
+public:
+	static constexpr std::uint16_t UNREACHABLE = 0xFFFF;
+	static constexpr unsigned int MAX_LANDMARKS = 32U;
+
+	CNavLandmarks();
+
+	/**
+	 * @brief Selects the landmarks and computes the distance tables for the current mesh.
+	 * @param numLandmarks Number of landmarks to select.
+	 */
+	void Build(unsigned int numLandmarks);
+	void Clear();
+	bool IsBuilt() const { return m_numLandmarks > 0U; }
+
+	unsigned int GetLandmarkCount() const { return m_numLandmarks; }
+	const std::vector<CNavArea*>& GetLandmarks() const { return m_landmarks; }
+
+	/**
+	 * @brief Lower bound of the travel distance between two areas.
+	 * @param from Start area.
+	 * @param to Goal area.
+	 * @return Lower bound of the travel distance, zero if the tables don't have any information about the areas.
+	 */
+	float GetLowerBound(const CNavArea* from, const CNavArea* to) const
+	{
+		const unsigned int fromIndex = GetTableIndex(from);
+		const unsigned int toIndex = GetTableIndex(to);
+
+		if (fromIndex == INVALID_INDEX || toIndex == INVALID_INDEX)
+		{
+			return 0.0f;
+		}
+
+		const std::uint16_t* fromLandmark = &m_fromLandmark[fromIndex];
+		const std::uint16_t* toLandmark = &m_toLandmark[fromIndex];
+		const std::uint16_t* goalFromLandmark = &m_fromLandmark[toIndex];
+		const std::uint16_t* goalToLandmark = &m_toLandmark[toIndex];
+		int best = 0;
+
+		for (unsigned int i = 0; i < m_numLandmarks; i++)
+		{
+			// stored values are rounded down, subtract one to account for the rounding of the subtracted distance
+			if (goalFromLandmark[i] != UNREACHABLE && fromLandmark[i] != UNREACHABLE)
+			{
+				const int bound = static_cast<int>(goalFromLandmark[i]) - static_cast<int>(fromLandmark[i]) - 1;
+				best = bound > best ? bound : best;
+			}
+
+			if (toLandmark[i] != UNREACHABLE && goalToLandmark[i] != UNREACHABLE)
+			{
+				const int bound = static_cast<int>(toLandmark[i]) - static_cast<int>(goalToLandmark[i]) - 1;
+				best = bound > best ? bound : best;
+			}
+		}
+
+		return static_cast<float>(best) * m_scale;
+	}
+
+	void Save(std::ostream& filestream, uint32_t version) const;
+	/**
+	 * @brief Loads the distance tables. Must be called after the nav areas are loaded.
+	 * @return NAV_OK if the tables were loaded. Tables that don't match the loaded areas are skipped and left empty.
+	 */
+	NavErrorType Load(CNavFileReader& reader, uint32_t version);
+
+private:
+	static constexpr unsigned int INVALID_INDEX = 0xFFFFFFFF;
+
+	unsigned int m_numLandmarks;
+	float m_scale;									// distance of one table unit
+	std::vector<CNavArea*> m_landmarks;
+	std::vector<std::uint16_t> m_fromLandmark;		// distance from each landmark to the area, indexed by search index * number of landmarks
+	std::vector<std::uint16_t> m_toLandmark;		// distance from the area to each landmark, same layout
+
+	// index of the first table entry of an area
+	unsigned int GetTableIndex(const CNavArea* area) const
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex()) * m_numLandmarks;
+
+		if (m_numLandmarks == 0U || index >= m_fromLandmark.size())
+		{
+			return INVALID_INDEX; // area created after the tables were built
+		}
+
+		return static_cast<unsigned int>(index);
+	}
+};
+
+#endif // !NAV_LANDMARKS_H_
@@ -0,0 +1,88 @@
+#include <algorithm>
+
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_layeredgrid.h"
+
+#undef max
+#undef min
+#undef clamp
+
+extern ConVar sm_nav_edit;
+
+ConVar sm_nav_layered_grid("sm_nav_layered_grid", "1", FCVAR_GAMEDLL, "Nav area position queries use the area bounds stored with the grid to skip areas without reading them.");
+
+CNavLayeredGrid::CNavLayeredGrid()
+{
+}
+
+bool CNavLayeredGrid::IsAvailable() const
+{
+	// areas are added, removed and moved at any time while editing
+	return sm_nav_layered_grid.GetBool() && !sm_nav_edit.GetBool() && IsBuilt();
+}
+
+void CNavLayeredGrid::Clear()
+{
+	m_cellStart.clear();
+	m_entries.clear();
+	m_batchStart.clear();
+	m_gridBounds.Clear();
+	m_heightBounds.Clear();
+	m_heightOrder.clear();
+}
+
+void CNavLayeredGrid::Build(const CUtlVector<NavAreaVector>& grid)
+{
+	Clear();
+	m_cellStart.reserve(static_cast<std::size_t>(grid.Count()) + 1U);
+	m_batchStart.reserve(static_cast<std::size_t>(grid.Count()) + 1U);
+
+	std::vector<unsigned int> order;
+
+	for (int cell = 0; cell < grid.Count(); cell++)
+	{
+		const NavAreaVector& areas = grid[cell];
+		const unsigned int first = static_cast<unsigned int>(m_entries.size());
+
+		m_cellStart.push_back(first);
+		m_batchStart.push_back(m_gridBounds.Size());
+		order.clear();
+
+		FOR_EACH_VEC(areas, it)
+		{
+			CNavArea* area = areas[it];
+			Entry entry;
+			area->GetExtent(&entry.extent);
+			entry.center = area->GetCenter();
+			entry.area = area;
+			m_entries.push_back(entry);
+			m_gridBounds.Push(entry.extent, entry.center.z);
+			order.push_back(static_cast<unsigned int>(m_entries.size()) - 1U);
+		}
+
+		m_gridBounds.Pad();
+
+		std::sort(order.begin(), order.end(), [this](unsigned int lhs, unsigned int rhs) {
+			const float lhsZ = m_entries[lhs].extent.hi.z;
+			const float rhsZ = m_entries[rhs].extent.hi.z;
+			return lhsZ > rhsZ || (lhsZ == rhsZ && lhs < rhs);
+		});
+
+		for (unsigned int index : order)
+		{
+			Extent extent = m_entries[index].extent;
+			extent.lo.z -= Z_TOLERANCE;
+			extent.hi.z += Z_TOLERANCE;
+			m_heightBounds.Push(extent, m_entries[index].center.z);
+			m_heightOrder.push_back(index);
+		}
+
+		m_heightBounds.Pad();
+		m_heightOrder.resize(m_heightBounds.Size(), 0U);
+	}
+
+	m_cellStart.push_back(static_cast<unsigned int>(m_entries.size()));
+	m_batchStart.push_back(m_gridBounds.Size());
+}
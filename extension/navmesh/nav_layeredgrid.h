@@ -0,0 +1,158 @@
+#ifndef NAV_LAYERED_GRID_H_
+#define NAV_LAYERED_GRID_H_
+
+#include <vector>
+#include "nav.h"
+#include "nav_area.h"
+#include "nav_simd.h"
+
+/**
+ * @brief Copy of the nav mesh grid with the bounds of every area stored next to it.
+ *
+ * The cells keep the order of the nav mesh grid lists, so the queries can reject areas from the stored bounds and still visit the
+ * remaining areas in the same order as before. Each cell also has its areas sorted by height (highest corner first), point
+ * queries walk the layers from the top and stop once the areas left are below the position. Results are the same as the plain
+ * grid queries.
+ *
+ * The bounds are also stored as structure of arrays (see nav_simd.h), the queries test a batch of areas of a cell at once.
+ *
+ * Built after the mesh is loaded and after editing, cleared when an area is added or removed. Not available while editing.
+ */
+class CNavLayeredGrid
+{
+public:
+	struct Entry
+	{
+		Extent extent;		// see CNavArea::GetExtent
+		Vector center;
+		CNavArea* area;
+	};
+
+	// GetZ may round slightly past the corner heights
+	static constexpr float Z_TOLERANCE = 1.0f;
+	// areas tested at once by the batch queries
+	static constexpr std::size_t BATCH_SIZE = navsimd::BATCH_SIZE;
+
+	CNavLayeredGrid();
+
+	CNavLayeredGrid(const CNavLayeredGrid&) = delete;
+	CNavLayeredGrid& operator=(const CNavLayeredGrid&) = delete;
+
+	// Copies the area bounds of every cell of the nav mesh grid. Game thread only.
+	void Build(const CUtlVector<NavAreaVector>& grid);
+	void Clear();
+
+	bool IsBuilt() const { return !m_cellStart.empty(); }
+	// true if the queries may use the grid, see sm_nav_layered_grid
+	bool IsAvailable() const;
+
+	// Entry of an area of the cell, index is the position of the area on the nav mesh grid cell list
+	const Entry& GetEntry(int cell, int index) const { return m_entries[m_cellStart[cell] + index]; }
+
+	/**
+	 * @brief Finds the highest area of the cell that overlaps the position and has its height at the position within the given range.
+	 * @tparam Filter bool (CNavArea* area), return false to skip the area.
+	 * @param cell Nav mesh grid cell index.
+	 * @param pos Position to test.
+	 * @param maxZ Highest accepted area height.
+	 * @param minZ Lowest accepted area height.
+	 * @param filter Area filter.
+	 * @return Area found or NULL. On ties, the area listed first on the nav mesh grid cell wins.
+	 */
+	template <typename Filter>
+	CNavArea* GetAreaBeneath(int cell, const Vector& pos, float maxZ, float minZ, const Filter& filter) const;
+
+	/**
+	 * @brief Tests the stored extents of a batch of areas of the cell against the given extent (see Extent::IsOverlapping).
+	 * @param cell Nav mesh grid cell index.
+	 * @param index Position of the first area of the batch on the nav mesh grid cell list, multiple of BATCH_SIZE.
+	 * @param extent Extent to test.
+	 * @return Bit mask of the areas that overlap, bit 0 is the area at index.
+	 */
+	unsigned int GetOverlapMask(int cell, int index, const Extent& extent) const
+	{
+		return navsimd::ExtentOverlapMask(m_gridBounds, m_batchStart[cell] + static_cast<std::size_t>(index), extent);
+	}
+
+	/**
+	 * @brief Finds the areas of a batch that may be closer to the position than the given distance (see CNavArea::GetClosestPointOnArea).
+	 * @param cell Nav mesh grid cell index.
+	 * @param index Position of the first area of the batch on the nav mesh grid cell list, multiple of BATCH_SIZE.
+	 * @param pos Position.
+	 * @param maxDistSq Areas at this squared distance or farther are rejected.
+	 * @param maxCenterAbove Areas with their center higher than this above the position are rejected.
+	 * @return Bit mask of the areas left, bit 0 is the area at index.
+	 */
+	unsigned int GetNearMask(int cell, int index, const Vector& pos, float maxDistSq, float maxCenterAbove) const
+	{
+		return navsimd::NearMask(m_gridBounds, m_batchStart[cell] + static_cast<std::size_t>(index), pos, Z_TOLERANCE, maxDistSq, maxCenterAbove);
+	}
+
+private:
+	std::vector<unsigned int> m_cellStart;		// first entry of each cell, the last element is the number of entries
+	std::vector<Entry> m_entries;				// cell lists, same order as the nav mesh grid
+	std::vector<std::size_t> m_batchStart;		// first bounds of each cell, cells are padded to a multiple of BATCH_SIZE
+	navsimd::BoundsBlock m_gridBounds;			// extents, same order as the nav mesh grid
+	navsimd::BoundsBlock m_heightBounds;		// extents widened by Z_TOLERANCE, highest first
+	std::vector<unsigned int> m_heightOrder;	// entry of each height bounds
+};
+
+template <typename Filter>
+inline CNavArea* CNavLayeredGrid::GetAreaBeneath(int cell, const Vector& pos, float maxZ, float minZ, const Filter& filter) const
+{
+	CNavArea* use = nullptr;
+	float useZ = -99999999.9f;
+	unsigned int useEntry = 0U;
+
+	for (std::size_t first = m_batchStart[cell]; first < m_batchStart[cell + 1]; first += BATCH_SIZE)
+	{
+		// every area left is below the range or lower than the area found
+		if (m_heightBounds.hiZ[first] < minZ || m_heightBounds.hiZ[first] < useZ)
+		{
+			break;
+		}
+
+		// overlaps the position and the height range
+		const unsigned int candidates = navsimd::PointOverlapMask(m_heightBounds, first, pos, minZ, maxZ);
+
+		if (candidates == 0U)
+		{
+			continue;
+		}
+
+		for (std::size_t lane = 0U; lane < BATCH_SIZE; lane++)
+		{
+			// the areas after this one are lower than the area found
+			if ((candidates & (1U << lane)) == 0U || m_heightBounds.hiZ[first + lane] < useZ)
+			{
+				continue;
+			}
+
+			const unsigned int index = m_heightOrder[first + lane];
+			CNavArea* area = m_entries[index].area;
+
+			if (!filter(area))
+			{
+				continue;
+			}
+
+			const float z = area->GetZ(pos);
+
+			if (z > maxZ || z < minZ)
+			{
+				continue;
+			}
+
+			if (z > useZ || (z == useZ && index < useEntry))
+			{
+				use = area;
+				useZ = z;
+				useEntry = index;
+			}
+		}
+	}
+
+	return use;
+}
+
+#endif // !NAV_LAYERED_GRID_H_
@@ -0,0 +1,275 @@
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <extension.h>
+#include <tier1/checksum_crc.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_loader.h"
+#include "nav_loadcache.h"
+
+bool CNavLoadCache::Load(const std::filesystem::path& path, const NavLoadCacheKey& key)
+{
+	Clear();
+
+	std::error_code ec;
+
+	if (!std::filesystem::exists(path, ec))
+	{
+		return false;
+	}
+
+	CNavFileReader file;
+
+	if (!file.Open(path))
+	{
+		return false;
+	}
+
+	CacheHeader header;
+
+	if (!file.Read(header) || header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || !(header.key == key) ||
+		header.dataSize != file.GetBytesLeft())
+	{
+		return false;
+	}
+
+	const char* data = file.GetData() + file.GetPosition();
+
+	if (CRC32_ProcessSingleBuffer(data, static_cast<int>(header.dataSize)) != header.dataCRC)
+	{
+		TheNavMesh->LogLoadMessage(NAV_LOAD_ERROR, "Navigation Mesh cache file \"%s\" is corrupt and will be rebuilt.", path.string().c_str());
+		return false;
+	}
+
+	CNavFileReader reader;
+	reader.OpenView(data, static_cast<std::size_t>(header.dataSize));
+
+	reader.Read(m_gridMinX);
+	reader.Read(m_gridMinY);
+	reader.Read(m_gridSizeX);
+	reader.Read(m_gridSizeY);
+
+	const std::uint64_t numCells = static_cast<std::uint64_t>(m_gridSizeX) * static_cast<std::uint64_t>(m_gridSizeY);
+
+	if (!reader.IsGood() || m_gridSizeX < 0 || m_gridSizeY < 0 || numCells + 1U > reader.GetBytesLeft() / sizeof(std::uint32_t))
+	{
+		Clear();
+		return false;
+	}
+
+	m_gridCellStart.resize(static_cast<std::size_t>(numCells) + 1U);
+	reader.ReadBytes(m_gridCellStart.data(), sizeof(std::uint32_t) * m_gridCellStart.size());
+
+	const std::uint32_t numGridAreas = m_gridCellStart.back();
+
+	if (numGridAreas > reader.GetBytesLeft() / sizeof(unsigned int))
+	{
+		Clear();
+		return false;
+	}
+
+	for (std::size_t i = 1U; i < m_gridCellStart.size(); i++)
+	{
+		if (m_gridCellStart[i] < m_gridCellStart[i - 1U])
+		{
+			Clear();
+			return false;
+		}
+	}
+
+	m_gridAreas.resize(static_cast<std::size_t>(numGridAreas));
+
+	if (numGridAreas > 0U)
+	{
+		reader.ReadBytes(m_gridAreas.data(), sizeof(unsigned int) * m_gridAreas.size());
+	}
+
+	if (!ReadAreaMap(reader, m_volumeAreas) || !ReadAreaMap(reader, m_prerequisiteAreas))
+	{
+		Clear();
+		return false;
+	}
+
+	m_isLoaded = true;
+	return true;
+}
+
+bool CNavLoadCache::Save(const std::filesystem::path& path, const NavLoadCacheKey& key) const
+{
+	std::ostringstream stream(std::ios_base::out | std::ios_base::binary);
+
+	stream.write(reinterpret_cast<const char*>(&m_gridMinX), sizeof(float));
+	stream.write(reinterpret_cast<const char*>(&m_gridMinY), sizeof(float));
+	stream.write(reinterpret_cast<const char*>(&m_gridSizeX), sizeof(int));
+	stream.write(reinterpret_cast<const char*>(&m_gridSizeY), sizeof(int));
+	stream.write(reinterpret_cast<const char*>(m_gridCellStart.data()), sizeof(std::uint32_t) * m_gridCellStart.size());
+	stream.write(reinterpret_cast<const char*>(m_gridAreas.data()), sizeof(unsigned int) * m_gridAreas.size());
+	WriteAreaMap(stream, m_volumeAreas);
+	WriteAreaMap(stream, m_prerequisiteAreas);
+
+	const std::string data = stream.str();
+
+	CacheHeader header;
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.key = key;
+	header.dataCRC = CRC32_ProcessSingleBuffer(data.data(), static_cast<int>(data.size()));
+	header.dataSize = static_cast<std::uint32_t>(data.size());
+
+	std::fstream file;
+	file.open(path, std::fstream::out | std::fstream::binary | std::fstream::trunc);
+
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(CacheHeader));
+	file.write(data.data(), data.size());
+	return file.good();
+}
+
+void CNavLoadCache::Clear()
+{
+	m_isLoaded = false;
+	m_gridMinX = 0.0f;
+	m_gridMinY = 0.0f;
+	m_gridSizeX = 0;
+	m_gridSizeY = 0;
+	m_gridCellStart.clear();
+	m_gridAreas.clear();
+	m_volumeAreas.clear();
+	m_prerequisiteAreas.clear();
+}
+
+void CNavLoadCache::StoreGrid(float minX, float minY, int sizeX, int sizeY, const CUtlVector<NavAreaVector>& grid)
+{
+	m_gridMinX = minX;
+	m_gridMinY = minY;
+	m_gridSizeX = sizeX;
+	m_gridSizeY = sizeY;
+	m_gridCellStart.clear();
+	m_gridAreas.clear();
+	m_gridCellStart.reserve(static_cast<std::size_t>(grid.Count()) + 1U);
+
+	FOR_EACH_VEC(grid, cell)
+	{
+		m_gridCellStart.push_back(static_cast<std::uint32_t>(m_gridAreas.size()));
+
+		FOR_EACH_VEC(grid[cell], it)
+		{
+			m_gridAreas.push_back(grid[cell][it]->GetID());
+		}
+	}
+
+	m_gridCellStart.push_back(static_cast<std::uint32_t>(m_gridAreas.size()));
+}
+
+bool CNavLoadCache::RestoreGridCell(int cell, const CNavAreaIDTable& areas, NavAreaVector& out) const
+{
+	const std::uint32_t first = m_gridCellStart[static_cast<std::size_t>(cell)];
+	const std::uint32_t last = m_gridCellStart[static_cast<std::size_t>(cell) + 1U];
+
+	out.EnsureCapacity(static_cast<int>(last - first));
+
+	for (std::uint32_t i = first; i < last; i++)
+	{
+		CNavArea* area = areas.Find(m_gridAreas[i]);
+
+		if (area == nullptr)
+		{
+			return false;
+		}
+
+		out.AddToTail(area);
+	}
+
+	return true;
+}
+
+void CNavLoadCache::StoreAreas(std::vector<unsigned int>& ids, const std::vector<CNavArea*>& areas)
+{
+	ids.clear();
+	ids.reserve(areas.size());
+
+	for (CNavArea* area : areas)
+	{
+		ids.push_back(area->GetID());
+	}
+}
+
+bool CNavLoadCache::RestoreAreas(const std::unordered_map<unsigned int, std::vector<unsigned int>>& cache, unsigned int id, const CNavAreaIDTable& areas, std::vector<CNavArea*>& out)
+{
+	out.clear();
+
+	auto it = cache.find(id);
+
+	if (it == cache.end())
+	{
+		return false;
+	}
+
+	out.reserve(it->second.size());
+
+	for (unsigned int areaID : it->second)
+	{
+		CNavArea* area = areas.Find(areaID);
+
+		if (area == nullptr)
+		{
+			out.clear();
+			return false;
+		}
+
+		out.push_back(area);
+	}
+
+	return true;
+}
+
+bool CNavLoadCache::ReadAreaMap(CNavFileReader& reader, std::unordered_map<unsigned int, std::vector<unsigned int>>& cache)
+{
+	std::uint32_t count = 0U;
+	reader.Read(count);
+
+	for (std::uint32_t i = 0U; i < count && reader.IsGood(); i++)
+	{
+		unsigned int id = 0U;
+		std::uint32_t numAreas = 0U;
+		reader.Read(id);
+		reader.Read(numAreas);
+
+		if (numAreas > reader.GetBytesLeft() / sizeof(unsigned int))
+		{
+			return false;
+		}
+
+		std::vector<unsigned int>& ids = cache[id];
+		ids.resize(static_cast<std::size_t>(numAreas));
+
+		if (numAreas > 0U)
+		{
+			reader.ReadBytes(ids.data(), sizeof(unsigned int) * ids.size());
+		}
+	}
+
+	return reader.IsGood();
+}
+
+void CNavLoadCache::WriteAreaMap(std::ostream& stream, const std::unordered_map<unsigned int, std::vector<unsigned int>>& cache)
+{
+	std::uint32_t count = static_cast<std::uint32_t>(cache.size());
+	stream.write(reinterpret_cast<char*>(&count), sizeof(std::uint32_t));
+
+	for (auto& pair : cache)
+	{
+		unsigned int id = pair.first;
+		std::uint32_t numAreas = static_cast<std::uint32_t>(pair.second.size());
+		stream.write(reinterpret_cast<char*>(&id), sizeof(unsigned int));
+		stream.write(reinterpret_cast<char*>(&numAreas), sizeof(std::uint32_t));
+		stream.write(reinterpret_cast<const char*>(pair.second.data()), sizeof(unsigned int) * pair.second.size());
+	}
+}
@@ -0,0 +1,119 @@
+#ifndef NAV_LOAD_CACHE_H_
+#define NAV_LOAD_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include "nav.h"
+#include "nav_filereader.h"
+
+class CNavArea;
+class CNavAreaIDTable;
+
+/**
+ * @brief Identifies the nav mesh file and the settings the cached data was computed from. The cache is only used when every
+ * field matches.
+ */
+struct NavLoadCacheKey
+{
+	std::uint32_t fileCRC;			// CRC32 of the nav mesh file
+	std::uint32_t mapVersion;		// gpGlobals->mapversion
+	std::uint64_t fileSize;
+	float gridCellSize;
+	float stepHeight;				// used to test if an area is inside a volume
+
+	bool operator==(const NavLoadCacheKey& other) const
+	{
+		return fileCRC == other.fileCRC && mapVersion == other.mapVersion && fileSize == other.fileSize &&
+			gridCellSize == other.gridCellSize && stepHeight == other.stepHeight;
+	}
+};
+
+/**
+ * @brief Data computed from the nav mesh every time it is loaded, stored on a file next to the nav mesh file.
+ *
+ * Holds the areas of each grid cell and the areas inside each nav volume and prerequisite, by area ID. When the cache file matches
+ * the nav mesh file being loaded, the grid and the volume and prerequisite areas are restored from it instead of being computed again.
+ * Anything that depends on the map entities (elevator buttons, spawn rooms) is still computed when the mesh is loaded.
+ */
+class CNavLoadCache
+{
+public:
+	static constexpr std::uint32_t CACHE_MAGIC = 0x4E43424EU; // "NBCN"
+	static constexpr std::uint32_t CACHE_VERSION = 1U;
+
+	/**
+	 * @brief Reads the cache file.
+	 * @param path Path to the cache file.
+	 * @param key Key of the nav mesh file being loaded.
+	 * @return true if the file exists, isn't corrupt and was computed from the same nav mesh file.
+	 */
+	bool Load(const std::filesystem::path& path, const NavLoadCacheKey& key);
+	/**
+	 * @brief Writes the cache file.
+	 * @param path Path to the cache file.
+	 * @param key Key of the loaded nav mesh file.
+	 * @return true on success.
+	 */
+	bool Save(const std::filesystem::path& path, const NavLoadCacheKey& key) const;
+	void Clear();
+	// true if the data was read from a matching cache file
+	bool IsLoaded() const { return m_isLoaded; }
+
+	void StoreGrid(float minX, float minY, int sizeX, int sizeY, const CUtlVector<NavAreaVector>& grid);
+	void StoreVolumeAreas(unsigned int id, const std::vector<CNavArea*>& areas) { StoreAreas(m_volumeAreas[id], areas); }
+	void StorePrerequisiteAreas(unsigned int id, const std::vector<CNavArea*>& areas) { StoreAreas(m_prerequisiteAreas[id], areas); }
+
+	bool HasGrid() const { return m_gridSizeX > 0 && m_gridSizeY > 0; }
+	float GetGridMinX() const { return m_gridMinX; }
+	float GetGridMinY() const { return m_gridMinY; }
+	int GetGridSizeX() const { return m_gridSizeX; }
+	int GetGridSizeY() const { return m_gridSizeY; }
+	/**
+	 * @brief Converts the area IDs of a grid cell to pointers.
+	 * @param cell Cell index.
+	 * @param areas Table of the loaded areas.
+	 * @param out Vector the areas are added to.
+	 * @return false if a cached area no longer exists.
+	 */
+	bool RestoreGridCell(int cell, const CNavAreaIDTable& areas, NavAreaVector& out) const;
+	/**
+	 * @brief Converts the cached area IDs of a volume to pointers.
+	 * @param id Volume ID.
+	 * @param areas Table of the loaded areas.
+	 * @param out Areas inside the volume.
+	 * @return false if the volume isn't cached or a cached area no longer exists.
+	 */
+	bool RestoreVolumeAreas(unsigned int id, const CNavAreaIDTable& areas, std::vector<CNavArea*>& out) const { return RestoreAreas(m_volumeAreas, id, areas, out); }
+	bool RestorePrerequisiteAreas(unsigned int id, const CNavAreaIDTable& areas, std::vector<CNavArea*>& out) const { return RestoreAreas(m_prerequisiteAreas, id, areas, out); }
+
+private:
+	struct CacheHeader
+	{
+		std::uint32_t magic;
+		std::uint32_t version;
+		NavLoadCacheKey key;
+		std::uint32_t dataCRC;
+		std::uint32_t dataSize;
+	};
+
+	bool m_isLoaded = false;
+	float m_gridMinX = 0.0f;
+	float m_gridMinY = 0.0f;
+	int m_gridSizeX = 0;
+	int m_gridSizeY = 0;
+	std::vector<std::uint32_t> m_gridCellStart;		// first ID of each cell in m_gridAreas, one extra entry for the end of the last cell
+	std::vector<unsigned int> m_gridAreas;			// area IDs of every grid cell
+	std::unordered_map<unsigned int, std::vector<unsigned int>> m_volumeAreas;
+	std::unordered_map<unsigned int, std::vector<unsigned int>> m_prerequisiteAreas;
+
+	static void StoreAreas(std::vector<unsigned int>& ids, const std::vector<CNavArea*>& areas);
+	static bool RestoreAreas(const std::unordered_map<unsigned int, std::vector<unsigned int>>& cache, unsigned int id, const CNavAreaIDTable& areas, std::vector<CNavArea*>& out);
+	static bool ReadAreaMap(CNavFileReader& reader, std::unordered_map<unsigned int, std::vector<unsigned int>>& cache);
+	static void WriteAreaMap(std::ostream& stream, const std::unordered_map<unsigned int, std::vector<unsigned int>>& cache);
+};
+
+#endif // !NAV_LOAD_CACHE_H_
@@ -0,0 +1,50 @@
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_loader.h"
+
+// IDs are usually 1 to N, a few holes are left by deleted areas
+static constexpr std::size_t MAX_ID_TABLE_WASTE = 4U;
+
+bool CNavAreaIDTable::Build(const NavAreaVector& areas)
+{
+	m_areas.clear();
+
+	unsigned int maxID = 0U;
+
+	FOR_EACH_VEC(areas, it)
+	{
+		if (areas[it]->GetID() > maxID)
+		{
+			maxID = areas[it]->GetID();
+		}
+	}
+
+	if (areas.Count() == 0 || static_cast<std::size_t>(maxID) > static_cast<std::size_t>(areas.Count()) * MAX_ID_TABLE_WASTE + 1024U)
+	{
+		return false;
+	}
+
+	m_areas.resize(static_cast<std::size_t>(maxID) + 1U, nullptr);
+
+	FOR_EACH_VEC(areas, it)
+	{
+		CNavArea* area = areas[it];
+		CNavArea*& entry = m_areas[area->GetID()];
+
+		// duplicated IDs are corrupt data, keep the first area
+		if (entry == nullptr)
+		{
+			entry = area;
+		}
+	}
+
+	// ID zero is never used
+	m_areas[0] = nullptr;
+	return true;
+}
+
+CNavArea* CNavAreaIDTable::FindInMesh(unsigned int id)
+{
+	return TheNavMesh->GetNavAreaByID(id);
+}
@@ -0,0 +1,139 @@
+#ifndef NAV_LOADER_H_
+#define NAV_LOADER_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include "nav.h"
+#include "nav_loadcache.h"
+
+class CNavArea;
+
+/**
+ * @brief Splits [0, count) in contiguous ranges and calls func(first, last) for each range on its own thread.
+ *
+ * The calling thread runs the first range and returns after every range is done. Used while loading the nav mesh, the functions
+ * must only touch the items of their range and read data nothing else writes to.
+ * @param count Number of items.
+ * @param numThreads Maximum number of threads, including the calling thread.
+ * @param minPerThread Minimum number of items per range, small counts aren't worth starting a thread.
+ * @param func Function to call.
+ */
+template <typename F>
+inline void NavParallelFor(std::size_t count, unsigned int numThreads, std::size_t minPerThread, F&& func)
+{
+	std::size_t ranges = numThreads > 1U ? static_cast<std::size_t>(numThreads) : 1U;
+
+	if (minPerThread > 0U && count / minPerThread < ranges)
+	{
+		ranges = count / minPerThread;
+	}
+
+	if (ranges <= 1U)
+	{
+		func(static_cast<std::size_t>(0U), count);
+		return;
+	}
+
+	const std::size_t perRange = (count + ranges - 1U) / ranges;
+	std::vector<std::thread> threads;
+	threads.reserve(ranges - 1U);
+
+	for (std::size_t first = perRange; first < count; first += perRange)
+	{
+		const std::size_t last = first + perRange < count ? first + perRange : count;
+		threads.emplace_back([&func, first, last]() { func(first, last); });
+	}
+
+	func(static_cast<std::size_t>(0U), perRange);
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+/**
+ * @brief Nav areas indexed by ID, used to convert the IDs of the areas being loaded to pointers.
+ *
+ * Replaces the CNavMesh::GetNavAreaByID hash table lookups while the connections are resolved. Read only once built, safe to use
+ * from several threads.
+ */
+class CNavAreaIDTable
+{
+public:
+	/**
+	 * @brief Indexes the given areas by ID.
+	 * @param areas Areas to index.
+	 * @return false if the IDs are too sparse for a table, Find uses CNavMesh::GetNavAreaByID then.
+	 */
+	bool Build(const NavAreaVector& areas);
+
+	// Area of the given ID or NULL if none
+	CNavArea* Find(unsigned int id) const
+	{
+		if (m_areas.empty())
+		{
+			return FindInMesh(id);
+		}
+
+		return id < m_areas.size() ? m_areas[id] : nullptr;
+	}
+
+private:
+	std::vector<CNavArea*> m_areas;		// indexed by area ID, empty if not built
+
+	static CNavArea* FindInMesh(unsigned int id);
+};
+
+/**
+ * @brief Time spent on each phase of the last nav mesh load, in milliseconds.
+ */
+struct NavLoadTimes
+{
+	double read;			// reading the file into memory
+	double sections;		// decoding everything but the areas
+	double areas;			// decoding the areas and adding them to the grid
+	double connections;		// converting the area, ladder and link IDs to pointers
+	double postLoad;		// everything else done after the areas are loaded
+};
+
+enum NavLoadMessageType
+{
+	NAV_LOAD_ERROR,			// logged to the SourceMod error log
+	NAV_LOAD_WARNING,
+	NAV_LOAD_DEV_WARNING	// only printed in developer mode
+};
+
+/**
+ * @brief Error or warning raised while loading, see CNavMesh::LogLoadMessage.
+ */
+struct NavLoadMessage
+{
+	NavLoadMessageType type;
+	std::string text;
+};
+
+/**
+ * @brief Everything the nav mesh loader needs from the engine, collected on the game thread before the file is loaded.
+ *
+ * The loader thread reads this instead of calling the engine, and stores its log messages here for the game thread.
+ */
+struct NavLoadRequest
+{
+	std::chrono::high_resolution_clock::time_point start;	// when the load was requested
+	std::filesystem::path path;								// nav mesh file
+	std::string mapName;
+	std::string modFolder;
+	std::uint32_t mapVersion;
+	std::uint32_t version;									// file version, set once the header is read
+	NavLoadCacheKey cacheKey;								// set once the header is read
+	bool active;											// set from BeginLoad to FinishLoad, messages are queued meanwhile
+	std::vector<NavLoadMessage> messages;					// logged by FinishLoad on the game thread
+};
+
+#endif // !NAV_LOADER_H_
@@ -170,7 +170,7 @@ void CNavMesh::CommandNavSaveSelected( const CCommand &args )
 //--------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_save_selected, "Writes the selected set to disk for merging into another mesh via nav_merge_mesh.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSaveSelected( args );
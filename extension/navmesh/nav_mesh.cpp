@@ -27,6 +27,16 @@
 #include "nav_elevator.h"
 #include "nav_place_loader.h"
 #include "nav_prereq.h"
+#include "nav_search_context.h"
+#include "nav_pathslicer.h"
+#include "nav_cluster.h"
+#include "nav_pathcache.h"
+#include "nav_landmarks.h"
+#include "nav_connections.h"
+#include "nav_flowfield.h"
+#include "nav_reachability.h"
+#include "nav_layeredgrid.h"
+#include "nav_areatracker.h"
 #include <utlbuffer.h>
 #include <utlhash.h>
 #include <generichash.h>
@@ -48,6 +58,21 @@ ConVar sm_nav_show_func_nav_avoid( "sm_nav_show_func_nav_avoid", "0", FCVAR_GAME
 ConVar sm_nav_show_func_nav_prefer( "sm_nav_show_func_nav_prefer", "0", FCVAR_GAMEDLL | FCVAR_CHEAT, "Show areas of designer-placed bot preference due to func_nav_prefer entities" );
 ConVar sm_nav_show_func_nav_prerequisite( "sm_nav_show_func_nav_prerequisite", "0", FCVAR_GAMEDLL | FCVAR_CHEAT, "Show areas of designer-placed bot preference due to func_nav_prerequisite entities" );
 ConVar sm_nav_max_vis_delta_list_length( "sm_nav_max_vis_delta_list_length", "64", FCVAR_CHEAT );
+ConVar sm_nav_load_threads( "sm_nav_load_threads", "4", FCVAR_GAMEDLL, "Number of threads used to decode the nav areas and convert their connections when the nav mesh is loaded. One loads on the game thread.", true, 1.0f, true, 16.0f );
+
+static void ClusterPathfindChanged( IConVar *var, const char *pOldValue, float flOldValue )
+{
+	if ( TheNavMesh != nullptr )
+	{
+		TheNavMesh->RebuildClusterGraph();
+	}
+}
+
+ConVar sm_nav_landmarks( "sm_nav_landmarks", "8", FCVAR_GAMEDLL, "Number of landmarks used by the path finding heuristic. Applied when the nav mesh is saved or edited.", true, 0.0f, true, static_cast<float>( CNavLandmarks::MAX_LANDMARKS ) );
+ConVar sm_nav_load_cache( "sm_nav_load_cache", "1", FCVAR_GAMEDLL, "If enabled, the grid and the nav volume and prerequisite areas computed when the nav mesh is loaded are stored next to the nav mesh file and reused until the file or the map changes." );
+ConVar sm_nav_load_async( "sm_nav_load_async", "1", FCVAR_GAMEDLL, "If enabled, the nav mesh is loaded on a separate thread when the map starts. Bots wait until it is loaded." );
+ConVar sm_nav_load_waypoints( "sm_nav_load_waypoints", "1", FCVAR_GAMEDLL, "If disabled, waypoints are only loaded from the nav mesh file when they are edited or the mesh is saved. For mods that don't use waypoints. Applied on map start." );
+ConVar sm_nav_cluster_pathfind( "sm_nav_cluster_pathfind", "1", FCVAR_GAMEDLL, "If enabled, long path searches are limited to the clusters found on the nav mesh cluster graph.", ClusterPathfindChanged );
 
 
 extern ConVar sm_nav_show_potentially_visible;
@@ -115,6 +140,17 @@ CNavMesh::CNavMesh( void )
 	m_hostThreadModeRestoreValue = 0;
 	// m_placeCount = 0;
 	// m_placeName = NULL;
+	m_pathSlicer = std::make_unique<CNavPathSlicer>();
+	m_clusterGraph = std::make_unique<CNavClusterGraph>();
+	m_pathCache = std::make_unique<CNavPathCache>();
+	m_landmarks = std::make_unique<CNavLandmarks>();
+	m_connectionGraph = std::make_unique<CNavConnectionGraph>();
+	m_flowFields = std::make_unique<CNavFlowFieldManager>();
+	m_reachability = std::make_unique<CNavReachability>();
+	m_layeredGrid = std::make_unique<CNavLayeredGrid>();
+	m_areaTracker = std::make_unique<CNavAreaTracker>();
+	m_loadCache = std::make_unique<CNavLoadCache>();
+	m_loadCancelled = false;
 	m_invokeAreaUpdateTimer.Start(NAV_AREA_UPDATE_INTERVAL);
 	m_invokeWaypointUpdateTimer.Start(CWaypoint::UPDATE_INTERVAL);
 	m_invokeVolumeUpdateTimer.Start(CNavVolume::UPDATE_INTERVAL);
@@ -144,6 +180,7 @@ CNavMesh::CNavMesh( void )
 //--------------------------------------------------------------------------------------------------------------
 CNavMesh::~CNavMesh()
 {
+	CancelLoad();
 }
 
 bool CNavMesh::IsEntityWalkable(CBaseEntity* pEntity, unsigned int flags)
@@ -215,29 +252,8 @@ void CNavMesh::Precache()
 {
 }
 
-void CNavMesh::OnMapStart()
+static void ReportLoadResult(NavErrorType error)
 {
-	LoadPlaceDatabase();
-
-	NavErrorType error = NAV_CORRUPT_DATA;
-	
-	try
-	{
-		error = Load();
-	}
-	catch (const std::ios_base::failure& ex)
-	{
-		smutils->LogError(myself, "Exception throw while reading navigation mesh file: %s", ex.what());
-		Reset();
-		error = NAV_CORRUPT_DATA;
-	}
-	catch (const std::exception& ex)
-	{
-		smutils->LogError(myself, "Failed to load navigation mesh: %s", ex.what());
-		Reset();
-		error = NAV_CORRUPT_DATA;
-	}
-
 	switch (error)
 	{
 	case NAV_OK:
@@ -264,6 +280,39 @@ void CNavMesh::OnMapStart()
 	default:
 		break;
 	}
+}
+
+void CNavMesh::OnMapStart()
+{
+	LoadPlaceDatabase();
+
+	// the file is loaded while the server starts, UpdateLoad finishes it on the game thread
+	if (sm_nav_load_async.GetBool())
+	{
+		LoadAsync();
+		return;
+	}
+
+	NavErrorType error = NAV_CORRUPT_DATA;
+	
+	try
+	{
+		error = Load();
+	}
+	catch (const std::ios_base::failure& ex)
+	{
+		smutils->LogError(myself, "Exception throw while reading navigation mesh file: %s", ex.what());
+		Reset();
+		error = NAV_CORRUPT_DATA;
+	}
+	catch (const std::exception& ex)
+	{
+		smutils->LogError(myself, "Failed to load navigation mesh: %s", ex.what());
+		Reset();
+		error = NAV_CORRUPT_DATA;
+	}
+
+	ReportLoadResult(error);
 
 	// Sourcemod's OnMapStart is called on a ServerActivate hook
 	OnServerActivate(); // this isn't called anywhere else so just call it here
@@ -271,6 +320,84 @@ void CNavMesh::OnMapStart()
 
 void CNavMesh::OnMapEnd()
 {
+	CancelLoad();
+}
+
+/**
+ * Publish the mesh if the loader thread is done. Returns true once the load is finished.
+ */
+bool CNavMesh::UpdateLoad()
+{
+	if (m_loadTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+	{
+		return false;
+	}
+
+	NavErrorType error = NAV_CORRUPT_DATA;
+
+	try
+	{
+		error = m_loadTask.get();
+	}
+	catch (const std::exception& ex)
+	{
+		smutils->LogError(myself, "Failed to load navigation mesh: %s", ex.what());
+		Reset();
+		error = NAV_CORRUPT_DATA;
+	}
+
+	ReportLoadResult(FinishLoad(error));
+
+	// deferred from OnMapStart
+	OnServerActivate();
+	return true;
+}
+
+void CNavMesh::RebuildClusterGraph()
+{
+	if ( !sm_nav_cluster_pathfind.GetBool() || !IsLoaded() || sm_nav_edit.GetBool() )
+	{
+		m_clusterGraph->Clear();
+		return;
+	}
+
+	m_clusterGraph->Build();
+}
+
+void CNavMesh::RebuildLandmarks()
+{
+	// search indexes are reused when areas are deleted and created while editing
+	if ( !IsLoaded() || sm_nav_edit.GetBool() )
+	{
+		m_landmarks->Clear();
+		return;
+	}
+
+	m_landmarks->Build( static_cast<unsigned int>( sm_nav_landmarks.GetInt() ) );
+}
+
+void CNavMesh::RebuildConnectionGraph()
+{
+	// connections change while editing, incremental searches fall back to regular searches until edit mode ends
+	if ( !IsLoaded() || sm_nav_edit.GetBool() )
+	{
+		m_connectionGraph->Clear();
+		return;
+	}
+
+	m_connectionGraph->Build();
+}
+
+void CNavMesh::RebuildLayeredGrid()
+{
+	// areas move while editing, the queries use the plain grid until edit mode ends
+	if ( !IsLoaded() || sm_nav_edit.GetBool() )
+	{
+		m_layeredGrid->Clear();
+		return;
+	}
+
+	m_layeredGrid->Build( m_grid );
 }
 
 //--------------------------------------------------------------------------------------------------------------
@@ -331,6 +458,17 @@ CNavArea *CNavMesh::GetMarkedArea( void ) const
  */
 void CNavMesh::DestroyNavigationMesh( bool incremental )
 {
+	// time sliced searches may still be reading the areas
+	m_pathSlicer->DiscardAll();
+	m_clusterGraph->Clear();
+	m_pathCache->Invalidate();
+	m_landmarks->Clear();
+	m_connectionGraph->Clear();
+	m_flowFields->Invalidate();
+	m_reachability->Invalidate();
+	m_layeredGrid->Clear();
+	m_areaTracker->Clear();
+
 	// these needs the nav area pointers to still be valid since some of them notify their destruction via the destructor
 	m_selectedWaypoint = nullptr;
 	m_selectedVolume = nullptr;
@@ -343,6 +481,7 @@ void CNavMesh::DestroyNavigationMesh( bool incremental )
 		m_volumes.clear();
 		m_elevators.clear();
 		m_prerequisites.clear();
+		m_deferredSections.clear();
 	}
 
 	m_blockedAreas.RemoveAll();
@@ -430,6 +569,23 @@ void CNavMesh::DestroyNavigationMesh( bool incremental )
  * Invoked on each game frame
  */
 void CNavMesh::Update( void )
+{
+	// nothing else may touch the mesh until the loader thread is done, derived meshes only get OnFrame
+	if (IsLoading())
+	{
+		UpdateLoad();
+		return;
+	}
+
+	OnFrame();
+}
+
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Invoked on each game frame once the mesh isn't loading, derived meshes extend it
+ */
+void CNavMesh::OnFrame( void )
 {
 	if (IsGenerating())
 	{
@@ -447,6 +603,9 @@ void CNavMesh::Update( void )
 	UpdateBlockedAreas();
 	UpdateAvoidanceObstacleAreas();
 
+	// after the blocked areas, the tracker skips the areas blocked for the player's team
+	m_areaTracker->Update();
+
 	if (sm_nav_edit.GetBool())
 	{
 		if (m_isEditing == false)
@@ -632,6 +791,15 @@ void CNavMesh::FireGameEvent(IGameEvent* event)
 	if (event == nullptr)
 		return;
 
+	// OnServerActivate restarts the round once the mesh is loaded
+	if (IsLoading())
+		return;
+
+	OnGameEvent(event);
+}
+
+void CNavMesh::OnGameEvent(IGameEvent* event)
+{
 	auto name = event->GetName();
 
 	if (strncmp(name, "round_start", 11) == 0 || strncmp(name, "dod_round_start", 15) == 0 || strncmp(name, "teamplay_round_start", 20) == 0)
@@ -670,7 +838,7 @@ void CNavMesh::AllocateGrid( float minX, float maxX, float minY, float maxY )
 /**
  * Add an area to the mesh
  */
-void CNavMesh::AddNavArea( CNavArea *area )
+void CNavMesh::AddNavArea( CNavArea *area, bool addToGrid )
 {
 	if ( !m_grid.Count() )
 	{
@@ -679,19 +847,25 @@ void CNavMesh::AddNavArea( CNavArea *area )
 	}
 
 	// add to grid
-	int loX = WorldToGridX( area->GetCorner( NORTH_WEST ).x );
-	int loY = WorldToGridY( area->GetCorner( NORTH_WEST ).y );
-	int hiX = WorldToGridX( area->GetCorner( SOUTH_EAST ).x );
-	int hiY = WorldToGridY( area->GetCorner( SOUTH_EAST ).y );
-
-	for( int y = loY; y <= hiY; ++y )
+	if ( addToGrid )
 	{
-		for( int x = loX; x <= hiX; ++x )
+		int loX = WorldToGridX( area->GetCorner( NORTH_WEST ).x );
+		int loY = WorldToGridY( area->GetCorner( NORTH_WEST ).y );
+		int hiX = WorldToGridX( area->GetCorner( SOUTH_EAST ).x );
+		int hiY = WorldToGridY( area->GetCorner( SOUTH_EAST ).y );
+
+		for( int y = loY; y <= hiY; ++y )
 		{
-			m_grid[ x + y*m_gridSizeX ].AddToTail( const_cast<CNavArea *>( area ) );
+			for( int x = loX; x <= hiX; ++x )
+			{
+				m_grid[ x + y*m_gridSizeX ].AddToTail( const_cast<CNavArea *>( area ) );
+			}
 		}
 	}
 
+	// no longer matches the grid
+	m_layeredGrid->Clear();
+
 	// add to hash table
 	int key = ComputeHashKey( area->GetID() );
 
@@ -739,6 +913,10 @@ void CNavMesh::RemoveNavArea( CNavArea *area )
 		}
 	}
 
+	// no longer matches the grid
+	m_layeredGrid->Clear();
+	m_areaTracker->Clear();
+
 	// remove from hash table
 	int key = ComputeHashKey( area->GetID() );
 
@@ -947,6 +1125,12 @@ CNavArea *CNavMesh::GetNavArea( const Vector &pos, float beneathLimit ) const
 	float useZ = -99999999.9f;
 	Vector testPos = pos + Vector( 0, 0, 5 );
 
+	if ( m_layeredGrid->IsAvailable() )
+	{
+		// same checks as below, starting with the highest areas of the cell
+		return m_layeredGrid->GetAreaBeneath( x + y*m_gridSizeX, testPos, testPos.z, pos.z - beneathLimit, []( CNavArea *area ) { return true; } );
+	}
+
 	FOR_EACH_VEC( (*areaVector), it )
 	{
 		CNavArea *area = (*areaVector)[ it ];
@@ -1014,30 +1198,46 @@ CNavArea *CNavMesh::GetNavArea( edict_t *pEntity, int nFlags, float flBeneathLim
 	float useZ = -99999999.9f;
 
 	bool bSkipBlockedAreas = ( ( nFlags & GETNAVAREA_ALLOW_BLOCKED_AREAS ) == 0 );
-	FOR_EACH_VEC( (*areaVector), it )
+
+	if ( m_layeredGrid->IsAvailable() )
 	{
-		CNavArea *pArea = (*areaVector)[ it ];
+		// same checks as below, starting with the highest areas of the cell
+		use = m_layeredGrid->GetAreaBeneath( x + y*m_gridSizeX, testPos, testPos.z + flStepHeight, testPos.z - flBeneathLimit, [&]( CNavArea *pArea ) {
+			return !( bSkipBlockedAreas && isPlayer && pArea->IsBlocked( pBCC->GetTeamIndex() ) );
+		} );
 
-		// check if position is within 2D boundaries of this area
-		if ( !pArea->IsOverlapping( testPos )
-		// don't consider blocked areas
-				|| ( bSkipBlockedAreas && isPlayer
-						&& pArea->IsBlocked( pBCC->GetTeamIndex() ) ))
-			continue;
+		if ( use )
+		{
+			useZ = use->GetZ( testPos );
+		}
+	}
+	else
+	{
+		FOR_EACH_VEC( (*areaVector), it )
+		{
+			CNavArea *pArea = (*areaVector)[ it ];
 
-		// project position onto area to get Z
-		float z = pArea->GetZ( testPos );
+			// check if position is within 2D boundaries of this area
+			if ( !pArea->IsOverlapping( testPos )
+			// don't consider blocked areas
+					|| ( bSkipBlockedAreas && isPlayer
+							&& pArea->IsBlocked( pBCC->GetTeamIndex() ) ))
+				continue;
 
-		// if area is above us, skip it
-		if ( z > testPos.z + flStepHeight
-		// if area is too far below us, skip it
-				|| z < testPos.z - flBeneathLimit
-		// if area is lower than the one we have, skip it
-				|| z <= useZ )
-			continue;
+			// project position onto area to get Z
+			float z = pArea->GetZ( testPos );
+
+			// if area is above us, skip it
+			if ( z > testPos.z + flStepHeight
+			// if area is too far below us, skip it
+					|| z < testPos.z - flBeneathLimit
+			// if area is lower than the one we have, skip it
+					|| z <= useZ )
+				continue;
 
-		use = pArea;
-		useZ = z;
+			use = pArea;
+			useZ = z;
+		}
 	}
 
 	// Check LOS if necessary
@@ -1080,34 +1280,27 @@ CNavArea *CNavMesh::GetNearestNavArea( const Vector &pos, float maxDist, bool ch
 	}
 
 	// ensure source position is well behaved
-	Vector source;
-	source.x = pos.x;
-	source.y = pos.y;
-	if ( !GetGroundHeight( pos, &source.z ) )
+	// the closest point on an area doesn't depend on the source height, the ground trace only rejects positions without ground
+	Vector source = pos;
+
+	if ( checkGround )
 	{
-		if ( !checkGround )
-		{
-			source.z = pos.z;
-		}
-		else
+		if ( !GetGroundHeight( pos, &source.z ) )
 		{
 			return NULL;
 		}
+
+		source.z += navgenparams->human_height;
 	}
 
-	source.z += navgenparams->human_height;
+	// areas can be rejected from their stored bounds without reading them
+	const CNavLayeredGrid *layeredGrid = m_layeredGrid->IsAvailable() ? m_layeredGrid.get() : nullptr;
 
 	// find closest nav area
 
 	// use a unique marker for this method, so it can be used within a SearchSurroundingArea() call
-	static unsigned int searchMarker = librandom::generate_random_int(0, 1024 * 1024);
-
-	++searchMarker;
-
-	if ( searchMarker == 0 )
-	{
-		++searchMarker;
-	}
+	NavSearchContext* searchContext = NavSearchContext::GetCurrent();
+	searchContext->MakeNewNearSearchMarker();
 
 
 	// get list in cell that contains position
@@ -1142,14 +1335,26 @@ CNavArea *CNavMesh::GetNearestNavArea( const Vector &pos, float maxDist, bool ch
 					continue;
 
 				NavAreaVector *areaVector = &m_grid[ x + y*m_gridSizeX ];
+				unsigned int candidates = 0U;
 
 				// find closest area in this cell
 				FOR_EACH_VEC( (*areaVector), it )
 				{
+					if ( layeredGrid )
+					{
+						// overhead or can't be closer than the closest area found, always rejected by the checks below
+						// the areas of a batch are tested at once against the closest distance found before the batch
+						if ( it % CNavLayeredGrid::BATCH_SIZE == 0 )
+							candidates = layeredGrid->GetNearMask( x + y*m_gridSizeX, it, pos, closeDistSq, navgenparams->human_height );
+
+						if ( ( candidates & ( 1U << ( it % CNavLayeredGrid::BATCH_SIZE ) ) ) == 0 )
+							continue;
+					}
+
 					CNavArea *area = (*areaVector)[ it ];
 
 					// skip if we've already visited this area
-					if ( area->m_nearNavSearchMarker == searchMarker
+					if ( searchContext->IsNearSearchMarked( area )
 							// don't consider blocked areas
 							|| area->IsBlocked( team )
 							// don't consider area that is overhead
@@ -1157,7 +1362,7 @@ CNavArea *CNavMesh::GetNearestNavArea( const Vector &pos, float maxDist, bool ch
 						continue;
 
 					// mark as visited
-					area->m_nearNavSearchMarker = searchMarker;
+					searchContext->NearSearchMark( area );
 
 					Vector areaPos;
 					area->GetClosestPointOnArea( source, &areaPos );
@@ -1810,8 +2015,8 @@ void CNavMesh::IncreaseDangerNearby( int teamID, float amount, CNavArea *startAr
 					float cost = (adjArea->GetCenter() - pos).Length();
 					if (cost <= maxRadius)
 					{
-						adjArea->AddToOpenList();
 						adjArea->SetTotalCost( cost );
+						adjArea->AddToOpenList();
 						adjArea->Mark();
 
 						finalDanger = amount * cost/maxRadius;
@@ -1834,7 +2039,7 @@ void CNavMesh::IncreaseDangerNearby( int teamID, float amount, CNavArea *startAr
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavRemoveJumpAreas( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavRemoveJumpAreas();
@@ -1845,7 +2050,7 @@ static ConCommand sm_nav_remove_jump_areas( "sm_nav_remove_jump_areas", CommandN
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavDelete( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() || !sm_nav_edit.GetBool() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() || !sm_nav_edit.GetBool() )
 		return;
 
 	TheNavMesh->CommandNavDelete();
@@ -1856,7 +2061,7 @@ static ConCommand sm_nav_delete( "sm_nav_delete", CommandNavDelete, "Deletes the
 //-------------------------------------------------------------------------------------------------------------- 
 void CommandNavDeleteMarked( void ) 
 { 
-	if ( !UTIL_IsCommandIssuedByServerAdmin() || !sm_nav_edit.GetBool() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() || !sm_nav_edit.GetBool() )
 		return; 
 
 	TheNavMesh->CommandNavDeleteMarked(); 
@@ -1867,7 +2072,7 @@ static ConCommand sm_nav_delete_marked( "sm_nav_delete_marked", CommandNavDelete
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_flood_select, "Selects the current Area and all Areas connected to it, recursively. To clear a selection, use this command again.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavFloodSelect( args );
@@ -1877,7 +2082,7 @@ CON_COMMAND_F(sm_nav_flood_select, "Selects the current Area and all Areas conne
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavToggleSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleSelectedSet();
@@ -1888,7 +2093,7 @@ static ConCommand sm_nav_toggle_selected_set( "sm_nav_toggle_selected_set", Comm
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavStoreSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavStoreSelectedSet();
@@ -1899,7 +2104,7 @@ static ConCommand sm_nav_store_selected_set( "sm_nav_store_selected_set", Comman
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavRecallSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavRecallSelectedSet();
@@ -1910,7 +2115,7 @@ static ConCommand sm_nav_recall_selected_set( "sm_nav_recall_selected_set", Comm
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavAddToSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavAddToSelectedSet();
@@ -1921,7 +2126,7 @@ static ConCommand sm_nav_add_to_selected_set( "sm_nav_add_to_selected_set", Comm
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_add_to_selected_set_by_id, "Add specified area id to the selected set.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavAddToSelectedSetByID( args );
@@ -1931,7 +2136,7 @@ CON_COMMAND_F(sm_nav_add_to_selected_set_by_id, "Add specified area id to the se
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavRemoveFromSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavRemoveFromSelectedSet();
@@ -1942,7 +2147,7 @@ static ConCommand sm_nav_remove_from_selected_set( "sm_nav_remove_from_selected_
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavToggleInSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleInSelectedSet();
@@ -1953,7 +2158,7 @@ static ConCommand sm_nav_toggle_in_selected_set( "sm_nav_toggle_in_selected_set"
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavClearSelectedSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavClearSelectedSet();
@@ -1964,7 +2169,7 @@ static ConCommand sm_nav_clear_selected_set( "sm_nav_clear_selected_set", Comman
 //----------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_dump_selected_set_positions, "Write the (x,y,z) coordinates of the centers of all selected nav areas to a file.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	const NavAreaVector &selectedSet = TheNavMesh->GetSelectedSet();
@@ -2000,7 +2205,7 @@ CON_COMMAND_F(sm_nav_dump_selected_set_positions, "Write the (x,y,z) coordinates
 //----------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_show_dumped_positions, "Show the (x,y,z) coordinate positions of the given dump file.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	CUtlBuffer fileBuffer( 4096, 1024*1024, CUtlBuffer::TEXT_BUFFER );
@@ -2037,7 +2242,7 @@ CON_COMMAND_F(sm_nav_show_dumped_positions, "Show the (x,y,z) coordinate positio
 //----------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_larger_than, "Select nav areas where both dimensions are larger than the given size.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	if ( args.ArgC() > 1 )
@@ -2065,7 +2270,7 @@ CON_COMMAND_F(sm_nav_select_larger_than, "Select nav areas where both dimensions
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBeginSelecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBeginSelecting();
@@ -2076,7 +2281,7 @@ static ConCommand sm_nav_begin_selecting( "sm_nav_begin_selecting", CommandNavBe
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavEndSelecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavEndSelecting();
@@ -2087,7 +2292,7 @@ static ConCommand sm_nav_end_selecting( "sm_nav_end_selecting", CommandNavEndSel
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBeginDragSelecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBeginDragSelecting();
@@ -2098,7 +2303,7 @@ static ConCommand sm_nav_begin_drag_selecting( "sm_nav_begin_drag_selecting", Co
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavEndDragSelecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavEndDragSelecting();
@@ -2109,7 +2314,7 @@ static ConCommand sm_nav_end_drag_selecting( "sm_nav_end_drag_selecting", Comman
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBeginDragDeselecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBeginDragDeselecting();
@@ -2120,7 +2325,7 @@ static ConCommand sm_nav_begin_drag_deselecting( "sm_nav_begin_drag_deselecting"
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavEndDragDeselecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavEndDragDeselecting();
@@ -2131,7 +2336,7 @@ static ConCommand sm_nav_end_drag_deselecting( "sm_nav_end_drag_deselecting", Co
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavRaiseDragVolumeMax( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavRaiseDragVolumeMax();
@@ -2142,7 +2347,7 @@ static ConCommand sm_nav_raise_drag_volume_max( "sm_nav_raise_drag_volume_max",
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavLowerDragVolumeMax( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavLowerDragVolumeMax();
@@ -2153,7 +2358,7 @@ static ConCommand sm_nav_lower_drag_volume_max( "sm_nav_lower_drag_volume_max",
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavRaiseDragVolumeMin( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavRaiseDragVolumeMin();
@@ -2164,7 +2369,7 @@ static ConCommand sm_nav_raise_drag_volume_min( "sm_nav_raise_drag_volume_min",
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavLowerDragVolumeMin( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavLowerDragVolumeMin();
@@ -2175,7 +2380,7 @@ static ConCommand sm_nav_lower_drag_volume_min( "sm_nav_lower_drag_volume_min",
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavToggleSelecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleSelecting();
@@ -2186,7 +2391,7 @@ static ConCommand sm_nav_toggle_selecting( "sm_nav_toggle_selecting", CommandNav
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBeginDeselecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBeginDeselecting();
@@ -2197,7 +2402,7 @@ static ConCommand sm_nav_begin_deselecting( "sm_nav_begin_deselecting", CommandN
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavEndDeselecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavEndDeselecting();
@@ -2208,7 +2413,7 @@ static ConCommand sm_nav_end_deselecting( "sm_nav_end_deselecting", CommandNavEn
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavToggleDeselecting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleDeselecting();
@@ -2219,7 +2424,7 @@ static ConCommand sm_nav_toggle_deselecting( "sm_nav_toggle_deselecting", Comman
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_half_space, "Selects any areas that intersect the given half-space.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectHalfSpace( args );
@@ -2229,7 +2434,7 @@ CON_COMMAND_F(sm_nav_select_half_space, "Selects any areas that intersect the gi
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBeginShiftXY( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBeginShiftXY();
@@ -2240,7 +2445,7 @@ static ConCommand sm_nav_begin_shift_xy( "sm_nav_begin_shift_xy", CommandNavBegi
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavEndShiftXY( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavEndShiftXY();
@@ -2251,7 +2456,7 @@ static ConCommand sm_nav_end_shift_xy( "sm_nav_end_shift_xy", CommandNavEndShift
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavSelectInvalidAreas( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectInvalidAreas();
@@ -2262,7 +2467,7 @@ static ConCommand sm_nav_select_invalid_areas( "sm_nav_select_invalid_areas", Co
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_blocked_areas, "Adds all blocked areas to the selected set", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectBlockedAreas();
@@ -2272,7 +2477,7 @@ CON_COMMAND_F(sm_nav_select_blocked_areas, "Adds all blocked areas to the select
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_obstructed_areas, "Adds all obstructed areas to the selected set", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectObstructedAreas();
@@ -2282,7 +2487,7 @@ CON_COMMAND_F(sm_nav_select_obstructed_areas, "Adds all obstructed areas to the
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_damaging_areas, "Adds all damaging areas to the selected set", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectDamagingAreas();
@@ -2292,7 +2497,7 @@ CON_COMMAND_F(sm_nav_select_damaging_areas, "Adds all damaging areas to the sele
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_stairs, "Adds all stairway areas to the selected set", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectStairs();
@@ -2302,7 +2507,7 @@ CON_COMMAND_F(sm_nav_select_stairs, "Adds all stairway areas to the selected set
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_select_orphans, "Adds all orphan areas to the selected set (highlight a valid area first).", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSelectOrphans();
@@ -2312,7 +2517,7 @@ CON_COMMAND_F(sm_nav_select_orphans, "Adds all orphan areas to the selected set
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavSplit( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSplit();
@@ -2323,7 +2528,7 @@ static ConCommand sm_nav_split( "sm_nav_split", CommandNavSplit, "To split an Ar
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavMakeSniperSpots( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavMakeSniperSpots();
@@ -2334,7 +2539,7 @@ static ConCommand sm_nav_make_sniper_spots( "sm_nav_make_sniper_spots", CommandN
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavMerge( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavMerge();
@@ -2345,7 +2550,7 @@ static ConCommand sm_nav_merge( "sm_nav_merge", CommandNavMerge, "To merge two A
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavMark( const CCommand &args )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavMark( args );
@@ -2356,7 +2561,7 @@ static ConCommand sm_nav_mark( "sm_nav_mark", CommandNavMark, "Marks the Area or
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavUnmark( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavUnmark();
@@ -2367,7 +2572,7 @@ static ConCommand sm_nav_unmark( "sm_nav_unmark", CommandNavUnmark, "Clears the
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBeginArea( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBeginArea();
@@ -2378,7 +2583,7 @@ static ConCommand sm_nav_begin_area( "sm_nav_begin_area", CommandNavBeginArea, "
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavEndArea( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavEndArea();
@@ -2389,7 +2594,7 @@ static ConCommand sm_nav_end_area( "sm_nav_end_area", CommandNavEndArea, "Define
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavConnect( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavConnect();
@@ -2400,7 +2605,7 @@ static ConCommand sm_nav_connect( "sm_nav_connect", CommandNavConnect, "To conne
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavDisconnect( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavDisconnect();
@@ -2411,7 +2616,7 @@ static ConCommand sm_nav_disconnect( "sm_nav_disconnect", CommandNavDisconnect,
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavDisconnectOutgoingOneWays( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavDisconnectOutgoingOneWays();
@@ -2422,7 +2627,7 @@ static ConCommand sm_nav_disconnect_outgoing_oneways( "sm_nav_disconnect_outgoin
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavSplice( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavSplice();
@@ -2433,7 +2638,7 @@ static ConCommand sm_nav_splice( "sm_nav_splice", CommandNavSplice, "To splice,
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavCrouch( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_CROUCH );
@@ -2444,7 +2649,7 @@ static ConCommand sm_nav_crouch( "sm_nav_crouch", CommandNavCrouch, "Toggles the
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPrecise( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_PRECISE );
@@ -2455,7 +2660,7 @@ static ConCommand sm_nav_precise( "sm_nav_precise", CommandNavPrecise, "Toggles
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavJump( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_JUMP );
@@ -2466,7 +2671,7 @@ static ConCommand sm_nav_jump( "sm_nav_jump", CommandNavJump, "Toggles the 'trav
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavNoJump( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_NO_JUMP );
@@ -2477,7 +2682,7 @@ static ConCommand sm_nav_no_jump( "sm_nav_no_jump", CommandNavNoJump, "Toggles t
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavStop( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_STOP );
@@ -2488,7 +2693,7 @@ static ConCommand sm_nav_stop( "sm_nav_stop", CommandNavStop, "Toggles the 'must
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavWalk( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_WALK );
@@ -2499,7 +2704,7 @@ static ConCommand sm_nav_walk( "sm_nav_walk", CommandNavWalk, "Toggles the 'trav
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavRun( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_RUN );
@@ -2510,7 +2715,7 @@ static ConCommand sm_nav_run( "sm_nav_run", CommandNavRun, "Toggles the 'travers
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavAvoid( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_AVOID );
@@ -2521,7 +2726,7 @@ static ConCommand sm_nav_avoid( "sm_nav_avoid", CommandNavAvoid, "Toggles the 'a
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavTransient( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_TRANSIENT );
@@ -2532,7 +2737,7 @@ static ConCommand sm_nav_transient( "sm_nav_transient", CommandNavTransient, "To
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavDontHide( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_DONT_HIDE );
@@ -2543,7 +2748,7 @@ static ConCommand sm_nav_dont_hide( "sm_nav_dont_hide", CommandNavDontHide, "Tog
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavStand( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_STAND );
@@ -2554,7 +2759,7 @@ static ConCommand sm_nav_stand( "sm_nav_stand", CommandNavStand, "Toggles the 's
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavNoHostages( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavToggleAttribute( NAV_MESH_NO_HOSTAGES );
@@ -2565,7 +2770,7 @@ static ConCommand sm_nav_no_hostages( "sm_nav_no_hostages", CommandNavNoHostages
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavStrip( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->StripNavigationAreas();
@@ -2576,7 +2781,7 @@ static ConCommand sm_nav_strip( "sm_nav_strip", CommandNavStrip, "Strips all Hid
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavSave( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	if (TheNavMesh->Save())
@@ -2595,7 +2800,7 @@ static ConCommand sm_nav_save( "sm_nav_save", CommandNavSave, "Saves the current
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavLoad( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	if (TheNavMesh->Load() != NAV_OK)
@@ -2617,7 +2822,7 @@ static int PlaceNameAutocompleteCallback( char const *partial, char commands[ CO
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavUsePlace( const CCommand &args )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	if (args.ArgC() == 1)
@@ -2647,7 +2852,7 @@ static ConCommand sm_nav_use_place( "sm_nav_use_place", CommandNavUsePlace, "If
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPlaceReplace( const CCommand &args )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	if (args.ArgC() != 3)
@@ -2684,7 +2889,7 @@ static ConCommand sm_nav_place_replace( "sm_nav_place_replace", CommandNavPlaceR
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPlaceList( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	std::unordered_set<Place> allplaces;
@@ -2713,7 +2918,7 @@ static ConCommand sm_nav_place_list( "sm_nav_place_list", CommandNavPlaceList, "
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavTogglePlaceMode( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavTogglePlaceMode();
@@ -2724,7 +2929,7 @@ static ConCommand sm_nav_toggle_place_mode( "sm_nav_toggle_place_mode", CommandN
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavSetPlaceMode( const CCommand &args )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	bool on = true;
@@ -2744,7 +2949,7 @@ static ConCommand sm_nav_set_place_mode( "sm_nav_set_place_mode", CommandNavSetP
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPlaceFloodFill( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavPlaceFloodFill();
@@ -2755,7 +2960,7 @@ static ConCommand sm_nav_place_floodfill( "sm_nav_place_floodfill", CommandNavPl
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPlaceSet( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavPlaceSet();
@@ -2766,7 +2971,7 @@ static ConCommand sm_nav_place_set( "sm_nav_place_set", CommandNavPlaceSet, "Set
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPlacePick( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavPlacePick();
@@ -2777,7 +2982,7 @@ static ConCommand sm_nav_place_pick( "sm_nav_place_pick", CommandNavPlacePick, "
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavTogglePlacePainting( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavTogglePlacePainting();
@@ -2788,7 +2993,7 @@ static ConCommand sm_nav_toggle_place_painting( "sm_nav_toggle_place_painting",
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavMarkUnnamed( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavMarkUnnamed();
@@ -2799,7 +3004,7 @@ static ConCommand sm_nav_mark_unnamed( "sm_nav_mark_unnamed", CommandNavMarkUnna
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavCornerSelect( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavCornerSelect();
@@ -2810,7 +3015,7 @@ static ConCommand sm_nav_corner_select( "sm_nav_corner_select", CommandNavCorner
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_corner_raise, "Raise the selected corner of the currently marked Area.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavCornerRaise( args );
@@ -2820,7 +3025,7 @@ CON_COMMAND_F(sm_nav_corner_raise, "Raise the selected corner of the currently m
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_corner_lower, "Lower the selected corner of the currently marked Area.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavCornerLower( args );
@@ -2830,7 +3035,7 @@ CON_COMMAND_F(sm_nav_corner_lower, "Lower the selected corner of the currently m
 //--------------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_corner_place_on_ground, "Places the selected corner of the currently marked Area on the ground.", FCVAR_GAMEDLL | FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavCornerPlaceOnGround( args );
@@ -2840,7 +3045,7 @@ CON_COMMAND_F(sm_nav_corner_place_on_ground, "Places the selected corner of the
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavWarpToMark( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavWarpToMark();
@@ -2851,7 +3056,7 @@ static ConCommand sm_nav_warp_to_mark( "sm_nav_warp_to_mark", CommandNavWarpToMa
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavLadderFlip( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavLadderFlip();
@@ -2862,7 +3067,7 @@ static ConCommand sm_nav_ladder_flip( "sm_nav_ladder_flip", CommandNavLadderFlip
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavGenerate( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->BeginGeneration();
@@ -2873,7 +3078,7 @@ static ConCommand sm_nav_generate( "sm_nav_generate", CommandNavGenerate, "Gener
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavGenerateIncremental( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->BeginGeneration( INCREMENTAL_GENERATION );
@@ -2884,7 +3089,7 @@ static ConCommand sm_nav_generate_incremental( "sm_nav_generate_incremental", Co
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavAnalyze( void )
 {
-	if ( UTIL_IsCommandIssuedByServerAdmin() && sm_nav_edit.GetBool() )
+	if ( UTIL_IsCommandIssuedByServerAdmin() && !UTIL_WarnIfNavMeshIsLoading() && sm_nav_edit.GetBool() )
 	{
 		TheNavMesh->BeginAnalysis();
 	}
@@ -2895,7 +3100,7 @@ static ConCommand sm_nav_analyze( "sm_nav_analyze", CommandNavAnalyze, "Re-analy
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavAnalyzeScripted( const CCommand &args )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	const char *pszCmd = NULL;
@@ -2924,7 +3129,7 @@ static ConCommand sm_nav_analyze_scripted( "sm_nav_analyze_scripted", CommandNav
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavMarkWalkable( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavMarkWalkable();
@@ -2936,7 +3141,7 @@ void CNavMesh::CommandNavMarkWalkable( void )
 {
 	Vector pos;
 
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	if (sm_nav_edit.GetBool())
@@ -2985,7 +3190,7 @@ static ConCommand sm_nav_seed_walkable_spots("sm_nav_seed_walkable_spots", Comma
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavClearWalkableMarks( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->ClearWalkableSeeds();
@@ -2996,7 +3201,7 @@ static ConCommand sm_nav_clear_walkable_marks( "sm_nav_clear_walkable_marks", Co
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavCompressID( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	CNavArea::CompressIDs(TheNavMesh);
@@ -3013,7 +3218,7 @@ static ConCommand sm_nav_compress_id( "sm_nav_compress_id", CommandNavCompressID
 #ifdef TERROR
 void CommandNavShowLadderBounds( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	CFuncSimpleLadder *ladder = NULL;
@@ -3031,7 +3236,7 @@ static ConCommand nav_show_ladder_bounds( "nav_show_ladder_bounds", CommandNavSh
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavBuildLadder( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavBuildLadder();
@@ -3201,7 +3406,7 @@ static ConCommand SMNavMarkAttribute( "sm_nav_mark_attribute", NavEditMarkAttrib
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavPickArea( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavPickArea();
@@ -3212,7 +3417,7 @@ static ConCommand nav_pick_area( "nav_pick_area", CommandNavPickArea, "Marks an
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavResizeHorizontal( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavResizeHorizontal();
@@ -3223,7 +3428,7 @@ static ConCommand nav_resize_horizontal( "nav_resize_horizontal", CommandNavResi
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavResizeVertical( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavResizeVertical();
@@ -3234,7 +3439,7 @@ static ConCommand nav_resize_vertical( "nav_resize_vertical", CommandNavResizeVe
 //--------------------------------------------------------------------------------------------------------------
 void CommandNavResizeEnd( void )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() )
 		return;
 
 	TheNavMesh->CommandNavResizeEnd();
@@ -3333,7 +3538,7 @@ HidingSpot::HidingSpot( void )
 
 
 //--------------------------------------------------------------------------------------------------------------
-void HidingSpot::Save(std::fstream& filestream, uint32_t version)
+void HidingSpot::Save(std::ostream& filestream, uint32_t version)
 {
 	filestream.write(reinterpret_cast<char*>(&m_id), sizeof(m_id));
 	filestream.write(reinterpret_cast<char*>(&m_pos), sizeof(Vector));
@@ -3342,11 +3547,11 @@ void HidingSpot::Save(std::fstream& filestream, uint32_t version)
 
 
 //--------------------------------------------------------------------------------------------------------------
-void HidingSpot::Load(std::fstream& filestream, uint32_t version)
+void HidingSpot::Load(CNavFileReader& reader, uint32_t version)
 {
-	filestream.read(reinterpret_cast<char*>(&m_id), sizeof(m_id));
-	filestream.read(reinterpret_cast<char*>(&m_pos), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_flags), sizeof(m_flags));
+	reader.Read(m_id);
+	reader.Read(m_pos);
+	reader.Read(m_flags);
 
 	// update next ID to avoid ID collisions by later spots
 	if (m_id >= m_nextID)
@@ -3365,7 +3570,7 @@ NavErrorType HidingSpot::PostLoad( void )
 
 	if ( !m_area )
 	{
-		DevWarning( "A Hiding Spot is off of the Nav Mesh at setpos %.0f %.0f %.0f\n", m_pos.x, m_pos.y, m_pos.z );
+		TheNavMesh->LogLoadMessage( NAV_LOAD_DEV_WARNING, "A Hiding Spot is off of the Nav Mesh at setpos %.0f %.0f %.0f\n", m_pos.x, m_pos.y, m_pos.z );
 	}
 
 	return NAV_OK;
@@ -3398,6 +3603,8 @@ void CNavMesh::OnAreaBlocked( CNavArea *area )
 	{
 		m_blockedAreas.AddToTail( area );
 	}
+
+	m_pathCache->Invalidate();
 }
 
 
@@ -3406,6 +3613,8 @@ void CNavMesh::OnAreaBlocked( CNavArea *area )
 void CNavMesh::OnAreaUnblocked( CNavArea *area )
 {
 	m_blockedAreas.FindAndRemove( area );
+
+	m_pathCache->Invalidate();
 }
 
 
@@ -3583,6 +3792,9 @@ void CNavMesh::RebuildPrerequisiteMap()
 
 std::optional<const std::shared_ptr<CWaypoint>> CNavMesh::AddWaypoint(const Vector& origin)
 {
+	// IDs of new waypoints must not be used by the waypoints not loaded yet
+	LoadDeferredSection(NavFileSectionID::SECTION_WAYPOINTS);
+
 	std::shared_ptr<CWaypoint> wpt = CreateWaypoint();
 
 	if (m_waypoints.count(wpt->GetID()) > 0)
@@ -24,18 +24,25 @@
 #include <string>
 #include <cstdint>
 #include <vector>
+#include <memory>
 #include <utility>
 #include <array>
 #include <unordered_map>
 #include <unordered_set>
 #include <optional>
 #include <algorithm>
+#include <future>
+#include <atomic>
 
 #if SOURCE_ENGINE == SE_EPISODEONE
 #include <util/commandargs_episode1.h>
 #endif // SOURCE_ENGINE == SE_EPISODEONE
 
 #include "nav.h"
+#include "nav_filereader.h"
+#include "nav_filesections.h"
+#include "nav_loader.h"
+#include "nav_loadcache.h"
 #include <sdkports/sdk_timers.h>
 #include <sdkports/eventlistenerhelper.h>
 #include <shareddefs.h>
@@ -45,6 +52,15 @@
 class HidingSpot;
 class CUtlBuffer;
 class NavPlaceDatabaseLoader;
+class CNavPathSlicer;
+class CNavClusterGraph;
+class CNavPathCache;
+class CNavLandmarks;
+class CNavConnectionGraph;
+class CNavFlowFieldManager;
+class CNavReachability;
+class CNavLayeredGrid;
+class CNavAreaTracker;
 
 namespace SourceMod
 {
@@ -292,8 +308,8 @@ public:
 		return UNDEFINED_PLACE;
 	}
 
-	void Save(std::fstream& filestream);					/// store the directory
-	void Load(std::fstream& filestream, uint32_t version);	/// load the directory
+	void Save(std::ostream& filestream);					/// store the directory
+	void Load(CNavFileReader& reader, uint32_t version);	/// load the directory
 
 	bool HasUnnamedPlaces( void ) const 
 	{
@@ -321,7 +337,7 @@ public:
 	CNavMesh( void );
 	virtual ~CNavMesh();
 
-	static constexpr uint32_t NavMeshVersion = 1;
+	static constexpr uint32_t NavMeshVersion = 3; // 2: landmark distance tables 3: sections with a table of contents
 	static constexpr uint32_t NavMagicNumber = 0x20110FC0;
 
 	typedef std::pair<std::string, uint64_t> NavEditor; // name & steamid pair
@@ -369,7 +385,7 @@ public:
 	};
 
 	// CEventListenerHelper
-	void FireGameEvent(IGameEvent* event) override; // incoming event processing
+	void FireGameEvent(IGameEvent* event) override final; // incoming event processing, dropped while the mesh is loading
 
 #if SOURCE_ENGINE >= SE_LEFT4DEAD
 	int	GetEventDebugID(void) override;
@@ -388,12 +404,17 @@ public:
 	virtual HidingSpot *CreateHidingSpot( void ) const;					// Hiding Spot factory
 
 	virtual void Reset( void );											// destroy Navigation Mesh data and revert to initial state
-	virtual void Update( void );										// invoked on each game frame
+	void Update( void );												// invoked on each game frame, only publishes the mesh while it's loading
 
 	virtual NavErrorType Load( void );									// load navigation data from a file
-	virtual NavErrorType PostLoad( uint32_t version );				// (EXTEND) invoked after all areas have been loaded - for pointer binding, etc
+	virtual NavErrorType PostLoad( uint32_t version );				// (EXTEND) invoked on the game thread after the loaded data is bound - for entity binding, etc
+	void LoadAsync( void );												// load navigation data from a file on the loader thread, Update publishes it when done
+	void CancelLoad( void );											// wait for the loader thread and discard what it loaded
 	inline bool IsLoaded( void ) const		{ return m_isLoaded; }				// return true if a Navigation Mesh has been loaded
+	inline bool IsLoading( void ) const		{ return m_loadTask.valid(); }		// return true while the loader thread is reading the Navigation Mesh
 	inline bool IsAnalyzed( void ) const	{ return m_isAnalyzed; }			// return true if a Navigation Mesh has been analyzed
+	const NavLoadTimes &GetLoadTimes( void ) const { return m_loadTimes; }		// time spent on each phase of the last load
+	void LogLoadMessage( NavLoadMessageType type, const char *fmt, ... );		// log a loader error or warning, queued for the game thread while loading
 
 	/**
 	 * Return true if nav mesh can be trusted for all climbing/jumping decisions because game environment is fairly simple.
@@ -406,10 +427,14 @@ public:
 	inline bool IsOutOfDate( void ) const	{ return m_isOutOfDate; }			// return true if the Navigation Mesh is older than the current map version
 
 	virtual uint32_t GetSubVersionNumber( void ) const;										// returns sub-version number of data format used by derived classes
-	virtual void SaveCustomData(std::fstream& filestream) { }								// store custom mesh data for derived classes
-	virtual void LoadCustomData(std::fstream& filestream, uint32_t subVersion ) { }			// load custom mesh data for derived classes
-	virtual void SaveCustomDataPreArea(std::fstream& filestream) { }						// store custom mesh data for derived classes that needs to be loaded before areas are read in
-	virtual void LoadCustomDataPreArea(std::fstream& filestream, uint32_t subVersion) { }	// load custom mesh data for derived classes that needs to be loaded before areas are read in
+	virtual void SaveCustomData(std::ostream& filestream) { }								// store custom mesh data for derived classes
+	virtual void LoadCustomData(CNavFileReader& reader, uint32_t subVersion ) { }			// load custom mesh data for derived classes
+	virtual void SaveCustomDataPreArea(std::ostream& filestream) { }						// store custom mesh data for derived classes that needs to be loaded before areas are read in
+	virtual void LoadCustomDataPreArea(CNavFileReader& reader, uint32_t subVersion) { }	// load custom mesh data for derived classes that needs to be loaded before areas are read in
+
+	void LoadDeferredSection(NavFileSectionID id);									// decode a section skipped when the file was loaded, does nothing if it wasn't skipped
+	void LoadDeferredSections( void );												// decode every section skipped when the file was loaded
+	bool IsSectionDeferred(NavFileSectionID id) const;
 
 	// events
 	virtual void OnServerActivate( void );								// (EXTEND) invoked when server loads a new map
@@ -437,6 +462,20 @@ public:
 
 	unsigned int GetNavAreaCount( void ) const	{ return m_areaCount; }	// return total number of nav areas
 
+	CNavPathSlicer *GetPathSlicer( void ) const			{ return m_pathSlicer.get(); }	// time sliced path searches, stepped every tick
+	const CNavClusterGraph *GetClusterGraph( void ) const	{ return m_clusterGraph.get(); }	// cluster level graph used by long path searches
+	CNavPathCache *GetPathCache( void ) const			{ return m_pathCache.get(); }	// results of recent path searches
+	const CNavLandmarks *GetLandmarks( void ) const		{ return m_landmarks.get(); }	// landmark distances used by the path finding heuristic
+	const CNavConnectionGraph *GetConnectionGraph( void ) const	{ return m_connectionGraph.get(); }	// outgoing and incoming connections of every area
+	CNavFlowFieldManager *GetFlowFields( void ) const	{ return m_flowFields.get(); }	// objective flow fields shared by the bots of a team
+	CNavReachability *GetReachability( void ) const		{ return m_reachability.get(); }	// per team connected components, rejects unreachable goals
+	const CNavLayeredGrid *GetLayeredGrid( void ) const	{ return m_layeredGrid.get(); }	// area bounds stored per grid cell, used by the position queries
+	CNavAreaTracker *GetAreaTracker( void ) const		{ return m_areaTracker.get(); }	// nav area of every client, updated every tick
+	void RebuildClusterGraph( void );									// rebuild the cluster graph, or clear it if disabled or editing
+	void RebuildLandmarks( void );										// recompute the landmark distance tables, or clear them if editing
+	void RebuildConnectionGraph( void );								// rebuild the connection graph, or clear it if editing
+	void RebuildLayeredGrid( void );									// rebuild the layered grid, or clear it if editing
+
 	// See GetNavAreaFlags_t for flags
 	CNavArea *GetNavArea( const Vector &pos, float beneathLimt = 120.0f ) const;	// given a position, return the nav area that IsOverlapping and is *immediately* beneath it
 	CNavArea *GetNavArea( edict_t *pEntity, int nGetNavAreaFlags, float flBeneathLimit = 120.0f ) const;
@@ -801,7 +840,11 @@ public:
 	// Formats the map filename for save/load
 	virtual std::string GetMapFileName() const;
 	std::filesystem::path GetFullPathToNavMeshFile() const;
-	const AuthorInfo& GetAuthorInfo() const { return m_authorinfo; }
+	const AuthorInfo& GetAuthorInfo()
+	{
+		LoadDeferredSection(NavFileSectionID::SECTION_AUTHOR);
+		return m_authorinfo;
+	}
 
 	void LoadEditSounds(SourceMod::IGameConfig* gamedata);
 
@@ -825,6 +868,8 @@ public:
 	}
 
 protected:
+	virtual void OnFrame( void );								// (EXTEND) invoked by Update on each game frame, never while the mesh is loading
+	virtual void OnGameEvent( IGameEvent *event );				// (EXTEND) invoked by FireGameEvent, never while the mesh is loading
 	virtual void PostCustomAnalysis( void ) { }					// invoked when custom analysis step is complete
 	bool FindActiveNavArea( void );								// Finds the area or ladder the local player is currently pointing at.  Returns true if a surface was hit by the traceline.
 	virtual void RemoveNavArea( CNavArea *area );				// remove an area from the grid
@@ -865,6 +910,16 @@ private:
 	bool m_isOutOfDate;											// true if the Navigation Mesh is older than the actual BSP
 	bool m_isAnalyzed;											// true if the Navigation Mesh needs analysis
 
+	std::unique_ptr<CNavPathSlicer> m_pathSlicer;				// game thread path searches with a per tick budget
+	std::unique_ptr<CNavClusterGraph> m_clusterGraph;			// hierarchical path finding, built after the mesh is loaded
+	std::unique_ptr<CNavPathCache> m_pathCache;					// invalidated when the blocked state of the mesh changes
+	std::unique_ptr<CNavLandmarks> m_landmarks;					// saved on the nav file, rebuilt after editing
+	std::unique_ptr<CNavConnectionGraph> m_connectionGraph;		// built after the mesh is loaded, rebuilt after editing
+	std::unique_ptr<CNavFlowFieldManager> m_flowFields;			// built on demand, cleared with the mesh
+	std::unique_ptr<CNavReachability> m_reachability;			// labels built on demand, cleared with the mesh
+	std::unique_ptr<CNavLayeredGrid> m_layeredGrid;				// built after the mesh is loaded, cleared when areas are added or removed
+	std::unique_ptr<CNavAreaTracker> m_areaTracker;				// cleared when areas are removed
+
 	static constexpr auto HASH_TABLE_SIZE = 256;
 	CNavArea *m_hashTable[ HASH_TABLE_SIZE ];					// hash table to optimize lookup by ID
 	int ComputeHashKey( unsigned int id ) const;				// returns a hash key for the given nav area ID
@@ -874,7 +929,7 @@ private:
 	void AllocateGrid( float minX, float maxX, float minY, float maxY );	// clear and reset the grid to the given extents
 	void GridToWorld( int gridX, int gridY, Vector *pos ) const;
 
-	void AddNavArea( CNavArea *area );							// add an area to the grid
+	void AddNavArea( CNavArea *area, bool addToGrid = true );	// add an area to the grid, addToGrid is false when the grid cells were restored from the load cache
 
 	void DestroyNavigationMesh( bool incremental = false );		// free all resources of the mesh and reset it to empty state
 	void DestroyHidingSpots( void );
@@ -1064,6 +1119,30 @@ private:
 	static constexpr auto NAV_AREA_UPDATE_INTERVAL = 1.0f;
 	void BuildAuthorInfo();
 	AuthorInfo m_authorinfo;
+	std::vector<NavDeferredSection> m_deferredSections; // sections of the file decoded when first needed
+
+	std::vector<std::uint64_t> m_areaRecordOffsets; // offset of each area in the areas section, see SECTION_AREA_INDEX
+	NavLoadTimes m_loadTimes;
+	std::unique_ptr<CNavLoadCache> m_loadCache; // data computed from the mesh on the last load, only holds data while loading
+	NavLoadRequest m_loadRequest;
+	std::future<NavErrorType> m_loadTask; // valid while the loader thread is running or its result wasn't published
+	std::atomic<bool> m_loadCancelled; // set by CancelLoad, the loader thread stops at its next check
+	inline bool IsLoadCancelled( void ) const { return m_loadCancelled.load( std::memory_order_relaxed ); }
+
+	void BeginLoad( void );
+	NavErrorType LoadFile( void );
+	NavErrorType PostLoadData( uint32_t version );
+	NavErrorType FinishLoad( NavErrorType error );
+	bool UpdateLoad( void );
+	NavErrorType LoadSection(NavFileSectionID id, CNavFileReader& reader, uint32_t version, uint32_t subversion);
+	NavErrorType LoadSections(CNavFileReader& reader, uint32_t version, uint32_t subversion);	// load a file with a table of contents
+	NavErrorType LoadAreas(CNavFileReader& reader, int count, uint32_t version, uint32_t subversion);
+	bool RestoreGridFromCache( void );
+	void SaveLoadCache(const NavLoadCacheKey& key);
+	std::filesystem::path GetFullPathToLoadCacheFile() const;
+	void SaveSection(NavFileSectionID id, std::ostream& filestream);
+	bool ShouldDeferSection(NavFileSectionID id) const;
+	void PostLoadWaypoints( void );
 	std::array<std::string, static_cast<size_t>(EditSoundType::MAX_EDIT_SOUNDS)> m_editsounds;
 	Vector m_linkorigin;
 
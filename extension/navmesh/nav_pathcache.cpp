@@ -0,0 +1,102 @@
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_pathcache.h"
+#include "nav_stats.h"
+
+extern ConVar sm_nav_edit;
+
+ConVar sm_nav_path_cache_size("sm_nav_path_cache_size", "1024", FCVAR_GAMEDLL, "Maximum number of paths stored on the path search cache. Zero disables the cache.", true, 0.0f, false, 0.0f);
+ConVar sm_nav_path_cache_max_age("sm_nav_path_cache_max_age", "15", FCVAR_GAMEDLL, "Number of seconds a path stays on the path search cache.", true, 0.0f, false, 0.0f);
+
+CNavPathCache::CNavPathCache()
+{
+	m_generation = 0U;
+	ResetStats();
+}
+
+bool CNavPathCache::IsEnabled() const
+{
+	// areas and connections may change at any time while editing
+	return sm_nav_path_cache_size.GetInt() > 0 && !sm_nav_edit.GetBool();
+}
+
+bool CNavPathCache::Lookup(const NavPathCacheKey& key, std::vector<NavPathArea>& areas, bool& result)
+{
+	auto it = m_entries.find(key);
+
+	if (it == m_entries.end())
+	{
+		m_stats.misses++;
+		return false;
+	}
+
+	if (gpGlobals->curtime - it->second.timestamp > sm_nav_path_cache_max_age.GetFloat())
+	{
+		m_entries.erase(it);
+		m_stats.misses++;
+		return false;
+	}
+
+	areas = it->second.areas;
+	result = it->second.result;
+	m_stats.hits++;
+	return true;
+}
+
+void CNavPathCache::Store(const NavPathCacheKey& key, unsigned int generation, const std::vector<NavPathArea>& areas, bool result)
+{
+	if (generation != m_generation || !IsEnabled())
+	{
+		return;
+	}
+
+	// the cache is only useful while many bots are asking for the same paths, start over instead of tracking usage
+	if (m_entries.size() >= static_cast<std::size_t>(sm_nav_path_cache_size.GetInt()))
+	{
+		m_entries.clear();
+	}
+
+	Entry& entry = m_entries[key];
+	entry.areas = areas;
+	entry.timestamp = gpGlobals->curtime;
+	entry.result = result;
+	m_stats.stores++;
+}
+
+void CNavPathCache::Invalidate()
+{
+	m_generation++;
+
+	if (!m_entries.empty())
+	{
+		m_entries.clear();
+		m_stats.invalidations++;
+	}
+}
+
+void CNavPathCache::ResetStats()
+{
+	m_stats.hits = 0U;
+	m_stats.misses = 0U;
+	m_stats.stores = 0U;
+	m_stats.invalidations = 0U;
+}
+
+NAV_STATS_COMMAND(sm_nav_path_cache_stats, "path search cache")
+{
+	CNavPathCache* cache = TheNavMesh->GetPathCache();
+	char details[64];
+	ke::SafeSprintf(details, sizeof(details), ", %i/%i entries, generation %u", static_cast<int>(cache->GetSize()), sm_nav_path_cache_size.GetInt(), cache->GetGeneration());
+
+	if (!navutils::BeginStatsCommand(args, "Path cache", cache, details))
+	{
+		return;
+	}
+
+	const CNavPathCache::Stats& stats = cache->GetStats();
+	unsigned int lookups = stats.hits + stats.misses;
+	float hitRate = lookups > 0U ? static_cast<float>(stats.hits) * 100.0f / static_cast<float>(lookups) : 0.0f;
+
+	Msg("  Hits: %u  Misses: %u  Hit rate: %3.1f%%\n", stats.hits, stats.misses, hitRate);
+	Msg("  Stores: %u  Invalidations: %u\n", stats.stores, stats.invalidations);
+}
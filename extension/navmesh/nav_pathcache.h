@@ -0,0 +1,134 @@
+#ifndef NAV_PATH_CACHE_H_
+#define NAV_PATH_CACHE_H_
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+#include "nav.h"
+
+class CNavArea;
+
+// An area on a path found by a nav mesh search
+struct NavPathArea
+{
+	CNavArea* area;
+	NavTraverseType how; // how to get to this area from the previous area
+};
+
+/**
+ * @brief Identifies a path search. Searches with the same key produce the same path while the cache generation doesn't change.
+ */
+struct NavPathCacheKey
+{
+	NavPathCacheKey()
+	{
+		startArea = nullptr;
+		goalArea = nullptr;
+		teamID = NAV_TEAM_ANY;
+		costKey = 0U;
+		maxPathLength = 0.0f;
+	}
+
+	const CNavArea* startArea;
+	const CNavArea* goalArea;
+	int teamID;
+	std::size_t costKey;		// cost function type and parameters, see IPathCost::GetPathCacheKey
+	float maxPathLength;
+
+	bool operator==(const NavPathCacheKey& other) const
+	{
+		return startArea == other.startArea && goalArea == other.goalArea && teamID == other.teamID &&
+			costKey == other.costKey && maxPathLength == other.maxPathLength;
+	}
+};
+
+// Mixes 'value' into the hash 'seed'
+inline void NavHashCombine(std::size_t& seed, std::size_t value)
+{
+	seed ^= value + static_cast<std::size_t>(0x9e3779b97f4a7c15ULL) + (seed << 6) + (seed >> 2);
+}
+
+template <typename T>
+inline void NavHashCombineValue(std::size_t& seed, const T& value)
+{
+	NavHashCombine(seed, std::hash<T>{}(value));
+}
+
+/**
+ * @brief Stores the results of recent path searches so bots asking for the same route don't repeat the search.
+ *
+ * Any change that may alter a search result (blocked areas, nav volumes, elevator floors, func_nav_cost) invalidates the whole cache.
+ * Searches started before an invalidation don't store their results. Entries also expire after a few seconds to cover state the
+ * cache isn't told about. Game thread only.
+ */
+class CNavPathCache
+{
+public:
+	CNavPathCache();
+
+	CNavPathCache(const CNavPathCache&) = delete;
+	CNavPathCache& operator=(const CNavPathCache&) = delete;
+
+	struct Stats
+	{
+		unsigned int hits;
+		unsigned int misses;
+		unsigned int stores;
+		unsigned int invalidations;
+	};
+
+	bool IsEnabled() const;
+
+	/**
+	 * @brief Searches the cache for a path.
+	 * @param key Search key.
+	 * @param areas Stores the path areas, goal area first.
+	 * @param result Stores the search result.
+	 * @return true if the path was found on the cache.
+	 */
+	bool Lookup(const NavPathCacheKey& key, std::vector<NavPathArea>& areas, bool& result);
+	/**
+	 * @brief Stores a search result.
+	 * @param key Search key.
+	 * @param generation Cache generation when the search started. Results of searches started before an invalidation are dropped.
+	 * @param areas Path areas, goal area first.
+	 * @param result Search result.
+	 */
+	void Store(const NavPathCacheKey& key, unsigned int generation, const std::vector<NavPathArea>& areas, bool result);
+	// Removes all entries, called when something changed that may alter the search results
+	void Invalidate();
+	unsigned int GetGeneration() const { return m_generation; }
+
+	std::size_t GetSize() const { return m_entries.size(); }
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats();
+
+private:
+	struct KeyHasher
+	{
+		std::size_t operator()(const NavPathCacheKey& key) const
+		{
+			std::size_t seed = 0U;
+			NavHashCombineValue(seed, key.startArea);
+			NavHashCombineValue(seed, key.goalArea);
+			NavHashCombineValue(seed, key.teamID);
+			NavHashCombine(seed, key.costKey);
+			NavHashCombineValue(seed, key.maxPathLength);
+			return seed;
+		}
+	};
+
+	struct Entry
+	{
+		std::vector<NavPathArea> areas;
+		float timestamp;
+		bool result;
+	};
+
+	std::unordered_map<NavPathCacheKey, Entry, KeyHasher> m_entries;
+	unsigned int m_generation;
+	Stats m_stats;
+};
+
+#endif // !NAV_PATH_CACHE_H_
@@ -13,6 +13,7 @@
 #define _NAV_PATHFIND_H_
 
 #include <algorithm>
+#include <limits>
 #include <vector>
 #include <stack>
 #include <queue>
@@ -26,6 +27,12 @@
 #include <util/librandom.h>
 #include "nav_area.h"
 #include "nav_elevator.h"
+#include "nav_mesh.h"
+#include "nav_cluster.h"
+#include "nav_landmarks.h"
+#include "nav_bidirectional.h"
+#include "nav_reachability.h"
+#include "nav_search_context.h"
 
 
 #undef max
@@ -118,393 +125,636 @@ public:
 	}
 };
 
+#define IGNORE_NAV_BLOCKERS true
+
+enum NavPathSearchStatus
+{
+	NAV_PATH_SEARCH_RUNNING,		// more areas must be expanded
+	NAV_PATH_SEARCH_FOUND,			// a path to the goal exists
+	NAV_PATH_SEARCH_FAILED,			// the goal can't be reached, the closest area is still valid
+};
+
 //--------------------------------------------------------------------------------------------------------------
 /**
- * Find path from startArea to goalArea via an A* search, using supplied cost heuristic.
- * If cost functor returns -1 for an area, that area is considered a dead end.
- * This doesn't actually build a path, but the path is defined by following parent
- * pointers back from goalArea to startArea.
- * If 'closestArea' is non-NULL, the closest area to the goal is returned (useful if the path fails).
- * If 'goalArea' is NULL, will compute a path as close as possible to 'goalPos'.
- * If 'goalPos' is NULL, will use the center of 'goalArea' as the goal position.
- * If 'maxPathLength' is nonzero, path building will stop when this length is reached.
- * Returns true if a path exists.
+ * Resumable A* search, see NavAreaBuildPathInCorridor for the parameters.
+ * The search state is kept in the search context, so the search may be run a few areas at a time as long as nothing
+ * else uses the context in between. The cost functor must outlive the search.
  */
-#define IGNORE_NAV_BLOCKERS true
 template< typename CostFunctor >
-bool NavAreaBuildPath( CNavArea *startArea, CNavArea *goalArea, const Vector *goalPos,
-		const CostFunctor &costFunc, CNavArea **closestArea = NULL, float maxPathLength = 0.0f, int teamID = NAV_TEAM_ANY, bool ignoreNavBlockers = false )
+class CNavAreaPathSearch
 {
-	if ( closestArea )
-	{
-		*closestArea = startArea;
-	}
+public:
+	CNavAreaPathSearch( const CostFunctor &costFunc ) : m_costFunc( costFunc )
+	{
+		m_context = NULL;
+		m_corridor = NULL;
+		m_startArea = NULL;
+		m_goalArea = NULL;
+		m_closestArea = NULL;
+		m_landmarks = NULL;
+		m_closestAreaDist = 0.0f;
+		m_maxPathLength = 0.0f;
+		m_teamID = NAV_TEAM_ANY;
+		m_ignoreNavBlockers = false;
+		m_expansions = 0;
+		m_status = NAV_PATH_SEARCH_FAILED;
+	}
+
+	NavPathSearchStatus Start( NavSearchContext &context, const NavClusterCorridor *corridor, CNavArea *startArea, CNavArea *goalArea, const Vector *goalPos,
+		float maxPathLength = 0.0f, int teamID = NAV_TEAM_ANY, bool ignoreNavBlockers = false );
+	NavPathSearchStatus Run( int maxExpansions = 0 );		// expand up to 'maxExpansions' areas, zero runs until the search is done
+
+	NavPathSearchStatus GetStatus( void ) const		{ return m_status; }
+	CNavArea *GetStartArea( void ) const			{ return m_startArea; }
+	CNavArea *GetClosestArea( void ) const			{ return m_closestArea; }	// the goal area once found, the area closest to the goal otherwise
+	int GetExpansionCount( void ) const				{ return m_expansions; }	// number of areas taken from the open list since the search started
+	bool IsInCorridor( void ) const					{ return m_corridor != NULL; }
+
+private:
+	void SearchAdjacentAreas( CNavArea *area );
+
+	const CostFunctor &m_costFunc;
+	NavSearchContext *m_context;
+	const NavClusterCorridor *m_corridor;
+	CNavArea *m_startArea;
+	CNavArea *m_goalArea;
+	CNavArea *m_closestArea;
+	const CNavLandmarks *m_landmarks;
+	Vector m_actualGoalPos;
+	float m_closestAreaDist;
+	float m_maxPathLength;
+	int m_teamID;
+	bool m_ignoreNavBlockers;
+	int m_expansions;
+	NavPathSearchStatus m_status;
 
 #ifdef STAGING_ONLY
-	bool isDebug = ( g_DebugPathfindCounter-- > 0 );
+	bool m_isDebug;
+#endif
+};
+
+template< typename CostFunctor >
+NavPathSearchStatus CNavAreaPathSearch< CostFunctor >::Start( NavSearchContext &context, const NavClusterCorridor *corridor, CNavArea *startArea, CNavArea *goalArea, const Vector *goalPos,
+	float maxPathLength, int teamID, bool ignoreNavBlockers )
+{
+	// the cost functor reads the search state of 'fromArea' from the current context
+	NavSearchContext::Scope scope( context );
+
+	m_context = &context;
+	m_corridor = corridor;
+	m_startArea = startArea;
+	m_closestArea = startArea;
+	m_maxPathLength = maxPathLength;
+	m_teamID = teamID;
+	m_ignoreNavBlockers = ignoreNavBlockers;
+	m_expansions = 0;
+	m_status = NAV_PATH_SEARCH_FAILED;
+
+#ifdef STAGING_ONLY
+	m_isDebug = ( g_DebugPathfindCounter-- > 0 );
 #endif
 
 	if (startArea == NULL)
-		return false;
+		return m_status;
 
-	startArea->SetParent( NULL );
+	context.SetParent( startArea, NULL );
 
 	if (goalArea != NULL && goalArea->IsBlocked( teamID, ignoreNavBlockers ))
 		goalArea = NULL;
 
+	m_goalArea = goalArea;
+
 	if (goalArea == NULL && goalPos == NULL)
-		return false;
+		return m_status;
 
 	// if we are already in the goal area, build trivial path
 	if (startArea == goalArea)
 	{
-		return true;
+		m_status = NAV_PATH_SEARCH_FOUND;
+		return m_status;
 	}
 
 	// determine actual goal position
-	Vector actualGoalPos = (goalPos) ? *goalPos : goalArea->GetCenter();
+	m_actualGoalPos = (goalPos) ? *goalPos : goalArea->GetCenter();
+
+	// landmark distances give a better estimate than the straight line distance when the goal area is known
+	m_landmarks = ( goalArea && TheNavMesh->GetLandmarks()->IsBuilt() ) ? TheNavMesh->GetLandmarks() : NULL;
 
 	// start search
-	CNavArea::ClearSearchLists();
+	context.ClearSearchLists();
 
 	// compute estimate of path length
 	/// @todo Cost might work as "manhattan distance"
-	startArea->SetTotalCost( (startArea->GetCenter() - actualGoalPos).Length() );
+	context.SetTotalCost( startArea, (startArea->GetCenter() - m_actualGoalPos).Length() );
 
 	/* CNavArea *area, CNavArea *fromArea, const CNavLadder *ladder, const NavOffMeshConnection *link, const CFuncElevator *elevator, float length */
-	float initCost = costFunc( startArea, nullptr, nullptr, nullptr, nullptr, -1.0f );	
+	float initCost = m_costFunc( startArea, nullptr, nullptr, nullptr, nullptr, -1.0f );	
 	if (initCost < 0.0f)
-		return false;
-	startArea->SetCostSoFar( initCost );
-	startArea->SetPathLengthSoFar( 0.0 );
+		return m_status;
+	context.SetCostSoFar( startArea, initCost );
+	context.SetPathLengthSoFar( startArea, 0.0 );
 
-	startArea->AddToOpenList();
+	context.AddToOpenList( startArea );
 
 	// keep track of the area we visit that is closest to the goal
-	float closestAreaDist = startArea->GetTotalCost();
+	m_closestAreaDist = context.GetTotalCost( startArea );
+
+	m_status = NAV_PATH_SEARCH_RUNNING;
+	return m_status;
+}
+
+template< typename CostFunctor >
+NavPathSearchStatus CNavAreaPathSearch< CostFunctor >::Run( int maxExpansions )
+{
+	if ( m_status != NAV_PATH_SEARCH_RUNNING )
+		return m_status;
+
+	NavSearchContext &context = *m_context;
+	NavSearchContext::Scope scope( context );
 
 	// do A* search
-	while( !CNavArea::IsOpenListEmpty() )
+	for ( int expanded = 0; maxExpansions <= 0 || expanded < maxExpansions; ++expanded )
 	{
+		if ( context.IsOpenListEmpty() )
+		{
+			m_status = NAV_PATH_SEARCH_FAILED;
+			return m_status;
+		}
+
 		// get next area to check
-		CNavArea *area = CNavArea::PopOpenList();
+		CNavArea *area = context.PopOpenList();
+		++m_expansions;
 
 #ifdef STAGING_ONLY
-		if ( isDebug )
+		if ( m_isDebug )
 		{
 			area->DrawFilled( 0, 255, 0, 128, 30.0f );
 		}
 #endif
 
 		// don't consider blocked areas
-		if ( area->IsBlocked( teamID, ignoreNavBlockers ) )
+		if ( area->IsBlocked( m_teamID, m_ignoreNavBlockers ) )
 			continue;
 
 		// check if we have found the goal area or position
-		if (area == goalArea || (goalArea == NULL && goalPos && area->Contains( *goalPos )))
+		if (area == m_goalArea || (m_goalArea == NULL && area->Contains( m_actualGoalPos )))
 		{
-			if (closestArea)
-			{
-				*closestArea = area;
-			}
-
-			return true;
+			m_closestArea = area;
+			m_status = NAV_PATH_SEARCH_FOUND;
+			return m_status;
 		}
 
-		// search adjacent areas
-		enum SearchType
+		SearchAdjacentAreas( area );
+
+		// we have searched this area
+		context.AddToClosedList( area );
+	}
+
+	return m_status;
+}
+
+template< typename CostFunctor >
+void CNavAreaPathSearch< CostFunctor >::SearchAdjacentAreas( CNavArea *area )
+{
+	NavSearchContext &context = *m_context;
+	const CostFunctor &costFunc = m_costFunc;
+	const NavClusterCorridor *corridor = m_corridor;
+	const CNavLandmarks *landmarks = m_landmarks;
+	CNavArea *goalArea = m_goalArea;
+	const Vector &actualGoalPos = m_actualGoalPos;
+	const float maxPathLength = m_maxPathLength;
+	const int teamID = m_teamID;
+	const bool ignoreNavBlockers = m_ignoreNavBlockers;
+
+	// search adjacent areas
+	enum SearchType
+	{
+		SEARCH_FLOOR, SEARCH_LADDERS, SEARCH_ELEVATORS, SEARCH_LINKS
+	};
+	SearchType searchWhere = SEARCH_FLOOR;
+	int searchIndex = 0;
+	size_t linkIndex = 0U;
+
+	int dir = NORTH;
+	const NavConnectVector *floorList = area->GetAdjacentAreas( NORTH );
+	auto& linklist = area->GetOffMeshConnections();
+	size_t maxlinks = area->GetOffMeshConnectionCount();
+
+	bool ladderUp = true;
+	const NavLadderConnectVector *ladderList = nullptr;
+	std::size_t ladderConnIndex = 0;
+	const std::vector<LadderToAreaConnection>* ladderAreaList = nullptr;
+	std::size_t elevFloorIndex = 0;
+	bool bHaveMaxPathLength = ( maxPathLength > 0.0f );
+	float length = -1;
+	
+	while( true )
+	{
+		CNavArea *newArea = nullptr;
+		NavTraverseType how;
+		const CNavLadder *ladder = nullptr;
+		const CNavElevator *elevator = nullptr;
+		const NavOffMeshConnection* currentlink = nullptr;
+
+		//
+		// Get next adjacent area - either on floor or via ladder
+		//
+		if ( searchWhere == SEARCH_FLOOR )
 		{
-			SEARCH_FLOOR, SEARCH_LADDERS, SEARCH_ELEVATORS, SEARCH_LINKS
-		};
-		SearchType searchWhere = SEARCH_FLOOR;
-		int searchIndex = 0;
-		size_t linkIndex = 0U;
-
-		int dir = NORTH;
-		const NavConnectVector *floorList = area->GetAdjacentAreas( NORTH );
-		auto& linklist = area->GetOffMeshConnections();
-		size_t maxlinks = area->GetOffMeshConnectionCount();
-
-		bool ladderUp = true;
-		const NavLadderConnectVector *ladderList = nullptr;
-		std::size_t ladderConnIndex = 0;
-		const std::vector<LadderToAreaConnection>* ladderAreaList = nullptr;
-		std::size_t elevFloorIndex = 0;
-		bool bHaveMaxPathLength = ( maxPathLength > 0.0f );
-		float length = -1;
-		
-		while( true )
-		{
-			CNavArea *newArea = nullptr;
-			NavTraverseType how;
-			const CNavLadder *ladder = nullptr;
-			const CNavElevator *elevator = nullptr;
-			const NavOffMeshConnection* currentlink = nullptr;
-
-			//
-			// Get next adjacent area - either on floor or via ladder
-			//
-			if ( searchWhere == SEARCH_FLOOR )
+			// if exhausted adjacent connections in current direction, begin checking next direction
+			if ( searchIndex >= floorList->Count() )
 			{
-				// if exhausted adjacent connections in current direction, begin checking next direction
-				if ( searchIndex >= floorList->Count() )
-				{
-					++dir;
+				++dir;
 
-					if ( dir == NUM_DIRECTIONS )
-					{
-						// checked all directions on floor - check ladders next
-						searchWhere = SEARCH_LADDERS;
+				if ( dir == NUM_DIRECTIONS )
+				{
+					// checked all directions on floor - check ladders next
+					searchWhere = SEARCH_LADDERS;
 
-						ladderList = area->GetLadders( CNavLadder::LADDER_UP );
-						ladderConnIndex = 0;
-					}
-					else
-					{
-						// start next direction
-						floorList = area->GetAdjacentAreas( (NavDirType)dir );
-					}
-					searchIndex = 0;
-					continue;
+					ladderList = area->GetLadders( CNavLadder::LADDER_UP );
+					ladderConnIndex = 0;
 				}
-
-				const NavConnect &floorConnect = floorList->Element( searchIndex );
-				newArea = floorConnect.area;
-				length = floorConnect.length;
-				how = (NavTraverseType)dir;
-				++searchIndex;
-
-				if ( IsX360() && searchIndex < floorList->Count() )
+				else
 				{
-					PREFETCH360( floorList->Element( searchIndex ).area, 0  );
+					// start next direction
+					floorList = area->GetAdjacentAreas( (NavDirType)dir );
 				}
+				searchIndex = 0;
+				continue;
 			}
-			else if ( searchWhere == SEARCH_LADDERS )
+
+			const NavConnect &floorConnect = floorList->Element( searchIndex );
+			newArea = floorConnect.area;
+			length = floorConnect.length;
+			how = (NavTraverseType)dir;
+			++searchIndex;
+
+			if ( IsX360() && searchIndex < floorList->Count() )
+			{
+				PREFETCH360( floorList->Element( searchIndex ).area, 0  );
+			}
+		}
+		else if ( searchWhere == SEARCH_LADDERS )
+		{
+			if ( searchIndex >= ladderList->Count() )
 			{
-				if ( searchIndex >= ladderList->Count() )
+				if ( !ladderUp )
 				{
-					if ( !ladderUp )
-					{
-						// checked both ladder directions - check elevators next
-						searchWhere = SEARCH_ELEVATORS;
-						ladder = NULL;
-					}
-					else
-					{
-						// check down ladders
-						ladderUp = false;
-						ladderList = area->GetLadders( CNavLadder::LADDER_DOWN );
-						ladderConnIndex = 0;
-					}
-					searchIndex = 0;
-					continue;
+					// checked both ladder directions - check elevators next
+					searchWhere = SEARCH_ELEVATORS;
+					ladder = NULL;
 				}
-
-				if ( ladderUp )
+				else
 				{
-					ladder = ladderList->Element( searchIndex ).ladder;
-
-					// if index is 0, update the area vectors
-					if (ladderConnIndex == 0)
-					{
-						ladderAreaList = &ladder->GetConnections();
-					}
+					// check down ladders
+					ladderUp = false;
+					ladderList = area->GetLadders( CNavLadder::LADDER_DOWN );
+					ladderConnIndex = 0;
+				}
+				searchIndex = 0;
+				continue;
+			}
 
-					if (ladderConnIndex >= ladderAreaList->size())
-					{
-						++searchIndex; // go to next ladder
-						ladderConnIndex = 0; // reset index
-						continue;
-					}
-					else
-					{
-						if (ladderAreaList->at(ladderConnIndex).IsConnectedToLadderTop())
-						{
-							newArea = ladderAreaList->at(ladderConnIndex).GetConnectedArea();
-						}
-						else
-						{
-							ladderConnIndex++; // increment index
-							continue;
-						}
+			if ( ladderUp )
+			{
+				ladder = ladderList->Element( searchIndex ).ladder;
 
-						ladderConnIndex++; // increment index
-					}
+				// if index is 0, update the area vectors
+				if (ladderConnIndex == 0)
+				{
+					ladderAreaList = &ladder->GetConnections();
+				}
 
-					how = GO_LADDER_UP;
+				if (ladderConnIndex >= ladderAreaList->size())
+				{
+					++searchIndex; // go to next ladder
+					ladderConnIndex = 0; // reset index
+					continue;
 				}
 				else
 				{
-					ladder = ladderList->Element(searchIndex).ladder;
-
-					// if index is 0, update the area vectors
-					if (ladderConnIndex == 0)
+					if (ladderAreaList->at(ladderConnIndex).IsConnectedToLadderTop())
 					{
-						ladderAreaList = &ladder->GetConnections();
-					}
-
-					if (ladderConnIndex >= ladderAreaList->size())
-					{
-						++searchIndex; // go to next ladder
-						ladderConnIndex = 0; // reset index
-						continue;
+						newArea = ladderAreaList->at(ladderConnIndex).GetConnectedArea();
 					}
 					else
 					{
-						if (ladderAreaList->at(ladderConnIndex).IsConnectedToLadderBottom())
-						{
-							newArea = ladderAreaList->at(ladderConnIndex).GetConnectedArea();
-						}
-						else
-						{
-							ladderConnIndex++; // increment index
-							continue;
-						}
-
 						ladderConnIndex++; // increment index
+						continue;
 					}
-					
-					how = GO_LADDER_DOWN;
-				}
 
-				if ( newArea == NULL )
-					continue;
+					ladderConnIndex++; // increment index
+				}
 
-				length = -1.0f;
+				how = GO_LADDER_UP;
 			}
-			else if ( searchWhere == SEARCH_ELEVATORS )
+			else
 			{
-				elevator = area->GetElevator();
+				ladder = ladderList->Element(searchIndex).ladder;
 
-				if (elevator == nullptr || elevFloorIndex >= elevator->GetFloors().size())
+				// if index is 0, update the area vectors
+				if (ladderConnIndex == 0)
 				{
-					// done searching connected areas
-					elevator = nullptr;
-					searchWhere = SEARCH_LINKS;
-					elevFloorIndex = 0;
-					continue;
+					ladderAreaList = &ladder->GetConnections();
 				}
 
-				newArea = elevator->GetFloors()[elevFloorIndex].GetArea();
-
-				if (newArea == area)
+				if (ladderConnIndex >= ladderAreaList->size())
 				{
-					elevFloorIndex++; // skip self
+					++searchIndex; // go to next ladder
+					ladderConnIndex = 0; // reset index
 					continue;
 				}
-
-				how = newArea->GetCenter().z > area->GetCenter().z ? GO_ELEVATOR_UP : GO_ELEVATOR_DOWN;
-				elevFloorIndex++;
-
-				length = -1.0f;
-			}
-			else // if (searchWhere == SEARCH_LINKS)
-			{
-				if (maxlinks == 0)
-				{
-					// no link to search, get out
-					break;
-				}
 				else
 				{
-					if (linkIndex >= maxlinks)
+					if (ladderAreaList->at(ladderConnIndex).IsConnectedToLadderBottom())
 					{
-						linkIndex = 0;
-						break; // ALL links searched, break
+						newArea = ladderAreaList->at(ladderConnIndex).GetConnectedArea();
+					}
+					else
+					{
+						ladderConnIndex++; // increment index
+						continue;
 					}
 
-					currentlink = &linklist[linkIndex];
-					newArea = currentlink->m_link.area;
-					length = currentlink->GetConnectionLength();
-					how = GO_OFF_MESH_CONNECTION;
-					linkIndex++;
+					ladderConnIndex++; // increment index
 				}
+				
+				how = GO_LADDER_DOWN;
 			}
 
-			// don't backtrack
-			// Assert( newArea );
-			if ( newArea == area->GetParent()
-				|| newArea == area // self neighbor?
-				// don't consider blocked areas
-				|| newArea->IsBlocked( teamID, ignoreNavBlockers ) )
+			if ( newArea == NULL )
 				continue;
 
-			/* CNavArea *area, CNavArea *fromArea, const CNavLadder *ladder, const NavOffMeshConnection *link, const CNavElevator *elevator, float length */
-			float newCostSoFar = costFunc( newArea, area, ladder, currentlink, elevator, length );
-
-			// NaNs really mess this function up causing tough to track down hangs. If
-			//  we get inf back, clamp it down to a really high number.
-			// DebuggerBreakOnNaN_StagingOnly( newCostSoFar );
-			if ( IS_NAN( newCostSoFar ) )
-				newCostSoFar = 1e30f;
-
-			// check if cost functor says this area is a dead-end
-			if ( newCostSoFar < 0.0f )
-				continue;
-
-			// Safety check against a bogus functor.  The cost of the path
-			// A...B, C should always be at least as big as the path A...B.
-			// Assert( newCostSoFar >= area->GetCostSoFar() );
-
-			// And now that we've asserted, let's be a bit more defensive.
-			// Make sure that any jump to a new area incurs some pathfinsing
-			// cost, to avoid us spinning our wheels over insignificant cost
-			// benefit, floating point precision bug, or busted cost functor.
-			newCostSoFar = std::max(newCostSoFar, area->GetCostSoFar() * 1.00001f + 0.00001f);
-				
-			// stop if path length limit reached
-			if ( bHaveMaxPathLength )
-			{
-				// keep track of path length so far
-				float newLengthSoFar = area->GetPathLengthSoFar() + ( newArea->GetCenter() - area->GetCenter() ).Length();
-				if ( newLengthSoFar > maxPathLength )
-					continue;
-				
-				newArea->SetPathLengthSoFar( newLengthSoFar );
-			}
+			length = -1.0f;
+		}
+		else if ( searchWhere == SEARCH_ELEVATORS )
+		{
+			elevator = area->GetElevator();
 
-			if ( ( newArea->IsOpen() || newArea->IsClosed() ) && newArea->GetCostSoFar() <= newCostSoFar )
+			if (elevator == nullptr || elevFloorIndex >= elevator->GetFloors().size())
 			{
-				// this is a worse path - skip it
+				// done searching connected areas
+				elevator = nullptr;
+				searchWhere = SEARCH_LINKS;
+				elevFloorIndex = 0;
 				continue;
 			}
-			// compute estimate of distance left to go
-			float distSq = ( newArea->GetCenter() - actualGoalPos ).LengthSqr();
-			float newCostRemaining = ( distSq > 0.0 ) ? FastSqrt( distSq ) : 0.0 ;
 
-			// track closest area to goal in case path fails
-			if ( closestArea && newCostRemaining < closestAreaDist )
-			{
-				*closestArea = newArea;
-				closestAreaDist = newCostRemaining;
-			}
+			newArea = elevator->GetFloors()[elevFloorIndex].GetArea();
 
-			newArea->SetCostSoFar( newCostSoFar );
-			newArea->SetTotalCost( newCostSoFar + newCostRemaining );
-
-			if ( newArea->IsClosed() )
+			if (newArea == area)
 			{
-				newArea->RemoveFromClosedList();
+				elevFloorIndex++; // skip self
+				continue;
 			}
 
-			if ( newArea->IsOpen() )
+			how = newArea->GetCenter().z > area->GetCenter().z ? GO_ELEVATOR_UP : GO_ELEVATOR_DOWN;
+			elevFloorIndex++;
+
+			length = -1.0f;
+		}
+		else // if (searchWhere == SEARCH_LINKS)
+		{
+			if (maxlinks == 0)
 			{
-				// area already on open list, update the list order to keep costs sorted
-				newArea->UpdateOnOpenList();
+				// no link to search, get out
+				break;
 			}
 			else
 			{
-				newArea->AddToOpenList();
+				if (linkIndex >= maxlinks)
+				{
+					linkIndex = 0;
+					break; // ALL links searched, break
+				}
+
+				currentlink = &linklist[linkIndex];
+				newArea = currentlink->m_link.area;
+				length = currentlink->GetConnectionLength();
+				how = GO_OFF_MESH_CONNECTION;
+				linkIndex++;
 			}
+		}
+
+		// don't backtrack
+		// Assert( newArea );
+		if ( newArea == context.GetParent( area )
+			|| newArea == area // self neighbor?
+			// don't consider blocked areas
+			|| newArea->IsBlocked( teamID, ignoreNavBlockers )
+			// stay inside the clusters found by the coarse search
+			|| ( corridor && !corridor->Contains( newArea ) ) )
+			continue;
+
+		/* CNavArea *area, CNavArea *fromArea, const CNavLadder *ladder, const NavOffMeshConnection *link, const CNavElevator *elevator, float length */
+		float newCostSoFar = costFunc( newArea, area, ladder, currentlink, elevator, length );
+
+		// NaNs really mess this function up causing tough to track down hangs. If
+		//  we get inf back, clamp it down to a really high number.
+		// DebuggerBreakOnNaN_StagingOnly( newCostSoFar );
+		if ( IS_NAN( newCostSoFar ) )
+			newCostSoFar = 1e30f;
+
+		// check if cost functor says this area is a dead-end
+		if ( newCostSoFar < 0.0f )
+			continue;
 
-			newArea->SetParent( area, how );
+		// Safety check against a bogus functor.  The cost of the path
+		// A...B, C should always be at least as big as the path A...B.
+		// Assert( newCostSoFar >= area->GetCostSoFar() );
+
+		// And now that we've asserted, let's be a bit more defensive.
+		// Make sure that any jump to a new area incurs some pathfinsing
+		// cost, to avoid us spinning our wheels over insignificant cost
+		// benefit, floating point precision bug, or busted cost functor.
+		newCostSoFar = std::max(newCostSoFar, context.GetCostSoFar( area ) * 1.00001f + 0.00001f);
+			
+		// stop if path length limit reached
+		if ( bHaveMaxPathLength )
+		{
+			// keep track of path length so far
+			float newLengthSoFar = context.GetPathLengthSoFar( area ) + ( newArea->GetCenter() - area->GetCenter() ).Length();
+			if ( newLengthSoFar > maxPathLength )
+				continue;
+			
+			context.SetPathLengthSoFar( newArea, newLengthSoFar );
 		}
 
-		// we have searched this area
-		area->AddToClosedList();
+		if ( ( context.IsOpen( newArea ) || context.IsClosed( newArea ) ) && context.GetCostSoFar( newArea ) <= newCostSoFar )
+		{
+			// this is a worse path - skip it
+			continue;
+		}
+		// compute estimate of distance left to go
+		float distSq = ( newArea->GetCenter() - actualGoalPos ).LengthSqr();
+		float newCostRemaining = ( distSq > 0.0 ) ? FastSqrt( distSq ) : 0.0 ;
+
+		// track closest area to goal in case path fails
+		if ( newCostRemaining < m_closestAreaDist )
+		{
+			m_closestArea = newArea;
+			m_closestAreaDist = newCostRemaining;
+		}
+
+		if ( landmarks )
+		{
+			newCostRemaining = std::max( newCostRemaining, landmarks->GetLowerBound( newArea, goalArea ) );
+		}
+
+		context.SetCostSoFar( newArea, newCostSoFar );
+		context.SetTotalCost( newArea, newCostSoFar + newCostRemaining );
+
+		if ( context.IsClosed( newArea ) )
+		{
+			context.RemoveFromClosedList( newArea );
+		}
+
+		if ( context.IsOpen( newArea ) )
+		{
+			// area already on open list, update the list order to keep costs sorted
+			context.UpdateOnOpenList( newArea );
+		}
+		else
+		{
+			context.AddToOpenList( newArea );
+		}
+
+		context.SetParent( newArea, area, how );
 	}
+}
+
+//--------------------------------------------------------------------------------------------------------------
+/**
+ * Find path from startArea to goalArea via an A* search, using supplied cost heuristic.
+ * If cost functor returns -1 for an area, that area is considered a dead end.
+ * This doesn't actually build a path, but the path is defined by following parent
+ * pointers back from goalArea to startArea.
+ * If 'closestArea' is non-NULL, the closest area to the goal is returned (useful if the path fails).
+ * If 'goalArea' is NULL, will compute a path as close as possible to 'goalPos'.
+ * If 'goalPos' is NULL, will use the center of 'goalArea' as the goal position.
+ * If 'maxPathLength' is nonzero, path building will stop when this length is reached.
+ * If 'corridor' is non-NULL, only areas inside the corridor clusters are searched.
+ * Returns true if a path exists.
+ */
+template< typename CostFunctor >
+bool NavAreaBuildPathInCorridor( NavSearchContext &context, const NavClusterCorridor *corridor, CNavArea *startArea, CNavArea *goalArea, const Vector *goalPos,
+		const CostFunctor &costFunc, CNavArea **closestArea = NULL, float maxPathLength = 0.0f, int teamID = NAV_TEAM_ANY, bool ignoreNavBlockers = false )
+{
+	CNavAreaPathSearch< CostFunctor > search( costFunc );
+	search.Start( context, corridor, startArea, goalArea, goalPos, maxPathLength, teamID, ignoreNavBlockers );
+
+	const NavPathSearchStatus status = search.Run();
+
+	if ( closestArea )
+	{
+		*closestArea = search.GetClosestArea();
+	}
+
+	return status == NAV_PATH_SEARCH_FOUND;
+}
+
+/**
+ * Find path from startArea to goalArea with a bidirectional A* search (see CNavBidirectionalSearch), using supplied cost heuristic.
+ * On success, the parent chain and the costs so far of the path areas are set in the context, the same as NavAreaBuildPathInCorridor.
+ * Nothing is written to the context if the search fails and 'closestArea' is only set on success.
+ * Returns true if a path exists.
+ */
+template< typename CostFunctor >
+bool NavAreaBuildPathBidirectional( NavSearchContext &context, const NavClusterCorridor *corridor, CNavArea *startArea, CNavArea *goalArea,
+		const CostFunctor &costFunc, CNavArea **closestArea = NULL, int teamID = NAV_TEAM_ANY )
+{
+	// GetConnectionCost and the cost functor use the current context
+	NavSearchContext::Scope scope( context );
+	CNavBidirectionalSearch &search = CNavBidirectionalSearch::GetThreadSearch();
 
-	return false;
+	auto edgeCost = [&costFunc, teamID]( const NavAreaConnection &connection ) {
+		return CNavConnectionGraph::GetConnectionCost( connection, costFunc, teamID );
+	};
+
+	if ( !search.FindPath( startArea, goalArea, edgeCost, corridor ) )
+	{
+		return false;
+	}
+
+	context.ClearSearchLists();
+
+	const std::vector< NavPathArea > &path = search.GetPath();
+	const std::vector< float > &costs = search.GetPathCosts();
+
+	for ( std::size_t i = 0; i < path.size(); i++ )
+	{
+		context.SetCostSoFar( path[i].area, costs[i] );
+		context.SetParent( path[i].area, i > 0 ? path[i - 1].area : NULL, path[i].how );
+	}
+
+	if ( closestArea )
+	{
+		*closestArea = goalArea;
+	}
+
+	return true;
+}
+
+/**
+ * Cost functors with an out of line operator() should declare the search with NAV_DECLARE_PATH_SEARCH after the class
+ * and instantiate it with NAV_INSTANTIATE_PATH_SEARCH in the source file that defines operator(). The search loop is then
+ * compiled once, next to the cost function body, where a 'final' functor can be called directly and inlined.
+ */
+#define NAV_DECLARE_PATH_SEARCH( CostFunctor ) \
+	extern template class CNavAreaPathSearch< CostFunctor >; \
+	extern template bool NavAreaBuildPathInCorridor< CostFunctor >( NavSearchContext &, const NavClusterCorridor *, CNavArea *, CNavArea *, \
+		const Vector *, const CostFunctor &, CNavArea **, float, int, bool ); \
+	extern template bool NavAreaBuildPathBidirectional< CostFunctor >( NavSearchContext &, const NavClusterCorridor *, CNavArea *, CNavArea *, \
+		const CostFunctor &, CNavArea **, int )
+
+#define NAV_INSTANTIATE_PATH_SEARCH( CostFunctor ) \
+	template class CNavAreaPathSearch< CostFunctor >; \
+	template bool NavAreaBuildPathInCorridor< CostFunctor >( NavSearchContext &, const NavClusterCorridor *, CNavArea *, CNavArea *, \
+		const Vector *, const CostFunctor &, CNavArea **, float, int, bool ); \
+	template bool NavAreaBuildPathBidirectional< CostFunctor >( NavSearchContext &, const NavClusterCorridor *, CNavArea *, CNavArea *, \
+		const CostFunctor &, CNavArea **, int )
+
+/**
+ * Find path from startArea to goalArea via an A* search, using supplied cost heuristic.
+ * Long searches are first planned on the nav mesh cluster graph and the area search is restricted to the clusters found,
+ * if the restricted search fails the whole mesh is searched.
+ * See NavAreaBuildPathInCorridor for the parameters.
+ */
+template< typename CostFunctor >
+bool NavAreaBuildPath( NavSearchContext &context, CNavArea *startArea, CNavArea *goalArea, const Vector *goalPos,
+		const CostFunctor &costFunc, CNavArea **closestArea = NULL, float maxPathLength = 0.0f, int teamID = NAV_TEAM_ANY, bool ignoreNavBlockers = false )
+{
+	const NavClusterCorridor *corridor = TheNavMesh->GetClusterGraph()->FindCorridor( context.GetClusterCorridor(), startArea, goalArea, teamID, ignoreNavBlockers );
+
+	// long routes expand from both ends, the connection graph doesn't support path length limits or ignoring nav blockers
+	if ( goalArea && maxPathLength <= 0.0f && !ignoreNavBlockers && CNavBidirectionalSearch::ShouldUse( startArea, goalArea ) )
+	{
+		if ( NavAreaBuildPathBidirectional( context, corridor, startArea, goalArea, costFunc, closestArea, teamID ) )
+		{
+			return true;
+		}
+
+		// no path in the corridor, the regular search covers the whole mesh and finds the closest area if the goal is unreachable
+		return NavAreaBuildPathInCorridor( context, NULL, startArea, goalArea, goalPos, costFunc, closestArea, maxPathLength, teamID, ignoreNavBlockers );
+	}
+
+	if ( corridor && NavAreaBuildPathInCorridor( context, corridor, startArea, goalArea, goalPos, costFunc, closestArea, maxPathLength, teamID, ignoreNavBlockers ) )
+	{
+		return true;
+	}
+
+	return NavAreaBuildPathInCorridor( context, NULL, startArea, goalArea, goalPos, costFunc, closestArea, maxPathLength, teamID, ignoreNavBlockers );
+}
+
+/**
+ * Same as above, using the calling thread's current search context.
+ * The resulting parent chain can be read with CNavArea::GetParent().
+ */
+template< typename CostFunctor >
+bool NavAreaBuildPath( CNavArea *startArea, CNavArea *goalArea, const Vector *goalPos,
+		const CostFunctor &costFunc, CNavArea **closestArea = NULL, float maxPathLength = 0.0f, int teamID = NAV_TEAM_ANY, bool ignoreNavBlockers = false )
+{
+	return NavAreaBuildPath( *NavSearchContext::GetCurrent(), startArea, goalArea, goalPos, costFunc, closestArea, maxPathLength, teamID, ignoreNavBlockers );
 }
 
 /**
@@ -513,10 +763,12 @@ bool NavAreaBuildPath( CNavArea *startArea, CNavArea *goalArea, const Vector *go
  * @param start Start area
  * @param goal Goal/End area
  * @param costFunc A* cost function
+ * @param teamID Team used to check for blocked areas, should match the team the cost function checks.
  * @return true if the start area can reach the goal area. false otherwise.
+ * @note Goals outside of the start area's connected components are rejected without searching, game thread only.
  */
 template<typename CostFunctor>
-bool NavIsReachable(CNavArea* start, CNavArea* goal, CostFunctor& costFunc)
+bool NavIsReachable(NavSearchContext& context, CNavArea* start, CNavArea* goal, CostFunctor& costFunc, int teamID)
 {
 	if (start == nullptr || goal == nullptr)
 		return false;
@@ -524,7 +776,16 @@ bool NavIsReachable(CNavArea* start, CNavArea* goal, CostFunctor& costFunc)
 	if (start == goal)
 		return true;
 
-	return NavAreaBuildPath(start, goal, nullptr, costFunc, nullptr);
+	if (!TheNavMesh->GetReachability()->MayReach(start, goal, teamID))
+		return false;
+
+	return NavAreaBuildPath(context, start, goal, nullptr, costFunc, nullptr, 0.0f, teamID);
+}
+
+template<typename CostFunctor>
+bool NavIsReachable(CNavArea* start, CNavArea* goal, CostFunctor& costFunc, int teamID)
+{
+	return NavIsReachable(*NavSearchContext::GetCurrent(), start, goal, costFunc, teamID);
 }
 
 
@@ -533,7 +794,7 @@ bool NavIsReachable(CNavArea* start, CNavArea* goal, CostFunctor& costFunc)
  * Compute distance between two areas. Return -1 if can't reach 'endArea' from 'startArea'.
  */
 template< typename CostFunctor >
-float NavAreaTravelDistance( CNavArea *startArea, CNavArea *endArea, CostFunctor &costFunc, float maxPathLength = 0.0f )
+float NavAreaTravelDistance( NavSearchContext &context, CNavArea *startArea, CNavArea *endArea, CostFunctor &costFunc, float maxPathLength = 0.0f )
 {
 	if (startArea == NULL || endArea == NULL)
 		return -1.0f;
@@ -542,19 +803,25 @@ float NavAreaTravelDistance( CNavArea *startArea, CNavArea *endArea, CostFunctor
 		return 0.0f;
 
 	// compute path between areas using given cost heuristic
-	if (NavAreaBuildPath( startArea, endArea, NULL, costFunc, NULL, maxPathLength ) == false)
+	if (NavAreaBuildPath( context, startArea, endArea, NULL, costFunc, NULL, maxPathLength ) == false)
 		return -1.0f;
 
 	// compute distance along path
 	float distance = 0.0f;
-	for( CNavArea *area = endArea; area->GetParent(); area = area->GetParent() )
+	for( CNavArea *area = endArea; context.GetParent( area ); area = context.GetParent( area ) )
 	{
-		distance += (area->GetCenter() - area->GetParent()->GetCenter()).Length();
+		distance += (area->GetCenter() - context.GetParent( area )->GetCenter()).Length();
 	}
 
 	return distance;
 }
 
+template< typename CostFunctor >
+float NavAreaTravelDistance( CNavArea *startArea, CNavArea *endArea, CostFunctor &costFunc, float maxPathLength = 0.0f )
+{
+	return NavAreaTravelDistance( *NavSearchContext::GetCurrent(), startArea, endArea, costFunc, maxPathLength );
+}
+
 
 
 //--------------------------------------------------------------------------------------------------------------
@@ -570,16 +837,16 @@ float NavAreaTravelDistance( CNavArea *startArea, CNavArea *endArea, CostFunctor
  */
 
 // helper function
-inline void AddAreaToOpenList( CNavArea *area, CNavArea *parent, const Vector &startPos, float maxRange )
+inline void AddAreaToOpenList( NavSearchContext &context, CNavArea *area, CNavArea *parent, const Vector &startPos, float maxRange )
 {
 	if (area == NULL)
 		return;
 
-	if (!area->IsMarked())
+	if (!context.IsMarked( area ))
 	{
-		area->Mark();
-		area->SetTotalCost( 0.0f );
-		area->SetParent( parent );
+		context.Mark( area );
+		context.SetTotalCost( area, 0.0f );
+		context.SetParent( area, parent );
 
 		if (maxRange > 0.0f)
 		{
@@ -589,19 +856,19 @@ inline void AddAreaToOpenList( CNavArea *area, CNavArea *parent, const Vector &s
 			if ((closePos - startPos).AsVector2D().IsLengthLessThan( maxRange ))
 			{
 				// compute approximate distance along path to limit travel range, too
-				float distAlong = parent->GetCostSoFar();
+				float distAlong = context.GetCostSoFar( parent );
 				distAlong += (area->GetCenter() - parent->GetCenter()).Length();
-				area->SetCostSoFar( distAlong );
+				context.SetCostSoFar( area, distAlong );
 
 				// allow for some fudge due to large size areas
 				if (distAlong <= 1.5f * maxRange)
-					area->AddToOpenList();
+					context.AddToOpenList( area );
 			}
 		}
 		else
 		{
 			// infinite range
-			area->AddToOpenList();
+			context.AddToOpenList( area );
 		}
 	}
 }
@@ -615,24 +882,27 @@ inline void AddAreaToOpenList( CNavArea *area, CNavArea *parent, const Vector &s
 #define EXCLUDE_OUTGOING_CONNECTIONS	0x4
 #define EXCLUDE_ELEVATORS				0x8
 template < typename Functor >
-void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functor &func, float maxRange = -1.0f, unsigned int options = 0, int teamID = NAV_TEAM_ANY )
+void SearchSurroundingAreas( NavSearchContext &context, CNavArea *startArea, const Vector &startPos, Functor &func, float maxRange = -1.0f, unsigned int options = 0, int teamID = NAV_TEAM_ANY )
 {
 	if (startArea == NULL)
 		return;
 
-	CNavArea::MakeNewMarker();
-	CNavArea::ClearSearchLists();
+	// the functor may read the search state of the areas from the current context
+	NavSearchContext::Scope scope( context );
 
-	startArea->AddToOpenList();
-	startArea->SetTotalCost( 0.0f );
-	startArea->SetCostSoFar( 0.0f );
-	startArea->SetParent( NULL );
-	startArea->Mark();
+	context.MakeNewMarker();
+	context.ClearSearchLists();
 
-	while( !CNavArea::IsOpenListEmpty() )
+	context.AddToOpenList( startArea );
+	context.SetTotalCost( startArea, 0.0f );
+	context.SetCostSoFar( startArea, 0.0f );
+	context.SetParent( startArea, NULL );
+	context.Mark( startArea );
+
+	while( !context.IsOpenListEmpty() )
 	{
 		// get next area to check
-		CNavArea *area = CNavArea::PopOpenList();
+		CNavArea *area = context.PopOpenList();
 
 		// don't use blocked areas
 		if ( area->IsBlocked( teamID ) && !(options & INCLUDE_BLOCKED_AREAS) )
@@ -651,7 +921,7 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 						CNavArea *adjArea = area->GetAdjacentArea( (NavDirType)dir, i );
 						if ( adjArea->IsConnected( area, NUM_DIRECTIONS ) )
 						{
-							AddAreaToOpenList( adjArea, area, startPos, maxRange );
+							AddAreaToOpenList( context, adjArea, area, startPos, maxRange );
 						}
 					}
 				}
@@ -661,7 +931,7 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 				for (auto& link : alllinks)
 				{
 					CNavArea* other = link.m_link.area;
-					AddAreaToOpenList(other, area, startPos, maxRange);
+					AddAreaToOpenList(context, other, area, startPos, maxRange);
 				}
 			}
 			// potentially include areas that connect TO this area via a one-way link
@@ -672,7 +942,7 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 					const NavConnectVector *list = area->GetIncomingConnections( (NavDirType)dir );
 					FOR_EACH_VEC( (*list), it )
 					{
-						AddAreaToOpenList( (*list)[ it ].area, area, startPos, maxRange );
+						AddAreaToOpenList( context, (*list)[ it ].area, area, startPos, maxRange );
 					}
 				}
 			}
@@ -691,7 +961,7 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 					{
 						if (connect.IsConnectedToLadderTop())
 						{
-							AddAreaToOpenList(connect.GetConnectedArea(), area, startPos, maxRange);
+							AddAreaToOpenList(context, connect.GetConnectedArea(), area, startPos, maxRange);
 						}
 					}
 				}
@@ -709,7 +979,7 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 					{
 						if (connect.IsConnectedToLadderBottom())
 						{
-							AddAreaToOpenList(connect.GetConnectedArea(), area, startPos, maxRange);
+							AddAreaToOpenList(context, connect.GetConnectedArea(), area, startPos, maxRange);
 						}
 					}
 				}
@@ -727,7 +997,7 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 					{
 						if (floor.GetArea() != area)
 						{
-							AddAreaToOpenList(floor.GetArea(), area, startPos, maxRange);
+							AddAreaToOpenList(context, floor.GetArea(), area, startPos, maxRange);
 						}
 					}
 				}
@@ -736,6 +1006,12 @@ void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functo
 	}
 }
 
+template < typename Functor >
+void SearchSurroundingAreas( CNavArea *startArea, const Vector &startPos, Functor &func, float maxRange = -1.0f, unsigned int options = 0, int teamID = NAV_TEAM_ANY )
+{
+	SearchSurroundingAreas( *NavSearchContext::GetCurrent(), startArea, startPos, func, maxRange, options, teamID );
+}
+
 
 //--------------------------------------------------------------------------------------------------------------
 /**
@@ -800,23 +1076,26 @@ public:
 		if ( area == NULL )
 			return;
 
-		if ( !area->IsMarked() )
+		// SearchSurroundingAreas makes the search context current while the search runs
+		NavSearchContext &context = *NavSearchContext::GetCurrent();
+
+		if ( !context.IsMarked( area ) )
 		{
-			area->Mark();
-			area->SetTotalCost( 0.0f );
-			area->SetParent( priorArea );
+			context.Mark( area );
+			context.SetTotalCost( area, 0.0f );
+			context.SetParent( area, priorArea );
 			// compute approximate travel distance from start area of search
 			if (link != nullptr)
 			{
-				area->SetCostSoFar(link->GetConnectionLength());
+				context.SetCostSoFar( area, link->GetConnectionLength() );
 			}
 			else
 			{
-				area->SetCostSoFar(priorArea ? priorArea->GetCostSoFar() + (area->GetCenter() - priorArea->GetCenter()).Length() : 0.0f);
+				context.SetCostSoFar( area, priorArea ? context.GetCostSoFar( priorArea ) + (area->GetCenter() - priorArea->GetCenter()).Length() : 0.0f );
 			}
 			
 			// adding an area to the open list also marks it
-			area->AddToOpenList();
+			context.AddToOpenList( area );
 		}
 	}
 };
@@ -826,32 +1105,35 @@ public:
  * Do a breadth-first search starting from 'startArea' and continuing outward based on
  * adjacent areas that pass the given filter
  */
-inline void SearchSurroundingAreas( CNavArea *startArea, ISearchSurroundingAreasFunctor &func, float travelDistanceLimit = -1.0f )
+inline void SearchSurroundingAreas( NavSearchContext &context, CNavArea *startArea, ISearchSurroundingAreasFunctor &func, float travelDistanceLimit = -1.0f )
 {
+	// the functor reads and writes the search state of the areas through the current context
+	NavSearchContext::Scope scope( context );
+
 	if ( startArea )
 	{
-		CNavArea::MakeNewMarker();
-		CNavArea::ClearSearchLists();
+		context.MakeNewMarker();
+		context.ClearSearchLists();
 
-		startArea->AddToOpenList();
-		startArea->SetTotalCost( 0.0f );
-		startArea->SetCostSoFar( 0.0f );
-		startArea->SetParent( NULL );
-		startArea->Mark();
+		context.AddToOpenList( startArea );
+		context.SetTotalCost( startArea, 0.0f );
+		context.SetCostSoFar( startArea, 0.0f );
+		context.SetParent( startArea, NULL );
+		context.Mark( startArea );
 
 		CUtlVector< CNavArea * > adjVector;
 
-		while( !CNavArea::IsOpenListEmpty() )
+		while( !context.IsOpenListEmpty() )
 		{
 			// get next area to check
-			CNavArea *area = CNavArea::PopOpenList();
+			CNavArea *area = context.PopOpenList();
 
-			if ( travelDistanceLimit > 0.0f && area->GetCostSoFar() > travelDistanceLimit )
+			if ( travelDistanceLimit > 0.0f && context.GetCostSoFar( area ) > travelDistanceLimit )
 				continue;
 
-			if ( func( area, area->GetParent(), area->GetCostSoFar() ) )
+			if ( func( area, context.GetParent( area ), context.GetCostSoFar( area ) ) )
 			{
-				func.IterateAdjacentAreas( area, area->GetParent(), area->GetCostSoFar() );
+				func.IterateAdjacentAreas( area, context.GetParent( area ), context.GetCostSoFar( area ) );
 			}
 			else
 			{
@@ -864,6 +1146,11 @@ inline void SearchSurroundingAreas( CNavArea *startArea, ISearchSurroundingAreas
 	func.PostSearch();
 }
 
+inline void SearchSurroundingAreas( CNavArea *startArea, ISearchSurroundingAreasFunctor &func, float travelDistanceLimit = -1.0f )
+{
+	SearchSurroundingAreas( *NavSearchContext::GetCurrent(), startArea, func, travelDistanceLimit );
+}
+
 
 //--------------------------------------------------------------------------------------------------------------
 /**
@@ -872,34 +1159,34 @@ inline void SearchSurroundingAreas( CNavArea *startArea, ISearchSurroundingAreas
  * Areas in the collection will be "marked", returning true for IsMarked(). 
  * Each area in the collection's GetCostSoFar() will be approximate travel distance from 'startArea'.
  */
-inline void CollectSurroundingAreas( CUtlVector< CNavArea * > *nearbyAreaVector, CNavArea *startArea, float travelDistanceLimit = 1500.0f, float maxStepUpLimit = navgenparams->step_height, float maxDropDownLimit = 100.0f )
+inline void CollectSurroundingAreas( NavSearchContext &context, CUtlVector< CNavArea * > *nearbyAreaVector, CNavArea *startArea, float travelDistanceLimit = 1500.0f, float maxStepUpLimit = navgenparams->step_height, float maxDropDownLimit = 100.0f )
 {
 	nearbyAreaVector->RemoveAll();
 
 	if ( startArea )
 	{
-		CNavArea::MakeNewMarker();
-		CNavArea::ClearSearchLists();
+		context.MakeNewMarker();
+		context.ClearSearchLists();
 
-		startArea->AddToOpenList();
-		startArea->SetTotalCost( 0.0f );
-		startArea->SetCostSoFar( 0.0f );
-		startArea->SetParent( NULL );
-		startArea->Mark();
+		context.AddToOpenList( startArea );
+		context.SetTotalCost( startArea, 0.0f );
+		context.SetCostSoFar( startArea, 0.0f );
+		context.SetParent( startArea, NULL );
+		context.Mark( startArea );
 
 		CUtlVector< CNavArea * > adjVector;
 
-		while( !CNavArea::IsOpenListEmpty() )
+		while( !context.IsOpenListEmpty() )
 		{
 			// get next area to check
-			CNavArea *area = CNavArea::PopOpenList();
+			CNavArea *area = context.PopOpenList();
 
-			if ( travelDistanceLimit > 0.0f && area->GetCostSoFar() > travelDistanceLimit )
+			if ( travelDistanceLimit > 0.0f && context.GetCostSoFar( area ) > travelDistanceLimit )
 				continue;
 
-			if ( area->GetParent() )
+			if ( context.GetParent( area ) )
 			{
-				float deltaZ = area->GetParent()->ComputeAdjacentConnectionHeightChange( area );
+				float deltaZ = context.GetParent( area )->ComputeAdjacentConnectionHeightChange( area );
 
 				if ( deltaZ > maxStepUpLimit
 						|| deltaZ < -maxDropDownLimit )
@@ -909,7 +1196,7 @@ inline void CollectSurroundingAreas( CUtlVector< CNavArea * > *nearbyAreaVector,
 			nearbyAreaVector->AddToTail( area );
 
 			// mark here to ensure all marked areas are also valid areas that are in the collection
-			area->Mark();
+			context.Mark( area );
 
 			// search adjacent outgoing connections
 			for( int dir=0; dir<NUM_DIRECTIONS; ++dir )
@@ -920,16 +1207,16 @@ inline void CollectSurroundingAreas( CUtlVector< CNavArea * > *nearbyAreaVector,
 					CNavArea *adjArea = area->GetAdjacentArea( (NavDirType)dir, i );
 
 					if ( adjArea->IsBlocked( NAV_TEAM_ANY )
-							|| adjArea->IsMarked() ) {
+							|| context.IsMarked( adjArea ) ) {
 						continue;
 					}
-					adjArea->SetTotalCost( 0.0f );
-					adjArea->SetParent( area );
+					context.SetTotalCost( adjArea, 0.0f );
+					context.SetParent( adjArea, area );
 
 					// compute approximate travel distance from start area of search
-					adjArea->SetCostSoFar( area->GetCostSoFar()
-							+ ( adjArea->GetCenter() - area->GetCenter() ).Length());
-					adjArea->AddToOpenList();
+					context.SetCostSoFar( adjArea, context.GetCostSoFar( area )
+							+ ( adjArea->GetCenter() - area->GetCenter() ).Length() );
+					context.AddToOpenList( adjArea );
 				}
 			}
 
@@ -937,20 +1224,25 @@ inline void CollectSurroundingAreas( CUtlVector< CNavArea * > *nearbyAreaVector,
 			{
 				CNavArea* adjArea = links.m_link.area;
 
-				if (adjArea->IsBlocked(NAV_TEAM_ANY) || adjArea->IsMarked())
+				if (adjArea->IsBlocked(NAV_TEAM_ANY) || context.IsMarked( adjArea ))
 				{
 					continue;
 				}
 
-				adjArea->SetTotalCost(0.0f);
-				adjArea->SetParent(area, GO_OFF_MESH_CONNECTION);
-				adjArea->SetCostSoFar(area->GetCostSoFar() + links.GetConnectionLength());
-				adjArea->AddToOpenList();
+				context.SetTotalCost( adjArea, 0.0f );
+				context.SetParent( adjArea, area, GO_OFF_MESH_CONNECTION );
+				context.SetCostSoFar( adjArea, context.GetCostSoFar( area ) + links.GetConnectionLength() );
+				context.AddToOpenList( adjArea );
 			}
 		}
 	}
 }
 
+inline void CollectSurroundingAreas( CUtlVector< CNavArea * > *nearbyAreaVector, CNavArea *startArea, float travelDistanceLimit = 1500.0f, float maxStepUpLimit = navgenparams->step_height, float maxDropDownLimit = 100.0f )
+{
+	CollectSurroundingAreas( *NavSearchContext::GetCurrent(), nearbyAreaVector, startArea, travelDistanceLimit, maxStepUpLimit, maxDropDownLimit );
+}
+
 
 //--------------------------------------------------------------------------------------------------------------
 /**
@@ -1091,38 +1383,145 @@ void SelectSeparatedShuffleSet( int maxCount, float minSeparation, const CUtlVec
 		int k = randomgen->GetRandomInt<int>(0, n - 1);
 		n--;
 
-		T *tmp = shuffledVector[n];
-		shuffledVector[n] = shuffledVector[k];
-		shuffledVector[k] = tmp;
+		T *tmp = shuffledVector[n];
+		shuffledVector[n] = shuffledVector[k];
+		shuffledVector[k] = tmp;
+	}
+
+	// enforce minSeparation between shuffled areas
+	for( i=0; i<shuffledVector.Count(); ++i )
+	{
+		T *area = shuffledVector[i];
+
+		CUtlVector< CNavArea * > nearVector;
+		CollectSurroundingAreas( &nearVector, area, minSeparation, 2.0f * navgenparams->step_height, 2.0f * navgenparams->step_height );
+
+		for( j=0; j<i; ++j )
+		{
+			if ( nearVector.HasElement( (CNavArea *)shuffledVector[j] ) )
+			{
+				// this area is too near an area earlier in the vector
+				break;
+			}
+		}
+
+		if ( j == i )
+		{
+			// separated from all prior areas
+			outVector->AddToTail( area );
+
+			if ( outVector->Count() >= maxCount )
+				return;
+		}
+	}
+}
+
+/**
+ * @brief Per area search state stored in a flat array indexed by the area search index.
+ * 
+ * Clearing only increments a generation counter, the array keeps its memory between searches so repeated searches don't allocate.
+ * Call Prepare before a search, node references stay valid until the next call to Prepare.
+ * @tparam Node Node type, default constructed when an area is first visited on a search.
+ */
+template <typename Node>
+class NavAreaNodeStorage
+{
+public:
+	NavAreaNodeStorage()
+	{
+		m_generation = 1U;
+	}
+
+	// Makes room for every area, node references are invalidated
+	void Prepare()
+	{
+		const std::size_t count = static_cast<std::size_t>(CNavArea::GetSearchIndexCount());
+
+		if (m_entries.size() < count)
+		{
+			m_entries.resize(count);
+		}
+	}
+
+	// Forgets every node
+	void Clear()
+	{
+		if (++m_generation == 0U)
+		{
+			// generation wrapped around, clear the old entries
+			for (auto& entry : m_entries)
+			{
+				entry.generation = 0U;
+			}
+
+			m_generation = 1U;
+		}
+	}
+
+	bool Contains(const CNavArea* area) const
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+		return index < m_entries.size() && m_entries[index].generation == m_generation;
+	}
+
+	// Gets the node of an area, NULL if the area wasn't visited
+	Node* Find(const CNavArea* area)
+	{
+		return Contains(area) ? &m_entries[area->GetSearchIndex()].node : nullptr;
 	}
 
-	// enforce minSeparation between shuffled areas
-	for( i=0; i<shuffledVector.Count(); ++i )
+	const Node* Find(const CNavArea* area) const
 	{
-		T *area = shuffledVector[i];
+		return Contains(area) ? &m_entries[area->GetSearchIndex()].node : nullptr;
+	}
 
-		CUtlVector< CNavArea * > nearVector;
-		CollectSurroundingAreas( &nearVector, area, minSeparation, 2.0f * navgenparams->step_height, 2.0f * navgenparams->step_height );
+	/**
+	 * @brief Gets the node of an area, creating it if the area wasn't visited.
+	 * @param area Area.
+	 * @param created Set to true if the node was created.
+	 * @return Node reference.
+	 */
+	Node& Get(const CNavArea* area, bool* created = nullptr)
+	{
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
 
-		for( j=0; j<i; ++j )
+		if (index >= m_entries.size())
 		{
-			if ( nearVector.HasElement( (CNavArea *)shuffledVector[j] ) )
+			Prepare();
+
+			if (index >= m_entries.size())
 			{
-				// this area is too near an area earlier in the vector
-				break;
+				m_entries.resize(index + 1U);
 			}
 		}
 
-		if ( j == i )
+		Entry& entry = m_entries[index];
+		const bool isNew = entry.generation != m_generation;
+
+		if (isNew)
 		{
-			// separated from all prior areas
-			outVector->AddToTail( area );
+			entry.node = Node{};
+			entry.generation = m_generation;
+		}
 
-			if ( outVector->Count() >= maxCount )
-				return;
+		if (created != nullptr)
+		{
+			*created = isNew;
 		}
+
+		return entry.node;
 	}
-}
+
+private:
+	struct Entry
+	{
+		Node node;
+		unsigned int generation = 0U;
+	};
+
+	std::vector<Entry> m_entries;
+	unsigned int m_generation;
+};
 
 template <typename T>
 class INavSearchNode
@@ -1164,7 +1563,6 @@ public:
 	{
 		m_startArea = nullptr;
 		m_travelLimit = 999999.0f;
-		m_nodes.reserve(4096);
 		m_collected.reserve(4096);
 		m_searchLadders = true;
 		m_searchLinks = true;
@@ -1175,7 +1573,6 @@ public:
 	{
 		m_startArea = start;
 		m_travelLimit = limit;
-		m_nodes.reserve(4096);
 		m_collected.reserve(4096);
 		m_searchLadders = true;
 		m_searchLinks = true;
@@ -1186,7 +1583,6 @@ public:
 	{
 		m_startArea = start;
 		m_travelLimit = limit;
-		m_nodes.reserve(4096);
 		m_collected.reserve(4096);
 		m_searchLadders = searchLadders;
 		m_searchLinks = searchLinks;
@@ -1245,8 +1641,8 @@ protected:
 private:
 	T* m_startArea;
 	float m_travelLimit;
-	std::stack<T*> m_searchlist;
-	std::unordered_map<unsigned int, INavSearchNode<T>> m_nodes;
+	std::stack<T*, std::vector<T*>> m_searchlist;
+	NavAreaNodeStorage<INavSearchNode<T>> m_nodes;
 	std::vector<T*> m_collected;
 	bool m_searchLadders;
 	bool m_searchLinks;
@@ -1277,7 +1673,7 @@ inline void INavAreaCollector<T>::Execute()
 		T* next = PopNextArea();
 
 		// All areas at the searchlist should have a valid node!
-		auto thisnode = &m_nodes.find(next->GetID())->second;
+		auto thisnode = m_nodes.Find(next);
 
 		if (m_travelLimit > 0.0f && thisnode->total > m_travelLimit)
 		{
@@ -1426,7 +1822,7 @@ template<typename T>
 inline void INavAreaCollector<T>::Reset()
 {
 	m_collected.clear();
-	m_nodes.clear();
+	m_nodes.Clear();
 
 	while (!m_searchlist.empty())
 	{
@@ -1437,37 +1833,34 @@ inline void INavAreaCollector<T>::Reset()
 template<typename T>
 inline void INavAreaCollector<T>::IncludeInSearch(T* prevArea, T* area)
 {
-	if (m_nodes.find(area->GetID()) == m_nodes.end())
+	bool created = false;
+	auto node = &m_nodes.Get(area, &created);
+
+	if (created)
 	{
-		auto status = m_nodes.emplace(area->GetID(), INavSearchNode<T>(area));
-		
-		if (status.second == true)
-		{
-			auto node = &status.first->second;
-			auto prevnode = &m_nodes.find(prevArea->GetID())->second;
+		auto prevnode = m_nodes.Find(prevArea);
 
-			node->me = area;
-			node->parent = prevArea;
-			float distAlong = prevnode->total;
-			float cost = ComputeCostBetweenAreas(prevArea, area);
-			node->cost = cost; // store the cost to go from parent to me
-			node->total = distAlong + cost; // store total cost along the path
+		node->me = area;
+		node->parent = prevArea;
+		float distAlong = prevnode->total;
+		float cost = ComputeCostBetweenAreas(prevArea, area);
+		node->cost = cost; // store the cost to go from parent to me
+		node->total = distAlong + cost; // store total cost along the path
 
-			m_searchlist.push(area);
-		}
+		m_searchlist.push(area);
 	}
 }
 
 template<typename T>
 inline void INavAreaCollector<T>::InitSearch()
 {
+	m_nodes.Prepare();
 
-	auto status = m_nodes.emplace(m_startArea->GetID(), INavSearchNode<T>(m_startArea));
+	bool created = false;
+	auto node = &m_nodes.Get(m_startArea, &created);
 
-	if (status.second == true)
+	if (created)
 	{
-		auto node = &status.first->second;
-
 		node->parent = nullptr;
 		node->me = m_startArea;
 		node->cost = ComputeCostBetweenAreas(nullptr, m_startArea);
@@ -1502,7 +1895,8 @@ public:
 	// Calculates a heuristic cost between two areas
 	float operator()(CNavArea* from, CNavArea* goal) const
 	{
-		return (from->GetCenter() - goal->GetCenter()).Length();
+		float distance = (from->GetCenter() - goal->GetCenter()).Length();
+		return std::max(distance, TheNavMesh->GetLandmarks()->GetLowerBound(from, goal));
 	}
 
 	// Calculates a heuristic cost between an area and a goal position
@@ -1652,6 +2046,13 @@ public:
 
 	template <typename CF, typename HF>
 	void DoSearch(CF& gCostFunctor, HF& hCostFunctor);
+	// Runs the search with the given context as the current search context
+	template <typename CF, typename HF>
+	void DoSearch(NavSearchContext& context, CF& gCostFunctor, HF& hCostFunctor)
+	{
+		NavSearchContext::Scope scope(context);
+		DoSearch(gCostFunctor, hCostFunctor);
+	}
 	void Clear();
 	bool FoundPath() const { return lastResult; }
 	const std::vector<CNavArea*>& GetPath() const { return path; }
@@ -1668,7 +2069,9 @@ private:
 	NavAStarNode* GetNodeForArea(T* area);
 	void BuildPath(NavAStarNode* endnode);
 
-	std::unordered_map<unsigned int, NavAStarNode> nodes;
+	NavAreaNodeStorage<NavAStarNode> nodes;
+	std::vector<NavAStarNode*> openList; // min heap, kept between searches to reuse the memory
+	std::vector<CNavArea*> neighborAreas;
 	std::vector<CNavArea*> path;
 };
 
@@ -1679,7 +2082,6 @@ inline INavAStarSearch<T>::INavAStarSearch()
 	goalArea = nullptr;
 	goalPosition.Init(0.0f, 0.0f, 0.0f);
 	lastResult = false;
-	nodes.reserve(1024);
 }
 
 template<typename T>
@@ -1690,33 +2092,26 @@ inline INavAStarSearch<T>::~INavAStarSearch()
 template<typename T>
 inline NavAStarNode* INavAStarSearch<T>::GetNodeForArea(T* area)
 {
-	unsigned int id = area->GetID();
+	bool created = false;
+	NavAStarNode* node = &nodes.Get(area, &created);
 
-	auto it = nodes.find(id);
-
-	if (it == nodes.end())
+	if (created)
 	{
-		auto node = nodes.emplace(id, area);
-
-		if (node.second)
-		{
-			return &node.first->second;
-		}
-
-		return nullptr;
+		node->SetArea(area);
 	}
 
-	return &it->second;
+	return node;
 }
 
 template<typename T>
 template<typename CF, typename HF>
 inline void INavAStarSearch<T>::DoSearch(CF& gCostFunctor, HF& hCostFunctor)
 {
-	std::priority_queue<NavAStarNode*, std::vector<NavAStarNode*>, NavNodeSmallestCost> openList;
 	Vector searchGoal = goalArea != nullptr ? goalArea->GetCenter() : goalPosition;
-	std::vector<CNavArea*> neighborAreas;
 	CNavArea* endArea = goalArea;
+	NavNodeSmallestCost compare;
+	openList.clear();
+	nodes.Prepare();
 
 	if (endArea == nullptr)
 	{
@@ -1748,16 +2143,45 @@ inline void INavAStarSearch<T>::DoSearch(CF& gCostFunctor, HF& hCostFunctor)
 			return;
 		}
 
-		openList.push(startNode);
+		openList.push_back(startNode);
+	}
+
+	// long routes expand from both ends, a failed bidirectional search means there is no path
+	if (CNavBidirectionalSearch::ShouldUse(startArea, endArea))
+	{
+		CNavBidirectionalSearch& search = CNavBidirectionalSearch::GetThreadSearch();
+
+		auto edgeCost = [&gCostFunctor](const NavAreaConnection& connection) {
+			const float cost = gCostFunctor(connection.to, connection.from, connection.ladder, connection.link, connection.elevator);
+			return cost < 0.0f ? CNavConnectionGraph::INFINITE_COST : std::max(cost, CNavConnectionGraph::MIN_CONNECTION_COST);
+		};
+
+		this->lastResult = search.FindPath(startArea, endArea, edgeCost);
+
+		if (!this->lastResult)
+		{
+			OnFailure();
+			return;
+		}
+
+		// goal first, same as BuildPath
+		for (auto it = search.GetPath().rbegin(); it != search.GetPath().rend(); ++it)
+		{
+			this->path.push_back(it->area);
+		}
+
+		OnSuccess();
+		return;
 	}
 
 	// search loop
 	while (!openList.empty())
 	{
 		neighborAreas.clear();
-		NavAStarNode* current = openList.top();
+		std::pop_heap(openList.begin(), openList.end(), compare);
+		NavAStarNode* current = openList.back();
 		CNavArea* area = current->area;
-		openList.pop(); // remove current from openList
+		openList.pop_back(); // remove current from openList
 		current->Close(); // mark as closed
 
 		if (current->area == endArea)
@@ -1770,7 +2194,7 @@ inline void INavAStarSearch<T>::DoSearch(CF& gCostFunctor, HF& hCostFunctor)
 		}
 
 		// Collect neighbors
-		area->ForEachConnectedArea([&neighborAreas](CNavArea* other) {
+		area->ForEachConnectedArea([this](CNavArea* other) {
 			neighborAreas.push_back(other);
 		});
 
@@ -1807,7 +2231,8 @@ inline void INavAStarSearch<T>::DoSearch(CF& gCostFunctor, HF& hCostFunctor)
 				if (node->IsStatusUndefined())
 				{
 					node->Open();
-					openList.push(node);
+					openList.push_back(node);
+					std::push_heap(openList.begin(), openList.end(), compare);
 				}
 			}
 		}
@@ -1821,7 +2246,7 @@ template<typename T>
 inline void INavAStarSearch<T>::Clear()
 {
 	this->path.clear();
-	this->nodes.clear();
+	this->nodes.Clear();
 	this->lastResult = false;
 }
 
@@ -1833,7 +2258,6 @@ inline void INavAStarSearch<T>::BuildPath(NavAStarNode* endnode)
 #endif
 
 	NavAStarNode* next = endnode;
-	path.reserve(nodes.size());
 
 	for (;;)
 	{
@@ -1847,7 +2271,7 @@ inline void INavAStarSearch<T>::BuildPath(NavAStarNode* endnode)
 		next = next->parent;
 
 #ifdef EXT_DEBUG
-		if (++i >= (nodes.size() + 10U))
+		if (++i >= (static_cast<size_t>(CNavArea::GetSearchIndexCount()) + 10U))
 		{
 			throw std::runtime_error("Infinite Loop!");
 		}
@@ -1868,9 +2292,7 @@ public:
 	{
 		m_startArea = nullptr;
 		m_travelLimit = -1.0f;
-		m_searchedAreas.reserve(4096);
-		m_travelCost.reserve(4096);
-		m_parents.reserve(4096);
+		m_searchHead = 0U;
 		m_searchLadders = true;
 		m_searchOffmeshLinks = true;
 		m_searchElevators = true;
@@ -1880,9 +2302,7 @@ public:
 	{
 		m_startArea = start;
 		m_travelLimit = -1.0f;
-		m_searchedAreas.reserve(4096);
-		m_travelCost.reserve(4096);
-		m_parents.reserve(4096);
+		m_searchHead = 0U;
 		m_searchLadders = true;
 		m_searchOffmeshLinks = true;
 		m_searchElevators = true;
@@ -1892,9 +2312,7 @@ public:
 	{
 		m_startArea = start;
 		m_travelLimit = travelLimit;
-		m_searchedAreas.reserve(4096);
-		m_travelCost.reserve(4096);
-		m_parents.reserve(4096);
+		m_searchHead = 0U;
 		m_searchLadders = true;
 		m_searchOffmeshLinks = true;
 		m_searchElevators = true;
@@ -1904,9 +2322,7 @@ public:
 	{
 		m_startArea = start;
 		m_travelLimit = travelLimit;
-		m_searchedAreas.reserve(4096);
-		m_travelCost.reserve(4096);
-		m_parents.reserve(4096);
+		m_searchHead = 0U;
 		m_searchLadders = searchLadders;
 		m_searchOffmeshLinks = searchOffMeshLinks;
 		m_searchElevators = searchElevators;
@@ -1915,16 +2331,11 @@ public:
 	virtual ~INavFloodFill() {}
 
 	// Reset for a new search
-	void Reset()
+	virtual void Reset()
 	{
-		m_searchedAreas.clear();
-		m_travelCost.clear();
-		m_parents.clear();
-
-		while (!m_searchAreas.empty())
-		{
-			m_searchAreas.pop();
-		}
+		m_nodes.Clear();
+		m_searchAreas.clear();
+		m_searchHead = 0U;
 	}
 
 	void SetStartArea(T* area) { m_startArea = area; }
@@ -1933,7 +2344,7 @@ public:
 	void SetSearchOffmeshLinks(bool search) { m_searchOffmeshLinks = search; }
 	void SetSearchElevators(bool search) { m_searchElevators = search; }
 
-	void Execute();
+	virtual void Execute();
 
 	/**
 	 * @brief Called to each area in the flood fill.
@@ -1955,28 +2366,43 @@ public:
 	 */
 	virtual float operator()(T* toArea, T* fromArea, const float fromCost, const NavOffMeshConnection* link, const CNavLadder* ladder, const CNavElevator* elevator);
 
-private:
+protected:
 	T* m_startArea; // flood start area
 	float m_travelLimit;
-	std::unordered_set<unsigned int> m_searchedAreas;
-	std::unordered_map<unsigned int, float> m_travelCost;
-	std::unordered_map<unsigned int, T*> m_parents;
-	std::queue<T*> m_searchAreas;
+	struct FloodNode
+	{
+		float travelCost = 0.0f;
+		T* parent = nullptr;
+		bool searched = false;
+	};
+
+	NavAreaNodeStorage<FloodNode> m_nodes; // areas reached by the search
+	std::vector<T*> m_searchAreas; // FIFO queue, areas before m_searchHead were already removed
+	std::size_t m_searchHead;
 	bool m_searchLadders;
 	bool m_searchOffmeshLinks;
 	bool m_searchElevators;
 
-	bool AlreadySearched(T* area)
+	bool AlreadySearched(T* area) const
 	{
-		return m_searchedAreas.find(area->GetID()) != m_searchedAreas.end();
+		const FloodNode* node = m_nodes.Find(area);
+		return node != nullptr && node->searched;
 	}
 
-	T* GetParentForArea(T* area)
+	T* GetParentForArea(T* area) const
 	{
-		return m_parents[area->GetID()];
+		const FloodNode* node = m_nodes.Find(area);
+		return node != nullptr ? node->parent : nullptr;
 	}
 
 	void OnAreaBeingSearched(T* area, T* parent, const float parentCost, const NavOffMeshConnection* offmeshlink = nullptr, const CNavLadder* ladder = nullptr, const CNavElevator* elevator = nullptr);
+
+	/**
+	 * @brief Runs a function on each area connected to the given area, skipping the connection types disabled on this search.
+	 * @tparam F void (T* other, const NavOffMeshConnection* link, const CNavLadder* ladder, const CNavElevator* elevator)
+	 */
+	template <typename F>
+	void ForEachConnectedArea(T* area, F functor);
 };
 
 template<typename T>
@@ -1987,19 +2413,19 @@ inline void INavFloodFill<T>::Execute()
 		return;
 	}
 
-	m_searchAreas.push(m_startArea);
-	m_searchedAreas.insert(m_startArea->GetID());
-	m_travelCost[m_startArea->GetID()] = this->operator()(m_startArea, nullptr, 0.0f, nullptr, nullptr, nullptr);
-	m_parents[m_startArea->GetID()] = nullptr;
+	m_nodes.Prepare();
 
+	FloodNode& start = m_nodes.Get(m_startArea);
+	start.searched = true;
+	start.travelCost = this->operator()(m_startArea, nullptr, 0.0f, nullptr, nullptr, nullptr);
+	start.parent = nullptr;
+	m_searchAreas.push_back(m_startArea);
 
-	while (!m_searchAreas.empty())
+	while (m_searchHead < m_searchAreas.size())
 	{
-		T* nextArea = m_searchAreas.front();
-		unsigned int nextID = nextArea->GetID();
-		m_searchAreas.pop();
+		T* nextArea = m_searchAreas[m_searchHead++];
 		T* parentArea = GetParentForArea(nextArea);
-		float currentCost = m_travelCost[nextArea->GetID()];
+		float currentCost = m_nodes.Find(nextArea)->travelCost;
 
 		if (m_travelLimit > 0.0f && currentCost > m_travelLimit)
 		{
@@ -2012,84 +2438,86 @@ inline void INavFloodFill<T>::Execute()
 		}
 		else
 		{
-			float cost = m_travelCost[parentArea->GetID()];
+			float cost = m_nodes.Find(parentArea)->travelCost;
 			this->operator()(nextArea, parentArea, cost);
 		}
 
-		// search normal connections
-		for (int dir = 0; dir < static_cast<int>(NUM_DIRECTIONS); dir++)
-		{
-			auto vec = nextArea->GetAdjacentAreas(static_cast<NavDirType>(dir));
-
-			for (int i = 0; i < vec->Count(); i++)
+		ForEachConnectedArea(nextArea, [this, nextArea, currentCost](T* other, const NavOffMeshConnection* link, const CNavLadder* ladder, const CNavElevator* elevator) {
+			if (!AlreadySearched(other))
 			{
-				T* other = static_cast<T*>(vec->Element(i).area);
-
-				if (!AlreadySearched(other))
-				{
-					OnAreaBeingSearched(other, nextArea, currentCost);
-				}
+				OnAreaBeingSearched(other, nextArea, currentCost, link, ladder, elevator);
 			}
+		});
+	}
+}
+
+template<typename T>
+template<typename F>
+inline void INavFloodFill<T>::ForEachConnectedArea(T* area, F functor)
+{
+	// search normal connections
+	for (int dir = 0; dir < static_cast<int>(NUM_DIRECTIONS); dir++)
+	{
+		auto vec = area->GetAdjacentAreas(static_cast<NavDirType>(dir));
+
+		for (int i = 0; i < vec->Count(); i++)
+		{
+			functor(static_cast<T*>(vec->Element(i).area), nullptr, nullptr, nullptr);
 		}
+	}
 
-		if (m_searchLadders)
+	if (m_searchLadders)
+	{
+		// search ladders
+		for (int dir = 0; dir < static_cast<int>(CNavLadder::NUM_LADDER_DIRECTIONS); dir++)
 		{
-			// search ladders
-			for (int dir = 0; dir < static_cast<int>(CNavLadder::NUM_LADDER_DIRECTIONS); dir++)
+			auto vec = area->GetLadders(static_cast<CNavLadder::LadderDirectionType>(dir));
+
+			for (int i = 0; i < vec->Count(); i++)
 			{
-				auto vec = nextArea->GetLadders(static_cast<CNavLadder::LadderDirectionType>(dir));
+				CNavLadder* ladder = vec->Element(i).ladder;
+				auto& conns = ladder->GetConnections();
 
-				for (int i = 0; i < vec->Count(); i++)
+				for (auto& connect : conns)
 				{
-					CNavLadder* ladder = vec->Element(i).ladder;
-					auto& conns = ladder->GetConnections();
+					T* other = static_cast<T*>(connect.GetConnectedArea());
 
-					for (auto& connect : conns)
+					if (other != area)
 					{
-						T* other = static_cast<T*>(connect.GetConnectedArea());
-
-						if (other != nextArea && !AlreadySearched(other))
-						{
-							OnAreaBeingSearched(other, nextArea, currentCost, nullptr, ladder, nullptr);
-						}
+						functor(other, nullptr, ladder, nullptr);
 					}
 				}
 			}
 		}
+	}
 
-		if (m_searchOffmeshLinks)
-		{
-			// search offmesh links
-			auto& offmeshlinks = nextArea->GetOffMeshConnections();
-
-			for (auto& link : offmeshlinks)
-			{
-				T* other = static_cast<T*>(link.m_link.area);
+	if (m_searchOffmeshLinks)
+	{
+		// search offmesh links
+		auto& offmeshlinks = area->GetOffMeshConnections();
 
-				if (!AlreadySearched(other))
-				{
-					OnAreaBeingSearched(other, nextArea, currentCost, &link, nullptr, nullptr);
-				}
-			}
+		for (auto& link : offmeshlinks)
+		{
+			functor(static_cast<T*>(link.m_link.area), &link, nullptr, nullptr);
 		}
+	}
 
-		if (m_searchElevators)
+	if (m_searchElevators)
+	{
+		const CNavElevator* elevator = area->GetElevator();
+
+		// search elevators
+		if (elevator != nullptr)
 		{
-			const CNavElevator* elevator = nextArea->GetElevator();
+			auto& floors = elevator->GetFloors();
 
-			// search elevators
-			if (elevator != nullptr)
+			for (auto& floor : floors)
 			{
-				auto& floors = elevator->GetFloors();
+				T* other = static_cast<T*>(floor.GetArea());
 
-				for (auto& floor : floors)
+				if (other != area)
 				{
-					T* other = static_cast<T*>(floor.GetArea());
-
-					if (other != nextArea && !AlreadySearched(other))
-					{
-						OnAreaBeingSearched(other, nextArea, currentCost, nullptr, nullptr, elevator);
-					}
+					functor(other, nullptr, nullptr, elevator);
 				}
 			}
 		}
@@ -2131,10 +2559,284 @@ inline float INavFloodFill<T>::operator()(T* toArea, T* fromArea, const float fr
 template<typename T>
 inline void INavFloodFill<T>::OnAreaBeingSearched(T* area, T* parent, const float parentCost, const NavOffMeshConnection* offmeshlink, const CNavLadder* ladder, const CNavElevator* elevator)
 {
-	m_searchedAreas.insert(area->GetID());
-	m_travelCost[area->GetID()] = this->operator()(area, parent, parentCost, offmeshlink, ladder, elevator);
-	m_parents[area->GetID()] = parent;
-	m_searchAreas.push(area);
+	FloodNode& node = m_nodes.Get(area);
+	node.searched = true;
+	node.travelCost = this->operator()(area, parent, parentCost, offmeshlink, ladder, elevator);
+	node.parent = parent;
+	m_searchAreas.push_back(area);
+}
+
+/**
+ * @brief Result of a multi goal search.
+ */
+template <typename T = CNavArea>
+struct NavGoalSearchResult
+{
+	T* area; // goal area
+	float travelCost; // travel cost from the start area
+};
+
+/**
+ * @brief Flood fill ordered by travel cost (Dijkstra) from the start area to a set of goal areas.
+ * 
+ * Finds the nearest of many candidates (pickups, objectives, ...) with a single search instead of one path search per candidate.
+ * Travel costs are computed by the flood fill cost function, override it for custom costs. A negative cost skips the connection.
+ * @tparam T Nav area class.
+ */
+template <typename T = CNavArea>
+class INavMultiGoalSearch : public INavFloodFill<T>
+{
+public:
+	INavMultiGoalSearch() :
+		INavFloodFill<T>()
+	{
+		m_teamID = NAV_TEAM_ANY;
+		m_maxGoals = 0U;
+	}
+
+	INavMultiGoalSearch(T* start, float travelLimit = -1.0f) :
+		INavFloodFill<T>(start, travelLimit)
+	{
+		m_teamID = NAV_TEAM_ANY;
+		m_maxGoals = 0U;
+	}
+
+	// Reset for a new search, goals are kept
+	void Reset() override
+	{
+		INavFloodFill<T>::Reset();
+		m_results.clear();
+	}
+
+	void AddGoal(T* area) { m_goals.insert(area->GetID()); }
+	void ClearGoals() { m_goals.clear(); }
+	std::size_t GetGoalCount() const { return m_goals.size(); }
+	// Areas blocked for this team are not searched
+	void SetTeam(int teamID) { m_teamID = teamID; }
+	// Stops the search after this many goals were reached. Zero to search for all goals.
+	void SetMaxGoals(std::size_t count) { m_maxGoals = count; }
+
+	void Execute() override;
+
+	// Reached goals sorted by travel cost, nearest first
+	const std::vector<NavGoalSearchResult<T>>& GetResults() const { return m_results; }
+	// Nearest reached goal or NULL if none was reached
+	T* GetNearestGoal() const { return m_results.empty() ? nullptr : m_results[0].area; }
+
+	/**
+	 * @brief Gets the travel cost to a reached area.
+	 * @param area Area to get the travel cost of, must have been reached by the search (goal or not).
+	 * @param cost Stores the travel cost.
+	 * @return true if the area was reached.
+	 */
+	bool GetTravelCost(T* area, float& cost) const
+	{
+		if (!this->AlreadySearched(area))
+		{
+			return false;
+		}
+
+		cost = this->m_nodes.Find(area)->travelCost;
+		return true;
+	}
+
+	// Parent of a reached area on the search tree, NULL for the start area
+	T* GetParent(T* area) const { return this->GetParentForArea(area); }
+
+	/**
+	 * @brief Builds the chain of areas from the start area to a reached goal.
+	 * @param goal Goal area.
+	 * @param areas Stores the areas, start area first.
+	 * @return false if the goal wasn't reached.
+	 */
+	bool GetPathToGoal(T* goal, std::vector<T*>& areas) const
+	{
+		areas.clear();
+
+		if (!this->AlreadySearched(goal))
+		{
+			return false;
+		}
+
+		for (T* area = goal; area != nullptr; area = GetParent(area))
+		{
+			areas.push_back(area);
+		}
+
+		std::reverse(areas.begin(), areas.end());
+		return true;
+	}
+
+private:
+	struct OpenArea
+	{
+		float cost;
+		T* area;
+	};
+
+	// min heap ordering of the open list
+	static bool OpenAreaGreater(const OpenArea& lhs, const OpenArea& rhs) { return lhs.cost > rhs.cost; }
+
+	std::vector<OpenArea> m_openList; // kept between searches to reuse the memory
+	std::unordered_set<unsigned int> m_goals;
+	std::vector<NavGoalSearchResult<T>> m_results;
+	int m_teamID;
+	std::size_t m_maxGoals;
+};
+
+template<typename T>
+inline void INavMultiGoalSearch<T>::Execute()
+{
+	m_results.clear();
+
+	if (this->m_startArea == nullptr || m_goals.empty())
+	{
+		return;
+	}
+
+	const std::size_t maxGoals = m_maxGoals > 0U ? std::min(m_maxGoals, m_goals.size()) : m_goals.size();
+	m_openList.clear();
+	this->m_nodes.Prepare();
+
+	// nodes hold the best known cost, searched nodes have their final cost
+	auto& start = this->m_nodes.Get(this->m_startArea);
+	start.travelCost = this->operator()(this->m_startArea, nullptr, 0.0f, nullptr, nullptr, nullptr);
+	start.parent = nullptr;
+	m_openList.push_back({ start.travelCost, this->m_startArea });
+
+	while (!m_openList.empty())
+	{
+		std::pop_heap(m_openList.begin(), m_openList.end(), OpenAreaGreater);
+		OpenArea current = m_openList.back();
+		m_openList.pop_back();
+
+		T* area = current.area;
+		auto& node = *this->m_nodes.Find(area);
+
+		if (node.searched || current.cost > node.travelCost)
+		{
+			continue; // outdated entry
+		}
+
+		if (this->m_travelLimit > 0.0f && current.cost > this->m_travelLimit)
+		{
+			break; // every area left is farther
+		}
+
+		if (area->IsBlocked(m_teamID))
+		{
+			continue;
+		}
+
+		node.searched = true;
+
+		T* parent = node.parent;
+		this->operator()(area, parent, parent != nullptr ? this->m_nodes.Find(parent)->travelCost : 0.0f);
+
+		if (m_goals.find(area->GetID()) != m_goals.end())
+		{
+			m_results.push_back({ area, current.cost });
+
+			if (m_results.size() >= maxGoals)
+			{
+				break;
+			}
+		}
+
+		this->ForEachConnectedArea(area, [this, area, &current](T* other, const NavOffMeshConnection* link, const CNavLadder* ladder, const CNavElevator* elevator) {
+			if (this->AlreadySearched(other))
+			{
+				return;
+			}
+
+			const float cost = this->operator()(other, area, current.cost, link, ladder, elevator);
+
+			if (cost < current.cost)
+			{
+				return; // negative connection cost, can't be used
+			}
+
+			bool created = false;
+			auto& next = this->m_nodes.Get(other, &created);
+
+			if (created || cost < next.travelCost)
+			{
+				next.travelCost = cost;
+				next.parent = area;
+				m_openList.push_back({ cost, other });
+				std::push_heap(m_openList.begin(), m_openList.end(), OpenAreaGreater);
+			}
+		});
+	}
+}
+
+/**
+ * @brief A candidate of a nearest-of-N query, see NavSelectNearestCandidate.
+ */
+struct NavTravelCandidate
+{
+	CNavArea* area;		// nav area of the candidate, NULL if it isn't on the nav mesh
+	float distance;		// straight line distance
+	float preference;	// distance multiplier, lower values are preferred
+};
+
+// Candidates collected within a straight line range are searched up to this many times the range, to allow for detours
+static constexpr float NAV_CANDIDATE_DETOUR_LIMIT = 2.0f;
+
+/**
+ * @brief Selects the nearest candidate by travel distance, a single multi-goal search from the start area reaches all of them.
+ *
+ * Falls back to the straight line distance if the start area is NULL or none of the candidates are on the nav mesh.
+ * @param startArea Area to search from.
+ * @param teamID Areas blocked for this team are not searched.
+ * @param maxRange Straight line range the candidates were collected in. Candidates farther than NAV_CANDIDATE_DETOUR_LIMIT times this
+ * range by travel distance are unreachable.
+ * @param candidates Candidates to select from.
+ * @return Index of the selected candidate or -1 if none of them can be reached.
+ */
+inline int NavSelectNearestCandidate(CNavArea* startArea, int teamID, float maxRange, const std::vector<NavTravelCandidate>& candidates)
+{
+	INavMultiGoalSearch<CNavArea> search(startArea, maxRange * NAV_CANDIDATE_DETOUR_LIMIT);
+	search.SetTeam(teamID);
+
+	for (auto& candidate : candidates)
+	{
+		if (candidate.area != nullptr)
+		{
+			search.AddGoal(candidate.area);
+		}
+	}
+
+	const bool useTravelDistance = startArea != nullptr && search.GetGoalCount() > 0U;
+
+	if (useTravelDistance)
+	{
+		search.Execute();
+	}
+
+	int best = -1;
+	float smallest = std::numeric_limits<float>::max();
+
+	for (std::size_t i = 0; i < candidates.size(); i++)
+	{
+		const NavTravelCandidate& candidate = candidates[i];
+		float distance = candidate.distance;
+
+		if (useTravelDistance && (candidate.area == nullptr || !search.GetTravelCost(candidate.area, distance)))
+		{
+			continue; // unreachable or too far away
+		}
+
+		distance *= candidate.preference;
+
+		if (distance < smallest)
+		{
+			smallest = distance;
+			best = static_cast<int>(i);
+		}
+	}
+
+	return best;
 }
 
 #endif // _NAV_PATHFIND_H_
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <limits>
+
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_pathslicer.h"
+#include "nav_stats.h"
+
+#undef max
+#undef min
+#undef clamp
+
+extern ConVar sm_nav_edit;
+
+ConVar sm_nav_path_slice_budget("sm_nav_path_slice_budget", "3000", FCVAR_GAMEDLL, "Number of nav areas the time sliced path searches may expand per tick, shared by all bots. Zero runs the searches at once.", true, 0.0f, false, 0.0f);
+ConVar sm_nav_path_slice_max_searches("sm_nav_path_slice_max_searches", "8", FCVAR_GAMEDLL, "Maximum number of time sliced path searches running at the same time, the others wait in a queue.", true, 1.0f, true, 64.0f);
+
+// areas given to a search per turn when the budget is shared between many searches
+static constexpr int MIN_SLICE_EXPANSIONS = 32;
+
+CNavPathSlicer::CNavPathSlicer()
+{
+	m_numActive = 0U;
+	m_nextSlot = 0U;
+	ResetStats();
+}
+
+bool CNavPathSlicer::IsEnabled() const
+{
+	// areas may be deleted at any time while editing
+	return sm_nav_path_slice_budget.GetInt() > 0 && !sm_nav_edit.GetBool();
+}
+
+void CNavPathSlicer::Submit(std::shared_ptr<INavSlicedPathJob> job)
+{
+	m_queue.push_back(std::move(job));
+	m_stats.submitted++;
+}
+
+void CNavPathSlicer::Update()
+{
+	m_stats.lastExpansions = 0U;
+
+	for (Slot& slot : m_slots)
+	{
+		if (slot.job && slot.job->IsCancelled())
+		{
+			slot.job->m_done = true;
+			slot.job.reset();
+			m_numActive--;
+		}
+	}
+
+	StartQueuedJobs();
+
+	if (m_numActive == 0U)
+	{
+		return;
+	}
+
+	// when disabled, finish the searches still running at once
+	int budget = IsEnabled() ? sm_nav_path_slice_budget.GetInt() : std::numeric_limits<int>::max();
+
+	while (budget > 0 && m_numActive > 0U)
+	{
+		const int share = std::max(budget / static_cast<int>(m_numActive), MIN_SLICE_EXPANSIONS);
+
+		for (std::size_t i = 0U; i < m_slots.size() && budget > 0; i++)
+		{
+			Slot& slot = m_slots[(m_nextSlot + i) % m_slots.size()];
+
+			if (!slot.job)
+			{
+				continue;
+			}
+
+			int expansions = 0;
+			const bool done = slot.job->Step(*slot.context, std::min(share, budget), expansions);
+
+			m_stats.lastExpansions += static_cast<unsigned int>(expansions);
+			// a step always expands an area or finishes, the minimum only guards against a job that does neither
+			budget -= std::max(expansions, 1);
+
+			if (done)
+			{
+				FinishJob(slot);
+			}
+		}
+
+		// searches submitted by the finished jobs may use what's left of the budget
+		StartQueuedJobs();
+	}
+
+	if (!m_slots.empty())
+	{
+		m_nextSlot = (m_nextSlot + 1U) % m_slots.size();
+	}
+
+	if (m_numActive > 0U)
+	{
+		m_stats.budgetExhausted++;
+
+		for (Slot& slot : m_slots)
+		{
+			if (slot.job)
+			{
+				slot.ticks++;
+			}
+		}
+	}
+}
+
+void CNavPathSlicer::DiscardAll()
+{
+	for (auto& job : m_queue)
+	{
+		job->m_done = true;
+	}
+
+	m_queue.clear();
+
+	for (Slot& slot : m_slots)
+	{
+		if (slot.job)
+		{
+			slot.job->m_done = true;
+			slot.job.reset();
+		}
+	}
+
+	m_numActive = 0U;
+}
+
+void CNavPathSlicer::ResetStats()
+{
+	m_stats.submitted = 0U;
+	m_stats.finished = 0U;
+	m_stats.budgetExhausted = 0U;
+	m_stats.maxTicks = 0U;
+	m_stats.lastExpansions = 0U;
+}
+
+void CNavPathSlicer::StartQueuedJobs()
+{
+	const std::size_t maxSearches = static_cast<std::size_t>(sm_nav_path_slice_max_searches.GetInt());
+
+	if (m_slots.size() < maxSearches)
+	{
+		m_slots.resize(maxSearches);
+	}
+
+	for (std::size_t i = 0U; i < maxSearches && !m_queue.empty(); i++)
+	{
+		Slot& slot = m_slots[i];
+
+		if (slot.job)
+		{
+			continue;
+		}
+
+		// skip the jobs cancelled while waiting
+		while (!m_queue.empty() && m_queue.front()->IsCancelled())
+		{
+			m_queue.front()->m_done = true;
+			m_queue.pop_front();
+		}
+
+		if (m_queue.empty())
+		{
+			break;
+		}
+
+		if (!slot.context)
+		{
+			slot.context = std::make_unique<NavSearchContext>();
+		}
+
+		slot.job = std::move(m_queue.front());
+		slot.ticks = 0U;
+		m_queue.pop_front();
+		m_numActive++;
+	}
+}
+
+void CNavPathSlicer::FinishJob(Slot& slot)
+{
+	// Finish may submit new jobs
+	std::shared_ptr<INavSlicedPathJob> job = std::move(slot.job);
+	slot.job.reset();
+	m_numActive--;
+
+	m_stats.finished++;
+	m_stats.maxTicks = std::max(m_stats.maxTicks, slot.ticks + 1U);
+
+	job->m_done = true;
+
+	if (!job->IsCancelled())
+	{
+		job->Finish();
+	}
+}
+
+NAV_STATS_COMMAND(sm_nav_path_slice_stats, "time sliced path search")
+{
+	CNavPathSlicer* slicer = TheNavMesh->GetPathSlicer();
+	char details[64];
+	ke::SafeSprintf(details, sizeof(details), ", budget %i areas per tick", sm_nav_path_slice_budget.GetInt());
+
+	if (!navutils::BeginStatsCommand(args, "Time sliced path search", slicer, details))
+	{
+		return;
+	}
+
+	const CNavPathSlicer::Stats& stats = slicer->GetStats();
+
+	Msg("  Running: %i  Queued: %i\n", static_cast<int>(slicer->GetActiveCount()), static_cast<int>(slicer->GetQueueSize()));
+	Msg("  Submitted: %u  Finished: %u  Longest search: %u ticks\n", stats.submitted, stats.finished, stats.maxTicks);
+	Msg("  Ticks over budget: %u  Areas expanded last tick: %u\n", stats.budgetExhausted, stats.lastExpansions);
+}
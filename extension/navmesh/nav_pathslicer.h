@@ -0,0 +1,114 @@
+#ifndef NAV_PATH_SLICER_H_
+#define NAV_PATH_SLICER_H_
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "nav_search_context.h"
+
+/**
+ * @brief A nav mesh search that can be run a few areas at a time, see CNavPathSlicer.
+ *
+ * Step and Finish are called on the game thread, Finish once Step returned true.
+ */
+class INavSlicedPathJob
+{
+public:
+	INavSlicedPathJob()
+	{
+		m_cancelled = false;
+		m_done = false;
+	}
+
+	virtual ~INavSlicedPathJob() {}
+
+	INavSlicedPathJob(const INavSlicedPathJob&) = delete;
+	INavSlicedPathJob& operator=(const INavSlicedPathJob&) = delete;
+
+	/**
+	 * @brief Continues the search, called from the game thread.
+	 * @param context Search context, the same context is given to every call until the search is done.
+	 * @param maxExpansions Maximum number of areas to expand, always positive.
+	 * @param expansions Set to the number of areas expanded by this call.
+	 * @return true once the search is done.
+	 */
+	virtual bool Step(NavSearchContext& context, int maxExpansions, int& expansions) = 0;
+	// Delivers the search results
+	virtual void Finish() = 0;
+
+	// Cancels the job, Finish won't be called
+	void Cancel() { m_cancelled = true; }
+	bool IsCancelled() const { return m_cancelled; }
+	// true if the job was finished or discarded
+	bool IsDone() const { return m_done; }
+
+private:
+	friend class CNavPathSlicer;
+
+	bool m_cancelled;
+	bool m_done;
+};
+
+/**
+ * @brief Runs path searches on the game thread with a shared per tick budget.
+ *
+ * Every tick, the running searches are stepped in turns until the budget (number of areas expanded) runs out. A search that doesn't
+ * finish continues on the next tick, the bot keeps its previous path until then. This caps the cost of path finding per tick no
+ * matter how many bots repath at the same time.
+ * Each running search needs a search context, searches beyond sm_nav_path_slice_max_searches wait in a queue.
+ */
+class CNavPathSlicer
+{
+public:
+	struct Stats
+	{
+		unsigned int submitted;
+		unsigned int finished;
+		unsigned int budgetExhausted;		// ticks that ended with searches still running
+		unsigned int maxTicks;				// longest search, in ticks
+		unsigned int lastExpansions;		// areas expanded on the last tick
+	};
+
+	CNavPathSlicer();
+
+	CNavPathSlicer(const CNavPathSlicer&) = delete;
+	CNavPathSlicer& operator=(const CNavPathSlicer&) = delete;
+
+	// true if searches may be time sliced, otherwise they should be run at once
+	bool IsEnabled() const;
+
+	// Queues a search, it starts on the next update. Game thread only.
+	void Submit(std::shared_ptr<INavSlicedPathJob> job);
+	// Steps the searches up to the per tick budget and finishes the ones that are done. Game thread only.
+	void Update();
+	// Discards all searches without finishing them. Called before the mesh changes or is destroyed.
+	void DiscardAll();
+
+	bool HasPendingJobs() const { return !m_queue.empty() || m_numActive > 0; }
+	std::size_t GetQueueSize() const { return m_queue.size(); }
+	std::size_t GetActiveCount() const { return m_numActive; }
+
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats();
+
+private:
+	struct Slot
+	{
+		std::unique_ptr<NavSearchContext> context;
+		std::shared_ptr<INavSlicedPathJob> job;
+		unsigned int ticks;				// number of ticks the search has been running
+	};
+
+	std::vector<Slot> m_slots;
+	std::deque<std::shared_ptr<INavSlicedPathJob>> m_queue;	// jobs waiting for a slot
+	std::size_t m_numActive;
+	std::size_t m_nextSlot;										// slot stepped first on the next tick, keeps the budget fair
+	Stats m_stats;
+
+	// Moves queued jobs to the free slots
+	void StartQueuedJobs();
+	void FinishJob(Slot& slot);
+};
+
+#endif // !NAV_PATH_SLICER_H_
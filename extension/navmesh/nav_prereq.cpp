@@ -43,7 +43,7 @@ const char* CNavPrerequisite::TaskIDtoString(PrerequisiteTask task)
 	return names[static_cast<std::size_t>(task)].data();
 }
 
-void CNavPrerequisite::Save(std::fstream& filestream, uint32_t version)
+void CNavPrerequisite::Save(std::ostream& filestream, uint32_t version)
 {
 	m_goalEntity.Save(filestream, version);
 	m_toggle_condition.Save(filestream, version);
@@ -57,20 +57,20 @@ void CNavPrerequisite::Save(std::fstream& filestream, uint32_t version)
 	filestream.write(reinterpret_cast<char*>(&m_teamIndex), sizeof(int));
 }
 
-NavErrorType CNavPrerequisite::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+NavErrorType CNavPrerequisite::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	m_goalEntity.Load(filestream, version);
-	m_toggle_condition.Load(filestream, version);
-	filestream.read(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
-	filestream.read(reinterpret_cast<char*>(&m_origin), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_mins), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_maxs), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_task), sizeof(PrerequisiteTask));
-	filestream.read(reinterpret_cast<char*>(&m_goalPosition), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_flData), sizeof(float));
-	filestream.read(reinterpret_cast<char*>(&m_teamIndex), sizeof(int));
-
-	if (!filestream.good())
+	m_goalEntity.Load(reader, version);
+	m_toggle_condition.Load(reader, version);
+	reader.Read(m_id);
+	reader.Read(m_origin);
+	reader.Read(m_mins);
+	reader.Read(m_maxs);
+	reader.Read(m_task);
+	reader.Read(m_goalPosition);
+	reader.Read(m_flData);
+	reader.Read(m_teamIndex);
+
+	if (!reader.IsGood())
 	{
 		return NAV_CORRUPT_DATA;
 	}
@@ -84,7 +84,19 @@ NavErrorType CNavPrerequisite::PostLoad(void)
 	m_toggle_condition.PostLoad();
 	m_calculatedMins = (m_origin + m_mins);
 	m_calculatedMaxs = (m_origin + m_maxs);
-	SearchForNavAreas();
+
+	// the areas are already known when restored from the load cache
+	if (m_areas.empty())
+	{
+		SearchForNavAreas();
+	}
+	else
+	{
+		for (auto area : m_areas)
+		{
+			area->SetPrerequisite(this);
+		}
+	}
 
 	return NAV_OK;
 }
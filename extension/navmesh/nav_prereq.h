@@ -31,8 +31,8 @@ public:
 	static inline unsigned int s_nextID{ 0 };
 	static constexpr auto MAX_EDIT_DRAW_DISTANCE = 1024.0f;
 
-	virtual void Save(std::fstream& filestream, uint32_t version);
-	virtual NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);
+	virtual void Save(std::ostream& filestream, uint32_t version);
+	virtual NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);
 	virtual NavErrorType PostLoad(void);
 	virtual void OnRoundRestart();
 	virtual bool IsEnabled() const { return m_toggle_condition.RunTestCondition(); }
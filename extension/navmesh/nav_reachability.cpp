@@ -0,0 +1,329 @@
+#include <algorithm>
+
+#include <extension.h>
+#include "nav_mesh.h"
+#include "nav_area.h"
+#include "nav_connections.h"
+#include "nav_pathcache.h"
+#include "nav_reachability.h"
+#include "nav_stats.h"
+
+#undef max
+#undef min
+#undef clamp
+
+extern ConVar sm_nav_edit;
+
+ConVar sm_nav_reachability("sm_nav_reachability", "1", FCVAR_GAMEDLL, "Rejects unreachable goals with the nav mesh connected components before searching for a path.");
+
+CNavReachability::CNavReachability()
+{
+	ResetStats();
+}
+
+bool CNavReachability::IsEnabled() const
+{
+	// areas and connections may change at any time while editing
+	return sm_nav_reachability.GetBool() && !sm_nav_edit.GetBool() && TheNavMesh->GetConnectionGraph()->IsBuilt();
+}
+
+bool CNavReachability::MayReach(const CNavArea* from, const CNavArea* to, int teamID)
+{
+	if (!IsEnabled())
+	{
+		return true;
+	}
+
+	m_stats.queries++;
+
+	const CNavConnectionGraph* graph = TheNavMesh->GetConnectionGraph();
+	const Labels& labels = GetLabels(graph, teamID);
+	const std::size_t fromIndex = static_cast<std::size_t>(from->GetSearchIndex());
+	const std::size_t toIndex = static_cast<std::size_t>(to->GetSearchIndex());
+
+	if (fromIndex >= labels.component.size() || toIndex >= labels.component.size())
+	{
+		return true; // area created after the graph was built
+	}
+
+	bool reachable = false;
+
+	if (labels.component[fromIndex] == NO_COMPONENT)
+	{
+		// the cost functors only check the areas being entered, a blocked start area (elevator, door) can still be left through its connections
+		graph->ForEachOutgoingConnection(from, [&labels, &reachable, toIndex](const NavAreaConnection& connection) {
+			const std::size_t index = static_cast<std::size_t>(connection.to->GetSearchIndex());
+
+			if (!reachable && index < labels.component.size() && ComponentMayReach(labels, index, toIndex))
+			{
+				reachable = true;
+			}
+		});
+	}
+	else
+	{
+		reachable = ComponentMayReach(labels, fromIndex, toIndex);
+	}
+
+	if (!reachable)
+	{
+		m_stats.rejected++;
+	}
+
+	return reachable;
+}
+
+bool CNavReachability::ComponentMayReach(const Labels& labels, std::size_t fromIndex, std::size_t toIndex)
+{
+	const unsigned int fromComponent = labels.component[fromIndex];
+	const unsigned int toComponent = labels.component[toIndex];
+
+	// components are numbered in reverse topological order, a component can only reach components with a lower or equal number
+	return fromComponent != NO_COMPONENT && toComponent != NO_COMPONENT && toComponent <= fromComponent &&
+		labels.region[fromIndex] == labels.region[toIndex];
+}
+
+void CNavReachability::Invalidate()
+{
+	m_labels.clear();
+}
+
+void CNavReachability::ResetStats()
+{
+	m_stats.queries = 0U;
+	m_stats.rejected = 0U;
+	m_stats.builds = 0U;
+	m_stats.reused = 0U;
+}
+
+const CNavReachability::Labels& CNavReachability::GetLabels(const CNavConnectionGraph* graph, int teamID)
+{
+	// the path cache is invalidated every time the blocked state of an area changes
+	const unsigned int generation = TheNavMesh->GetPathCache()->GetGeneration();
+	auto it = m_labels.find(teamID);
+
+	const bool sameGraph = it != m_labels.end() && it->second.graphBuild == graph->GetBuildCount();
+
+	if (sameGraph && it->second.generation == generation)
+	{
+		return it->second;
+	}
+
+	// the generation also changes for things the labels don't care about (costs, other teams), only rebuild if this team's blocked areas changed
+	CollectBlocked(graph, teamID);
+
+	if (sameGraph && it->second.blocked == m_blocked)
+	{
+		it->second.generation = generation;
+		m_stats.reused++;
+		return it->second;
+	}
+
+	Labels& labels = m_labels[teamID];
+	labels.generation = generation;
+	labels.graphBuild = graph->GetBuildCount();
+	labels.blocked.swap(m_blocked);
+
+	BuildEdges(graph, teamID);
+	BuildComponents(labels);
+	BuildRegions(labels);
+
+	m_stats.builds++;
+	return labels;
+}
+
+void CNavReachability::CollectBlocked(const CNavConnectionGraph* graph, int teamID)
+{
+	const std::size_t numAreas = graph->GetAreaCount();
+	m_blocked.clear();
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		const CNavArea* area = TheNavAreas[it];
+
+		if (static_cast<std::size_t>(area->GetSearchIndex()) < numAreas && area->IsBlocked(teamID))
+		{
+			m_blocked.push_back(area->GetSearchIndex());
+		}
+	}
+
+	std::sort(m_blocked.begin(), m_blocked.end());
+}
+
+void CNavReachability::BuildEdges(const CNavConnectionGraph* graph, int teamID)
+{
+	const std::size_t numAreas = graph->GetAreaCount();
+	m_areas.assign(numAreas, nullptr);
+
+	FOR_EACH_VEC(TheNavAreas, it)
+	{
+		const CNavArea* area = TheNavAreas[it];
+		const std::size_t index = static_cast<std::size_t>(area->GetSearchIndex());
+
+		// blocked areas can't be entered or left, see CNavConnectionGraph::GetConnectionCost
+		if (index < numAreas && !area->IsBlocked(teamID))
+		{
+			m_areas[index] = area;
+		}
+	}
+
+	m_edgeStart.assign(numAreas + 1U, 0U);
+	m_edgeTarget.clear();
+
+	for (std::size_t index = 0U; index < numAreas; index++)
+	{
+		m_edgeStart[index] = static_cast<unsigned int>(m_edgeTarget.size());
+
+		if (m_areas[index] == nullptr)
+		{
+			continue;
+		}
+
+		graph->ForEachOutgoingConnection(m_areas[index], [this](const NavAreaConnection& connection) {
+			const unsigned int to = connection.to->GetSearchIndex();
+
+			if (m_areas[to] != nullptr)
+			{
+				m_edgeTarget.push_back(to);
+			}
+		});
+	}
+
+	m_edgeStart[numAreas] = static_cast<unsigned int>(m_edgeTarget.size());
+}
+
+void CNavReachability::BuildComponents(Labels& labels)
+{
+	constexpr unsigned int NOT_VISITED = NO_COMPONENT;
+	const unsigned int numAreas = static_cast<unsigned int>(m_edgeStart.size() - 1U);
+
+	labels.component.assign(numAreas, NO_COMPONENT);
+	m_order.assign(numAreas, NOT_VISITED);
+	m_lowLink.assign(numAreas, 0U);
+	m_stack.clear();
+	m_callStack.clear();
+
+	unsigned int nextOrder = 0U;
+	unsigned int nextComponent = 0U;
+
+	for (unsigned int root = 0U; root < numAreas; root++)
+	{
+		// blocked and unused search indexes don't get a component
+		if (m_areas[root] == nullptr || m_order[root] != NOT_VISITED)
+		{
+			continue;
+		}
+
+		m_order[root] = nextOrder;
+		m_lowLink[root] = nextOrder;
+		nextOrder++;
+		m_stack.push_back(root);
+		m_callStack.push_back({ root, m_edgeStart[root] });
+
+		while (!m_callStack.empty())
+		{
+			StackFrame& frame = m_callStack.back();
+			const unsigned int area = frame.area;
+
+			if (frame.edge < m_edgeStart[area + 1U])
+			{
+				const unsigned int next = m_edgeTarget[frame.edge++];
+
+				if (m_order[next] == NOT_VISITED)
+				{
+					m_order[next] = nextOrder;
+					m_lowLink[next] = nextOrder;
+					nextOrder++;
+					m_stack.push_back(next);
+					m_callStack.push_back({ next, m_edgeStart[next] });
+				}
+				else if (labels.component[next] == NO_COMPONENT)
+				{
+					// visited areas without a component are still on the stack
+					m_lowLink[area] = std::min(m_lowLink[area], m_order[next]);
+				}
+
+				continue;
+			}
+
+			if (m_lowLink[area] == m_order[area])
+			{
+				unsigned int member = 0U;
+
+				do
+				{
+					member = m_stack.back();
+					m_stack.pop_back();
+					labels.component[member] = nextComponent;
+				} while (member != area);
+
+				nextComponent++;
+			}
+
+			m_callStack.pop_back();
+
+			if (!m_callStack.empty())
+			{
+				const unsigned int parent = m_callStack.back().area;
+				m_lowLink[parent] = std::min(m_lowLink[parent], m_lowLink[area]);
+			}
+		}
+	}
+}
+
+void CNavReachability::BuildRegions(Labels& labels)
+{
+	const unsigned int numAreas = static_cast<unsigned int>(m_edgeStart.size() - 1U);
+	std::vector<unsigned int>& region = labels.region;
+
+	region.resize(numAreas);
+
+	for (unsigned int index = 0U; index < numAreas; index++)
+	{
+		region[index] = index;
+	}
+
+	for (unsigned int index = 0U; index < numAreas; index++)
+	{
+		for (unsigned int edge = m_edgeStart[index]; edge < m_edgeStart[index + 1U]; edge++)
+		{
+			const unsigned int lhs = FindRegion(region, index);
+			const unsigned int rhs = FindRegion(region, m_edgeTarget[edge]);
+
+			if (lhs != rhs)
+			{
+				region[std::max(lhs, rhs)] = std::min(lhs, rhs);
+			}
+		}
+	}
+
+	for (unsigned int index = 0U; index < numAreas; index++)
+	{
+		region[index] = FindRegion(region, index);
+	}
+}
+
+unsigned int CNavReachability::FindRegion(std::vector<unsigned int>& region, unsigned int index)
+{
+	while (region[index] != index)
+	{
+		region[index] = region[region[index]];
+		index = region[index];
+	}
+
+	return index;
+}
+
+NAV_STATS_COMMAND(sm_nav_reachability_stats, "nav mesh reachability")
+{
+	CNavReachability* reachability = TheNavMesh->GetReachability();
+
+	if (!navutils::BeginStatsCommand(args, "Reachability", reachability))
+	{
+		return;
+	}
+
+	const CNavReachability::Stats& stats = reachability->GetStats();
+
+	Msg("  Queries: %u  Rejected: %u  Label builds: %u  Labels reused: %u\n", stats.queries, stats.rejected, stats.builds, stats.reused);
+}
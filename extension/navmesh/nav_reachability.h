@@ -0,0 +1,103 @@
+#ifndef NAV_REACHABILITY_H_
+#define NAV_REACHABILITY_H_
+
+#include <cstddef>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+#include "nav.h"
+
+class CNavArea;
+class CNavConnectionGraph;
+
+/**
+ * @brief Per team connected component labels of the nav mesh, used to reject unreachable goals before searching.
+ *
+ * Each team has its own labels since areas may be blocked for a single team. Areas are labeled with their strongly connected
+ * component, numbered in reverse topological order, and their weakly connected component. An area can only reach areas of the
+ * same weak component whose strong component number is not greater than its own, this respects one-way drops.
+ *
+ * The labels only know about blocked areas, a path may still not exist for cost functors that reject connections. They're checked
+ * on the first query after the path cache generation changes (see CNavPathCache::GetGeneration) and only rebuilt if the areas
+ * blocked for the team changed, or when the connection graph is rebuilt. Game thread only.
+ */
+class CNavReachability
+{
+public:
+	CNavReachability();
+
+	CNavReachability(const CNavReachability&) = delete;
+	CNavReachability& operator=(const CNavReachability&) = delete;
+
+	struct Stats
+	{
+		unsigned int queries;
+		unsigned int rejected;
+		unsigned int builds;
+		unsigned int reused;					// generation changes that left the blocked areas of the team untouched
+	};
+
+	bool IsEnabled() const;
+
+	/**
+	 * @brief Checks if a path may exist between two areas.
+	 * @param from Start area.
+	 * @param to Goal area.
+	 * @param teamID Team used to check for blocked areas.
+	 * @return false if the goal area can't be reached from the start area. true if it may be reachable or the labels are not available.
+	 * A start area blocked for the team may still reach the areas its connections lead to.
+	 */
+	bool MayReach(const CNavArea* from, const CNavArea* to, int teamID);
+
+	// Removes the labels of every team, they're rebuilt on the next query
+	void Invalidate();
+
+	const Stats& GetStats() const { return m_stats; }
+	void ResetStats();
+
+private:
+	static constexpr unsigned int NO_COMPONENT = std::numeric_limits<unsigned int>::max();
+
+	struct Labels
+	{
+		std::vector<unsigned int> component;	// strongly connected component, indexed by area search index. NO_COMPONENT if blocked.
+		std::vector<unsigned int> region;		// weakly connected component, same layout
+		std::vector<unsigned int> blocked;		// search indexes of the areas blocked for the team, in ascending order
+		unsigned int generation;
+		unsigned int graphBuild;
+	};
+
+	// iterative Tarjan search state
+	struct StackFrame
+	{
+		unsigned int area;
+		unsigned int edge;						// next edge to visit
+	};
+
+	std::unordered_map<int, Labels> m_labels;
+	std::vector<const CNavArea*> m_areas;		// indexed by search index, NULL if blocked for the team being labeled or not in use
+	// connections between the areas not blocked for the team being labeled, in compressed row form
+	std::vector<unsigned int> m_edgeStart;
+	std::vector<unsigned int> m_edgeTarget;
+	// memory kept between builds
+	std::vector<unsigned int> m_order;
+	std::vector<unsigned int> m_lowLink;
+	std::vector<unsigned int> m_stack;
+	std::vector<StackFrame> m_callStack;
+	std::vector<unsigned int> m_blocked;
+	Stats m_stats;
+
+	// Gets the labels of a team, building them if needed
+	const Labels& GetLabels(const CNavConnectionGraph* graph, int teamID);
+	// Collects the search indexes of the areas blocked for the team into m_blocked
+	void CollectBlocked(const CNavConnectionGraph* graph, int teamID);
+	void BuildEdges(const CNavConnectionGraph* graph, int teamID);
+	void BuildComponents(Labels& labels);
+	void BuildRegions(Labels& labels);
+	// true if the components of the areas at the given search indexes allow a path between them
+	static bool ComponentMayReach(const Labels& labels, std::size_t fromIndex, std::size_t toIndex);
+	// Union find root of the region, with path halving
+	static unsigned int FindRegion(std::vector<unsigned int>& region, unsigned int index);
+};
+
+#endif // !NAV_REACHABILITY_H_
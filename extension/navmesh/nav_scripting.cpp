@@ -15,7 +15,7 @@
 #undef max
 #undef clamp
 
-void navscripting::EntityLink::Save(std::fstream& filestream, uint32_t version)
+void navscripting::EntityLink::Save(std::ostream& filestream, uint32_t version)
 {
 	bool hasentity = !m_classname.empty();
 	filestream.write(reinterpret_cast<char*>(&hasentity), sizeof(bool));
@@ -39,30 +39,26 @@ void navscripting::EntityLink::Save(std::fstream& filestream, uint32_t version)
 	}
 }
 
-void navscripting::EntityLink::Load(std::fstream& filestream, uint32_t version)
+void navscripting::EntityLink::Load(CNavFileReader& reader, uint32_t version)
 {
 	bool hasentity = false;
-	filestream.read(reinterpret_cast<char*>(&hasentity), sizeof(bool));
+	reader.Read(hasentity);
 
 	if (hasentity)
 	{
 		std::uint64_t strlength = 0;
-		filestream.read(reinterpret_cast<char*>(&strlength), sizeof(std::uint64_t));
-		std::unique_ptr<char[]> classname = std::make_unique<char[]>(strlength + 2U);
-		filestream.read(classname.get(), strlength);
-		filestream.read(reinterpret_cast<char*>(&m_position), sizeof(Vector));
-		m_classname.assign(classname.get());
+		reader.Read(strlength);
+		reader.ReadString(strlength, m_classname);
+		reader.Read(m_position);
 
 		bool hastargetname = false;
-		filestream.read(reinterpret_cast<char*>(&hastargetname), sizeof(bool));
+		reader.Read(hastargetname);
 
 		if (hastargetname)
 		{
 			strlength = 0;
-			filestream.read(reinterpret_cast<char*>(&strlength), sizeof(std::uint64_t));
-			std::unique_ptr<char[]> targetname = std::make_unique<char[]>(strlength + 2U);
-			filestream.read(targetname.get(), strlength);
-			m_targetname.assign(targetname.get());
+			reader.Read(strlength);
+			reader.ReadString(strlength, m_targetname);
 		}
 	}
 }
@@ -205,7 +201,7 @@ const char* navscripting::ToggleCondition::TCTypeToString(navscripting::ToggleCo
 	return names[static_cast<std::size_t>(type)].data();
 }
 
-void navscripting::ToggleCondition::Save(std::fstream& filestream, uint32_t version)
+void navscripting::ToggleCondition::Save(std::ostream& filestream, uint32_t version)
 {
 	m_targetEnt.Save(filestream, version);
 	filestream.write(reinterpret_cast<char*>(&m_toggle_type), sizeof(TCTypes));
@@ -215,14 +211,14 @@ void navscripting::ToggleCondition::Save(std::fstream& filestream, uint32_t vers
 	filestream.write(reinterpret_cast<char*>(&m_inverted), sizeof(bool));
 }
 
-void navscripting::ToggleCondition::Load(std::fstream& filestream, uint32_t version)
+void navscripting::ToggleCondition::Load(CNavFileReader& reader, uint32_t version)
 {
-	m_targetEnt.Load(filestream, version);
-	filestream.read(reinterpret_cast<char*>(&m_toggle_type), sizeof(TCTypes));
-	filestream.read(reinterpret_cast<char*>(&m_iData), sizeof(int));
-	filestream.read(reinterpret_cast<char*>(&m_flData), sizeof(float));
-	filestream.read(reinterpret_cast<char*>(&m_vecData), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_inverted), sizeof(bool));
+	m_targetEnt.Load(reader, version);
+	reader.Read(m_toggle_type);
+	reader.Read(m_iData);
+	reader.Read(m_flData);
+	reader.Read(m_vecData);
+	reader.Read(m_inverted);
 }
 
 void navscripting::ToggleCondition::PostLoad()
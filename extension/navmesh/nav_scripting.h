@@ -4,6 +4,7 @@
 #include <string>
 #include <fstream>
 #include <sdkports/sdk_ehandle.h>
+#include "nav_filereader.h"
 
 /**
  * @brief Namespace for navigation mesh scripting utils
@@ -27,8 +28,8 @@ namespace navscripting
 		{
 		}
 
-		void Save(std::fstream& filestream, uint32_t version);
-		void Load(std::fstream& filestream, uint32_t version);
+		void Save(std::ostream& filestream, uint32_t version);
+		void Load(CNavFileReader& reader, uint32_t version);
 		void PostLoad();
 		void OnRoundRestart()
 		{
@@ -107,8 +108,8 @@ namespace navscripting
 		{
 		}
 
-		void Save(std::fstream& filestream, uint32_t version);
-		void Load(std::fstream& filestream, uint32_t version);
+		void Save(std::ostream& filestream, uint32_t version);
+		void Load(CNavFileReader& reader, uint32_t version);
 		void PostLoad();
 		void OnRoundRestart()
 		{
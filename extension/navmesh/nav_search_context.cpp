@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <extension.h>
+#include "nav_area.h"
+#include "nav_search_context.h"
+
+#undef min
+#undef max
+#undef clamp
+
+static thread_local NavSearchContext* s_currentSearchContext = nullptr;
+
+NavSearchContext::NavSearchContext()
+{
+	m_openSequence = 0;
+	m_masterMarker = 1;
+	m_nearSearchMarker = 1;
+}
+
+NavSearchContext::Scope::Scope(NavSearchContext& context)
+{
+	m_previous = s_currentSearchContext;
+	s_currentSearchContext = &context;
+}
+
+NavSearchContext::Scope::~Scope()
+{
+	s_currentSearchContext = m_previous;
+}
+
+NavSearchContext* NavSearchContext::GetCurrent()
+{
+	if (s_currentSearchContext == nullptr)
+	{
+		static thread_local NavSearchContext s_defaultContext;
+		s_currentSearchContext = &s_defaultContext;
+	}
+
+	return s_currentSearchContext;
+}
+
+void NavSearchContext::Reserve(std::size_t count)
+{
+	if (count > m_nodes.size())
+	{
+		m_nodes.resize(count, Node{});
+	}
+
+	m_openList.reserve(count);
+}
+
+void NavSearchContext::Grow(unsigned int index)
+{
+	std::size_t count = std::max<std::size_t>(static_cast<std::size_t>(index) + 1U, static_cast<std::size_t>(CNavArea::GetSearchIndexCount()));
+	count = std::max<std::size_t>(count, m_nodes.size() * 2U);
+	m_nodes.resize(count, Node{});
+}
+
+void NavSearchContext::AddToOpenList(CNavArea* area)
+{
+	Node& node = GetNode(area);
+
+	if (node.openMarker == m_masterMarker)
+	{
+		// already on list
+		return;
+	}
+
+	// mark as being on open list for quick check
+	node.openMarker = m_masterMarker;
+	node.openSequence = m_openSequence++;
+
+	const unsigned int index = area->GetSearchIndex();
+	m_openList.push_back(index);
+	OpenListSet(m_openList.size() - 1, index);
+	OpenListSiftUp(m_openList.size() - 1);
+}
+
+void NavSearchContext::UpdateOnOpenList(const CNavArea* area)
+{
+	if (!IsOpen(area))
+	{
+		return;
+	}
+
+	// since value can only decrease, move this area towards the root of the heap
+	OpenListSiftUp(m_nodes[area->GetSearchIndex()].openIndex);
+}
+
+void NavSearchContext::RemoveFromOpenList(const CNavArea* area)
+{
+	if (!IsOpen(area))
+	{
+		// not on the list
+		return;
+	}
+
+	Node& node = m_nodes[area->GetSearchIndex()];
+	const std::size_t position = node.openIndex;
+	const unsigned int last = m_openList.back();
+	m_openList.pop_back();
+
+	if (last != area->GetSearchIndex())
+	{
+		// fill the hole with the last element and restore the heap order around it
+		OpenListSet(position, last);
+		OpenListSiftUp(position);
+		OpenListSiftDown(m_nodes[last].openIndex);
+	}
+
+	// zero is an invalid marker
+	node.openMarker = 0;
+}
+
+CNavArea* NavSearchContext::PopOpenList()
+{
+	if (m_openList.empty())
+	{
+		return nullptr;
+	}
+
+	Node& node = m_nodes[m_openList.front()];
+	const unsigned int last = m_openList.back();
+	m_openList.pop_back();
+
+	if (!m_openList.empty())
+	{
+		OpenListSet(0, last);
+		OpenListSiftDown(0);
+	}
+
+	// zero is an invalid marker
+	node.openMarker = 0;
+
+	return node.area;
+}
+
+void NavSearchContext::ClearSearchLists()
+{
+	// effectively clears all open list flags and closed flags
+	MakeNewMarker();
+
+	// keeps the allocated capacity for the next search
+	m_openList.clear();
+	m_openSequence = 0;
+}
+
+void NavSearchContext::OpenListSiftUp(std::size_t position)
+{
+	const unsigned int index = m_openList[position];
+
+	while (position > 0)
+	{
+		const std::size_t parent = (position - 1) / OPEN_LIST_HEAP_ARITY;
+		const unsigned int parentIndex = m_openList[parent];
+
+		if (!OpenListPriorityLess(index, parentIndex))
+		{
+			break;
+		}
+
+		OpenListSet(position, parentIndex);
+		position = parent;
+	}
+
+	OpenListSet(position, index);
+}
+
+void NavSearchContext::OpenListSiftDown(std::size_t position)
+{
+	const std::size_t count = m_openList.size();
+	const unsigned int index = m_openList[position];
+
+	for (;;)
+	{
+		const std::size_t firstChild = position * OPEN_LIST_HEAP_ARITY + 1;
+
+		if (firstChild >= count)
+		{
+			break;
+		}
+
+		const std::size_t lastChild = std::min(firstChild + OPEN_LIST_HEAP_ARITY, count);
+		std::size_t best = firstChild;
+
+		for (std::size_t child = firstChild + 1; child < lastChild; ++child)
+		{
+			if (OpenListPriorityLess(m_openList[child], m_openList[best]))
+			{
+				best = child;
+			}
+		}
+
+		if (!OpenListPriorityLess(m_openList[best], index))
+		{
+			break;
+		}
+
+		OpenListSet(position, m_openList[best]);
+		position = best;
+	}
+
+	OpenListSet(position, index);
+}
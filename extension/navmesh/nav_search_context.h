@@ -0,0 +1,219 @@
+#ifndef NAV_SEARCH_CONTEXT_H_
+#define NAV_SEARCH_CONTEXT_H_
+
+#include <cstddef>
+#include <vector>
+#include "nav_area.h"
+#include "nav_cluster.h"
+
+/**
+ * @brief Per query state for nav mesh searches.
+ *
+ * Search state (costs, parents, markers and the open list) is stored in a dense array indexed by the area's search index instead of
+ * inside the areas themselves. Each thread has a default context and searches may be given a context of their own, this allows
+ * searches to nest (ie: GetNearestNavArea inside a SearchSurroundingAreas functor) and to run concurrently on different threads.
+ *
+ * CNavArea's search accessors (GetParent, GetCostSoFar, IsMarked, ...) read from the calling thread's current context.
+ */
+class NavSearchContext
+{
+public:
+	NavSearchContext();
+
+	NavSearchContext(const NavSearchContext&) = delete;
+	NavSearchContext& operator=(const NavSearchContext&) = delete;
+
+	/**
+	 * @brief Makes the given context the current context of the calling thread until the scope ends.
+	 */
+	class Scope
+	{
+	public:
+		Scope(NavSearchContext& context);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		NavSearchContext* m_previous;
+	};
+
+	// Returns the current search context of the calling thread
+	static NavSearchContext* GetCurrent();
+
+	// Pre-allocates nodes for the given number of areas
+	void Reserve(std::size_t count);
+
+	//- markers -----------------------------------------------------------------------------------------
+	void MakeNewMarker()
+	{
+		++m_masterMarker;
+
+		if (m_masterMarker == 0)
+		{
+			m_masterMarker = 1;
+		}
+	}
+
+	void Mark(const CNavArea* area) { GetNode(area).marker = m_masterMarker; }
+	bool IsMarked(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr && node->marker == m_masterMarker;
+	}
+
+	// marker used by the nav mesh spatial queries (GetNearestNavArea, ForAllAreasOverlappingExtent, ...), independent from the search marker
+	void MakeNewNearSearchMarker()
+	{
+		++m_nearSearchMarker;
+
+		if (m_nearSearchMarker == 0)
+		{
+			m_nearSearchMarker = 1;
+		}
+	}
+
+	void NearSearchMark(const CNavArea* area) { GetNode(area).nearSearchMarker = m_nearSearchMarker; }
+	bool IsNearSearchMarked(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr && node->nearSearchMarker == m_nearSearchMarker;
+	}
+
+	//- search data -------------------------------------------------------------------------------------
+	void SetParent(const CNavArea* area, CNavArea* parent, NavTraverseType how = NUM_TRAVERSE_TYPES)
+	{
+		Node& node = GetNode(area);
+		node.parent = parent;
+		node.parentHow = how;
+	}
+
+	CNavArea* GetParent(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr ? node->parent : nullptr;
+	}
+
+	NavTraverseType GetParentHow(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr ? node->parentHow : GO_NORTH;
+	}
+
+	void SetTotalCost(const CNavArea* area, float value) { GetNode(area).totalCost = value; }
+	float GetTotalCost(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr ? node->totalCost : 0.0f;
+	}
+
+	void SetCostSoFar(const CNavArea* area, float value) { GetNode(area).costSoFar = value; }
+	float GetCostSoFar(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr ? node->costSoFar : 0.0f;
+	}
+
+	void SetPathLengthSoFar(const CNavArea* area, float value) { GetNode(area).pathLengthSoFar = value; }
+	float GetPathLengthSoFar(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr ? node->pathLengthSoFar : 0.0f;
+	}
+
+	//- open and closed lists ---------------------------------------------------------------------------
+	bool IsOpen(const CNavArea* area) const
+	{
+		const Node* node = FindNode(area);
+		return node != nullptr && node->openMarker == m_masterMarker;
+	}
+
+	bool IsClosed(const CNavArea* area) const { return IsMarked(area) && !IsOpen(area); }
+	void AddToClosedList(const CNavArea* area) { Mark(area); }
+	// since "closed" is defined as visited (marked) and not on open list, do nothing
+	void RemoveFromClosedList(const CNavArea* area) {}
+
+	void AddToOpenList(CNavArea* area);							// add to open list, ordered by total cost
+	void UpdateOnOpenList(const CNavArea* area);				// a smaller value has been found, update this area on the open list
+	void RemoveFromOpenList(const CNavArea* area);
+	bool IsOpenListEmpty() const { return m_openList.empty(); }
+	CNavArea* PopOpenList();									// remove and return the area with the lowest total cost
+
+	void ClearSearchLists();									// clears the open and closed lists for a new search
+
+	// clusters the current search is restricted to, see CNavClusterGraph
+	NavClusterCorridor& GetClusterCorridor() { return m_clusterCorridor; }
+
+private:
+	struct Node
+	{
+		CNavArea* area;
+		CNavArea* parent;											// the area just prior to this on in the search path
+		float totalCost;											// the distance so far plus an estimate of the distance left
+		float costSoFar;											// distance travelled so far
+		float pathLengthSoFar;										// length of path so far, needed for limiting pathfind max path length
+		unsigned int marker;										// used to flag the area as visited
+		unsigned int openMarker;									// if this equals the current marker value, we are on the open list
+		unsigned int openIndex;										// position in the open list heap, only valid while on the open list
+		unsigned int openSequence;									// insertion order, used to break ties between equal costs on the open list
+		unsigned int nearSearchMarker;								// used by the spatial queries
+		NavTraverseType parentHow;									// how we get from parent to us
+	};
+
+	static constexpr std::size_t OPEN_LIST_HEAP_ARITY = 4U;		// number of children per open list heap node
+
+	std::vector<Node> m_nodes;									// indexed by CNavArea::GetSearchIndex
+	std::vector<unsigned int> m_openList;						// indexed d-ary min heap of search indexes ordered by total cost
+	unsigned int m_openSequence;								// incremented each time an area is added to the open list
+	unsigned int m_masterMarker;
+	unsigned int m_nearSearchMarker;
+	NavClusterCorridor m_clusterCorridor;
+
+	Node& GetNode(const CNavArea* area)
+	{
+		const unsigned int index = area->GetSearchIndex();
+
+		if (index >= m_nodes.size())
+		{
+			Grow(index);
+		}
+
+		Node& node = m_nodes[index];
+		node.area = const_cast<CNavArea*>(area);
+		return node;
+	}
+
+	const Node* FindNode(const CNavArea* area) const
+	{
+		const unsigned int index = area->GetSearchIndex();
+		return index < m_nodes.size() ? &m_nodes[index] : nullptr;
+	}
+
+	void Grow(unsigned int index);
+
+	bool OpenListPriorityLess(unsigned int lhs, unsigned int rhs) const	// returns true if 'lhs' should be popped before 'rhs'
+	{
+		const Node& a = m_nodes[lhs];
+		const Node& b = m_nodes[rhs];
+
+		if (a.totalCost != b.totalCost)
+		{
+			return a.totalCost < b.totalCost;
+		}
+
+		// equal costs are popped in insertion order, this keeps breadth-first searches with a constant cost in order
+		return a.openSequence < b.openSequence;
+	}
+
+	void OpenListSet(std::size_t position, unsigned int index)
+	{
+		m_openList[position] = index;
+		m_nodes[index].openIndex = static_cast<unsigned int>(position);
+	}
+
+	void OpenListSiftUp(std::size_t position);
+	void OpenListSiftDown(std::size_t position);
+};
+
+#endif // !NAV_SEARCH_CONTEXT_H_
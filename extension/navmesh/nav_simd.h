@@ -0,0 +1,276 @@
+#ifndef NAV_SIMD_H_
+#define NAV_SIMD_H_
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "nav.h"
+
+// The kernels are picked at compile time from the instruction set of the build (see the arch options of the build scripts),
+// builds without SSE use the scalar loops.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NAV_SIMD_AVX2
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define NAV_SIMD_SSE
+#endif
+
+namespace navsimd
+{
+	// number of areas tested by each kernel call, blocks are padded to a multiple of it
+	static constexpr std::size_t BATCH_SIZE = 8U;
+
+	// name of the kernels compiled in
+	inline const char* GetKernelName()
+	{
+#if defined(NAV_SIMD_AVX2)
+		return "AVX2";
+#elif defined(NAV_SIMD_SSE)
+		return "SSE";
+#else
+		return "scalar";
+#endif
+	}
+
+	/**
+	 * @brief Area bounds stored as structure of arrays, one array per component.
+	 *
+	 * Padding entries have inverted bounds and never pass any of the tests.
+	 */
+	struct BoundsBlock
+	{
+		std::vector<float> loX;
+		std::vector<float> loY;
+		std::vector<float> loZ;
+		std::vector<float> hiX;
+		std::vector<float> hiY;
+		std::vector<float> hiZ;
+		std::vector<float> centerZ;
+
+		std::size_t Size() const { return loX.size(); }
+
+		void Clear()
+		{
+			loX.clear();
+			loY.clear();
+			loZ.clear();
+			hiX.clear();
+			hiY.clear();
+			hiZ.clear();
+			centerZ.clear();
+		}
+
+		void Push(const Extent& extent, float center)
+		{
+			loX.push_back(extent.lo.x);
+			loY.push_back(extent.lo.y);
+			loZ.push_back(extent.lo.z);
+			hiX.push_back(extent.hi.x);
+			hiY.push_back(extent.hi.y);
+			hiZ.push_back(extent.hi.z);
+			centerZ.push_back(center);
+		}
+
+		// Pads the block to the next batch boundary
+		void Pad()
+		{
+			constexpr float inf = std::numeric_limits<float>::infinity();
+
+			while (Size() % BATCH_SIZE != 0U)
+			{
+				loX.push_back(inf);
+				loY.push_back(inf);
+				loZ.push_back(inf);
+				hiX.push_back(-inf);
+				hiY.push_back(-inf);
+				hiZ.push_back(-inf);
+				centerZ.push_back(inf);
+			}
+		}
+	};
+
+	/**
+	 * @brief Tests a batch of areas for a point inside their 2D bounds (see CNavArea::IsOverlapping) and a height range overlapping
+	 * their bounds.
+	 * @param block Area bounds.
+	 * @param first First entry of the batch, multiple of BATCH_SIZE.
+	 * @param pos Position.
+	 * @param minZ Lowest height of the range.
+	 * @param maxZ Highest height of the range.
+	 * @return Bit mask of the areas that pass, bit 0 is the first entry.
+	 */
+	inline unsigned int PointOverlapMask(const BoundsBlock& block, std::size_t first, const Vector& pos, float minZ, float maxZ)
+	{
+#if defined(NAV_SIMD_AVX2)
+		const __m256 x = _mm256_set1_ps(pos.x);
+		const __m256 y = _mm256_set1_ps(pos.y);
+		__m256 pass = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&block.loX[first]), x, _CMP_LE_OQ), _mm256_cmp_ps(x, _mm256_loadu_ps(&block.hiX[first]), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_loadu_ps(&block.loY[first]), y, _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(y, _mm256_loadu_ps(&block.hiY[first]), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_loadu_ps(&block.loZ[first]), _mm256_set1_ps(maxZ), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_set1_ps(minZ), _mm256_loadu_ps(&block.hiZ[first]), _CMP_LE_OQ));
+		return static_cast<unsigned int>(_mm256_movemask_ps(pass));
+#elif defined(NAV_SIMD_SSE)
+		const __m128 x = _mm_set1_ps(pos.x);
+		const __m128 y = _mm_set1_ps(pos.y);
+		const __m128 lowest = _mm_set1_ps(minZ);
+		const __m128 highest = _mm_set1_ps(maxZ);
+		unsigned int mask = 0U;
+
+		for (std::size_t half = 0U; half < BATCH_SIZE; half += 4U)
+		{
+			const std::size_t i = first + half;
+			__m128 pass = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&block.loX[i]), x), _mm_cmple_ps(x, _mm_loadu_ps(&block.hiX[i])));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_loadu_ps(&block.loY[i]), y));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(y, _mm_loadu_ps(&block.hiY[i])));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_loadu_ps(&block.loZ[i]), highest));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(lowest, _mm_loadu_ps(&block.hiZ[i])));
+			mask |= static_cast<unsigned int>(_mm_movemask_ps(pass)) << half;
+		}
+
+		return mask;
+#else
+		unsigned int mask = 0U;
+
+		for (std::size_t lane = 0U; lane < BATCH_SIZE; lane++)
+		{
+			const std::size_t i = first + lane;
+
+			if (block.loX[i] <= pos.x && pos.x <= block.hiX[i] && block.loY[i] <= pos.y && pos.y <= block.hiY[i] &&
+				block.loZ[i] <= maxZ && minZ <= block.hiZ[i])
+			{
+				mask |= 1U << lane;
+			}
+		}
+
+		return mask;
+#endif
+	}
+
+	/**
+	 * @brief Tests a batch of areas for bounds overlapping the given extent (see Extent::IsOverlapping).
+	 * @param block Area bounds.
+	 * @param first First entry of the batch, multiple of BATCH_SIZE.
+	 * @param extent Extent to test.
+	 * @return Bit mask of the areas that overlap, bit 0 is the first entry.
+	 */
+	inline unsigned int ExtentOverlapMask(const BoundsBlock& block, std::size_t first, const Extent& extent)
+	{
+#if defined(NAV_SIMD_AVX2)
+		__m256 pass = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(&block.loX[first]), _mm256_set1_ps(extent.hi.x), _CMP_LE_OQ), _mm256_cmp_ps(_mm256_set1_ps(extent.lo.x), _mm256_loadu_ps(&block.hiX[first]), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_loadu_ps(&block.loY[first]), _mm256_set1_ps(extent.hi.y), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_set1_ps(extent.lo.y), _mm256_loadu_ps(&block.hiY[first]), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_loadu_ps(&block.loZ[first]), _mm256_set1_ps(extent.hi.z), _CMP_LE_OQ));
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_set1_ps(extent.lo.z), _mm256_loadu_ps(&block.hiZ[first]), _CMP_LE_OQ));
+		return static_cast<unsigned int>(_mm256_movemask_ps(pass));
+#elif defined(NAV_SIMD_SSE)
+		unsigned int mask = 0U;
+
+		for (std::size_t half = 0U; half < BATCH_SIZE; half += 4U)
+		{
+			const std::size_t i = first + half;
+			__m128 pass = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&block.loX[i]), _mm_set1_ps(extent.hi.x)), _mm_cmple_ps(_mm_set1_ps(extent.lo.x), _mm_loadu_ps(&block.hiX[i])));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_loadu_ps(&block.loY[i]), _mm_set1_ps(extent.hi.y)));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_set1_ps(extent.lo.y), _mm_loadu_ps(&block.hiY[i])));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_loadu_ps(&block.loZ[i]), _mm_set1_ps(extent.hi.z)));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_set1_ps(extent.lo.z), _mm_loadu_ps(&block.hiZ[i])));
+			mask |= static_cast<unsigned int>(_mm_movemask_ps(pass)) << half;
+		}
+
+		return mask;
+#else
+		unsigned int mask = 0U;
+
+		for (std::size_t lane = 0U; lane < BATCH_SIZE; lane++)
+		{
+			const std::size_t i = first + lane;
+
+			if (block.loX[i] <= extent.hi.x && extent.lo.x <= block.hiX[i] && block.loY[i] <= extent.hi.y && extent.lo.y <= block.hiY[i] &&
+				block.loZ[i] <= extent.hi.z && extent.lo.z <= block.hiZ[i])
+			{
+				mask |= 1U << lane;
+			}
+		}
+
+		return mask;
+#endif
+	}
+
+	/**
+	 * @brief Tests a batch of areas for a closest point (see CNavArea::GetClosestPointOnArea) that may be nearer than the given distance.
+	 *
+	 * The distance is measured to the bounds, with the height widened by zTolerance, so it never exceeds the distance to the closest point.
+	 * @param block Area bounds.
+	 * @param first First entry of the batch, multiple of BATCH_SIZE.
+	 * @param pos Position.
+	 * @param zTolerance Height added above and below the bounds.
+	 * @param maxDistSq Areas at this squared distance or farther fail.
+	 * @param maxCenterAbove Areas with a center higher than this above the position fail.
+	 * @return Bit mask of the areas that pass, bit 0 is the first entry.
+	 */
+	inline unsigned int NearMask(const BoundsBlock& block, std::size_t first, const Vector& pos, float zTolerance, float maxDistSq, float maxCenterAbove)
+	{
+#if defined(NAV_SIMD_AVX2)
+		const __m256 x = _mm256_set1_ps(pos.x);
+		const __m256 y = _mm256_set1_ps(pos.y);
+		const __m256 z = _mm256_set1_ps(pos.z);
+		const __m256 tolerance = _mm256_set1_ps(zTolerance);
+		const __m256 dx = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(x, _mm256_loadu_ps(&block.loX[first])), _mm256_loadu_ps(&block.hiX[first])), x);
+		const __m256 dy = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(y, _mm256_loadu_ps(&block.loY[first])), _mm256_loadu_ps(&block.hiY[first])), y);
+		const __m256 lowest = _mm256_sub_ps(_mm256_loadu_ps(&block.loZ[first]), tolerance);
+		const __m256 highest = _mm256_add_ps(_mm256_loadu_ps(&block.hiZ[first]), tolerance);
+		const __m256 dz = _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(z, lowest), highest), z);
+		const __m256 distSq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+		__m256 pass = _mm256_cmp_ps(distSq, _mm256_set1_ps(maxDistSq), _CMP_LT_OQ);
+		pass = _mm256_and_ps(pass, _mm256_cmp_ps(_mm256_sub_ps(_mm256_loadu_ps(&block.centerZ[first]), z), _mm256_set1_ps(maxCenterAbove), _CMP_LE_OQ));
+		return static_cast<unsigned int>(_mm256_movemask_ps(pass));
+#elif defined(NAV_SIMD_SSE)
+		const __m128 x = _mm_set1_ps(pos.x);
+		const __m128 y = _mm_set1_ps(pos.y);
+		const __m128 z = _mm_set1_ps(pos.z);
+		const __m128 tolerance = _mm_set1_ps(zTolerance);
+		unsigned int mask = 0U;
+
+		for (std::size_t half = 0U; half < BATCH_SIZE; half += 4U)
+		{
+			const std::size_t i = first + half;
+			const __m128 dx = _mm_sub_ps(_mm_min_ps(_mm_max_ps(x, _mm_loadu_ps(&block.loX[i])), _mm_loadu_ps(&block.hiX[i])), x);
+			const __m128 dy = _mm_sub_ps(_mm_min_ps(_mm_max_ps(y, _mm_loadu_ps(&block.loY[i])), _mm_loadu_ps(&block.hiY[i])), y);
+			const __m128 lowest = _mm_sub_ps(_mm_loadu_ps(&block.loZ[i]), tolerance);
+			const __m128 highest = _mm_add_ps(_mm_loadu_ps(&block.hiZ[i]), tolerance);
+			const __m128 dz = _mm_sub_ps(_mm_min_ps(_mm_max_ps(z, lowest), highest), z);
+			const __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+			__m128 pass = _mm_cmplt_ps(distSq, _mm_set1_ps(maxDistSq));
+			pass = _mm_and_ps(pass, _mm_cmple_ps(_mm_sub_ps(_mm_loadu_ps(&block.centerZ[i]), z), _mm_set1_ps(maxCenterAbove)));
+			mask |= static_cast<unsigned int>(_mm_movemask_ps(pass)) << half;
+		}
+
+		return mask;
+#else
+		unsigned int mask = 0U;
+
+		for (std::size_t lane = 0U; lane < BATCH_SIZE; lane++)
+		{
+			const std::size_t i = first + lane;
+			const float px = pos.x < block.loX[i] ? block.loX[i] : pos.x;
+			const float py = pos.y < block.loY[i] ? block.loY[i] : pos.y;
+			const float lowest = block.loZ[i] - zTolerance;
+			const float highest = block.hiZ[i] + zTolerance;
+			const float pz = pos.z < lowest ? lowest : pos.z;
+			const float dx = (px > block.hiX[i] ? block.hiX[i] : px) - pos.x;
+			const float dy = (py > block.hiY[i] ? block.hiY[i] : py) - pos.y;
+			const float dz = (pz > highest ? highest : pz) - pos.z;
+
+			if (dx * dx + dy * dy + dz * dz < maxDistSq && block.centerZ[i] - pos.z <= maxCenterAbove)
+			{
+				mask |= 1U << lane;
+			}
+		}
+
+		return mask;
+#endif
+	}
+}
+
+#endif // !NAV_SIMD_H_
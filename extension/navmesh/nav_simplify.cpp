@@ -91,7 +91,7 @@ static bool ReduceToComponentAreas( CNavArea *area, bool addToSelectedSet )
 //--------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_chop_selected, "Chops all selected areas into their component 1x1 areas", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() || engine->IsDedicatedServer() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() || engine->IsDedicatedServer() )
 		return;
 
 	TheNavMesh->StripNavigationAreas();
@@ -267,7 +267,7 @@ void CNavMesh::SimplifySelectedAreas( void )
 //--------------------------------------------------------------------------------------------------------
 CON_COMMAND_F(sm_nav_simplify_selected, "Chops all selected areas into their component 1x1 areas and re-merges them together into larger areas", FCVAR_CHEAT )
 {
-	if ( !UTIL_IsCommandIssuedByServerAdmin() || engine->IsDedicatedServer() )
+	if ( !UTIL_IsCommandIssuedByServerAdmin() || UTIL_WarnIfNavMeshIsLoading() || engine->IsDedicatedServer() )
 		return;
 
 	int selectedSetSize = TheNavMesh->GetSelecteSetSize();
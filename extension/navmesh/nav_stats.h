@@ -0,0 +1,36 @@
+#ifndef NAVMESH_STATS_H_
+#define NAVMESH_STATS_H_
+
+#include <convar.h>
+#include <tier1/strtools.h>
+
+// Declares a sm_nav_*_stats console command, 'what' is the statistics name used in the help text
+#define NAV_STATS_COMMAND(name, what) CON_COMMAND_F(name, "Prints the " what " statistics. Pass 'reset' to clear the counters.", FCVAR_GAMEDLL)
+
+namespace navutils
+{
+	/**
+	 * @brief Shared part of the statistics commands: clears the counters when 'reset' is passed, otherwise prints the state line.
+	 * @tparam T Type with IsEnabled and ResetStats.
+	 * @param args Command arguments.
+	 * @param title Name printed in front of the messages.
+	 * @param stats Object owning the statistics.
+	 * @param details Text appended to the state line.
+	 * @return true if the caller should print the counters, false if they were cleared.
+	 */
+	template <typename T>
+	bool BeginStatsCommand(const CCommand& args, const char* title, T* stats, const char* details = "")
+	{
+		if (args.ArgC() >= 2 && V_stricmp(args[1], "reset") == 0)
+		{
+			stats->ResetStats();
+			Msg("%s statistics cleared.\n", title);
+			return false;
+		}
+
+		Msg("%s: %s%s\n", title, stats->IsEnabled() ? "enabled" : "disabled", details);
+		return true;
+	}
+}
+
+#endif // !NAVMESH_STATS_H_
@@ -3,6 +3,9 @@
 
 #include <util/librandom.h>
 #include "nav_area.h"
+#include "nav_ladder.h"
+#include "nav_elevator.h"
+#include "nav_connections.h"
 
 extern NavAreaVector TheNavAreas;
 
@@ -30,6 +33,119 @@ namespace navutils
 			}
 		}
 	}
+
+	/**
+	 * @brief Runs a function on each outgoing connection of an area, including ladders, elevators and off-mesh links.
+	 * Connections are visited in the same order as the A* search in NavAreaBuildPath.
+	 * @tparam F void (const NavAreaConnection& connection)
+	 */
+	template <typename F>
+	void ForEachOutgoingAreaConnection(const CNavArea* area, F functor)
+	{
+		NavAreaConnection connection;
+		connection.from = const_cast<CNavArea*>(area);
+
+		for (int dir = 0; dir < static_cast<int>(NUM_DIRECTIONS); dir++)
+		{
+			const NavConnectVector* floorList = area->GetAdjacentAreas(static_cast<NavDirType>(dir));
+
+			for (int i = 0; i < floorList->Count(); i++)
+			{
+				const NavConnect& connect = floorList->Element(i);
+				connection.to = connect.area;
+				connection.ladder = nullptr;
+				connection.link = nullptr;
+				connection.elevator = nullptr;
+				connection.length = connect.length;
+				connection.how = static_cast<NavTraverseType>(dir);
+				functor(connection);
+			}
+		}
+
+		for (int ladderDir = 0; ladderDir < static_cast<int>(CNavLadder::NUM_LADDER_DIRECTIONS); ladderDir++)
+		{
+			const NavLadderConnectVector* ladderList = area->GetLadders(static_cast<CNavLadder::LadderDirectionType>(ladderDir));
+
+			for (int i = 0; i < ladderList->Count(); i++)
+			{
+				const CNavLadder* ladder = ladderList->Element(i).ladder;
+
+				for (auto& ladderConnection : ladder->GetConnections())
+				{
+					bool usable = ladderDir == CNavLadder::LADDER_UP ? ladderConnection.IsConnectedToLadderTop() : ladderConnection.IsConnectedToLadderBottom();
+
+					if (usable && ladderConnection.GetConnectedArea() != nullptr)
+					{
+						connection.to = ladderConnection.GetConnectedArea();
+						connection.ladder = ladder;
+						connection.link = nullptr;
+						connection.elevator = nullptr;
+						connection.length = -1.0f;
+						connection.how = ladderDir == CNavLadder::LADDER_UP ? GO_LADDER_UP : GO_LADDER_DOWN;
+						functor(connection);
+					}
+				}
+			}
+		}
+
+		const CNavElevator* elevator = area->GetElevator();
+
+		if (elevator != nullptr)
+		{
+			for (auto& floor : elevator->GetFloors())
+			{
+				CNavArea* floorArea = floor.GetArea();
+
+				if (floorArea != nullptr && floorArea != area)
+				{
+					connection.to = floorArea;
+					connection.ladder = nullptr;
+					connection.link = nullptr;
+					connection.elevator = elevator;
+					connection.length = -1.0f;
+					connection.how = floorArea->GetCenter().z > area->GetCenter().z ? GO_ELEVATOR_UP : GO_ELEVATOR_DOWN;
+					functor(connection);
+				}
+			}
+		}
+
+		for (auto& link : area->GetOffMeshConnections())
+		{
+			if (link.m_link.area != nullptr)
+			{
+				connection.to = link.m_link.area;
+				connection.ladder = nullptr;
+				connection.link = &link;
+				connection.elevator = nullptr;
+				connection.length = link.GetConnectionLength();
+				connection.how = GO_OFF_MESH_CONNECTION;
+				functor(connection);
+			}
+		}
+	}
+
+	/**
+	 * @brief Runs a function on each outgoing connection of an area, including ladders, elevators and off-mesh links.
+	 * @tparam F void (CNavArea* connectedArea, float length). Length is the connection length, zero or negative if unknown.
+	 */
+	template <typename F>
+	void ForEachOutgoingConnection(const CNavArea* area, F functor)
+	{
+		ForEachOutgoingAreaConnection(area, [&functor](const NavAreaConnection& connection) {
+			if (connection.ladder != nullptr)
+			{
+				functor(connection.to, connection.ladder->m_length);
+			}
+			else if (connection.elevator != nullptr)
+			{
+				functor(connection.to, connection.elevator->GetLengthBetweenFloors(connection.from, connection.to));
+			}
+			else
+			{
+				functor(connection.to, connection.length);
+			}
+		});
+	}
 }
 
 #endif // !NAVMESH_UTILS_H_
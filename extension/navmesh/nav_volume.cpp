@@ -8,6 +8,7 @@
 #include "nav_mesh.h"
 #include "nav_area.h"
 #include "nav_volume.h"
+#include "nav_pathcache.h"
 
 unsigned int CNavVolume::s_nextID = 0;
 
@@ -97,7 +98,26 @@ void CNavVolume::Update()
 	UpdateBlockedStatus(m_teamIndex, result);
 }
 
-void CNavVolume::Save(std::fstream& filestream, uint32_t version)
+void CNavVolume::UpdateBlockedStatus(int teamID, bool blocked)
+{
+	auto oldBlocked = m_blockedCache;
+
+	if (teamID < 0 || teamID >= static_cast<int>(m_blockedCache.size()))
+	{
+		std::fill(m_blockedCache.begin(), m_blockedCache.end(), blocked);
+	}
+	else
+	{
+		m_blockedCache[teamID] = blocked;
+	}
+
+	if (oldBlocked != m_blockedCache)
+	{
+		TheNavMesh->GetPathCache()->Invalidate();
+	}
+}
+
+void CNavVolume::Save(std::ostream& filestream, uint32_t version)
 {
 	filestream.write(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
 	filestream.write(reinterpret_cast<char*>(&m_origin), sizeof(Vector));
@@ -107,14 +127,14 @@ void CNavVolume::Save(std::fstream& filestream, uint32_t version)
 	m_toggle_condition.Save(filestream, version);
 }
 
-NavErrorType CNavVolume::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+NavErrorType CNavVolume::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	filestream.read(reinterpret_cast<char*>(&m_id), sizeof(unsigned int));
-	filestream.read(reinterpret_cast<char*>(&m_origin), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_mins), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_maxs), sizeof(Vector));
-	filestream.read(reinterpret_cast<char*>(&m_teamIndex), sizeof(int));
-	m_toggle_condition.Load(filestream, version);
+	reader.Read(m_id);
+	reader.Read(m_origin);
+	reader.Read(m_mins);
+	reader.Read(m_maxs);
+	reader.Read(m_teamIndex);
+	m_toggle_condition.Load(reader, version);
 
 	return NAV_OK;
 }
@@ -126,11 +146,22 @@ NavErrorType CNavVolume::PostLoad(void)
 	
 	if (m_teamIndex >= static_cast<int>(NAV_TEAMS_ARRAY_SIZE))
 	{
-		smutils->LogError(myself, "Nav Volume #%i has invalid team index #%i! Limit is %i.\n", m_teamIndex, NAV_TEAMS_ARRAY_SIZE);
+		TheNavMesh->LogLoadMessage(NAV_LOAD_ERROR, "Nav Volume #%i has invalid team index #%i! Limit is %i.", m_id, m_teamIndex, static_cast<int>(NAV_TEAMS_ARRAY_SIZE));
 		m_teamIndex = NAV_TEAM_ANY;
 	}
 
-	SearchForNavAreas();
+	// the areas are already known when restored from the load cache
+	if (m_areas.empty())
+	{
+		SearchForNavAreas();
+	}
+	else
+	{
+		for (auto& area : m_areas)
+		{
+			area->SetNavVolume(this);
+		}
+	}
 
 	return NAV_OK;
 }
@@ -204,7 +235,7 @@ void CNavVolume::SearchForNavAreas()
 
 	if (m_areas.empty())
 	{
-		Warning("Nav Volume #%i: No areas found inside bounds!\n", m_id);
+		TheNavMesh->LogLoadMessage(NAV_LOAD_WARNING, "Nav Volume #%i: No areas found inside bounds!\n", m_id);
 	}
 
 	for (auto& area : m_areas)
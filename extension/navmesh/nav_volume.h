@@ -8,6 +8,7 @@
 #include <sdkports/sdk_ehandle.h>
 #include <sdkports/sdk_timers.h>
 #include "nav.h"
+#include "nav_filereader.h"
 #include "nav_scripting.h"
 
 class CNavVolume
@@ -87,8 +88,8 @@ public:
 		m_scanTimer.Start(1.0f);
 		m_toggle_condition.OnRoundRestart();
 	}
-	virtual void Save(std::fstream& filestream, uint32_t version);
-	virtual NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);
+	virtual void Save(std::ostream& filestream, uint32_t version);
+	virtual NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);
 	virtual NavErrorType PostLoad(void);
 	virtual void Draw() const; // draw this volume
 	void DrawAreas() const;
@@ -105,17 +106,7 @@ public:
 	void ClearToggleData() { m_toggle_condition.clear(); }
 
 protected:
-	void UpdateBlockedStatus(int teamID, bool blocked)
-	{
-		if (teamID < 0 || teamID >= static_cast<int>(m_blockedCache.size()))
-		{
-			std::fill(m_blockedCache.begin(), m_blockedCache.end(), blocked);
-		}
-		else
-		{
-			m_blockedCache[teamID] = blocked;
-		}
-	}
+	void UpdateBlockedStatus(int teamID, bool blocked);
 
 private:
 	friend class CNavMesh;
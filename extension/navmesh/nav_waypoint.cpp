@@ -84,7 +84,7 @@ bool CWaypoint::CanBeUsedByBot(CBaseBot* bot) const
 	return !m_expireUserTimer.HasStarted();
 }
 
-void CWaypoint::Save(std::fstream& filestream, uint32_t version)
+void CWaypoint::Save(std::ostream& filestream, uint32_t version)
 {
 	filestream.write(reinterpret_cast<char*>(&m_ID), sizeof(WaypointID));
 	filestream.write(reinterpret_cast<char*>(&m_origin), sizeof(Vector));
@@ -111,43 +111,43 @@ void CWaypoint::Save(std::fstream& filestream, uint32_t version)
 	}
 }
 
-NavErrorType CWaypoint::Load(std::fstream& filestream, uint32_t version, uint32_t subVersion)
+NavErrorType CWaypoint::Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion)
 {
-	if (!filestream.good())
+	if (!reader.IsGood())
 	{
 		return NAV_CORRUPT_DATA;
 	}
 
-	filestream.read(reinterpret_cast<char*>(&m_ID), sizeof(WaypointID));
-	filestream.read(reinterpret_cast<char*>(&m_origin), sizeof(Vector));
+	reader.Read(m_ID);
+	reader.Read(m_origin);
 
 	for (std::size_t i = 0; i < CWaypoint::MAX_AIM_ANGLES; i++)
 	{
 		QAngle angle;
-		filestream.read(reinterpret_cast<char*>(&angle), sizeof(QAngle));
+		reader.Read(angle);
 		m_aimAngles[i] = angle;
 	}
 
-	filestream.read(reinterpret_cast<char*>(&m_numAimAngles), sizeof(int));
-	filestream.read(reinterpret_cast<char*>(&m_flags), sizeof(int));
-	filestream.read(reinterpret_cast<char*>(&m_teamNum), sizeof(int));
-	filestream.read(reinterpret_cast<char*>(&m_radius), sizeof(float));
+	reader.Read(m_numAimAngles);
+	reader.Read(m_flags);
+	reader.Read(m_teamNum);
+	reader.Read(m_radius);
 
 	{
 		uint64_t size = 0;
-		filestream.read(reinterpret_cast<char*>(&size), sizeof(uint64_t));
+		reader.Read(size);
 
 		for (uint64_t i = 0; i < size; i++)
 		{
 			WaypointID id = 0;
-			filestream.read(reinterpret_cast<char*>(&id), sizeof(WaypointID));
+			reader.Read(id);
 
 			auto& connect = m_connections.emplace_back();
 			connect.connection = id;
 		}
 	}
 
-	if (!filestream.good())
+	if (!reader.IsGood())
 	{
 		return NAV_CORRUPT_DATA;
 	}
@@ -7,6 +7,7 @@
 #include <optional>
 #include <sdkports/sdk_ehandle.h>
 #include "nav.h"
+#include "nav_filereader.h"
 
 class CBaseBot;
 
@@ -99,8 +100,8 @@ public:
 	// Can this bot use this waypoint
 	virtual bool CanBeUsedByBot(CBaseBot* bot) const;
 
-	virtual void Save(std::fstream& filestream, uint32_t version);
-	virtual NavErrorType Load(std::fstream& filestream, uint32_t version, uint32_t subVersion);
+	virtual void Save(std::ostream& filestream, uint32_t version);
+	virtual NavErrorType Load(CNavFileReader& reader, uint32_t version, uint32_t subVersion);
 	virtual NavErrorType PostLoad();
 
 	// Draws this waypoint during editing